@@ -651,6 +651,28 @@ size_t UsefulBuf_IsValue(const UsefulBufC UB, uint8_t uValue);
 size_t UsefulBuf_FindBytes(UsefulBufC BytesToSearch, UsefulBufC BytesToFind);
 
 
+/**
+ * @brief Check that bytes are valid UTF-8.
+ *
+ * @param[in] UB  The bytes to check.
+ *
+ * @return Offset of the first byte of the first invalid sequence or
+ *         @c SIZE_MAX if all of @c UB is valid UTF-8.
+ *
+ * Like UsefulBuf_IsValue(), the test for success is:
+ *
+ *      UsefulBuf_IsValidUTF8(...) == SIZE_MAX
+ *
+ * Valid is as in RFC 3629. Overlong forms, surrogates (U+D800 to
+ * U+DFFF), code points above U+10FFFF and sequences cut off by the
+ * end of @c UB are invalid. An empty or NULL @c UB is valid.
+ *
+ * Runs of ASCII are checked eight bytes at a time so mostly-ASCII
+ * text checks at several bytes per cycle.
+ */
+size_t UsefulBuf_IsValidUTF8(const UsefulBufC UB);
+
+
 /**
  * @brief Convert a pointer to an offset with bounds checking.
  *
@@ -33,6 +33,9 @@
 #ifndef qcbor_common_h
 #define qcbor_common_h
 
+#include <stdint.h>
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #if 0
@@ -382,9 +385,12 @@ typedef enum {
    QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP = 41,
 
    /** During decoding, the array or map had too many items in it.
-    *  This limit is @ref QCBOR_MAX_ITEMS_IN_ARRAY (65,534) for
-    *  arrays and @ref QCBOR_MAX_ITEMS_IN_MAP (32,767) for maps. This
-    *  error makes no further decoding possible. */
+    *  This limit is @ref QCBOR_MAX_ITEMS_IN_ARRAY (65,534 by default)
+    *  for arrays and @ref QCBOR_MAX_ITEMS_IN_MAP (32,767 by default)
+    *  for maps. See @ref QCBORCount to raise it. Also
+    *  set by QCBORDecode_GetInt64Array() and similar when the array
+    *  has more items than the caller's buffer. This error makes no
+    *  further decoding possible. */
    QCBOR_ERR_ARRAY_DECODE_TOO_LONG = 42,
 
    /** When decoding, a string's size is greater than what a size_t
@@ -541,6 +547,49 @@ typedef enum {
     * a @ref QCBORStringAllocate. */
    QCBOR_ERR_CANNOT_ENTER_ALLOCATED_STRING = 79,
 
+   /** The storage given to QCBORDecode_BuildContainerIndex() is too
+    * small for the number of maps and arrays in the input. */
+   QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL = 80,
+
+   /** In streaming mode the input ended in the middle of a data item
+    * or inside an array or map. Decoding can continue after more
+    * input is given with QCBORDecode_ContinueInput(). See
+    * QCBORDecode_EnableStreaming(). */
+   QCBOR_ERR_NEED_MORE_INPUT = 81,
+
+   /** The storage given to QCBORDecode_SetNestingStorage() is not
+    * aligned or is too small for the nesting levels in use. */
+   QCBOR_ERR_NESTING_STORAGE = 82,
+
+   /** The storage given to QCBORDecode_SetDuplicateLabelCheck() is
+    * too small for the number of items in a map entered. */
+   QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL = 83,
+
+   /** QCBORDecode_CheckDeterministic() found an integer, length, tag
+    * number or float that is not encoded in its shortest form. */
+   QCBOR_ERR_NOT_PREFERRED = 84,
+
+   /** QCBORDecode_CheckDeterministic() found an indefinite-length
+    * string, array or map. */
+   QCBOR_ERR_INDEFINITE_NOT_ALLOWED = 85,
+
+   /** QCBORDecode_CheckDeterministic() found map labels that are not
+    * in the bytewise lexicographic order of their encoding. */
+   QCBOR_ERR_UNSORTED = 86,
+
+   /** A text string is not valid UTF-8. This is only checked for
+    * when enabled with QCBORDecode_EnableUTF8Check() or
+    * QCBOREncode_EnableUTF8Check(). */
+   QCBOR_ERR_INVALID_UTF8 = 87,
+
+   /** The descriptor passed to QCBORDecode_GetStruct() has too many
+    * fields or a field type it can't fill in. */
+   QCBOR_ERR_STRUCT_DESCRIPTOR = 88,
+
+   /** The path passed to QCBORPath_Compile() has a syntax error or
+    * too many steps. */
+   QCBOR_ERR_PATH_SYNTAX = 89,
+
    /** A range of error codes that can be made use of by the
     * caller. QCBOR internally does nothing with these except notice
     * that they are not QCBOR_SUCCESS. See QCBORDecode_SetError(). */
@@ -580,15 +629,61 @@ qcbor_err_to_str(QCBORError uErr);
 #define QCBOR_MAX_ARRAY_NESTING  15
 
 
+/**
+ * Byte offsets into the input to the decoder are this type.
+ *
+ * By default it is @c uint32_t which limits decoder input to a little
+ * less than 4GB and keeps @ref QCBORDecodeContext small. When @c
+ * QCBOR_WIDE_OFFSETS is defined it is @c size_t so decoder input,
+ * such as a memory-mapped file, can be larger. This costs about 140
+ * bytes more for @ref QCBORDecodeContext on a 64-bit CPU.
+ *
+ * @c QCBOR_WIDE_OFFSETS must be defined the same for the library and
+ * for code that uses it.
+ */
+#ifndef QCBOR_WIDE_OFFSETS
+typedef uint32_t QCBOROffset;
+#define QCBOR_OFFSET_MAX UINT32_MAX
+#else /* ! QCBOR_WIDE_OFFSETS */
+typedef size_t QCBOROffset;
+#define QCBOR_OFFSET_MAX SIZE_MAX
+#endif /* ! QCBOR_WIDE_OFFSETS */
+
+
+/**
+ * The number of items in a map or array is this type when encoding
+ * and decoding.
+ *
+ * By default it is @c uint16_t which limits maps and arrays to
+ * @ref QCBOR_MAX_ITEMS_IN_ARRAY items and keeps the encode and decode
+ * contexts small. When @c QCBOR_WIDE_COUNTS is defined it is @c
+ * uint32_t so maps and arrays can have a few billion items. This
+ * costs 64 bytes more for each of @ref QCBORDecodeContext and
+ * @ref QCBOREncodeContext on a 64-bit CPU, but no measurable speed.
+ *
+ * @c QCBOR_WIDE_COUNTS must be defined the same for the library and
+ * for code that uses it.
+ */
+#ifndef QCBOR_WIDE_COUNTS
+typedef uint16_t QCBORCount;
+#define QCBOR_COUNT_MAX UINT16_MAX
+#else /* ! QCBOR_WIDE_COUNTS */
+typedef uint32_t QCBORCount;
+#define QCBOR_COUNT_MAX UINT32_MAX
+#endif /* ! QCBOR_WIDE_COUNTS */
+
+
 /**
  * The maximum number of items in a single array when encoding or
- * decoding. See also @ref QCBOR_MAX_ITEMS_IN_MAP.
+ * decoding. It is 65,534 unless @c QCBOR_WIDE_COUNTS is defined. See
+ * also @ref QCBOR_MAX_ITEMS_IN_MAP.
  */
-#define QCBOR_MAX_ITEMS_IN_ARRAY (UINT16_MAX-1) /* -1 is because the
-                                                 * value UINT16_MAX is
-                                                 * used to indicate
-                                                 * indefinite-length.
-                                                 */
+#define QCBOR_MAX_ITEMS_IN_ARRAY (QCBOR_COUNT_MAX-1) /* -1 is because the
+                                                      * value
+                                                      * QCBOR_COUNT_MAX is
+                                                      * used to indicate
+                                                      * indefinite-length.
+                                                      */
 /**
  * The maximum number of items in a single map when encoding or
  * decoding. See also @ref QCBOR_MAX_ITEMS_IN_ARRAY.
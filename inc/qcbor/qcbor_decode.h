@@ -199,9 +199,11 @@ typedef enum {
 
 /**
  * The maximum size of input to the decoder. Slightly less than
- * @c UINT32_MAX to make room for some special indicator values.
+ * @c UINT32_MAX to make room for some special indicator values. It is
+ * slightly less than @c SIZE_MAX if @c QCBOR_WIDE_OFFSETS is defined
+ * (see @ref QCBOROffset).
  */
-#define QCBOR_MAX_DECODE_INPUT_SIZE (UINT32_MAX - 2)
+#define QCBOR_MAX_DECODE_INPUT_SIZE (QCBOR_OFFSET_MAX - 2)
 
 /**
  * The maximum number of tags that may occur on an individual nested
@@ -475,11 +477,12 @@ typedef struct _QCBORItem {
       UsefulBufC  string;
       /** The "value" for @c uDataType @ref QCBOR_TYPE_ARRAY or @ref
        *  QCBOR_TYPE_MAP, the number of items in the array or map.  It
-       *  is @c UINT16_MAX when decoding indefinite-lengths maps and
-       *  arrays. Detection of the end of a map or array is best done
-       *  with @c uNestLevel and @c uNextNestLevel so as to work for
-       *  both definite and indefinite length maps and arrays. */
-      uint16_t    uCount;
+       *  is @ref QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH when decoding
+       *  indefinite-lengths maps and arrays. Detection of the end of a
+       *  map or array is best done with @c uNestLevel and @c
+       *  uNextNestLevel so as to work for both definite and indefinite
+       *  length maps and arrays. */
+      QCBORCount  uCount;
 #ifndef USEFULBUF_DISABLE_ALL_FLOAT
       /** The value for @c uDataType @ref QCBOR_TYPE_DOUBLE. All floating-point
        * values (double, single and half-precision) are returned as a double except when
@@ -567,7 +570,48 @@ typedef struct _QCBORItem {
 /**
  * An array or map's length is indefinite when it has this value.
  */
-#define QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH UINT16_MAX
+#define QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH QCBOR_COUNT_MAX
+
+
+/**
+ * @brief A smaller decoded data item for QCBORDecode_GetNextLite().
+ *
+ * This has the fields of @ref QCBORItem that are needed for plain
+ * data items. There are no tag numbers, allocation flags or next
+ * nesting level and the @c val union has no members for tag content
+ * like dates and big floats. See QCBORItem for the description of
+ * each field.
+ */
+typedef struct _QCBORItemLite {
+   /** See QCBORItem.uDataType */
+   uint8_t  uDataType;
+   /** See QCBORItem.uLabelType */
+   uint8_t  uLabelType;
+   /** See QCBORItem.uNestingLevel */
+   uint8_t  uNestingLevel;
+
+   /** See QCBORItem.val */
+   union {
+      int64_t     int64;
+      uint64_t    uint64;
+      UsefulBufC  string;
+      QCBORCount  uCount;
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+      double      dfnum;
+      float       fnum;
+#endif /* USEFULBUF_DISABLE_ALL_FLOAT */
+      uint8_t     uSimple;
+   } val;
+
+   /** See QCBORItem.label */
+   union {
+      int64_t     int64;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+      uint64_t    uint64;
+      UsefulBufC  string;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   } label;
+} QCBORItemLite;
 
 
 
@@ -792,6 +836,59 @@ QCBORDecode_SetUpAllocator(QCBORDecodeContext *pCtx,
                            bool                bAllStrings);
 
 
+/**
+ * The size of storage for QCBORDecode_SetNestingStorage() to decode
+ * maps, arrays and byte-string wrapped CBOR nested @c uMaxNesting
+ * deep. Each level is 9 bytes (13 with QCBOR_WIDE_COUNTS, 17 with
+ * QCBOR_WIDE_OFFSETS) and there
+ * is room for a second copy to save the levels while decoding ahead.
+ */
+#define QCBOR_DECODE_NESTING_STORAGE_SIZE(uMaxNesting) \
+   (((uMaxNesting) + 1) * 2 * (sizeof(QCBORDecodeLevel) + 1))
+
+
+/**
+ * @brief Use caller-provided storage to track map and array nesting.
+ *
+ * @param[in] pCtx     The decode context.
+ * @param[in] Storage  The storage or @ref NULLUsefulBuf to go back to
+ *                     the built-in storage.
+ *
+ * @return @ref QCBOR_ERR_NESTING_STORAGE if @c Storage is not aligned
+ *         for a @c uint64_t or is too small for the levels currently
+ *         entered.
+ *
+ * The context has storage built in for nesting
+ * @ref QCBOR_MAX_ARRAY_NESTING deep. With this, maps, arrays and
+ * byte-string wrapped CBOR can be nested as deep as @c Storage
+ * allows, up to 253, or limited to less. Input that is nested
+ * deeper gets @ref QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP. Use
+ * @ref QCBOR_DECODE_NESTING_STORAGE_SIZE to size @c Storage.
+ *
+ * This is usually called right after QCBORDecode_Init(), but it can
+ * be called at any point. The levels in use are copied over.
+ * @c Storage must remain valid until decoding is finished or this is
+ * called again.
+ *
+ * Some things stay limited to @ref QCBOR_MAX_ARRAY_NESTING levels
+ * whatever the storage:
+ * - When nested deeper, QCBORDecode_SaveCursor() gives @ref
+ *   QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP and the cache from
+ *   QCBORDecode_SetPeekCache() isn't used.
+ * - Fast skipping with QCBORDecode_EnableFastSkip() falls back to
+ *   decoding for maps and arrays nested deeper.
+ * - QCBORDecode_GetByPath() paths have at most that many steps and
+ *   the items it skips over can be nested at most that much.
+ * - QCBORDecode_ValidateWellFormed(), QCBORDecode_CheckDeterministic(),
+ *   QCBORDecode_Walk(), QCBORDecode_GetNextSequenceItem(),
+ *   QCBORDecode_SplitSequence() and QCBORDecode_BuildContainerIndex()
+ *   don't use a decode context. They give @ref
+ *   QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP for input nested deeper.
+ */
+QCBORError
+QCBORDecode_SetNestingStorage(QCBORDecodeContext *pCtx, UsefulBuf Storage);
+
+
 /**
  * @brief Get the next item (integer, byte string, array...) in the
  * preorder traversal of the CBOR tree.
@@ -880,7 +977,7 @@ QCBORDecode_SetUpAllocator(QCBORDecodeContext *pCtx,
  * end of a map or array. Alternatively, for definite-length arrays,
  * @c QCBORItem.val.uCount contains the number of items in the
  * array. For indefinite-length arrays, @c QCBORItem.val.uCount
- * is @c UINT16_MAX.
+ * is @ref QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH.
  *
  * All tags defined in RFC 8949 are automatically fully decoded. There
  * are QCBOR_TYPES and members in @ref QCBORItem for them. For
@@ -1060,12 +1157,95 @@ QCBORError
 QCBORDecode_PeekNext(QCBORDecodeContext *pCtx, QCBORItem *pDecodedItem);
 
 
+/**
+ * Storage for QCBORDecode_SetPeekCache(). The members are private.
+ */
+typedef struct _QCBORPeekCache {
+   /* PRIVATE DATA STRUCTURE */
+   /* The peeked item and the decoder state after it */
+   QCBORItem               Item;
+   UsefulInputBuf          InBuf;
+   QCBORDecodeNestingSave  Nesting;
+   /* The decoder state before it to know the cache applies */
+   const void             *pInput;
+   size_t                  uInputLen;
+   size_t                  uCursor;
+   const void             *pLevels;
+   QCBORDecodeLevel        Level;
+   uint8_t                 uLevelType;
+   uint8_t                 uCurrent;
+   uint8_t                 uCurrentBounded;
+   uint8_t                 bValid;
+} QCBORPeekCache;
+
+
+/**
+ * @brief Keep the item from a peek so the next get doesn't decode it again.
+ *
+ * @param[in] pCtx    The decoder context.
+ * @param[in] pCache  Storage for the cached item or @c NULL to stop.
+ *
+ * Normally QCBORDecode_PeekNext() decodes the next item and then
+ * restores the traversal cursor, so the QCBORDecode_GetNext() that
+ * usually follows decodes the same item again. With a cache set, the
+ * peeked item and the decoder state after it are kept in @c *pCache.
+ * A QCBORDecode_GetNext() or QCBORDecode_PeekNext() from the same
+ * place then just uses them. This saves most of the second decode,
+ * which matters most for items that are costly to decode, such as
+ * those with tags or allocated strings.
+ *
+ * Every call that moves the traversal cursor, for example
+ * QCBORDecode_EnterMap() or QCBORDecode_GetInt64(), makes the cache
+ * not apply, so it is safe to mix with any other decode calls. Only
+ * successfully peeked items are cached.
+ *
+ * @c *pCache is about 290 bytes on a 64-bit machine. It must remain
+ * valid for the life of the context or until this is called again
+ * with @c NULL. It doesn't need to be initialized.
+ */
+void
+QCBORDecode_SetPeekCache(QCBORDecodeContext *pCtx, QCBORPeekCache *pCache);
+
+
+/**
+ * @brief Preorder traversal like QCBORDecode_GetNext() into a smaller item.
+ *
+ * @param[in]  pCtx   The decoder context.
+ * @param[out] pItem  The decoded CBOR item.
+ *
+ * @return See error table of decoding errors set by QCBORDecode_VGetNext().
+ *
+ * This is for loops over large numbers of data items where the
+ * caller doesn't need tags or @c uNextNestLevel. It is like
+ * QCBORDecode_GetNext() except for the following.
+ *
+ * Tag numbers are skipped over and the tag content is returned as
+ * is. For example, an epoch date is returned as @ref
+ * QCBOR_TYPE_INT64 rather than @ref QCBOR_TYPE_DATE_EPOCH. The tag
+ * numbers are not available from QCBORDecode_GetNthTagOfLast().
+ *
+ * There is no indication of whether a string was allocated by the
+ * string allocator. Don't use this with an allocator whose strings
+ * have to be freed individually.
+ *
+ * Integers and definite-length strings at the top level or in a
+ * definite-length array are decoded straight into @c pItem without
+ * going through the layers of decoding and nesting bookkeeping that
+ * other data items need. For large arrays of integers or strings
+ * this is much faster than QCBORDecode_GetNext().
+ *
+ * It can be mixed with calls to all the other decode functions.
+ */
+QCBORError
+QCBORDecode_GetNextLite(QCBORDecodeContext *pCtx, QCBORItemLite *pItem);
+
+
 /**
  * @brief Get the current traversal cursort offset in the input CBOR.
  *
  * @param[in]  pCtx   The decoder context.
  *
- * @returns The traversal cursor offset or @c UINT32_MAX.
+ * @returns The traversal cursor offset or @ref QCBOR_OFFSET_MAX.
 
  * The position returned is always the start of the next item that
  * would be next decoded with QCBORDecode_VGetNext(). The cursor
@@ -1074,7 +1254,8 @@ QCBORDecode_PeekNext(QCBORDecodeContext *pCtx, QCBORItem *pDecodedItem);
  * QCBOR_ERR_NO_MORE_ITEMS. See also QCBORDecode_AtEnd().
  *
  * If the decoder is in error state from previous decoding,
- * @c UINT32_MAX is returned.
+ * @ref QCBOR_OFFSET_MAX is returned. It is @c UINT32_MAX unless @c
+ * QCBOR_WIDE_OFFSETS is defined.
  *
  * When decoding map items, the position returned is always of the
  * label, never the value.
@@ -1102,7 +1283,7 @@ QCBORDecode_PeekNext(QCBORDecodeContext *pCtx, QCBORItem *pDecodedItem);
  * There is no corresponding seek method because it is too complicated
  * to restore the internal decoder state that tracks nesting.
  */
-static uint32_t
+static QCBOROffset
 QCBORDecode_Tell(QCBORDecodeContext *pCtx);
 
 
@@ -1253,6 +1434,555 @@ QCBORError
 QCBORDecode_PartialFinish(QCBORDecodeContext *pCtx, size_t *puConsumed);
 
 
+/**
+ * @brief Check that input is one well-formed CBOR data item.
+ *
+ * @param[in]  EncodedCBOR    The input to check.
+ * @param[out] puErrorOffset  Offset of the error. May be @c NULL.
+ *
+ * @returns @ref QCBOR_SUCCESS or the not-well-formed error.
+ *
+ * This checks that @c EncodedCBOR is exactly one well-formed data
+ * item in a single pass without a decode context, without a string
+ * allocator and without creating any @ref QCBORItem. It is much
+ * faster than traversing the input with QCBORDecode_VGetNext() and
+ * is intended for screening input before it is stored, forwarded or
+ * decoded.
+ *
+ * Only well-formedness is checked (RFC 8949 Appendix F). Tag content,
+ * map label types, duplicate labels and such are not. It is not
+ * affected by the decoder feature #defines like @c
+ * QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS or @c QCBOR_DISABLE_TAGS, so
+ * some input that passes here may still not be decodable by a
+ * particular build of QCBOR.
+ *
+ * The errors returned are the same as QCBORDecode_GetNext() returns
+ * for the same not-well-formed input, for example @ref
+ * QCBOR_ERR_HIT_END, @ref QCBOR_ERR_BAD_BREAK and @ref
+ * QCBOR_ERR_UNSUPPORTED. Arrays and maps nested deeper than @ref
+ * QCBOR_MAX_ARRAY_NESTING give @ref
+ * QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP. This is fixed and not
+ * affected by QCBORDecode_SetNestingStorage(). If there are bytes left
+ * after the data item, @ref QCBOR_ERR_EXTRA_BYTES is returned.
+ *
+ * On error @c *puErrorOffset is the offset of the head of the data
+ * item or string chunk where the error was found. For @ref
+ * QCBOR_ERR_HIT_END it is the length of the input and for @ref
+ * QCBOR_ERR_EXTRA_BYTES it is the offset of the first extra byte. On
+ * success it is the length of the input.
+ */
+QCBORError
+QCBORDecode_ValidateWellFormed(UsefulBufC EncodedCBOR, size_t *puErrorOffset);
+
+
+/**
+ * @brief Check that encoded CBOR is deterministically encoded.
+ *
+ * @param[in] EncodedCBOR     The CBOR to check.
+ * @param[out] puErrorOffset  Offset of the error or NULL.
+ *
+ * @returns @ref QCBOR_SUCCESS, one of the errors below or a
+ *          not-well-formed error.
+ *
+ * This checks that a data item follows the core deterministic
+ * encoding requirements of RFC 8949 section 4.2.1. It is for
+ * protocols that sign or hash CBOR and need it to have only one
+ * encoding. It is a single pass over the input with no decode
+ * context and no @ref QCBORItem, so it is much faster than decoding,
+ * re-encoding and comparing.
+ *
+ * These are checked:
+ * - Integers, lengths, counts and tag numbers have the shortest head
+ *   (@ref QCBOR_ERR_NOT_PREFERRED).
+ * - Floats are the shortest of half, single and double that keeps
+ *   the value exactly, the same reduction as the encoder's preferred
+ *   serialization (@ref QCBOR_ERR_NOT_PREFERRED).
+ * - There are no indefinite-length strings, arrays or maps (@ref
+ *   QCBOR_ERR_INDEFINITE_NOT_ALLOWED).
+ * - Map labels are sorted in the bytewise lexicographic order of
+ *   their encoding (@ref QCBOR_ERR_UNSORTED) and there are no
+ *   duplicates (@ref QCBOR_ERR_DUPLICATE_LABEL).
+ *
+ * The input is also checked for well-formedness the same as
+ * QCBORDecode_ValidateWellFormed(), including the limit of @ref
+ * QCBOR_MAX_ARRAY_NESTING levels of maps and arrays. Integers that
+ * could be encoded smaller as floats or the reverse are not checked
+ * for, nor are the rules of any particular tag.
+ *
+ * Checking floats needs the half-precision conversion. If it is
+ * disabled with @c QCBOR_DISABLE_PREFERRED_FLOAT or @c
+ * USEFULBUF_DISABLE_ALL_FLOAT, input with a float gives @ref
+ * QCBOR_ERR_HALF_PRECISION_DISABLED or @ref
+ * QCBOR_ERR_ALL_FLOAT_DISABLED.
+ *
+ * On error @c *puErrorOffset is the offset of the head where the
+ * error was found. For unsorted and duplicate labels it is the
+ * offset of the second label. Other offsets are the same as
+ * QCBORDecode_ValidateWellFormed().
+ */
+QCBORError
+QCBORDecode_CheckDeterministic(UsefulBufC EncodedCBOR, size_t *puErrorOffset);
+
+
+/**
+ * @brief Get the next data item in a CBOR sequence as encoded bytes.
+ *
+ * @param[in] Sequence      The whole CBOR sequence.
+ * @param[in,out] puOffset  Offset of the item to get. Advanced past it
+ *                          on success.
+ * @param[out] pItem        The encoded data item.
+ *
+ * @returns @ref QCBOR_SUCCESS, @ref QCBOR_ERR_NO_MORE_ITEMS at the end
+ *          of @c Sequence or a not-well-formed error.
+ *
+ * This splits a CBOR sequence (RFC 8742) into its data items without
+ * decoding them or using a decode context. Each is checked for
+ * well-formedness the same as QCBORDecode_ValidateWellFormed(), so
+ * maps and arrays in it can be nested at most @ref
+ * QCBOR_MAX_ARRAY_NESTING deep. It is for large sequences, such as log files, where each item is decoded
+ * on its own with QCBORDecode_Init() on @c *pItem.
+ *
+ * @c *puOffset only moves forward so it tells how much of @c
+ * Sequence is done with. When @c Sequence is a memory-mapped file,
+ * use it to give the OS paging hints. QCBOR has no OS dependencies
+ * so this part is left to the caller. On POSIX systems it is
+ * something like this:
+ *
+ * @code
+ *    p = mmap(NULL, uLen, PROT_READ, MAP_PRIVATE, fd, 0);
+ *    madvise(p, uLen, MADV_SEQUENTIAL);
+ *    uOffset = uDone = 0;
+ *    while(QCBORDecode_GetNextSequenceItem((UsefulBufC){p, uLen}, &uOffset, &Item) == QCBOR_SUCCESS) {
+ *       // Decode Item
+ *       if(uOffset - uDone >= CHUNK) {  // CHUNK is a multiple of the page size
+ *          madvise(p + uDone, CHUNK, MADV_DONTNEED);
+ *          madvise(p + uDone + CHUNK, CHUNK, MADV_WILLNEED);
+ *          uDone += CHUNK;
+ *       }
+ *    }
+ * @endcode
+ *
+ * tools/qcbor_mmap.h is a complete version of this. It is not part of
+ * the library. Build it with the @c tools make target or the CMake
+ * option BUILD_QCBOR_TOOLS.
+ *
+ * On error @c *puOffset is not changed and @c *pItem is @ref
+ * NULLUsefulBufC. The items before it are still good, but the rest
+ * of the sequence can't be split up because where the next item
+ * starts isn't known.
+ */
+QCBORError
+QCBORDecode_GetNextSequenceItem(UsefulBufC  Sequence,
+                                size_t     *puOffset,
+                                UsefulBufC *pItem);
+
+
+/**
+ * @brief Find where each of a batch of items in a CBOR sequence ends.
+ *
+ * @param[in] Sequence      The whole CBOR sequence.
+ * @param[in,out] puOffset  Offset of the first item to find. Advanced
+ *                          past the last one found.
+ * @param[out] puEnds       Array to fill with the offset just past
+ *                          each item found.
+ * @param[in] uMaxEnds      Number of entries in @c puEnds.
+ * @param[out] puNumEnds    Number of entries filled in @c puEnds.
+ *
+ * @returns @ref QCBOR_SUCCESS, @ref QCBOR_ERR_NO_MORE_ITEMS if @c
+ *          *puOffset is already at the end of @c Sequence or a
+ *          not-well-formed error.
+ *
+ * This is QCBORDecode_GetNextSequenceItem() for up to @c uMaxEnds
+ * items at a time. Item @c i is from @c puEnds[i-1], or the original
+ * @c *puOffset for the first, to @c puEnds[i]. It stops early at the
+ * end of @c Sequence. The same limit of @ref QCBOR_MAX_ARRAY_NESTING
+ * levels applies to each item.
+ *
+ * It is for decoding a large sequence of independent items, such as
+ * a log file, on several threads. Finding where items end can only
+ * be done in order from the start, but it only scans heads so one
+ * thread can usually keep many decoding threads busy. One thread
+ * finds the ends of a batch of items, and then gives ranges of them
+ * to worker threads, each decoding with its own
+ * QCBORDecodeContext. Nothing in QCBOR is shared between threads
+ * this way, so no locking is needed. QCBOR has no OS dependencies,
+ * so the threads, the order results are handled in and waiting for
+ * workers are left to the caller. Something like:
+ *
+ * @code
+ *    uOffset = 0;
+ *    do {
+ *       uStart = uOffset;
+ *       uErr = QCBORDecode_SplitSequence(Seq, &uOffset, auEnds, BATCH, &uNum);
+ *       for(i = 0; i < uNum; i++) {
+ *          // Hand {Seq.ptr + uStart, auEnds[i] - uStart} to a worker
+ *          // that calls QCBORDecode_Init() on it
+ *          uStart = auEnds[i];
+ *       }
+ *       // Wait for the workers before reusing auEnds
+ *    } while(uErr == QCBOR_SUCCESS);
+ * @endcode
+ *
+ * On error the items found before the one in error are in @c puEnds
+ * and @c *puNumEnds and @c *puOffset is the start of the one in
+ * error. As with QCBORDecode_GetNextSequenceItem(), the rest of the
+ * sequence can't be split up.
+ */
+QCBORError
+QCBORDecode_SplitSequence(UsefulBufC  Sequence,
+                          size_t     *puOffset,
+                          size_t     *puEnds,
+                          size_t      uMaxEnds,
+                          size_t     *puNumEnds);
+
+
+/** The count given to QCBORWalkCallbacks.pfStart for indefinite-length
+ *  maps, arrays and strings. */
+#define QCBOR_WALK_INDEFINITE_LENGTH UINT64_MAX
+
+/**
+ * The callbacks for QCBORDecode_Walk(), one for each kind of event.
+ * Any of them may be @c NULL to ignore that kind of event. Each is
+ * passed the @c pCBCtx given to QCBORDecode_Walk(). If one returns
+ * other than @ref QCBOR_SUCCESS the walk stops and returns that
+ * error. @ref QCBOR_ERR_CALLBACK_FAIL is for errors that are not
+ * CBOR errors, as for @ref QCBORItemCallback.
+ */
+typedef struct _QCBORWalkCallbacks {
+   /** An integer from @c INT64_MIN to @c INT64_MAX. */
+   QCBORError (*pfInt)(void *pCBCtx, int64_t nValue);
+
+   /** A positive integer larger than @c INT64_MAX. */
+   QCBORError (*pfUInt)(void *pCBCtx, uint64_t uValue);
+
+   /** A definite-length string or one chunk of an indefinite-length
+    *  string. @c uDataType is @ref QCBOR_TYPE_BYTE_STRING or @ref
+    *  QCBOR_TYPE_TEXT_STRING. @c String points into the input. */
+   QCBORError (*pfString)(void *pCBCtx, uint8_t uDataType, UsefulBufC String);
+
+   /** The start of a map, array or indefinite-length string. @c
+    *  uDataType is @ref QCBOR_TYPE_ARRAY, @ref QCBOR_TYPE_MAP, @ref
+    *  QCBOR_TYPE_BYTE_STRING or @ref QCBOR_TYPE_TEXT_STRING. @c uCount
+    *  is the number of items in an array or pairs in a map, or @ref
+    *  QCBOR_WALK_INDEFINITE_LENGTH. */
+   QCBORError (*pfStart)(void *pCBCtx, uint8_t uDataType, uint64_t uCount);
+
+   /** The end of what pfStart started, with the same @c uDataType. */
+   QCBORError (*pfEnd)(void *pCBCtx, uint8_t uDataType);
+
+   /** A tag number. The events for the tag content follow. */
+   QCBORError (*pfTag)(void *pCBCtx, uint64_t uTagNumber);
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+   /** A half, single or double-precision value. */
+   QCBORError (*pfFloat)(void *pCBCtx, double dValue);
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+   /** A simple value, including false, true, null and undefined,
+    *  which are the same as @ref QCBOR_TYPE_FALSE, @ref
+    *  QCBOR_TYPE_TRUE, @ref QCBOR_TYPE_NULL and @ref
+    *  QCBOR_TYPE_UNDEF. */
+   QCBORError (*pfSimple)(void *pCBCtx, uint8_t uSimpleValue);
+} QCBORWalkCallbacks;
+
+
+/**
+ * @brief Decode CBOR by calling a function for each event.
+ *
+ * @param[in] EncodedCBOR     A CBOR sequence of zero or more data items.
+ * @param[in] pCallbacks      The functions to call.
+ * @param[in] pCBCtx          Context passed to each of them.
+ * @param[out] puErrorOffset  Where decoding stopped. May be @c NULL.
+ *
+ * @returns @ref QCBOR_SUCCESS, an error from a callback or a decode
+ *          error.
+ *
+ * This is a push, or SAX-style, decoder. It runs through all of @c
+ * EncodedCBOR in one loop, calling the functions in @c pCallbacks
+ * as it goes. There is no decode context, no @ref QCBORItem and no
+ * string allocator. For processing every item it is two to three
+ * times faster than a loop on QCBORDecode_GetNext().
+ *
+ * Maps and arrays come as a pfStart event, the events for each item
+ * in them and a pfEnd event. In a map the items alternate between
+ * label and value. Tag numbers come as pfTag events before their
+ * content. Tags are not processed into types like dates and big
+ * numbers, nor are labels checked for type or duplicates.
+ * Indefinite-length strings come as pfStart, a pfString for each
+ * chunk and pfEnd.
+ *
+ * The same errors as QCBORDecode_GetNext() are returned for
+ * not-well-formed input and for features disabled with #defines like
+ * @c QCBOR_DISABLE_TAGS. Maps and arrays can be nested @ref
+ * QCBOR_MAX_ARRAY_NESTING deep, as for
+ * QCBORDecode_ValidateWellFormed(). Counts are not limited to @ref
+ * QCBOR_MAX_ITEMS_IN_ARRAY. Some events may have been delivered for
+ * input that turns out to be not well-formed.
+ *
+ * @c *puErrorOffset is set the same as by
+ * QCBORDecode_ValidateWellFormed(). When a callback returns an error
+ * it is the offset of the head of the item it was called for.
+ */
+QCBORError
+QCBORDecode_Walk(UsefulBufC                EncodedCBOR,
+                 const QCBORWalkCallbacks *pCallbacks,
+                 void                     *pCBCtx,
+                 size_t                   *puErrorOffset);
+
+
+/**
+ * One entry in a container index built by
+ * QCBORDecode_BuildContainerIndex(). There is one for each map and
+ * array in the input in the order their heads occur.
+ */
+typedef struct _QCBORContainerIndexEntry {
+   /** Offset of the first byte after the head of the map or array. */
+   QCBOROffset uContentOffset;
+   /** Offset of the first byte after the map or array, after the
+    * break for indefinite lengths. */
+   QCBOROffset uEndOffset;
+   /** Number of items in an array or pairs in a map. @ref
+    * QCBOR_COUNT_MAX if there are more than can be decoded. */
+   QCBORCount  uCount;
+} QCBORContainerIndexEntry;
+
+
+/**
+ * @brief Index the maps and arrays in some CBOR.
+ *
+ * @param[in] EncodedCBOR    The input to index.
+ * @param[out] pIndex        Storage for the index. May be @c NULL if
+ *                           @c uIndexSize is 0.
+ * @param[in] uIndexSize     Number of entries in @c pIndex.
+ * @param[out] puIndexCount  The number of entries needed for the
+ *                           input.
+ *
+ * @returns @ref QCBOR_SUCCESS, @ref QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL,
+ *          @ref QCBOR_ERR_INPUT_TOO_LARGE or a not-well-formed error.
+ *
+ * This makes one pass over the input, a CBOR sequence of one or more
+ * items, recording the start, end and count of each map and array in
+ * @c pIndex. It checks well-formedness in the same way as
+ * QCBORDecode_ValidateWellFormed(). Maps and arrays nested deeper
+ * than @ref QCBOR_MAX_ARRAY_NESTING give @ref
+ * QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP, even if the context the
+ * index is for has deeper storage from
+ * QCBORDecode_SetNestingStorage().
+ *
+ * If @c pIndex is too small, @c *puIndexCount is still set to the
+ * number of entries needed so this can be called once with a @c
+ * uIndexSize of 0 to size the storage.
+ *
+ * The index is used by attaching it to a decode context with
+ * QCBORDecode_SetContainerIndex().
+ */
+QCBORError
+QCBORDecode_BuildContainerIndex(UsefulBufC                EncodedCBOR,
+                                QCBORContainerIndexEntry *pIndex,
+                                size_t                    uIndexSize,
+                                size_t                   *puIndexCount);
+
+
+/**
+ * @brief Attach a container index to a decode context.
+ *
+ * @param[in] pCtx         The decode context.
+ * @param[in] pIndex       Index from QCBORDecode_BuildContainerIndex().
+ * @param[in] uIndexCount  The number of entries in @c pIndex.
+ *
+ * With an index attached, skipping over a map or array jumps
+ * straight to its end rather than decoding every item in it. This
+ * applies to QCBORDecode_VGetNextConsume(), QCBORDecode_GetArray(),
+ * QCBORDecode_GetMap(), QCBORDecode_ExitMap(),
+ * QCBORDecode_ExitArray() and all the functions that search a map
+ * for a label like QCBORDecode_GetInt64InMapN(). For large input that
+ * is searched many times this replaces repeated rescans with a
+ * lookup.
+ *
+ * The index must have been built from the exact same input given to
+ * QCBORDecode_Init() and must remain valid for the life of the
+ * context. Maps and arrays not in the index, such as those in byte
+ * string wrapped CBOR, are skipped the usual way.
+ *
+ * Since the contents of a skipped map or array are not decoded,
+ * errors other than well-formedness errors in them, for example
+ * unsupported tag content or map labels of the wrong type, are not
+ * reported.
+ *
+ * Pass @c NULL and 0 to detach the index.
+ */
+void
+QCBORDecode_SetContainerIndex(QCBORDecodeContext             *pCtx,
+                              const QCBORContainerIndexEntry *pIndex,
+                              size_t                          uIndexCount);
+
+
+/**
+ * @brief Skip maps and arrays by scanning instead of decoding.
+ *
+ * @param[in] pCtx  The decode context.
+ *
+ * Normally skipping over a map or array decodes every data item in
+ * it the same as QCBORDecode_GetNext() would, including tag content
+ * processing and string allocation. With fast skip enabled, only the
+ * heads are decoded and string contents are jumped over. This is
+ * used by QCBORDecode_VGetNextConsume(), QCBORDecode_GetArray(),
+ * QCBORDecode_GetMap() and all the functions that search a map for a
+ * label like QCBORDecode_GetInt64InMapN() when they pass over a map
+ * or array. It helps most when maps have large nested values that
+ * are not of interest. An index set with
+ * QCBORDecode_SetContainerIndex() is used first if there is one.
+ *
+ * The skipped data items are checked for well-formedness and the
+ * nesting limit the same as QCBORDecode_ValidateWellFormed(), but no
+ * further. Errors that decoding them would give, for example
+ * unsupported tag content, map labels of the wrong type, features
+ * disabled by #define or the lack of a string allocator for
+ * indefinite-length strings, are not reported.
+ */
+void
+QCBORDecode_EnableFastSkip(QCBORDecodeContext *pCtx);
+
+
+/**
+ * @brief Check that text strings are valid UTF-8.
+ *
+ * @param[in] pCtx  The decode context.
+ *
+ * CBOR requires text strings to be UTF-8 (RFC 8949 section 3.1), but
+ * by default QCBOR returns their bytes without checking. With this
+ * enabled every text string, including map labels and each chunk of
+ * indefinite-length text strings, is checked with
+ * UsefulBuf_IsValidUTF8() as it is decoded. One that is not valid
+ * gives @ref QCBOR_ERR_INVALID_UTF8. Decoding can continue after
+ * this error.
+ *
+ * The check is done while the string is in cache from being decoded,
+ * so it is cheaper than checking the strings after decoding. Text
+ * strings passed over by QCBORDecode_EnableFastSkip() and
+ * QCBORDecode_ValidateWellFormed() are not checked.
+ */
+void
+QCBORDecode_EnableUTF8Check(QCBORDecodeContext *pCtx);
+
+
+/**
+ * @brief Trust the input to stop map searches early.
+ *
+ * @param[in] pCtx  The decode context.
+ *
+ * Searching a map for labels, for example with
+ * QCBORDecode_GetInt64InMapN() or QCBORDecode_GetItemsInMap(),
+ * normally goes through the whole map even after all the labels are
+ * found. This is to give @ref QCBOR_ERR_DUPLICATE_LABEL if one occurs
+ * again later in the map, to report errors in the rest of the map and
+ * to find the end of the map for exiting it.
+ *
+ * With this enabled, the search stops as soon as every label searched
+ * for is found. On average that is half the map for one label. The
+ * end of the map is then found only when QCBORDecode_ExitMap() needs
+ * it.
+ *
+ * Only use this for input known to be good, for example input that
+ * has already been checked with QCBORDecode_SetDuplicateLabelCheck()
+ * or that has a verified signature from a trusted signer. Otherwise
+ * a duplicate label may go undetected, with the first occurrence
+ * being used, which is a security issue for some protocols. Searches
+ * with a callback, like QCBORDecode_GetItemsInMapWithCallback(), and
+ * searches with QCBORDecode_SetLabelIndex() are not affected.
+ */
+void
+QCBORDecode_EnableTrustedInput(QCBORDecodeContext *pCtx);
+
+
+/**
+ * @brief Decode input that arrives in pieces.
+ *
+ * @param[in] pCtx  The decode context.
+ *
+ * Call this after QCBORDecode_Init() to decode input, such as from a
+ * socket, that arrives over time without waiting for all of it.
+ * QCBORDecode_Init() is given what has arrived so far.
+ *
+ * In streaming mode, when the input runs out in the middle of a data
+ * item or inside an array or map, QCBORDecode_GetNext() and related
+ * return @ref QCBOR_ERR_NEED_MORE_INPUT instead of @ref
+ * QCBOR_ERR_HIT_END. The decoder is left exactly as it was before
+ * that data item. Give it more input with QCBORDecode_ContinueInput()
+ * and call QCBORDecode_GetNext() again to get the item.
+ *
+ * At the top level the end of input is a boundary between items in a
+ * CBOR sequence so @ref QCBOR_ERR_NO_MORE_ITEMS is returned as
+ * usual. It is up to the caller to know whether more is coming.
+ *
+ * Data items are returned only when complete. Strings are returned
+ * by pointer into the input, so a long string is not returned until
+ * all of it has arrived. Since a break may follow, the last item in
+ * an indefinite-length array or map is not returned until the next
+ * byte has arrived.
+ *
+ * This is supported for QCBORDecode_GetNext(), QCBORDecode_VGetNext(),
+ * QCBORDecode_VGetNextConsume() and QCBORDecode_PeekNext(). The
+ * functions that enter and search maps and arrays and
+ * QCBORDecode_EnterBstrWrapped() need the whole map, array or byte
+ * string to be in the input already.
+ */
+void
+QCBORDecode_EnableStreaming(QCBORDecodeContext *pCtx);
+
+
+/**
+ * @brief Get the number of input bytes that can be discarded.
+ *
+ * @param[in] pCtx  The decode context.
+ *
+ * @returns The number of bytes at the start of the input that have
+ *          been fully decoded.
+ *
+ * In streaming mode this is how much of the front of the input can
+ * be dropped before calling QCBORDecode_ContinueInput() with @c
+ * bDiscardConsumed true. This keeps the memory needed down to about
+ * the size of the largest data item rather than the whole message.
+ *
+ * It is 0 while any map or array is entered with
+ * QCBORDecode_EnterMap() or similar or byte-string wrapped CBOR is
+ * entered.
+ */
+size_t
+QCBORDecode_StreamingConsumed(QCBORDecodeContext *pCtx);
+
+
+/**
+ * @brief Give the decoder more input in streaming mode.
+ *
+ * @param[in] pCtx              The decode context.
+ * @param[in] NewInput          All of the input so far, less what is
+ *                              discarded.
+ * @param[in] bDiscardConsumed  If true, @c NewInput starts after the
+ *                              QCBORDecode_StreamingConsumed() bytes.
+ *
+ * If @c bDiscardConsumed is false, @c NewInput must start with
+ * exactly the same bytes as the previous input and may be in a
+ * different place in memory, for example after a realloc().
+ *
+ * If @c bDiscardConsumed is true, @c NewInput must start with the
+ * previous input less the first QCBORDecode_StreamingConsumed()
+ * bytes. After this, offsets like those from QCBORDecode_Tell() are
+ * relative to @c NewInput and any container index set with
+ * QCBORDecode_SetContainerIndex() is detached.
+ *
+ * Either way, data items returned earlier that point into the
+ * previous input are no longer valid if that memory was reused.
+ *
+ * This clears @ref QCBOR_ERR_NEED_MORE_INPUT if it is the current
+ * error so decoding can continue.
+ */
+void
+QCBORDecode_ContinueInput(QCBORDecodeContext *pCtx,
+                          UsefulBufC          NewInput,
+                          bool                bDiscardConsumed);
+
+
 /**
  * @brief  Retrieve the undecoded input buffer.
  *
@@ -1631,15 +2361,15 @@ QCBORDecode_GetNextWithTags(QCBORDecodeContext *pCtx,
  *    BEGINNING OF PRIVATE INLINE IMPLEMENTATION                             *
  * ========================================================================= */
 
-static inline uint32_t
+static inline QCBOROffset
 QCBORDecode_Tell(QCBORDecodeContext *pMe)
 {
    if(pMe->uLastError) {
-      return UINT32_MAX;
+      return QCBOR_OFFSET_MAX;
    }
 
    /* Cast is safe because decoder input size is restricted. */
-   return (uint32_t)UsefulInputBuf_Tell(&(pMe->InBuf));
+   return (QCBOROffset)UsefulInputBuf_Tell(&(pMe->InBuf));
 }
 
 static inline UsefulBufC
@@ -483,6 +483,25 @@ void
 QCBOREncode_Init(QCBOREncodeContext *pCtx, UsefulBuf Storage);
 
 
+/**
+ * @brief Check that text strings added are valid UTF-8.
+ *
+ * @param[in] pCtx  The encoding context.
+ *
+ * Call this after QCBOREncode_Init(). Then QCBOREncode_AddText(),
+ * QCBOREncode_AddSZString() and all the other functions that add a
+ * text string or a text string label check it with
+ * UsefulBuf_IsValidUTF8(). If it is not valid, nothing is added and
+ * QCBOREncode_Finish() returns @ref QCBOR_ERR_INVALID_UTF8.
+ *
+ * This is off by default because text strings are most often
+ * literals known to be good. It does not apply to
+ * QCBOREncode_AddEncoded().
+ */
+void
+QCBOREncode_EnableUTF8Check(QCBOREncodeContext *pCtx);
+
+
 /**
  * @brief  Add a signed 64-bit integer to the encoded output.
  *
@@ -194,13 +194,16 @@ extern "C" {
  * Size approximation (varies with CPU/compiler):
  *    64-bit machine: (15 + 1) * (4 + 2 + 1 + 1 pad) + 8 = 136 bytes
  *   32-bit machine: (15 + 1) * (4 + 2 + 1 + 1 pad) + 4 = 132 bytes
+ *
+ * With QCBOR_WIDE_COUNTS uCount is 4 bytes and the padding 3, making
+ * it 200 bytes on a 64-bit machine.
  */
 typedef struct __QCBORTrackNesting {
   /* PRIVATE DATA STRUCTURE */
    struct {
       /* See QCBOREncode_OpenMapOrArray() for details on how this works */
       uint32_t  uStart;   /* uStart is the position where the array starts */
-      uint16_t  uCount;   /* Number of items in the arrary or map; counts items
+      QCBORCount uCount;  /* Number of items in the arrary or map; counts items
                            * in a map, not pairs of items */
       uint8_t   uMajorType; /* Indicates if item is a map or an array */
    } pArrays[QCBOR_MAX_ARRAY_NESTING+1], /* stored state for nesting levels */
@@ -223,10 +226,76 @@ struct _QCBOREncodeContext {
    UsefulOutBuf      OutBuf;  /* Pointer to output buffer, its length and
                                * position in it. */
    uint8_t           uError;  /* Error state, always from QCBORError enum */
+   uint8_t           bCheckUTF8; /* See QCBOREncode_EnableUTF8Check() */
    QCBORTrackNesting nesting; /* Keep track of array and map nesting */
 };
 
 
+/*
+ * PRIVATE DATA STRUCTURE
+ *
+ * The tracking info for one nesting level when decoding. There are
+ * two main types of levels:
+ *   1) Byte count tracking. This is for the top level input CBOR
+ *   which might be a single item or a CBOR sequence and byte
+ *   string wrapped encoded CBOR.
+ *   2) Item count tracking. This is for maps and arrays.
+ *
+ * The type of a level is not here. It is in a separate array indexed
+ * the same way (see QCBORDecodeNesting) so this packs into 8 bytes
+ * (12 with QCBOR_WIDE_COUNTS, 16 with QCBOR_WIDE_OFFSETS) without
+ * padding. The type is
+ * QCBOR_TYPE_BYTE_STRING for 1) and QCBOR_TYPE_MAP or
+ * QCBOR_TYPE_ARRAY or QCBOR_TYPE_MAP_AS_ARRAY for 2).
+ *
+ * Item count tracking is either for definite or indefinite-length
+ * maps/arrays. For definite lengths, the total count and items
+ * unconsumed are tracked. For indefinite-length, uTotalCount is
+ * QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH (QCBOR_COUNT_MAX) and
+ * there is no per-item count of members. For indefinite-length
+ * maps and arrays, uCountCursor is QCBOR_COUNT_MAX if not consumed
+ * and zero if it is consumed in the pre-order
+ * traversal. Additionally, if entered in bounded mode,
+ * uCountCursor is QCBOR_COUNT_INDICATES_ZERO_LENGTH to indicate
+ * it is empty.
+ *
+ * This also records whether a level is bounded or not. All
+ * byte-count tracked levels (the top-level sequence and
+ * bstr-wrapped CBOR) are bounded implicitly. Maps and arrays
+ * may or may not be bounded. They are bounded if they were
+ * Entered() and not if they were traversed with GetNext(). They
+ * are marked as bounded by uStartOffset not being
+ * QCBOR_NON_BOUNDED_OFFSET.
+ */
+typedef union {
+   struct {
+#define QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH QCBOR_COUNT_MAX
+#define QCBOR_COUNT_INDICATES_ZERO_LENGTH QCBOR_COUNT_MAX-1
+      QCBORCount uCountTotal;
+      QCBORCount uCountCursor;
+#define QCBOR_NON_BOUNDED_OFFSET QCBOR_OFFSET_MAX
+      /* The start of the array or map in bounded mode so
+       * the input can be rewound for GetInMapXx() by label. */
+      QCBOROffset uStartOffset;
+   } ma; /* for maps and arrays */
+   struct {
+      /* The end of the input before the bstr was entered so that
+       * it can be restored when the bstr is exited. */
+      QCBOROffset uSavedEndOffset;
+      /* The beginning of the bstr so that it can be rewound. */
+      QCBOROffset uBstrStartOffset;
+   } bs; /* for top-level sequence and bstr-wrapped CBOR */
+} QCBORDecodeLevel;
+
+
+/* Value of uCurrentBounded when there is no bounded level */
+#define QCBOR_NESTING_NOT_BOUNDED UINT8_MAX
+
+/* The most levels caller-provided storage can have. Level numbers
+ * must fit in a uint8_t with QCBOR_NESTING_NOT_BOUNDED left over. */
+#define QCBOR_MAX_DECODE_NESTING_STORAGE 254
+
+
 /*
  * PRIVATE DATA STRUCTURE
  *
@@ -235,93 +304,69 @@ struct _QCBOREncodeContext {
  * form an "object" that does the work for arrays and maps. All access
  * to this structure is through DecodeNesting_Xxx() functions.
  *
+ * The levels are a struct of arrays, pLevels and puLevelTypes, both
+ * indexed by level number with the top level at 0. They point to
+ * the built-in arrays here or to storage from
+ * QCBORDecode_SetNestingStorage(). Caller-provided storage also has
+ * room for one saved copy of the levels after the live ones for
+ * putting the nesting back after decoding ahead when it is too deep
+ * for a QCBORDecodeNestingSave.
+ *
+ * uCurrent is for item-by-item pre-order traversal.
+ *
+ * uCurrentBounded is the current bounding level or
+ * QCBOR_NESTING_NOT_BOUNDED if there isn't one.
+ *
+ * uCurrent must always be below uCurrentBounded as the pre-order
+ * traversal is always bounded by the bounding level.
+ *
+ * When a bounded level is entered, the pre-order traversal is set
+ * to the first item in the bounded level. When a bounded level is
+ * exited, the pre-order traversl is set to the next item after the
+ * map, array or bstr. This may be more than one level up, or even
+ * the end of the input CBOR.
+ *
  * 64-bit machine size
- *   128 = 16 * 8 for the two unions
- *   64  = 16 * 4 for the uLevelType, 1 byte padded to 4 bytes for alignment
- *   16  = 16 bytes for two pointers
- *   208 TOTAL
+ *   128 = 16 * 8 for the built-in levels
+ *    16 = 16 * 1 for the built-in level types
+ *    16 = 16 bytes for two pointers
+ *     8 = 3 level numbers padded for alignment
+ *   168 TOTAL
  *
- * 32-bit machine size is 200 bytes
+ * With QCBOR_WIDE_OFFSETS on a 64-bit machine the levels are 16
+ * bytes, making it 296 bytes. With QCBOR_WIDE_COUNTS they are 12
+ * bytes, making it 232, or still 16 with both.
  */
 typedef struct __QCBORDecodeNesting  {
   /* PRIVATE DATA STRUCTURE */
-   struct nesting_decode_level {
-      /*
-       * This keeps tracking info for each nesting level. There are two
-       * main types of levels:
-       *   1) Byte count tracking. This is for the top level input CBOR
-       *   which might be a single item or a CBOR sequence and byte
-       *   string wrapped encoded CBOR.
-       *   2) Item count tracking. This is for maps and arrays.
-       *
-       * uLevelType has value QCBOR_TYPE_BYTE_STRING for 1) and
-       * QCBOR_TYPE_MAP or QCBOR_TYPE_ARRAY or QCBOR_TYPE_MAP_AS_ARRAY
-       * for 2).
-       *
-       * Item count tracking is either for definite or indefinite-length
-       * maps/arrays. For definite lengths, the total count and items
-       * unconsumed are tracked. For indefinite-length, uTotalCount is
-       * QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH (UINT16_MAX) and
-       * there is no per-item count of members. For indefinite-length
-       * maps and arrays, uCountCursor is UINT16_MAX if not consumed
-       * and zero if it is consumed in the pre-order
-       * traversal. Additionally, if entered in bounded mode,
-       * uCountCursor is QCBOR_COUNT_INDICATES_ZERO_LENGTH to indicate
-       * it is empty.
-       *
-       * This also records whether a level is bounded or not. All
-       * byte-count tracked levels (the top-level sequence and
-       * bstr-wrapped CBOR) are bounded implicitly. Maps and arrays
-       * may or may not be bounded. They are bounded if they were
-       * Entered() and not if they were traversed with GetNext(). They
-       * are marked as bounded by uStartOffset not being @c UINT32_MAX.
-       */
-      /*
-       * If uLevelType can put in a separately indexed array, the
-       * union/struct will be 8 bytes rather than 9 and a lot of
-       * wasted padding for alignment will be saved.
-       */
-      uint8_t  uLevelType;
-      union {
-         struct {
-#define QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH UINT16_MAX
-#define QCBOR_COUNT_INDICATES_ZERO_LENGTH UINT16_MAX-1
-            uint16_t uCountTotal;
-            uint16_t uCountCursor;
-#define QCBOR_NON_BOUNDED_OFFSET UINT32_MAX
-            /* The start of the array or map in bounded mode so
-             * the input can be rewound for GetInMapXx() by label. */
-            uint32_t uStartOffset;
-         } ma; /* for maps and arrays */
-         struct {
-            /* The end of the input before the bstr was entered so that
-             * it can be restored when the bstr is exited. */
-            uint32_t uSavedEndOffset;
-            /* The beginning of the bstr so that it can be rewound. */
-            uint32_t uBstrStartOffset;
-         } bs; /* for top-level sequence and bstr-wrapped CBOR */
-      } u;
-   } pLevels[QCBOR_MAX_ARRAY_NESTING+1],
-    *pCurrent,
-    *pCurrentBounded;
-   /*
-    * pCurrent is for item-by-item pre-order traversal.
-    *
-    * pCurrentBounded points to the current bounding level or is NULL
-    * if there isn't one.
-    *
-    * pCurrent must always be below pCurrentBounded as the pre-order
-    * traversal is always bounded by the bounding level.
-    *
-    * When a bounded level is entered, the pre-order traversal is set
-    * to the first item in the bounded level. When a bounded level is
-    * exited, the pre-order traversl is set to the next item after the
-    * map, array or bstr. This may be more than one level up, or even
-    * the end of the input CBOR.
-    */
+   QCBORDecodeLevel *pLevels;
+   uint8_t          *puLevelTypes;
+   uint8_t           uCurrent;
+   uint8_t           uCurrentBounded;
+   uint8_t           uMaxLevel; /* Deepest level number pLevels has */
+   QCBORDecodeLevel  BuiltInLevels[QCBOR_MAX_ARRAY_NESTING+1];
+   uint8_t           auBuiltInLevelTypes[QCBOR_MAX_ARRAY_NESTING+1];
 } QCBORDecodeNesting;
 
 
+/*
+ * PRIVATE DATA STRUCTURE
+ *
+ * Levels uFirst to uCurrent and the level numbers, for putting the
+ * nesting back the way it was after decoding ahead. pLevels[0] is
+ * level uFirst. When there are more levels than these arrays hold,
+ * they are in the save area of caller-provided storage instead.
+ */
+typedef struct {
+   /* PRIVATE DATA STRUCTURE */
+   QCBORDecodeLevel pLevels[QCBOR_MAX_ARRAY_NESTING+1];
+   uint8_t          puLevelTypes[QCBOR_MAX_ARRAY_NESTING+1];
+   uint8_t          uFirst;
+   uint8_t          uCurrent;
+   uint8_t          uCurrentBounded;
+} QCBORDecodeNestingSave;
+
+
 typedef struct  {
    /* PRIVATE DATA STRUCTURE */
    void *pAllocateCxt;
@@ -336,8 +381,11 @@ typedef struct  {
  * QCBORDecode_xxx functions form an "object" that does CBOR decoding.
  *
  * Size approximation (varies with CPU/compiler):
- *  64-bit machine: 32 + 1 + 1 + 6 bytes padding + 72 + 16 + 8 + 8 = 144 bytes
- *  32-bit machine: 16 + 1 + 1 + 2 bytes padding + 68 +  8 + 8 + 4 = 108 bytes
+ *  64-bit machine: 344 bytes
+ *  32-bit machine: 276 bytes
+ * About 170 of that is the built-in nesting levels. QCBOR_WIDE_COUNTS
+ * adds 64 bytes and QCBOR_WIDE_OFFSETS adds 136 bytes on a 64-bit
+ * machine.
  */
 struct _QCBORDecodeContext {
   /* PRIVATE DATA STRUCTURE */
@@ -360,11 +408,41 @@ struct _QCBORDecodeContext {
    /* A cached offset to the end of the current map 0 if no value is
     * cached.
     */
-#define QCBOR_MAP_OFFSET_CACHE_INVALID UINT32_MAX
-   uint32_t uMapEndOffsetCache;
+#define QCBOR_MAP_OFFSET_CACHE_INVALID QCBOR_OFFSET_MAX
+   QCBOROffset uMapEndOffsetCache;
+
+   /* Optional index of map and array end offsets set by
+    * QCBORDecode_SetContainerIndex(). NULL if not in use.
+    */
+   const struct _QCBORContainerIndexEntry *pContainerIndex;
+   size_t                                  uContainerIndexCount;
+
+   /* Optional storage for QCBORDecode_SetPeekCache(). NULL if not in
+    * use. */
+   struct _QCBORPeekCache *pPeekCache;
+
+   /* Optional storage for QCBORDecode_SetDuplicateLabelCheck(). NULL
+    * if not in use. */
+   struct _QCBORLabelFingerprint *pLabelCheck;
+   QCBORCount                     uLabelCheckCount;
+
+   /* Optional hash table storage for QCBORDecode_SetLabelIndex(). NULL
+    * if not in use. uLabelIndexSize is how much of it is in use for
+    * the map starting at uLabelIndexMap and ending at
+    * uLabelIndexEnd. uLabelIndexMap is QCBOR_NON_BOUNDED_OFFSET when
+    * no map is indexed. */
+   struct _QCBORLabelIndexEntry *pLabelIndex;
+   QCBORCount                    uLabelIndexCount;
+   QCBORCount                    uLabelIndexSize;
+   QCBOROffset                   uLabelIndexMap;
+   QCBOROffset                   uLabelIndexEnd;
 
    uint8_t  uDecodeMode;
    uint8_t  bStringAllocateAll;
+   uint8_t  bStreaming;
+   uint8_t  bFastSkip;
+   uint8_t  bCheckUTF8;
+   uint8_t  bTrustedInput;
    uint8_t  uLastError;  /* QCBORError stuffed into a uint8_t */
 
    /* See MapTagNumber() for description of how tags are mapped. */
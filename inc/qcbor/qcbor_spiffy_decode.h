@@ -455,6 +455,97 @@ QCBORDecode_GetUInt64ConvertAllInMapSZ(QCBORDecodeContext *pCtx,
                                        uint64_t           *puValue);
 
 
+/**
+ * @brief Decode an array of integers into a C array of int64_t.
+ *
+ * @param[in] pCtx        The decode context.
+ * @param[in] uMaxCount   The number of elements in @c pnValues.
+ * @param[out] pnValues   The array the integers are written to.
+ * @param[out] puCount    The number of integers written to @c pnValues.
+ *
+ * The next item to decode must be an array and every item in it must
+ * be a positive or negative integer (CBOR major type 0 or 1). The
+ * whole array is consumed and the traversal cursor is left at the
+ * item after it. QCBORDecode_GetInt64ArrayInMapN() and
+ * QCBORDecode_GetInt64ArrayInMapSZ() don't affect the traversal
+ * cursor.
+ *
+ * The result is the same as entering the array with
+ * QCBORDecode_EnterArray(), calling QCBORDecode_GetInt64() for each
+ * item and then calling QCBORDecode_ExitArray(), but it is much
+ * faster for large arrays. Runs of untagged integers in a
+ * definite-length array are decoded directly from the input without
+ * going through QCBORDecode_GetNext(). The error checking is the
+ * same, including @ref QCBOR_ERR_UNEXPECTED_TYPE if an item is not
+ * an integer and @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW if a value
+ * doesn't fit in an int64_t.
+ *
+ * If the array has more than @c uMaxCount items, @c pnValues is
+ * filled and @ref QCBOR_ERR_ARRAY_DECODE_TOO_LONG is set.
+ *
+ * On error, @c *puCount is the number of integers that were decoded
+ * before the error. Like all other errors, this puts the decoder in
+ * the error state and no further decoding is possible.
+ *
+ * Please see @ref Decode-Errors-Overview "Decode Errors Overview".
+ *
+ * See also QCBORDecode_GetUInt64Array().
+ */
+void
+QCBORDecode_GetInt64Array(QCBORDecodeContext *pCtx,
+                          size_t              uMaxCount,
+                          int64_t            *pnValues,
+                          size_t             *puCount);
+
+void
+QCBORDecode_GetInt64ArrayInMapN(QCBORDecodeContext *pCtx,
+                                int64_t             nLabel,
+                                size_t              uMaxCount,
+                                int64_t            *pnValues,
+                                size_t             *puCount);
+
+void
+QCBORDecode_GetInt64ArrayInMapSZ(QCBORDecodeContext *pCtx,
+                                 const char         *szLabel,
+                                 size_t              uMaxCount,
+                                 int64_t            *pnValues,
+                                 size_t             *puCount);
+
+
+/**
+ * @brief Decode an array of integers into a C array of uint64_t.
+ *
+ * @param[in] pCtx        The decode context.
+ * @param[in] uMaxCount   The number of elements in @c puValues.
+ * @param[out] puValues   The array the integers are written to.
+ * @param[out] puCount    The number of integers written to @c puValues.
+ *
+ * This is the same as QCBORDecode_GetInt64Array(), but returns
+ * unsigned integers and thus sets
+ * @ref QCBOR_ERR_NUMBER_SIGN_CONVERSION if an item in the array is a
+ * negative integer.
+ */
+void
+QCBORDecode_GetUInt64Array(QCBORDecodeContext *pCtx,
+                           size_t              uMaxCount,
+                           uint64_t           *puValues,
+                           size_t             *puCount);
+
+void
+QCBORDecode_GetUInt64ArrayInMapN(QCBORDecodeContext *pCtx,
+                                 int64_t             nLabel,
+                                 size_t              uMaxCount,
+                                 uint64_t           *puValues,
+                                 size_t             *puCount);
+
+void
+QCBORDecode_GetUInt64ArrayInMapSZ(QCBORDecodeContext *pCtx,
+                                  const char         *szLabel,
+                                  size_t              uMaxCount,
+                                  uint64_t           *puValues,
+                                  size_t             *puCount);
+
+
 
 
 /**
@@ -643,6 +734,92 @@ QCBORDecode_GetDoubleConvertAllInMapSZ(QCBORDecodeContext *pCtx,
                                        const char         *szLabel,
                                        uint32_t            uConvertTypes,
                                        double             *pdValue);
+
+
+/**
+ * @brief Decode an array of floating-point values into a C array of double.
+ *
+ * @param[in] pCtx        The decode context.
+ * @param[in] uMaxCount   The number of elements in @c pdValues.
+ * @param[out] pdValues   The array the values are written to.
+ * @param[out] puCount    The number of values written to @c pdValues.
+ *
+ * The next item to decode must be an array and every item in it must
+ * be a half, single or double-precision floating-point value. Half
+ * and single-precision values are widened to double with no loss of
+ * precision. Integers are not converted.
+ *
+ * The result is the same as entering the array and calling
+ * QCBORDecode_GetDouble() for each item, but it is much faster for
+ * large arrays. Untagged floating-point values in a definite-length
+ * array are decoded directly from the input without going through
+ * QCBORDecode_GetNext().
+ *
+ * The handling of the traversal cursor, @c uMaxCount, @c puCount and
+ * errors is the same as QCBORDecode_GetInt64Array().
+ *
+ * If half-precision support is disabled, this will set
+ * @ref QCBOR_ERR_HALF_PRECISION_DISABLED if a half-precision value
+ * is encountered.
+ */
+void
+QCBORDecode_GetDoubleArray(QCBORDecodeContext *pCtx,
+                           size_t              uMaxCount,
+                           double             *pdValues,
+                           size_t             *puCount);
+
+void
+QCBORDecode_GetDoubleArrayInMapN(QCBORDecodeContext *pCtx,
+                                 int64_t             nLabel,
+                                 size_t              uMaxCount,
+                                 double             *pdValues,
+                                 size_t             *puCount);
+
+void
+QCBORDecode_GetDoubleArrayInMapSZ(QCBORDecodeContext *pCtx,
+                                  const char         *szLabel,
+                                  size_t              uMaxCount,
+                                  double             *pdValues,
+                                  size_t             *puCount);
+
+
+/**
+ * @brief Decode an array of floating-point values into a C array of float.
+ *
+ * @param[in] pCtx        The decode context.
+ * @param[in] uMaxCount   The number of elements in @c pfValues.
+ * @param[out] pfValues   The array the values are written to.
+ * @param[out] puCount    The number of values written to @c pfValues.
+ *
+ * This is the same as QCBORDecode_GetDoubleArray() except values are
+ * output as float. Half and single-precision values are always
+ * exact. A double-precision value is only accepted if it can be
+ * represented exactly as a float (or is a NaN). If not,
+ * @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW is set.
+ *
+ * Narrowing uses the floating-point hardware, so this sets
+ * @ref QCBOR_ERR_HW_FLOAT_DISABLED if QCBOR_DISABLE_FLOAT_HW_USE is
+ * defined.
+ */
+void
+QCBORDecode_GetFloatArray(QCBORDecodeContext *pCtx,
+                          size_t              uMaxCount,
+                          float              *pfValues,
+                          size_t             *puCount);
+
+void
+QCBORDecode_GetFloatArrayInMapN(QCBORDecodeContext *pCtx,
+                                int64_t             nLabel,
+                                size_t              uMaxCount,
+                                float              *pfValues,
+                                size_t             *puCount);
+
+void
+QCBORDecode_GetFloatArrayInMapSZ(QCBORDecodeContext *pCtx,
+                                 const char         *szLabel,
+                                 size_t              uMaxCount,
+                                 float              *pfValues,
+                                 size_t             *puCount);
 #endif /* USEFULBUF_DISABLE_ALL_FLOAT */
 
 
@@ -749,7 +926,8 @@ QCBORDecode_ExitArray(QCBORDecodeContext *pCtx);
  * @c pItem will have the label and tags for the array. It is filled
  * in the same as if QCBORDecode_GetNext() were called on the array item. In
  * particular, the array count will be filled in for definite-length
- * arrays and set to @c UINT16_MAX for indefinite-length arrays.
+ * arrays and set to @ref QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH for
+ * indefinite-length arrays.
  *
  * This works on both definite and indefinite length arrays (unless
  * indefinite length array decoding has been disabled).
@@ -879,6 +1057,123 @@ static void
 QCBORDecode_ExitMap(QCBORDecodeContext *pCtx);
 
 
+/**
+ * Storage for one label for QCBORDecode_SetDuplicateLabelCheck(). The
+ * members are private.
+ */
+typedef struct _QCBORLabelFingerprint {
+   /* PRIVATE DATA STRUCTURE */
+   uint64_t   uKey;       /* Integer label or hash of string label */
+   UsefulBufC String;     /* String label or NULLUsefulBufC */
+   uint8_t    uLabelType;
+} QCBORLabelFingerprint;
+
+
+/**
+ * @brief Check every map entered for duplicate labels.
+ *
+ * @param[in] pCtx          The decode context.
+ * @param[in] pLabels       Storage for the labels of one map or @c NULL
+ *                          to stop checking.
+ * @param[in] uLabelsCount  Number of entries in @c pLabels.
+ *
+ * Normally duplicate labels are only detected for the labels
+ * searched for, for example by QCBORDecode_GetItemsInMap(). With this
+ * set, QCBORDecode_EnterMap(), QCBORDecode_EnterMapFromMapN() and
+ * QCBORDecode_EnterMapFromMapSZ() check all the labels in the map
+ * and set @ref QCBOR_ERR_DUPLICATE_LABEL if any two are the
+ * same. Integer, unsigned integer, text string and byte string
+ * labels are checked. A text string label is never the same as a
+ * byte string label.
+ *
+ * Each label is fingerprinted and put in @c pLabels which is then
+ * sorted, so this takes one extra pass over the map plus O(n log n)
+ * time for a map with n items. No dynamic memory is used. If the map
+ * has more items than @c uLabelsCount, @ref
+ * QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL is set rather than passing the
+ * map unchecked. Only one map is checked at a time, so @c pLabels
+ * needs to be only as big as the biggest map.
+ *
+ * A @ref QCBORLabelFingerprint is 32 bytes on a 64-bit machine. @c
+ * pLabels must remain valid for the life of the context or until
+ * this is called again with @c NULL. It doesn't need to be
+ * initialized.
+ *
+ * Maps that are not entered, for example those traversed with
+ * QCBORDecode_GetNext() or skipped over, are not checked.
+ */
+void
+QCBORDecode_SetDuplicateLabelCheck(QCBORDecodeContext    *pCtx,
+                                   QCBORLabelFingerprint *pLabels,
+                                   size_t                 uLabelsCount);
+
+
+/**
+ * Storage for one slot of the hash table for
+ * QCBORDecode_SetLabelIndex(). The members are private.
+ */
+typedef struct _QCBORLabelIndexEntry {
+   /* PRIVATE DATA STRUCTURE */
+   QCBORLabelFingerprint Label;      /* uLabelType QCBOR_TYPE_NONE if empty */
+   QCBOROffset           uOffset;    /* Of the label in the input */
+   uint8_t               bDuplicate; /* Label occurs more than once */
+} QCBORLabelIndexEntry;
+
+
+/**
+ * @brief Index the labels of each map entered for fast searching.
+ *
+ * @param[in] pCtx           The decode context.
+ * @param[in] pEntries       Storage for a hash table or @c NULL to
+ *                           stop indexing.
+ * @param[in] uEntriesCount  Number of entries in @c pEntries.
+ *
+ * Normally each of QCBORDecode_GetItemInMapN(),
+ * QCBORDecode_GetInt64InMapSZ() and such goes through the whole map
+ * to find its item, so getting k items from a map of n items takes
+ * O(k·n) time. With this set, QCBORDecode_EnterMap(),
+ * QCBORDecode_EnterMapFromMapN() and QCBORDecode_EnterMapFromMapSZ()
+ * go through the map once and put the offset of each label in a hash
+ * table in @c pEntries. Getting an item from the map is then a
+ * lookup and a seek to decode just that item. Getting several items
+ * with QCBORDecode_GetItemsInMap() does a lookup for each. The end of
+ * the map is also remembered so exiting it is fast.
+ *
+ * The items found are the same as without the index. Duplicates of a
+ * label searched for are still detected. A map that can't be gone
+ * through, for example because it is not well-formed, is not indexed
+ * and the error is set when it is searched as usual. When a search
+ * hits more than one error, such as a duplicate of one label and the
+ * wrong type for another, which of them is set can differ from a
+ * search without the index. That is because the labels are looked
+ * up in the order of the items searched for rather than the order
+ * they occur in the map.
+ *
+ * The table is for the map most recently entered. It is discarded
+ * when that map is exited or another map is entered, so after
+ * exiting a map nested in an indexed map, searches of the outer map
+ * go through it item by item again. Entering the same map again
+ * indexes it again.
+ *
+ * The table is kept at most three-quarters full. If a map has more
+ * items than that, it is not indexed and searching is as if this
+ * were not set. A map of n items uses at most 2n entries of @c
+ * pEntries, so larger storage only helps larger maps. A @ref
+ * QCBORLabelIndexEntry is 40 bytes on a 64-bit machine. @c pEntries
+ * must remain valid for the life of the context or until this is
+ * called again with @c NULL. It doesn't need to be initialized.
+ *
+ * Building the table is one extra pass over each map entered, so
+ * this is only worth it for maps from which several items are
+ * gotten. QCBORDecode_GetStruct() is another way to get many items
+ * from a map in one pass.
+ */
+void
+QCBORDecode_SetLabelIndex(QCBORDecodeContext   *pCtx,
+                          QCBORLabelIndexEntry *pEntries,
+                          size_t                uEntriesCount);
+
+
 /**
  * @brief Get the bytes that make up a map.
  *
@@ -894,7 +1189,8 @@ QCBORDecode_ExitMap(QCBORDecodeContext *pCtx);
  *  @c pItem will have the label and tags for the array. It is filled
  * in the same as if QCBORDecode_GetNext() were called on the map item. In
  * particular, the map count will be filled in for definite-length
- * maps and set to @c UINT16_MAX for indefinite-length maps.
+ * maps and set to @ref QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH for
+ * indefinite-length maps.
  *
  * This works on both definite and indefinite length maps (unless
  * indefinite length map decoding has been disabled).
@@ -960,6 +1256,67 @@ void
 QCBORDecode_Rewind(QCBORDecodeContext *pCtx);
 
 
+/**
+ * Storage for QCBORDecode_SaveCursor(). The members are private.
+ */
+typedef struct _QCBORCursor {
+   /* PRIVATE DATA STRUCTURE */
+   QCBORDecodeNestingSave Nesting;
+   QCBOROffset            uOffset;
+   QCBOROffset            uInputLen;
+   QCBOROffset            uMapEndOffsetCache;
+   uint8_t                bValid;
+} QCBORCursor;
+
+
+/**
+ * @brief Save the traversal cursor to come back to later.
+ *
+ * @param[in] pCtx     The decode context.
+ * @param[out] pCursor  Where the traversal cursor is saved.
+ *
+ * This records the position in the input, the maps, arrays and
+ * byte-string wrapped CBOR entered and those being traversed so
+ * QCBORDecode_RestoreCursor() can return to exactly this point. It
+ * is a bookmark for revisiting part of the input many times, for
+ * example in multi-pass validation. It is cheaper than re-entering
+ * from the start with QCBORDecode_Rewind() or copying the whole
+ * QCBORDecodeContext. Only as many nesting levels as are in use are
+ * copied.
+ *
+ * The error state is not saved.
+ *
+ * A @ref QCBORCursor is about 165 bytes. A cursor can be restored any
+ * number of times, but only into the context it was saved from and
+ * only while that context is decoding the same input. In streaming
+ * mode, a cursor is invalid after QCBORDecode_ContinueInput()
+ * discards input.
+ *
+ * A cursor holds at most @ref QCBOR_MAX_ARRAY_NESTING levels. Deeper
+ * nesting, possible with QCBORDecode_SetNestingStorage(), sets
+ * @ref QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP and restoring the
+ * cursor sets it again.
+ */
+void
+QCBORDecode_SaveCursor(QCBORDecodeContext *pCtx, QCBORCursor *pCursor);
+
+
+/**
+ * @brief Return the traversal cursor to a saved point.
+ *
+ * @param[in] pCtx     The decode context.
+ * @param[in] pCursor  The cursor from QCBORDecode_SaveCursor().
+ *
+ * After this, decoding continues exactly as it would have after the
+ * call to QCBORDecode_SaveCursor(), including exiting maps, arrays
+ * and byte-string wrapped CBOR that were entered then.
+ *
+ * Like QCBORDecode_Rewind(), this also resets the error state.
+ */
+void
+QCBORDecode_RestoreCursor(QCBORDecodeContext *pCtx, const QCBORCursor *pCursor);
+
+
 /**
  * @brief Get an item in map by label and type.
  *
@@ -1119,6 +1476,232 @@ QCBORDecode_GetItemsInMapWithCallback(QCBORDecodeContext *pCtx,
                                       QCBORItemCallback   pfCB);
 
 
+/** The maximum number of fields in a @ref QCBORStructDescriptor. */
+#define QCBOR_MAX_STRUCT_FIELDS 64
+
+/** @ref QCBORStructField.uFlags for a field that must be in the map. */
+#define QCBOR_FIELD_REQUIRED 0x01
+
+struct _QCBORStructDescriptor;
+
+/**
+ * Describes one field of a C structure for QCBORDecode_GetStruct().
+ *
+ * @c uType says what is accepted and the C type of the field at @c
+ * uOffset:
+ *
+ * | @c uType                    | Accepts                 | C type        |
+ * | --------------------------- | ----------------------- | ------------- |
+ * | @ref QCBOR_TYPE_INT64       | Integer in range        | @c int64_t    |
+ * | @ref QCBOR_TYPE_UINT64      | Non-negative integer    | @c uint64_t   |
+ * | @ref QCBOR_TYPE_DOUBLE      | Float of any precision  | @c double     |
+ * | @ref QCBOR_TYPE_TRUE        | @c true or @c false     | @c bool       |
+ * | @ref QCBOR_TYPE_TEXT_STRING | Text string             | @ref UsefulBufC |
+ * | @ref QCBOR_TYPE_BYTE_STRING | Byte string             | @ref UsefulBufC |
+ * | @ref QCBOR_TYPE_MAP         | Map, per @c pNested     | C structure   |
+ * | @ref QCBOR_TYPE_ANY         | Anything                | @ref QCBORItem |
+ *
+ * For @ref QCBOR_TYPE_ANY the contents of a map or array are skipped
+ * over, the same as QCBORDecode_VGetNextConsume(). Tag numbers are
+ * not checked.
+ */
+typedef struct _QCBORStructField {
+   /** Text string label or @c NULL to use @c nLabel. */
+   const char                          *szLabel;
+   /** Integer label when @c szLabel is @c NULL. */
+   int64_t                              nLabel;
+   /** One of the types in the table above. */
+   uint8_t                              uType;
+   /** @ref QCBOR_FIELD_REQUIRED or 0. */
+   uint8_t                              uFlags;
+   /** @c offsetof() the field in the structure. */
+   size_t                               uOffset;
+   /** For @ref QCBOR_TYPE_MAP, the fields of the nested structure. */
+   const struct _QCBORStructDescriptor *pNested;
+} QCBORStructField;
+
+
+/**
+ * Describes a C structure for QCBORDecode_GetStruct(). This and the
+ * @ref QCBORStructField array are usually @c static @c const.
+ */
+typedef struct _QCBORStructDescriptor {
+   const QCBORStructField *pFields;
+   size_t                  uNumFields;
+} QCBORStructDescriptor;
+
+
+/**
+ * @brief Decode a map into a C structure in one traversal.
+ *
+ * @param[in] pCtx            The decode context.
+ * @param[in] pDescriptor     The fields to fill in.
+ * @param[out] pStruct        The structure to fill in.
+ * @param[out] puFieldErrors  Array of @c pDescriptor->uNumFields for
+ *                            an error per field or @c NULL.
+ *
+ * The next item must be a map. It is entered, every item in it is
+ * decoded once and matched against the labels in @c pDescriptor, and
+ * it is exited. A chain of calls like QCBORDecode_GetInt64InMapN()
+ * searches the whole map on each call, so this is much faster for
+ * maps with more than a few items of interest.
+ *
+ * For example:
+ *
+ * @code
+ *    typedef struct {
+ *       int64_t    nId;
+ *       UsefulBufC Name;
+ *       double     dScore;
+ *    } Record;
+ *
+ *    static const QCBORStructField RecordFields[] = {
+ *       {NULL,   1, QCBOR_TYPE_INT64,       QCBOR_FIELD_REQUIRED, offsetof(Record, nId),    NULL},
+ *       {"name", 0, QCBOR_TYPE_TEXT_STRING, QCBOR_FIELD_REQUIRED, offsetof(Record, Name),   NULL},
+ *       {"score",0, QCBOR_TYPE_DOUBLE,      0,                    offsetof(Record, dScore), NULL},
+ *    };
+ *    static const QCBORStructDescriptor RecordDescriptor = {RecordFields, 3};
+ *
+ *    Record R = {0, NULLUsefulBufC, -1.0};  // Default for optional fields
+ *    QCBORDecode_GetStruct(&DCtx, &RecordDescriptor, &R, NULL);
+ * @endcode
+ *
+ * Fields not in the map are not written to so they can be set to a
+ * default beforehand. A field's error is one of:
+ * - @ref QCBOR_ERR_LABEL_NOT_FOUND. This is only an error for the
+ *   whole call if the field is @ref QCBOR_FIELD_REQUIRED.
+ * - @ref QCBOR_ERR_DUPLICATE_LABEL when its label occurs more than
+ *   once. The first one is used.
+ * - @ref QCBOR_ERR_UNEXPECTED_TYPE or @ref
+ *   QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW when the item can't be put in
+ *   the field.
+ * - A recoverable decode error for the item, for example @ref
+ *   QCBOR_ERR_INVALID_UTF8.
+ * - For a nested map, the first error in the nested structure.
+ *
+ * Items in the map with labels not in @c pDescriptor are
+ * skipped. After a field error, the rest of the fields are still
+ * filled in and the first error in field order is set as the decoder
+ * error. Errors that stop decoding, for example not-well-formed
+ * input, are set right away and the structure is partly filled in.
+ *
+ * @ref QCBOR_ERR_STRUCT_DESCRIPTOR is set if @c pDescriptor has more
+ * than @ref QCBOR_MAX_STRUCT_FIELDS fields or a field with a type not
+ * in the table for @ref QCBORStructField.
+ *
+ * Labels are matched with the field after the one last matched first,
+ * so the search is least when the fields are in the order the map
+ * is usually encoded in.
+ */
+void
+QCBORDecode_GetStruct(QCBORDecodeContext          *pCtx,
+                      const QCBORStructDescriptor *pDescriptor,
+                      void                        *pStruct,
+                      QCBORError                  *puFieldErrors);
+
+
+/** The maximum number of steps in a @ref QCBORPath. */
+#define QCBOR_MAX_PATH_STEPS QCBOR_MAX_ARRAY_NESTING
+
+/**
+ * One step of a @ref QCBORPath. @c uType is @ref QCBOR_TYPE_INT64
+ * for an integer label in @c nValue, @ref QCBOR_TYPE_TEXT_STRING for
+ * a text string label in @c Label or @ref QCBOR_TYPE_ARRAY for an
+ * array index in @c nValue.
+ */
+typedef struct {
+   uint8_t    uType;
+   int64_t    nValue;
+   UsefulBufC Label;
+} QCBORPathStep;
+
+
+/**
+ * A path compiled by QCBORPath_Compile() for
+ * QCBORDecode_GetByPath().
+ */
+typedef struct {
+   QCBORPathStep Steps[QCBOR_MAX_PATH_STEPS];
+   uint8_t       uNumSteps;
+} QCBORPath;
+
+
+/**
+ * @brief Compile a path to an item in nested maps and arrays.
+ *
+ * @param[in] szPath  The path.
+ * @param[out] pPath  The compiled path.
+ *
+ * @retval QCBOR_ERR_PATH_SYNTAX  @c szPath is empty, has an empty or
+ *                                bad step or more than @ref
+ *                                QCBOR_MAX_PATH_STEPS steps.
+ *
+ * Steps are separated by "/". Each step is one of:
+ * - @c [n] for the array item at index @c n counting from 0.
+ * - An optional "-" followed by decimal digits for an integer label.
+ * - Anything else for a text string label.
+ * - Text between single quotes for a text string label that has a
+ *   "/" in it or looks like one of the above.
+ *
+ * For example "claims/7/[3]/name" is the item labeled "name" in the
+ * fourth item of the array labeled 7 in the map labeled "claims".
+ *
+ * Text string labels in @c pPath point into @c szPath, so it must
+ * stay around as long as @c pPath is used. Compiling once and
+ * keeping the result saves parsing the path on every use.
+ */
+QCBORError
+QCBORPath_Compile(const char *szPath, QCBORPath *pPath);
+
+
+/**
+ * @brief Get an item by following a path through nested maps and
+ *        arrays.
+ *
+ * @param[in] pCtx   The decode context.
+ * @param[in] pPath  The path from QCBORPath_Compile().
+ * @param[out] pItem The item found.
+ *
+ * The first step of the path is applied to the map or array that is
+ * entered. If none is entered, it is applied to the first item in
+ * the input or in the entered byte string wrapped CBOR.
+ *
+ * This goes straight to the item without entering and exiting each
+ * map and array on the way. Only the heads of the labels and items
+ * on the way are looked at, and items that don't match are skipped
+ * without decoding them, using the index from
+ * QCBORDecode_SetContainerIndex() if there is one. Only the item
+ * found is fully decoded. The traversal cursor doesn't move so this
+ * can be called any number of times in any order.
+ *
+ * The item found is decoded as if it were at the top level so its
+ * nesting levels are 0. Its label is the last step of the path if
+ * that is a label. If it is a map or array, it can't be entered, but
+ * the same path with more steps can be used to get items in it.
+ *
+ * @ref QCBOR_ERR_LABEL_NOT_FOUND is set if a label isn't in its map
+ * or an index is past the end of its array. @ref
+ * QCBOR_ERR_UNEXPECTED_TYPE is set if a label step is for something
+ * that is not a map or an index step is for something that is not an
+ * array. Labels are matched by their encoded value, so a tagged or
+ * indefinite-length string label never matches. If a label occurs
+ * more than once, the first one is used. Items skipped over must be
+ * well-formed.
+ *
+ * A path has at most @ref QCBOR_MAX_PATH_STEPS steps, which is @ref
+ * QCBOR_MAX_ARRAY_NESTING. Items skipped over are checked the same
+ * as QCBORDecode_ValidateWellFormed(), so maps and arrays in them
+ * nested deeper than @ref QCBOR_MAX_ARRAY_NESTING set @ref
+ * QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP unless they are skipped
+ * with the container index. These limits don't change with
+ * QCBORDecode_SetNestingStorage().
+ */
+void
+QCBORDecode_GetByPath(QCBORDecodeContext *pCtx,
+                      const QCBORPath    *pPath,
+                      QCBORItem          *pItem);
+
+
 
 
 /**
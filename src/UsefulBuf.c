@@ -154,6 +154,100 @@ size_t UsefulBuf_FindBytes(UsefulBufC BytesToSearch, UsefulBufC BytesToFind)
 }
 
 
+/*
+ * Public function -- see UsefulBuf.h
+ *
+ * Code Reviewers: THIS FUNCTION DOES POINTER MATH
+ */
+size_t UsefulBuf_IsValidUTF8(const UsefulBufC UB)
+{
+   const uint8_t *p;
+   const uint8_t *pEnd;
+   uint64_t       uWord;
+   uint8_t        uLead;
+   uint8_t        uSecondMin;
+   uint8_t        uSecondMax;
+   size_t         uContinuations;
+   size_t         uIndex;
+
+   if(UB.len == 0) {
+      /* Also keeps the pointer math below away from a NULL ptr */
+      return SIZE_MAX;
+   }
+
+   p    = UB.ptr;
+   pEnd = p + UB.len;
+   while(p < pEnd) {
+      /* ASCII fast path. Any byte with the high bit set ends it. The
+       * memcpy() is for alignment and compiles to a single load. */
+      if(pEnd - p >= 8) {
+         memcpy(&uWord, p, sizeof(uWord));
+         if((uWord & 0x8080808080808080ULL) == 0) {
+            p += 8;
+            continue;
+         }
+      }
+
+      uLead = *p;
+      if(uLead < 0x80) {
+         p++;
+         continue;
+      }
+
+      /* The first continuation byte's range is narrower after some
+       * leads to rule out overlong forms, surrogates and values
+       * beyond U+10FFFF (RFC 3629 section 4). */
+      uSecondMin = 0x80;
+      uSecondMax = 0xbf;
+      if(uLead < 0xc2) {
+         /* Continuation byte or overlong two-byte lead */
+         break;
+      } else if(uLead < 0xe0) {
+         uContinuations = 1;
+      } else if(uLead < 0xf0) {
+         uContinuations = 2;
+         if(uLead == 0xe0) {
+            uSecondMin = 0xa0;
+         } else if(uLead == 0xed) {
+            uSecondMax = 0x9f;
+         }
+      } else if(uLead < 0xf5) {
+         uContinuations = 3;
+         if(uLead == 0xf0) {
+            uSecondMin = 0x90;
+         } else if(uLead == 0xf4) {
+            uSecondMax = 0x8f;
+         }
+      } else {
+         break;
+      }
+
+      /* Cast is safe because p < pEnd */
+      if((size_t)(pEnd - p) <= uContinuations) {
+         break;
+      }
+      if(p[1] < uSecondMin || p[1] > uSecondMax) {
+         break;
+      }
+      for(uIndex = 2; uIndex <= uContinuations; uIndex++) {
+         if((p[uIndex] & 0xc0) != 0x80) {
+            break;
+         }
+      }
+      if(uIndex <= uContinuations) {
+         break;
+      }
+      p += uContinuations + 1;
+   }
+
+   if(p >= pEnd) {
+      return SIZE_MAX;
+   }
+   /* Cast from signed to unsigned. Safe because p only increments */
+   return (size_t)(p - (const uint8_t *)UB.ptr);
+}
+
+
 /*
  * Public function -- see UsefulBuf.h
  *
@@ -203,39 +203,59 @@ QCBORItem_MatchType(const QCBORItem Item1, const QCBORItem Item2)
  */
 
 
+static QCBORDecodeLevel *
+DecodeNesting_Current(const QCBORDecodeNesting *pNesting)
+{
+   return &(pNesting->pLevels[pNesting->uCurrent]);
+}
+
+
+static QCBORDecodeLevel *
+DecodeNesting_Bounded(const QCBORDecodeNesting *pNesting)
+{
+   return &(pNesting->pLevels[pNesting->uCurrentBounded]);
+}
+
+
+static uint8_t
+DecodeNesting_CurrentType(const QCBORDecodeNesting *pNesting)
+{
+   return pNesting->puLevelTypes[pNesting->uCurrent];
+}
+
+
 static uint8_t
 DecodeNesting_GetCurrentLevel(const QCBORDecodeNesting *pNesting)
 {
-   const ptrdiff_t nLevel = pNesting->pCurrent - &(pNesting->pLevels[0]);
-   /* Limit in DecodeNesting_Descend against more than
-    * QCBOR_MAX_ARRAY_NESTING gaurantees cast is safe
-    */
-   return (uint8_t)nLevel;
+   return pNesting->uCurrent;
 }
 
 
 static uint8_t
 DecodeNesting_GetBoundedModeLevel(const QCBORDecodeNesting *pNesting)
 {
-   const ptrdiff_t nLevel = pNesting->pCurrentBounded - &(pNesting->pLevels[0]);
-   /* Limit in DecodeNesting_Descend against more than
-    * QCBOR_MAX_ARRAY_NESTING gaurantees cast is safe
-    */
-   return (uint8_t)nLevel;
+   return pNesting->uCurrentBounded;
+}
+
+
+static bool
+DecodeNesting_IsBounded(const QCBORDecodeNesting *pNesting)
+{
+   return pNesting->uCurrentBounded != QCBOR_NESTING_NOT_BOUNDED;
 }
 
 
-static uint32_t
+static QCBOROffset
 DecodeNesting_GetMapOrArrayStart(const QCBORDecodeNesting *pNesting)
 {
-   return pNesting->pCurrentBounded->u.ma.uStartOffset;
+   return DecodeNesting_Bounded(pNesting)->ma.uStartOffset;
 }
 
 
 static bool
 DecodeNesting_IsBoundedEmpty(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrentBounded->u.ma.uCountCursor == QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
+   if(DecodeNesting_Bounded(pNesting)->ma.uCountCursor == QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
       return true;
    } else {
       return false;
@@ -246,7 +266,7 @@ DecodeNesting_IsBoundedEmpty(const QCBORDecodeNesting *pNesting)
 static bool
 DecodeNesting_IsCurrentAtTop(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent == &(pNesting->pLevels[0])) {
+   if(pNesting->uCurrent == 0) {
       return true;
    } else {
       return false;
@@ -257,13 +277,13 @@ DecodeNesting_IsCurrentAtTop(const QCBORDecodeNesting *pNesting)
 static bool
 DecodeNesting_IsCurrentDefiniteLength(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent->uLevelType == QCBOR_TYPE_BYTE_STRING) {
+   if(DecodeNesting_CurrentType(pNesting) == QCBOR_TYPE_BYTE_STRING) {
       /* Not a map or array */
       return false;
    }
 
 #ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
-   if(pNesting->pCurrent->u.ma.uCountTotal == QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
+   if(DecodeNesting_Current(pNesting)->ma.uCountTotal == QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       /* Is indefinite */
       return false;
    }
@@ -277,7 +297,7 @@ DecodeNesting_IsCurrentDefiniteLength(const QCBORDecodeNesting *pNesting)
 static bool
 DecodeNesting_IsCurrentBstrWrapped(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent->uLevelType == QCBOR_TYPE_BYTE_STRING) {
+   if(DecodeNesting_CurrentType(pNesting) == QCBOR_TYPE_BYTE_STRING) {
       /* is a byte string */
       return true;
    }
@@ -288,10 +308,10 @@ DecodeNesting_IsCurrentBstrWrapped(const QCBORDecodeNesting *pNesting)
 static bool
 DecodeNesting_IsCurrentBounded(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent->uLevelType == QCBOR_TYPE_BYTE_STRING) {
+   if(DecodeNesting_CurrentType(pNesting) == QCBOR_TYPE_BYTE_STRING) {
       return true;
    }
-   if(pNesting->pCurrent->u.ma.uStartOffset != QCBOR_NON_BOUNDED_OFFSET) {
+   if(DecodeNesting_Current(pNesting)->ma.uStartOffset != QCBOR_NON_BOUNDED_OFFSET) {
       return true;
    }
    return false;
@@ -307,10 +327,10 @@ DecodeNesting_SetMapOrArrayBoundedMode(QCBORDecodeNesting *pNesting, bool bIsEmp
     * larger than DecodeNesting_EnterBoundedMode which keeps it less than
     * uin32_t so the cast is safe.
     */
-   pNesting->pCurrent->u.ma.uStartOffset = (uint32_t)uStart;
+   DecodeNesting_Current(pNesting)->ma.uStartOffset = (QCBOROffset)uStart;
 
    if(bIsEmpty) {
-      pNesting->pCurrent->u.ma.uCountCursor = QCBOR_COUNT_INDICATES_ZERO_LENGTH;
+      DecodeNesting_Current(pNesting)->ma.uCountCursor = QCBOR_COUNT_INDICATES_ZERO_LENGTH;
    }
 }
 
@@ -318,18 +338,18 @@ DecodeNesting_SetMapOrArrayBoundedMode(QCBORDecodeNesting *pNesting, bool bIsEmp
 static void
 DecodeNesting_ClearBoundedMode(QCBORDecodeNesting *pNesting)
 {
-   pNesting->pCurrent->u.ma.uStartOffset = QCBOR_NON_BOUNDED_OFFSET;
+   DecodeNesting_Current(pNesting)->ma.uStartOffset = QCBOR_NON_BOUNDED_OFFSET;
 }
 
 
 static bool
 DecodeNesting_IsAtEndOfBoundedLevel(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrentBounded == NULL) {
+   if(!DecodeNesting_IsBounded(pNesting)) {
       /* No bounded map or array set up */
       return false;
    }
-   if(pNesting->pCurrent->uLevelType == QCBOR_TYPE_BYTE_STRING) {
+   if(DecodeNesting_CurrentType(pNesting) == QCBOR_TYPE_BYTE_STRING) {
       /* Not a map or array; end of those is by byte count */
       return false;
    }
@@ -338,8 +358,8 @@ DecodeNesting_IsAtEndOfBoundedLevel(const QCBORDecodeNesting *pNesting)
       return false;
    }
    /* Works for both definite- and indefinitelength maps/arrays */
-   if(pNesting->pCurrentBounded->u.ma.uCountCursor != 0 &&
-      pNesting->pCurrentBounded->u.ma.uCountCursor != QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
+   if(DecodeNesting_Bounded(pNesting)->ma.uCountCursor != 0 &&
+      DecodeNesting_Bounded(pNesting)->ma.uCountCursor != QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
       /* Count is not zero, still unconsumed item */
       return false;
    }
@@ -352,7 +372,7 @@ static bool
 DecodeNesting_IsEndOfDefiniteLengthMapOrArray(const QCBORDecodeNesting *pNesting)
 {
    /* Must only be called on map / array */
-   if(pNesting->pCurrent->u.ma.uCountCursor == 0) {
+   if(DecodeNesting_Current(pNesting)->ma.uCountCursor == 0) {
       return true;
    } else {
       return false;
@@ -363,7 +383,7 @@ DecodeNesting_IsEndOfDefiniteLengthMapOrArray(const QCBORDecodeNesting *pNesting
 static bool
 DecodeNesting_IsCurrentTypeMap(const QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent->uLevelType == CBOR_MAJOR_TYPE_MAP) {
+   if(DecodeNesting_CurrentType(pNesting) == CBOR_MAJOR_TYPE_MAP) {
       return true;
    } else {
       return false;
@@ -374,11 +394,11 @@ DecodeNesting_IsCurrentTypeMap(const QCBORDecodeNesting *pNesting)
 static bool
 DecodeNesting_IsBoundedType(const QCBORDecodeNesting *pNesting, uint8_t uType)
 {
-   if(pNesting->pCurrentBounded == NULL) {
+   if(!DecodeNesting_IsBounded(pNesting)) {
       return false;
    }
 
-   uint8_t uItemDataType = pNesting->pCurrentBounded->uLevelType;
+   uint8_t uItemDataType = pNesting->puLevelTypes[pNesting->uCurrentBounded];
 #ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
    if(uItemDataType == QCBOR_TYPE_MAP_AS_ARRAY) {
       uItemDataType = QCBOR_TYPE_ARRAY;
@@ -397,7 +417,7 @@ static void
 DecodeNesting_DecrementDefiniteLengthMapOrArrayCount(QCBORDecodeNesting *pNesting)
 {
    /* Only call on a definite-length array / map */
-   pNesting->pCurrent->u.ma.uCountCursor--;
+   DecodeNesting_Current(pNesting)->ma.uCountCursor--;
 }
 
 
@@ -405,14 +425,14 @@ static void
 DecodeNesting_ReverseDecrement(QCBORDecodeNesting *pNesting)
 {
    /* Only call on a definite-length array / map */
-   pNesting->pCurrent->u.ma.uCountCursor++;
+   DecodeNesting_Current(pNesting)->ma.uCountCursor++;
 }
 
 
 static void
 DecodeNesting_Ascend(QCBORDecodeNesting *pNesting)
 {
-   pNesting->pCurrent--;
+   pNesting->uCurrent--;
 }
 
 
@@ -420,14 +440,14 @@ static QCBORError
 DecodeNesting_Descend(QCBORDecodeNesting *pNesting, uint8_t uType)
 {
    /* Error out if nesting is too deep */
-   if(pNesting->pCurrent >= &(pNesting->pLevels[QCBOR_MAX_ARRAY_NESTING])) {
+   if(pNesting->uCurrent >= pNesting->uMaxLevel) {
       return QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP;
    }
 
    /* The actual descend */
-   pNesting->pCurrent++;
+   pNesting->uCurrent++;
 
-   pNesting->pCurrent->uLevelType = uType;
+   pNesting->puLevelTypes[pNesting->uCurrent] = uType;
 
    return QCBOR_SUCCESS;
 }
@@ -447,13 +467,13 @@ DecodeNesting_EnterBoundedMapOrArray(QCBORDecodeNesting *pNesting,
     * Check against QCBOR_MAX_DECODE_INPUT_SIZE make sure that
     * uOffset doesn't collide with QCBOR_NON_BOUNDED_OFFSET.
     *
-    * Cast of uOffset to uint32_t for cases where SIZE_MAX < UINT32_MAX.
+    * Cast of uOffset to QCBOROffset for cases where SIZE_MAX < UINT32_MAX.
     */
-   if((uint32_t)uOffset >= QCBOR_MAX_DECODE_INPUT_SIZE) {
+   if((QCBOROffset)uOffset >= QCBOR_MAX_DECODE_INPUT_SIZE) {
       return QCBOR_ERR_INPUT_TOO_LARGE;
    }
 
-   pNesting->pCurrentBounded = pNesting->pCurrent;
+   pNesting->uCurrentBounded = pNesting->uCurrent;
 
    DecodeNesting_SetMapOrArrayBoundedMode(pNesting, bIsEmpty, uOffset);
 
@@ -464,7 +484,7 @@ DecodeNesting_EnterBoundedMapOrArray(QCBORDecodeNesting *pNesting,
 static QCBORError
 DecodeNesting_DescendMapOrArray(QCBORDecodeNesting *pNesting,
                                 const uint8_t       uQCBORType,
-                                const uint16_t      uCount)
+                                const QCBORCount    uCount)
 {
    QCBORError uError = QCBOR_SUCCESS;
 
@@ -484,8 +504,8 @@ DecodeNesting_DescendMapOrArray(QCBORDecodeNesting *pNesting,
       goto Done;
    }
 
-   pNesting->pCurrent->u.ma.uCountCursor = uCount;
-   pNesting->pCurrent->u.ma.uCountTotal  = uCount;
+   DecodeNesting_Current(pNesting)->ma.uCountCursor = uCount;
+   DecodeNesting_Current(pNesting)->ma.uCountTotal  = uCount;
 
    DecodeNesting_ClearBoundedMode(pNesting);
 
@@ -497,15 +517,15 @@ Done:
 static void
 DecodeNesting_LevelUpCurrent(QCBORDecodeNesting *pNesting)
 {
-   pNesting->pCurrent = pNesting->pCurrentBounded - 1;
+   pNesting->uCurrent = (uint8_t)(pNesting->uCurrentBounded - 1);
 }
 
 
 static void
 DecodeNesting_LevelUpBounded(QCBORDecodeNesting *pNesting)
 {
-   while(pNesting->pCurrentBounded != &(pNesting->pLevels[0])) {
-      pNesting->pCurrentBounded--;
+   while(pNesting->uCurrentBounded != 0) {
+      pNesting->uCurrentBounded--;
       if(DecodeNesting_IsCurrentBounded(pNesting)) {
          break;
       }
@@ -516,14 +536,14 @@ DecodeNesting_LevelUpBounded(QCBORDecodeNesting *pNesting)
 static void
 DecodeNesting_SetCurrentToBoundedLevel(QCBORDecodeNesting *pNesting)
 {
-   pNesting->pCurrent = pNesting->pCurrentBounded;
+   pNesting->uCurrent = pNesting->uCurrentBounded;
 }
 
 
 static QCBORError
 DecodeNesting_DescendIntoBstrWrapped(QCBORDecodeNesting *pNesting,
-                                     uint32_t            uEndOffset,
-                                     uint32_t            uStartOffset)
+                                     QCBOROffset         uEndOffset,
+                                     QCBOROffset         uStartOffset)
 {
    QCBORError uError;
 
@@ -533,11 +553,11 @@ DecodeNesting_DescendIntoBstrWrapped(QCBORDecodeNesting *pNesting,
    }
 
    /* Fill in the new byte string level */
-   pNesting->pCurrent->u.bs.uSavedEndOffset  = uEndOffset;
-   pNesting->pCurrent->u.bs.uBstrStartOffset = uStartOffset;
+   DecodeNesting_Current(pNesting)->bs.uSavedEndOffset  = uEndOffset;
+   DecodeNesting_Current(pNesting)->bs.uBstrStartOffset = uStartOffset;
 
    /* Bstr wrapped levels are always bounded */
-   pNesting->pCurrentBounded = pNesting->pCurrent;
+   pNesting->uCurrentBounded = pNesting->uCurrent;
 
 Done:
    return uError;;
@@ -547,15 +567,15 @@ Done:
 static void
 DecodeNesting_ZeroMapOrArrayCount(QCBORDecodeNesting *pNesting)
 {
-   pNesting->pCurrent->u.ma.uCountCursor = 0;
+   DecodeNesting_Current(pNesting)->ma.uCountCursor = 0;
 }
 
 
 static void
 DecodeNesting_ResetMapOrArrayCount(QCBORDecodeNesting *pNesting)
 {
-   if(pNesting->pCurrent->u.ma.uCountCursor != QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
-      pNesting->pCurrentBounded->u.ma.uCountCursor = pNesting->pCurrentBounded->u.ma.uCountTotal;
+   if(DecodeNesting_Current(pNesting)->ma.uCountCursor != QCBOR_COUNT_INDICATES_ZERO_LENGTH) {
+      DecodeNesting_Bounded(pNesting)->ma.uCountCursor = DecodeNesting_Bounded(pNesting)->ma.uCountTotal;
    }
 }
 
@@ -563,32 +583,162 @@ DecodeNesting_ResetMapOrArrayCount(QCBORDecodeNesting *pNesting)
 static void
 DecodeNesting_Init(QCBORDecodeNesting *pNesting)
 {
-   /* Assumes that *pNesting has been zero'd before this call. */
-   pNesting->pLevels[0].uLevelType = QCBOR_TYPE_BYTE_STRING;
-   pNesting->pCurrent = &(pNesting->pLevels[0]);
+   /* Assumes that *pNesting has been zero'd and storage set up
+    * before this call. */
+   pNesting->puLevelTypes[0]  = QCBOR_TYPE_BYTE_STRING;
+   pNesting->uCurrent         = 0;
+   pNesting->uCurrentBounded  = QCBOR_NESTING_NOT_BOUNDED;
+}
+
+
+static void
+DecodeNesting_UseBuiltInStorage(QCBORDecodeNesting *pNesting)
+{
+   pNesting->pLevels      = pNesting->BuiltInLevels;
+   pNesting->puLevelTypes = pNesting->auBuiltInLevelTypes;
+   pNesting->uMaxLevel    = QCBOR_MAX_ARRAY_NESTING;
+}
+
+
+/* Copy uCount levels where there is room for at least uRoom in both
+ * source and destination. */
+static void
+DecodeNesting_CopyLevels(QCBORDecodeLevel       *pDestLevels,
+                         uint8_t                *puDestTypes,
+                         const QCBORDecodeLevel *pSrcLevels,
+                         const uint8_t          *puSrcTypes,
+                         const uint8_t           uCount,
+                         const uint8_t           uRoom)
+{
+   /* Usually only a level or two are copied. Copying a constant size
+    * lets compilers inline the copy as a few moves rather than a
+    * general-purpose block copy that is slow to start up. */
+   if(uCount <= 4 && uRoom >= 4) {
+      memcpy(pDestLevels, pSrcLevels, 4 * sizeof(QCBORDecodeLevel));
+      memcpy(puDestTypes, puSrcTypes, 4);
+   } else {
+      memcpy(pDestLevels, pSrcLevels, uCount * sizeof(QCBORDecodeLevel));
+      memcpy(puDestTypes, puSrcTypes, uCount);
+   }
+}
+
+
+/* Save the levels from uFirst down to the current one. They go in
+ * *pSave if they fit and into the save area of caller-provided
+ * storage otherwise, if bUseSaveArea. Returns false if they don't
+ * fit and can't go in the save area.
+ */
+static bool
+DecodeNesting_SaveFrom(const QCBORDecodeNesting *pNesting,
+                       const uint8_t             uFirst,
+                       const bool                bUseSaveArea,
+                       QCBORDecodeNestingSave   *pSave)
+{
+   const uint8_t uCount    = (uint8_t)(pNesting->uCurrent - uFirst + 1);
+   const uint8_t uSrcRoom  = (uint8_t)(pNesting->uMaxLevel - uFirst + 1);
+
+   pSave->uFirst          = uFirst;
+   pSave->uCurrent        = pNesting->uCurrent;
+   pSave->uCurrentBounded = pNesting->uCurrentBounded;
+
+   if(uCount <= QCBOR_MAX_ARRAY_NESTING + 1) {
+      DecodeNesting_CopyLevels(pSave->pLevels,
+                               pSave->puLevelTypes,
+                               &(pNesting->pLevels[uFirst]),
+                               &(pNesting->puLevelTypes[uFirst]),
+                               uCount,
+                               uSrcRoom);
+      return true;
+   }
+
+   if(!bUseSaveArea) {
+      return false;
+   }
+   /* Only caller-provided storage gets this deep. Its save area is
+    * after the live levels. */
+   DecodeNesting_CopyLevels(&(pNesting->pLevels[pNesting->uMaxLevel + 1 + uFirst]),
+                            &(pNesting->puLevelTypes[pNesting->uMaxLevel + 1 + uFirst]),
+                            &(pNesting->pLevels[uFirst]),
+                            &(pNesting->puLevelTypes[uFirst]),
+                            uCount,
+                            0);
+   return true;
+}
+
+
+static void
+DecodeNesting_Restore(QCBORDecodeNesting           *pNesting,
+                      const QCBORDecodeNestingSave *pSave)
+{
+   const uint8_t uFirst  = pSave->uFirst;
+   const uint8_t uCount  = (uint8_t)(pSave->uCurrent - uFirst + 1);
+
+   if(uCount <= QCBOR_MAX_ARRAY_NESTING + 1) {
+      DecodeNesting_CopyLevels(&(pNesting->pLevels[uFirst]),
+                               &(pNesting->puLevelTypes[uFirst]),
+                               pSave->pLevels,
+                               pSave->puLevelTypes,
+                               uCount,
+                               (uint8_t)(pNesting->uMaxLevel - uFirst + 1));
+   } else {
+      DecodeNesting_CopyLevels(&(pNesting->pLevels[uFirst]),
+                               &(pNesting->puLevelTypes[uFirst]),
+                               &(pNesting->pLevels[pNesting->uMaxLevel + 1 + uFirst]),
+                               &(pNesting->puLevelTypes[pNesting->uMaxLevel + 1 + uFirst]),
+                               uCount,
+                               0);
+   }
+   pNesting->uCurrent        = pSave->uCurrent;
+   pNesting->uCurrentBounded = pSave->uCurrentBounded;
+}
+
+
+/* Decoding ahead, whether one item or a whole map search, never
+ * changes the levels above the bounded level, so only those from
+ * it down are saved. Nothing is above the top level.
+ */
+static uint8_t
+DecodeNesting_FirstLevelToSave(const QCBORDecodeNesting *pNesting)
+{
+   if(DecodeNesting_IsBounded(pNesting)) {
+      return pNesting->uCurrentBounded;
+   } else {
+      return 0;
+   }
+}
+
+
+static void
+DecodeNesting_Save(const QCBORDecodeNesting *pNesting,
+                   QCBORDecodeNestingSave   *pSave)
+{
+   (void)DecodeNesting_SaveFrom(pNesting,
+                                DecodeNesting_FirstLevelToSave(pNesting),
+                                true,
+                                pSave);
 }
 
 
 static void
-DecodeNesting_PrepareForMapSearch(QCBORDecodeNesting *pNesting,
-                                  QCBORDecodeNesting *pSave)
+DecodeNesting_PrepareForMapSearch(const QCBORDecodeNesting *pNesting,
+                                  QCBORDecodeNestingSave   *pSave)
 {
-   *pSave = *pNesting;
+   DecodeNesting_Save(pNesting, pSave);
 }
 
 
 static void
-DecodeNesting_RestoreFromMapSearch(QCBORDecodeNesting *pNesting,
-                                   const QCBORDecodeNesting *pSave)
+DecodeNesting_RestoreFromMapSearch(QCBORDecodeNesting           *pNesting,
+                                   const QCBORDecodeNestingSave *pSave)
 {
-   *pNesting = *pSave;
+   DecodeNesting_Restore(pNesting, pSave);
 }
 
 
-static uint32_t
+static QCBOROffset
 DecodeNesting_GetPreviousBoundedEnd(const QCBORDecodeNesting *pMe)
 {
-   return pMe->pCurrentBounded->u.bs.uSavedEndOffset;
+   return DecodeNesting_Bounded(pMe)->bs.uSavedEndOffset;
 }
 
 
@@ -663,6 +813,7 @@ QCBORDecode_Init(QCBORDecodeContext *pMe,
     * passed it will just act as if the default normal mode of 0 was set.
     */
    pMe->uDecodeMode = (uint8_t)nDecodeMode;
+   DecodeNesting_UseBuiltInStorage(&(pMe->nesting));
    DecodeNesting_Init(&(pMe->nesting));
 
    /* Inialize me->auMappedTags to CBOR_TAG_INVALID16. See
@@ -671,6 +822,50 @@ QCBORDecode_Init(QCBORDecodeContext *pMe,
 }
 
 
+/*
+ * Public function, see header file
+ */
+QCBORError
+QCBORDecode_SetNestingStorage(QCBORDecodeContext *pMe, UsefulBuf Storage)
+{
+   QCBORDecodeNesting *pNesting = &(pMe->nesting);
+   QCBORDecodeLevel   *pLevels;
+   uint8_t            *puLevelTypes;
+   size_t              uLevels;
+
+   if(UsefulBuf_IsNULL(Storage)) {
+      pLevels      = pNesting->BuiltInLevels;
+      puLevelTypes = pNesting->auBuiltInLevelTypes;
+      uLevels      = QCBOR_MAX_ARRAY_NESTING + 1;
+   } else {
+      if((uintptr_t)Storage.ptr % sizeof(QCBOROffset) != 0) {
+         return QCBOR_ERR_NESTING_STORAGE;
+      }
+      /* Live levels, then the save area, then the types of each */
+      uLevels = Storage.len / (2 * (sizeof(QCBORDecodeLevel) + 1));
+      if(uLevels > QCBOR_MAX_DECODE_NESTING_STORAGE) {
+         uLevels = QCBOR_MAX_DECODE_NESTING_STORAGE;
+      }
+      pLevels      = (QCBORDecodeLevel *)Storage.ptr;
+      puLevelTypes = (uint8_t *)(pLevels + 2 * uLevels);
+   }
+
+   if(uLevels <= pNesting->uCurrent) {
+      return QCBOR_ERR_NESTING_STORAGE;
+   }
+
+   if(pLevels != pNesting->pLevels) {
+      memcpy(pLevels, pNesting->pLevels, (pNesting->uCurrent + 1) * sizeof(QCBORDecodeLevel));
+      memcpy(puLevelTypes, pNesting->puLevelTypes, pNesting->uCurrent + 1);
+   }
+   pNesting->pLevels      = pLevels;
+   pNesting->puLevelTypes = puLevelTypes;
+   pNesting->uMaxLevel    = (uint8_t)(uLevels - 1);
+
+   return QCBOR_SUCCESS;
+}
+
+
 #ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
 
 /*
@@ -685,6 +880,10 @@ QCBORDecode_SetUpAllocator(QCBORDecodeContext *pMe,
    pMe->StringAllocator.pfAllocator   = pfAllocateFunction;
    pMe->StringAllocator.pAllocateCxt  = pAllocateContext;
    pMe->bStringAllocateAll            = bAllStrings;
+   /* A peeked item might not have been allocated the new way */
+   if(pMe->pPeekCache != NULL) {
+      pMe->pPeekCache->bValid = false;
+   }
 }
 #endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
 
@@ -766,21 +965,83 @@ QCBORDecode_SetCallerConfiguredTagList(QCBORDecodeContext   *pMe,
  */
 
 
+/*
+ * The initial byte of every CBOR data item is looked up in this table
+ * to get its item class. This replaces a series of range checks on
+ * the major type and additional info with one indexed load and lets
+ * QCBOR_Private_DecodeAtomicDataItem() dispatch with one switch.
+ *
+ * For the normal case the item class is the major type. The classes
+ * that are not major types cover initial bytes that are never
+ * well-formed or not supported so they can be errored out without any
+ * further checks:
+ *
+ *   QCBOR_HEAD_CLASS_RESERVED  Additional info 28, 29 and 30 for all
+ *                              major types.
+ *   QCBOR_HEAD_CLASS_BAD_INT   Indefinite length for integers and tag
+ *                              numbers.
+ *
+ * Indefinite lengths for strings, arrays and maps and the break (0xff)
+ * keep their major type class since they are handled further up.
+ *
+ * The number of argument bytes is not in this table. Getting it from
+ * the additional info directly avoids a load that the argument fetch
+ * would have to wait on.
+ */
+#define QCBOR_HEAD_CLASS_RESERVED 8
+#define QCBOR_HEAD_CLASS_BAD_INT  9
+
+#define QCBOR_HEAD_CLASS4(nClass) nClass, nClass, nClass, nClass
+
+/* One row of 32 entries for one major type. nIndefClass is the class
+ * for additional info 31. */
+#define QCBOR_HEAD_ROW(nClass, nIndefClass) \
+   QCBOR_HEAD_CLASS4(nClass), QCBOR_HEAD_CLASS4(nClass), \
+   QCBOR_HEAD_CLASS4(nClass), QCBOR_HEAD_CLASS4(nClass), \
+   QCBOR_HEAD_CLASS4(nClass), QCBOR_HEAD_CLASS4(nClass), \
+   QCBOR_HEAD_CLASS4(nClass), \
+   QCBOR_HEAD_CLASS_RESERVED, QCBOR_HEAD_CLASS_RESERVED, \
+   QCBOR_HEAD_CLASS_RESERVED, nIndefClass
+
+#ifndef QCBOR_DISABLE_TAGS
+#define QCBOR_HEAD_TAG_INDEF_CLASS QCBOR_HEAD_CLASS_BAD_INT
+#else /* QCBOR_DISABLE_TAGS */
+/* So QCBOR_ERR_TAGS_DISABLED is returned rather than QCBOR_ERR_BAD_INT */
+#define QCBOR_HEAD_TAG_INDEF_CLASS CBOR_MAJOR_TYPE_TAG
+#endif /* QCBOR_DISABLE_TAGS */
+
+static const uint8_t QCBOR_Private_HeadTable[256] = {
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_POSITIVE_INT, QCBOR_HEAD_CLASS_BAD_INT),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_NEGATIVE_INT, QCBOR_HEAD_CLASS_BAD_INT),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_BYTE_STRING,  CBOR_MAJOR_TYPE_BYTE_STRING),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_TEXT_STRING,  CBOR_MAJOR_TYPE_TEXT_STRING),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_ARRAY,        CBOR_MAJOR_TYPE_ARRAY),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_MAP,          CBOR_MAJOR_TYPE_MAP),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_TAG,          QCBOR_HEAD_TAG_INDEF_CLASS),
+   QCBOR_HEAD_ROW(CBOR_MAJOR_TYPE_SIMPLE,       CBOR_MAJOR_TYPE_SIMPLE)
+};
+
+
 /**
  * @brief Decode the CBOR head, the type and argument.
  *
  * @param[in] pUInBuf            The input buffer to read from.
- * @param[out] pnMajorType       The decoded major type.
+ * @param[out] pnItemClass       The major type or a QCBOR_HEAD_CLASS_XXX.
  * @param[out] puArgument        The decoded argument.
  * @param[out] pnAdditionalInfo  The decoded Lower 5 bits of initial byte.
  *
- * @retval QCBOR_ERR_UNSUPPORTED Encountered unsupported/reserved features
  * @retval QCBOR_ERR_HIT_END Unexpected end of input
  *
  * This decodes the CBOR "head" that every CBOR data item has. See
  * longer explaination of the head in documentation for
  * QCBOREncode_EncodeHead().
  *
+ * The item class comes from QCBOR_Private_HeadTable. It is the major
+ * type except for initial bytes that are known to be in error in which
+ * case it is one of the QCBOR_HEAD_CLASS_XXX values. Those errors are
+ * reported by the caller rather than here so that there is only one
+ * branch on the item class.
+ *
  * This does the network->host byte order conversion. The conversion
  * here also results in the conversion for floats in addition to that
  * for lengths, tags and integer values.
@@ -791,57 +1052,71 @@ QCBORDecode_SetCallerConfiguredTagList(QCBORDecodeContext   *pMe,
  */
 static QCBORError
 QCBOR_Private_DecodeHead(UsefulInputBuf *pUInBuf,
-                         int            *pnMajorType,
+                         int            *pnItemClass,
                          uint64_t       *puArgument,
                          int            *pnAdditionalInfo)
 {
-   QCBORError uReturn;
-
-   /* Get the initial byte that every CBOR data item has and break it
-    * down. */
+   /* Get the initial byte that every CBOR data item has and look it
+    * up. */
    const int nInitialByte    = (int)UsefulInputBuf_GetByte(pUInBuf);
-   const int nTmpMajorType   = nInitialByte >> 5;
+   const int nItemClass      = QCBOR_Private_HeadTable[nInitialByte];
    const int nAdditionalInfo = nInitialByte & 0x1f;
 
    /* Where the argument accumulates */
    uint64_t uArgument;
 
-   if(nAdditionalInfo >= LEN_IS_ONE_BYTE && nAdditionalInfo <= LEN_IS_EIGHT_BYTES) {
-      /* Need to get 1,2,4 or 8 additional argument bytes. Map
-       * LEN_IS_ONE_BYTE..LEN_IS_EIGHT_BYTES to actual length.
-       */
-      static const uint8_t aIterate[] = {1,2,4,8};
+   /* The 1, 2, 4 and 8 byte arguments are each fetched with one
+    * bounds check on the input followed by one big-endian load,
+    * rather than a bounds check and shift for each byte. The
+    * UsefulInputBuf_GetUintXX() functions do the endian conversion
+    * and honor the USEFULBUF_CONFIG_XXX options for byte swapping
+    * so this ends up as a single load and swap instruction on many
+    * CPUs. If there are not enough bytes left in the input, they
+    * return 0 and put the UsefulInputBuf in the error state which is
+    * checked below.
+    */
+   switch(nAdditionalInfo) {
+      case LEN_IS_ONE_BYTE:
+         uArgument = UsefulInputBuf_GetByte(pUInBuf);
+         break;
 
-      /* Loop getting all the bytes in the argument */
-      uArgument = 0;
-      for(int i = aIterate[nAdditionalInfo - LEN_IS_ONE_BYTE]; i; i--) {
-         /* This shift and add gives the endian conversion. */
-         uArgument = (uArgument << 8) + UsefulInputBuf_GetByte(pUInBuf);
-      }
-   } else if(nAdditionalInfo >= ADDINFO_RESERVED1 && nAdditionalInfo <= ADDINFO_RESERVED3) {
-      /* The reserved and thus-far unused additional info values */
-      uReturn = QCBOR_ERR_UNSUPPORTED;
-      goto Done;
-   } else {
-      /* Less than 24, additional info is argument or 31, an
-       * indefinite-length.  No more bytes to get.
-       */
-      uArgument = (uint64_t)nAdditionalInfo;
+      case LEN_IS_TWO_BYTES:
+         uArgument = UsefulInputBuf_GetUint16(pUInBuf);
+         break;
+
+      case LEN_IS_FOUR_BYTES:
+         uArgument = UsefulInputBuf_GetUint32(pUInBuf);
+         break;
+
+      case LEN_IS_EIGHT_BYTES:
+         uArgument = UsefulInputBuf_GetUint64(pUInBuf);
+         break;
+
+      default:
+         /* Less than 24, additional info is argument or 31, an
+          * indefinite-length.  No more bytes to get. This is also
+          * where the reserved values 28-30 end up. They are errored
+          * out by the caller because of their item class.
+          */
+         uArgument = (uint64_t)nAdditionalInfo;
+         break;
    }
 
    if(UsefulInputBuf_GetError(pUInBuf)) {
-      uReturn = QCBOR_ERR_HIT_END;
-      goto Done;
+      /* The UsefulInputBuf_GetUintXX() functions don't move the
+       * cursor on a short read. Move it to the end of the input so
+       * the whole cut-off head counts as consumed for
+       * QCBORDecode_Finish() and QCBORDecode_PartialFinish(), the
+       * same as reading it a byte at a time. */
+      UsefulInputBuf_Seek(pUInBuf, UsefulInputBuf_GetBufferLength(pUInBuf));
+      return QCBOR_ERR_HIT_END;
    }
 
-   /* All successful if arrived here. */
-   uReturn           = QCBOR_SUCCESS;
-   *pnMajorType      = nTmpMajorType;
+   *pnItemClass      = nItemClass;
    *puArgument       = uArgument;
    *pnAdditionalInfo = nAdditionalInfo;
 
-Done:
-   return uReturn;
+   return QCBOR_SUCCESS;
 }
 
 
@@ -850,13 +1125,13 @@ Done:
  *
  * @param[in] nMajorType       The CBOR major type (0 or 1).
  * @param[in] uArgument        The argument from the head.
- * @param[in] nAdditionalInfo  So it can be error-checked.
  * @param[out] pDecodedItem    The filled in decoded item.
  *
  * @retval QCBOR_ERR_INT_OVERFLOW  Too-large negative encountered.
- * @retval QCBOR_ERR_BAD_INT       nAdditionalInfo indicated indefinte.
  *
- * Must only be called when major type is 0 or 1.
+ * Must only be called when major type is 0 or 1. Indefinite-length
+ * integers are caught by QCBOR_Private_HeadTable before this is
+ * called.
  *
  * CBOR doesn't explicitly specify two's compliment for integers but
  * all CPUs use it these days and the test vectors in the RFC are
@@ -870,16 +1145,10 @@ Done:
 static QCBORError
 QCBOR_Private_DecodeInteger(const int      nMajorType,
                             const uint64_t uArgument,
-                            const int      nAdditionalInfo,
                             QCBORItem     *pDecodedItem)
 {
    QCBORError uReturn = QCBOR_SUCCESS;
 
-   if(nAdditionalInfo == LEN_IS_INDEFINITE) {
-      uReturn = QCBOR_ERR_BAD_INT;
-      goto Done;
-   }
-
    if(nMajorType == CBOR_MAJOR_TYPE_POSITIVE_INT) {
       if (uArgument <= INT64_MAX) {
          pDecodedItem->val.int64 = (int64_t)uArgument;
@@ -908,7 +1177,6 @@ QCBOR_Private_DecodeInteger(const int      nMajorType,
       }
    }
 
-Done:
    return uReturn;
 }
 
@@ -927,6 +1195,7 @@ Done:
  * @retval QCBOR_ERR_STRING_ALLOCATE  Out of memory.
  * @retval QCBOR_ERR_STRING_TOO_LONG  String longer than SIZE_MAX - 4.
  * @retval QCBOR_ERR_NO_STRING_ALLOCATOR  Allocation requested, but no allocator
+ * @retval QCBOR_ERR_INVALID_UTF8  Text string isn't UTF-8 and checking is on.
  *
  * This reads @c uStrlen bytes from the input and fills in @c
  * pDecodedItem. If @c bAllocate is true, then memory for the string
@@ -979,6 +1248,19 @@ QCBOR_Private_DecodeString(QCBORDecodeContext  *pMe,
          goto Done;
       }
 
+      /* Each chunk of an indefinite-length text string must be
+       * valid on its own so this works for them too (RFC 8949
+       * section 3.2.3). */
+      if(nMajorType == CBOR_MAJOR_TYPE_TEXT_STRING &&
+         pMe->bCheckUTF8 &&
+         UsefulBuf_IsValidUTF8(Bytes) != SIZE_MAX) {
+         /* Not allocated, but filled in so a chunk of an
+          * indefinite-length string can still be accounted for. */
+         pDecodedItem->val.string = Bytes;
+         uReturn = QCBOR_ERR_INVALID_UTF8;
+         goto Done;
+      }
+
       if(bAllocate) {
 #ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
          /* --- Put string in allocated memory --- */
@@ -1085,7 +1367,7 @@ QCBOR_Private_DecodeArrayOrMap(const uint8_t  uMode,
 #endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
          /* cast OK because of check above */
-         pDecodedItem->val.uCount = (uint16_t)uItemCount;
+         pDecodedItem->val.uCount = (QCBORCount)uItemCount;
       }
    }
 
@@ -1097,30 +1379,23 @@ QCBOR_Private_DecodeArrayOrMap(const uint8_t  uMode,
  * @brief Decode a tag number.
  *
  * @param[in] uTagNumber       The length of the string.
- * @param[in] nAdditionalInfo  So this can be error-checked.
  * @param[out] pDecodedItem    The filled-in decoded item.
  *
- * @retval QCBOR_ERR_BAD_INT        nAdditionalInfo is LEN_IS_INDEFINITE.
  * @retval QCBOR_ERR_TAGS_DISABLED  QCBOR_DISABLE_TAGS is defined.
  *
- * Not much to do for tags, but fill in pDecodedItem and check for
- * error in nAdditionalInfo.
+ * Not much to do for tags, but fill in pDecodedItem. Indefinite-length
+ * tag numbers are caught by QCBOR_Private_HeadTable before this is
+ * called.
  */
 static QCBORError
 QCBOR_Private_DecodeTag(const uint64_t uTagNumber,
-                        const int      nAdditionalInfo,
                         QCBORItem     *pDecodedItem)
 {
 #ifndef QCBOR_DISABLE_TAGS
-   if(nAdditionalInfo == LEN_IS_INDEFINITE) {
-      return QCBOR_ERR_BAD_INT;
-   } else {
-      pDecodedItem->val.uTagV = uTagNumber;
-      pDecodedItem->uDataType = QCBOR_TYPE_TAG;
-      return QCBOR_SUCCESS;
-   }
+   pDecodedItem->val.uTagV = uTagNumber;
+   pDecodedItem->uDataType = QCBOR_TYPE_TAG;
+   return QCBOR_SUCCESS;
 #else /* QCBOR_DISABLE_TAGS */
-   (void)nAdditionalInfo;
    (void)uTagNumber;
    (void)pDecodedItem;
    return QCBOR_ERR_TAGS_DISABLED;
@@ -1309,8 +1584,9 @@ QCBOR_Private_DecodeAtomicDataItem(QCBORDecodeContext  *pMe,
 
    memset(pDecodedItem, 0, sizeof(QCBORItem));
 
-   /* Decode the "head" that every CBOR item has into the major type,
-    * argument and the additional info.
+   /* Decode the "head" that every CBOR item has into the item class,
+    * argument and the additional info. The item class is the major
+    * type or one of the QCBOR_HEAD_CLASS_XXX error classes.
     */
    uReturn = QCBOR_Private_DecodeHead(&(pMe->InBuf), &nMajorType, &uArgument, &nAdditionalInfo);
    if(uReturn != QCBOR_SUCCESS) {
@@ -1324,7 +1600,7 @@ QCBOR_Private_DecodeAtomicDataItem(QCBORDecodeContext  *pMe,
    switch (nMajorType) {
       case CBOR_MAJOR_TYPE_POSITIVE_INT: /* Major type 0 */
       case CBOR_MAJOR_TYPE_NEGATIVE_INT: /* Major type 1 */
-         return QCBOR_Private_DecodeInteger(nMajorType, uArgument, nAdditionalInfo, pDecodedItem);
+         return QCBOR_Private_DecodeInteger(nMajorType, uArgument, pDecodedItem);
          break;
 
       case CBOR_MAJOR_TYPE_BYTE_STRING: /* Major type 2 */
@@ -1338,7 +1614,7 @@ QCBOR_Private_DecodeAtomicDataItem(QCBORDecodeContext  *pMe,
          break;
 
       case CBOR_MAJOR_TYPE_TAG: /* Major type 6, tag numbers */
-         return QCBOR_Private_DecodeTag(uArgument, nAdditionalInfo, pDecodedItem);
+         return QCBOR_Private_DecodeTag(uArgument, pDecodedItem);
          break;
 
       case CBOR_MAJOR_TYPE_SIMPLE:
@@ -1346,8 +1622,15 @@ QCBOR_Private_DecodeAtomicDataItem(QCBORDecodeContext  *pMe,
          return QCBOR_Private_DecodeType7(nAdditionalInfo, uArgument, pDecodedItem);
          break;
 
+      case QCBOR_HEAD_CLASS_BAD_INT:
+         /* Integer or tag number with indefinite length */
+         return QCBOR_ERR_BAD_INT;
+         break;
+
       default:
-         /* Never happens because DecodeHead() should never return > 7 */
+         /* QCBOR_HEAD_CLASS_RESERVED, the reserved and thus-far
+          * unused additional info values 28-30.
+          */
          return QCBOR_ERR_UNSUPPORTED;
          break;
    }
@@ -1455,6 +1738,7 @@ QCBORDecode_Private_GetNextFullString(QCBORDecodeContext *pMe,
 
    /* Loop getting chunks of the indefinite-length string */
    UsefulBufC FullString = NULLUsefulBufC;
+   QCBORError uUTF8Error = QCBOR_SUCCESS;
 
    for(;;) {
       /* Get QCBORItem for next chunk */
@@ -1465,12 +1749,22 @@ QCBORDecode_Private_GetNextFullString(QCBORDecodeContext *pMe,
        * contiguous buffer allocated here.
        */
       uReturn = QCBOR_Private_DecodeAtomicDataItem(pMe, false, &StringChunkItem);
+      if(uReturn == QCBOR_ERR_INVALID_UTF8) {
+         /* Remember it, but read the rest of the chunks and the break
+          * so the error is recoverable. */
+         uUTF8Error = uReturn;
+         uReturn    = QCBOR_SUCCESS;
+      }
       if(uReturn) {
          break;
       }
 
       /* Is item is the marker for end of the indefinite-length string? */
       if(StringChunkItem.uDataType == QCBOR_TYPE_BREAK) {
+         if(uUTF8Error != QCBOR_SUCCESS) {
+            uReturn = uUTF8Error;
+            break;
+         }
          /* String is complete */
          pDecodedItem->val.string = FullString;
          pDecodedItem->uDataAlloc = 1;
@@ -1751,6 +2045,7 @@ QCBORDecode_Private_GetNextMapEntry(QCBORDecodeContext *pMe,
 {
    QCBORItem  LabelItem;
    QCBORError uErr;
+   QCBORError uLabelErr;
 
    uErr = QCBORDecode_Private_GetNextTagNumber(pMe, pDecodedItem);
    if(QCBORDecode_IsUnrecoverableError(uErr)) {
@@ -1768,6 +2063,7 @@ QCBORDecode_Private_GetNextMapEntry(QCBORDecodeContext *pMe,
 
    /* Decoding a map entry, so the item decoded above was the label */
    LabelItem = *pDecodedItem;
+   uLabelErr = uErr;
 
    /* Get the value of the map item */
    uErr = QCBORDecode_Private_GetNextTagNumber(pMe, pDecodedItem);
@@ -1811,6 +2107,12 @@ QCBORDecode_Private_GetNextMapEntry(QCBORDecodeContext *pMe,
          goto Done;
    }
 
+   if(uLabelErr != QCBOR_SUCCESS) {
+      /* For example QCBOR_ERR_INVALID_UTF8. It is reported even
+       * though the value decoded OK. */
+      uErr = uLabelErr;
+   }
+
 Done:
    return uErr;
 }
@@ -1832,10 +2134,19 @@ static QCBORError
 QCBOR_Private_NextIsBreak(QCBORDecodeContext *pMe, bool *pbNextIsBreak)
 {
    *pbNextIsBreak = false;
+   if(pMe->bStreaming && UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf)) == 0) {
+      /* Can't tell if the break is next until there is more input */
+      return QCBOR_ERR_HIT_END;
+   }
    if(UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf)) != 0) {
       QCBORItem Peek;
       size_t uPeek = UsefulInputBuf_Tell(&(pMe->InBuf));
+      /* An invalid text string is reported when it is decoded for
+       * real, not against the item before it. */
+      const uint8_t bCheckUTF8 = pMe->bCheckUTF8;
+      pMe->bCheckUTF8 = false;
       QCBORError uReturn = QCBOR_Private_DecodeAtomicDataItem(pMe, false, &Peek);
+      pMe->bCheckUTF8 = bCheckUTF8;
       if(uReturn != QCBOR_SUCCESS) {
          return uReturn;
       }
@@ -1960,6 +2271,91 @@ Done:
 }
 
 
+/**
+ * @brief Descend into or ascend out of nesting levels for an item.
+ *
+ * @param[in] pMe            Decoder context
+ * @param[out] pbBreak       Set to true if extra break was consumed.
+ * @param[in,out] pDecodedItem  The item just decoded.
+ *
+ * @retval QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP  Too many nesting levels.
+ * @retval QCBOR_ERR_BAD_BREAK               A break where it shouldn't be.
+ *
+ * This is the part of QCBORDecode_Private_GetNextMapOrArray() that
+ * runs after the item is decoded. It is separate so the fast path in
+ * QCBORDecode_GetNext() traverses exactly the same way.
+ */
+static QCBORError
+QCBORDecode_Private_NestAfterItem(QCBORDecodeContext *pMe,
+                                  bool               *pbBreak,
+                                  QCBORItem          *pDecodedItem)
+{
+   /* Record the nesting level for this data item before processing
+    * any of decrementing and descending.
+    */
+   pDecodedItem->uNestingLevel = DecodeNesting_GetCurrentLevel(&(pMe->nesting));
+
+
+   /* ==== Next: Process the item for descent, ascent, decrement... ==== */
+   if(QCBORItem_IsMapOrArray(*pDecodedItem)) {
+      /* If the new item is a map or array, descend.
+       *
+       * Empty indefinite-length maps and arrays are descended into,
+       * but then ascended out of in the next chunk of code.
+       *
+       * Maps and arrays do count as items in the map/array that
+       * encloses them so a decrement needs to be done for them too,
+       * but that is done only when all the items in them have been
+       * processed, not when they are opened with the exception of an
+       * empty map or array.
+       */
+      QCBORError uDescendErr;
+      uDescendErr = DecodeNesting_DescendMapOrArray(&(pMe->nesting),
+                                                    pDecodedItem->uDataType,
+                                                    pDecodedItem->val.uCount);
+      if(uDescendErr != QCBOR_SUCCESS) {
+         return uDescendErr;
+      }
+   }
+
+   if(!QCBORItem_IsMapOrArray(*pDecodedItem) ||
+       QCBORItem_IsEmptyDefiniteLengthMapOrArray(*pDecodedItem) ||
+       QCBORItem_IsIndefiniteLengthMapOrArray(*pDecodedItem)) {
+      /* The following cases are handled here:
+       *  - A non-aggregate item like an integer or string
+       *  - An empty definite-length map or array
+       *  - An indefinite-length map or array that might be empty or might not.
+       *
+       * QCBORDecode_NestLevelAscender() does the work of decrementing the count
+       * for an definite-length map/array and break detection for an
+       * indefinite-0length map/array. If the end of the map/array was
+       * reached, then it ascends nesting levels, possibly all the way
+       * to the top level.
+       */
+      QCBORError uAscendErr;
+      uAscendErr = QCBORDecode_Private_NestLevelAscender(pMe, true, pbBreak);
+      if(uAscendErr != QCBOR_SUCCESS) {
+         return uAscendErr;
+      }
+   }
+
+   /* ==== Last: tell the caller the nest level of the next item ==== */
+   /* Tell the caller what level is next. This tells them what
+    * maps/arrays were closed out and makes it possible for them to
+    * reconstruct the tree with just the information returned in a
+    * QCBORItem.
+   */
+   if(DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting))) {
+      /* At end of a bounded map/array; uNextNestLevel 0 to indicate this */
+      pDecodedItem->uNextNestLevel = 0;
+   } else {
+      pDecodedItem->uNextNestLevel = DecodeNesting_GetCurrentLevel(&(pMe->nesting));
+   }
+
+   return QCBOR_SUCCESS;
+}
+
+
 /**
  * @brief Ascending & Descending out of nesting levels (decode layer 2).
  *
@@ -2040,74 +2436,12 @@ QCBORDecode_Private_GetNextMapOrArray(QCBORDecodeContext *pMe,
       goto Done;
    }
 
-   /* Record the nesting level for this data item before processing
-    * any of decrementing and descending.
-    */
-   pDecodedItem->uNestingLevel = DecodeNesting_GetCurrentLevel(&(pMe->nesting));
-
-
-   /* ==== Next: Process the item for descent, ascent, decrement... ==== */
-   if(QCBORItem_IsMapOrArray(*pDecodedItem)) {
-      /* If the new item is a map or array, descend.
-       *
-       * Empty indefinite-length maps and arrays are descended into,
-       * but then ascended out of in the next chunk of code.
-       *
-       * Maps and arrays do count as items in the map/array that
-       * encloses them so a decrement needs to be done for them too,
-       * but that is done only when all the items in them have been
-       * processed, not when they are opened with the exception of an
-       * empty map or array.
+   QCBORError uNestErr = QCBORDecode_Private_NestAfterItem(pMe, pbBreak, pDecodedItem);
+   if(uNestErr != QCBOR_SUCCESS) {
+      /* This error is probably a traversal error and it overrides
+       * the non-traversal error.
        */
-      QCBORError uDescendErr;
-      uDescendErr = DecodeNesting_DescendMapOrArray(&(pMe->nesting),
-                                                    pDecodedItem->uDataType,
-                                                    pDecodedItem->val.uCount);
-      if(uDescendErr != QCBOR_SUCCESS) {
-         /* This error is probably a traversal error and it overrides
-          * the non-traversal error.
-          */
-         uReturn = uDescendErr;
-         goto Done;
-      }
-   }
-
-   if(!QCBORItem_IsMapOrArray(*pDecodedItem) ||
-       QCBORItem_IsEmptyDefiniteLengthMapOrArray(*pDecodedItem) ||
-       QCBORItem_IsIndefiniteLengthMapOrArray(*pDecodedItem)) {
-      /* The following cases are handled here:
-       *  - A non-aggregate item like an integer or string
-       *  - An empty definite-length map or array
-       *  - An indefinite-length map or array that might be empty or might not.
-       *
-       * QCBORDecode_NestLevelAscender() does the work of decrementing the count
-       * for an definite-length map/array and break detection for an
-       * indefinite-0length map/array. If the end of the map/array was
-       * reached, then it ascends nesting levels, possibly all the way
-       * to the top level.
-       */
-      QCBORError uAscendErr;
-      uAscendErr = QCBORDecode_Private_NestLevelAscender(pMe, true, pbBreak);
-      if(uAscendErr != QCBOR_SUCCESS) {
-         /* This error is probably a traversal error and it overrides
-          * the non-traversal error.
-          */
-         uReturn = uAscendErr;
-         goto Done;
-      }
-   }
-
-   /* ==== Last: tell the caller the nest level of the next item ==== */
-   /* Tell the caller what level is next. This tells them what
-    * maps/arrays were closed out and makes it possible for them to
-    * reconstruct the tree with just the information returned in a
-    * QCBORItem.
-   */
-   if(DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting))) {
-      /* At end of a bounded map/array; uNextNestLevel 0 to indicate this */
-      pDecodedItem->uNextNestLevel = 0;
-   } else {
-      pDecodedItem->uNextNestLevel = DecodeNesting_GetCurrentLevel(&(pMe->nesting));
+      uReturn = uNestErr;
    }
 
 Done:
@@ -2682,6 +3016,255 @@ Done:
 }
 
 
+/**
+ * @brief Roll back decoding of an item that ran out of input when streaming.
+ *
+ * @param[in] pMe           The decode context.
+ * @param[in] uErr          The error from decoding the item.
+ * @param[in] pSaveInBuf    The input buffer before decoding the item.
+ * @param[in] pSaveNesting  The nesting before decoding the item.
+ *
+ * @returns @c uErr or @ref QCBOR_ERR_NEED_MORE_INPUT.
+ *
+ * If the input ran out part way through an item or inside an array
+ * or map, the input and nesting are restored to what they were
+ * before the item so decoding of it can start over when there is
+ * more input. An entered map, array or byte-string wrapped CBOR is
+ * always wholly present, so reaching its end is not running out.
+ */
+static QCBORError
+QCBORDecode_Private_StreamingRollback(QCBORDecodeContext           *pMe,
+                                      const QCBORError              uErr,
+                                      const UsefulInputBuf         *pSaveInBuf,
+                                      const QCBORDecodeNestingSave *pSaveNesting)
+{
+   if(uErr == QCBOR_ERR_HIT_END ||
+      (uErr == QCBOR_ERR_NO_MORE_ITEMS &&
+       UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf)) == 0 &&
+       !DecodeNesting_IsCurrentAtTop(&(pMe->nesting)) &&
+       !DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting)) &&
+       !DecodeNesting_IsCurrentBstrWrapped(&(pMe->nesting)))) {
+      pMe->InBuf = *pSaveInBuf;
+      DecodeNesting_Restore(&(pMe->nesting), pSaveNesting);
+      return QCBOR_ERR_NEED_MORE_INPUT;
+   }
+
+   return uErr;
+}
+
+
+/**
+ * @brief Check whether the peek cache holds the next item.
+ *
+ * @param[in] pMe  The decode context.
+ *
+ * @returns true if there is a cached item and the decoder is in the
+ *          same state as when it was peeked.
+ *
+ * Rather than invalidate the cache in every function that moves the
+ * cursor, this checks the parts of the state that decoding the next
+ * item depends on. Only the current nesting level is compared since
+ * the levels above it can't change without changing it or the
+ * cursor.
+ */
+static bool
+QCBORDecode_Private_PeekCacheHit(QCBORDecodeContext *pMe)
+{
+   const QCBORPeekCache   *pCache = pMe->pPeekCache;
+   const QCBORDecodeLevel *pLevel = DecodeNesting_Current(&(pMe->nesting));
+
+   if(pCache == NULL || !pCache->bValid) {
+      return false;
+   }
+   if(pCache->uCursor != UsefulInputBuf_Tell(&(pMe->InBuf)) ||
+      pCache->pInput != pMe->InBuf.UB.ptr ||
+      pCache->uInputLen != UsefulInputBuf_GetBufferLength(&(pMe->InBuf)) ||
+      pCache->pLevels != pMe->nesting.pLevels ||
+      pCache->uCurrent != pMe->nesting.uCurrent ||
+      pCache->uCurrentBounded != pMe->nesting.uCurrentBounded ||
+      pCache->uLevelType != DecodeNesting_CurrentType(&(pMe->nesting))) {
+      return false;
+   }
+   if(pCache->uLevelType == QCBOR_TYPE_BYTE_STRING) {
+      return pCache->Level.bs.uSavedEndOffset == pLevel->bs.uSavedEndOffset &&
+             pCache->Level.bs.uBstrStartOffset == pLevel->bs.uBstrStartOffset;
+   } else {
+      return pCache->Level.ma.uCountTotal == pLevel->ma.uCountTotal &&
+             pCache->Level.ma.uCountCursor == pLevel->ma.uCountCursor &&
+             pCache->Level.ma.uStartOffset == pLevel->ma.uStartOffset;
+   }
+}
+
+
+/**
+ * @brief Decode an untagged definite-length item in one pass.
+ *
+ * @param[in] pMe            The decode context.
+ * @param[out] pDecodedItem  The decoded item.
+ * @param[out] puErr         Traversal error; set only when true is returned.
+ *
+ * @retval true   The item was decoded and the traversal cursor advanced.
+ * @retval false  Nothing was done; the item must be decoded the usual way.
+ *
+ * This is the fast path for QCBORDecode_GetNext(). It does the work
+ * of decode layers 1 through 6 at once for integers, definite-length
+ * strings, floats, simple values and definite-length maps and arrays
+ * that have no tag numbers and, in maps, an integer or string
+ * label. This skips the tag number list, the label item copy and the
+ * indefinite-length string and tag content checks that cost the most
+ * in the full stack.
+ *
+ * Anything else, including every decode error, is left to the full
+ * decode stack. Nothing but the cursor and the item, which the full
+ * stack overwrites, has changed when false is returned, so the full
+ * stack sees the input as if this had not been called. The
+ * nesting is done by the same function the full stack uses, so the
+ * item and traversal are always the same as from the full stack.
+ */
+static bool
+QCBORDecode_Private_GetNextFast(QCBORDecodeContext *pMe,
+                                QCBORItem          *pDecodedItem,
+                                QCBORError         *puErr)
+{
+   int        nMajorType;
+   int        nAdditionalInfo;
+   uint64_t   uArgument;
+   size_t     uStart;
+   uint8_t    uLabelType;
+   int64_t    nLabel;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   UsefulBufC LabelString;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   if(pMe->bStringAllocateAll ||
+      pMe->uDecodeMode != QCBOR_DECODE_MODE_NORMAL ||
+      UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf)) == 0 ||
+      DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting))) {
+      return false;
+   }
+
+   uStart     = UsefulInputBuf_Tell(&(pMe->InBuf));
+   uLabelType = QCBOR_TYPE_NONE;
+   nLabel     = 0;
+
+   if(DecodeNesting_IsCurrentTypeMap(&(pMe->nesting))) {
+      if(QCBOR_Private_DecodeHead(&(pMe->InBuf), &nMajorType, &uArgument, &nAdditionalInfo) != QCBOR_SUCCESS) {
+         goto Slow;
+      }
+      switch(nMajorType) {
+         case CBOR_MAJOR_TYPE_POSITIVE_INT:
+            if(uArgument > INT64_MAX) {
+               goto Slow;
+            }
+            nLabel = (int64_t)uArgument;
+            uLabelType = QCBOR_TYPE_INT64;
+            break;
+
+         case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+            if(uArgument > INT64_MAX) {
+               goto Slow;
+            }
+            nLabel = (-(int64_t)uArgument) - 1;
+            uLabelType = QCBOR_TYPE_INT64;
+            break;
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+         case CBOR_MAJOR_TYPE_BYTE_STRING:
+         case CBOR_MAJOR_TYPE_TEXT_STRING:
+            if(nAdditionalInfo == LEN_IS_INDEFINITE ||
+               uArgument > UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf))) {
+               goto Slow;
+            }
+            /* Cast is safe because of check against bytes left */
+            LabelString = UsefulInputBuf_GetUsefulBuf(&(pMe->InBuf), (size_t)uArgument);
+            uLabelType  = nMajorType == CBOR_MAJOR_TYPE_BYTE_STRING ?
+                             QCBOR_TYPE_BYTE_STRING : QCBOR_TYPE_TEXT_STRING;
+            if(uLabelType == QCBOR_TYPE_TEXT_STRING &&
+               pMe->bCheckUTF8 &&
+               UsefulBuf_IsValidUTF8(LabelString) != SIZE_MAX) {
+               /* Slow path sets the error */
+               goto Slow;
+            }
+            break;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+         default:
+            goto Slow;
+      }
+   }
+
+   memset(pDecodedItem, 0, sizeof(QCBORItem));
+   if(QCBOR_Private_DecodeHead(&(pMe->InBuf), &nMajorType, &uArgument, &nAdditionalInfo) != QCBOR_SUCCESS) {
+      goto Slow;
+   }
+   switch(nMajorType) {
+      case CBOR_MAJOR_TYPE_POSITIVE_INT:
+      case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+         if(QCBOR_Private_DecodeInteger(nMajorType, uArgument, pDecodedItem) != QCBOR_SUCCESS) {
+            goto Slow;
+         }
+         break;
+
+      case CBOR_MAJOR_TYPE_BYTE_STRING:
+      case CBOR_MAJOR_TYPE_TEXT_STRING:
+         if(nAdditionalInfo == LEN_IS_INDEFINITE ||
+            uArgument > UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf))) {
+            goto Slow;
+         }
+         /* Cast is safe because of check against bytes left */
+         pDecodedItem->val.string = UsefulInputBuf_GetUsefulBuf(&(pMe->InBuf), (size_t)uArgument);
+         pDecodedItem->uDataType  = nMajorType == CBOR_MAJOR_TYPE_BYTE_STRING ?
+                                       QCBOR_TYPE_BYTE_STRING : QCBOR_TYPE_TEXT_STRING;
+         if(pDecodedItem->uDataType == QCBOR_TYPE_TEXT_STRING &&
+            pMe->bCheckUTF8 &&
+            UsefulBuf_IsValidUTF8(pDecodedItem->val.string) != SIZE_MAX) {
+            goto Slow;
+         }
+         break;
+
+      case CBOR_MAJOR_TYPE_ARRAY:
+      case CBOR_MAJOR_TYPE_MAP:
+         if(nAdditionalInfo == LEN_IS_INDEFINITE ||
+            QCBOR_Private_DecodeArrayOrMap(pMe->uDecodeMode, nMajorType, uArgument, nAdditionalInfo, pDecodedItem) != QCBOR_SUCCESS) {
+            goto Slow;
+         }
+         break;
+
+      case CBOR_MAJOR_TYPE_SIMPLE:
+         if(QCBOR_Private_DecodeType7(nAdditionalInfo, uArgument, pDecodedItem) != QCBOR_SUCCESS ||
+            pDecodedItem->uDataType == QCBOR_TYPE_BREAK) {
+            goto Slow;
+         }
+         break;
+
+      default:
+         /* Tag numbers and the head error classes */
+         goto Slow;
+   }
+
+   pDecodedItem->uLabelType = uLabelType;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   if(uLabelType == QCBOR_TYPE_BYTE_STRING || uLabelType == QCBOR_TYPE_TEXT_STRING) {
+      pDecodedItem->label.string = LabelString;
+   } else
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   {
+      pDecodedItem->label.int64 = nLabel;
+   }
+#ifndef QCBOR_DISABLE_TAGS
+   memset(pDecodedItem->uTags, 0xff, sizeof(pDecodedItem->uTags));
+#endif /* ! QCBOR_DISABLE_TAGS */
+
+   *puErr = QCBORDecode_Private_NestAfterItem(pMe, NULL, pDecodedItem);
+   return true;
+
+Slow:
+   /* Errors from the head are found again by the full decode */
+   UsefulInputBuf_Seek(&(pMe->InBuf), uStart);
+   return false;
+}
+
+
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
@@ -2689,7 +3272,29 @@ QCBORError
 QCBORDecode_GetNext(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 {
    QCBORError uErr;
-   uErr =  QCBORDecode_Private_GetNextTagContent(pMe, pDecodedItem);
+
+   if(pMe->pPeekCache != NULL) {
+      if(QCBORDecode_Private_PeekCacheHit(pMe)) {
+         /* Commit the state after the peeked item */
+         pMe->InBuf    = pMe->pPeekCache->InBuf;
+         DecodeNesting_Restore(&(pMe->nesting), &(pMe->pPeekCache->Nesting));
+         *pDecodedItem = pMe->pPeekCache->Item;
+         pMe->pPeekCache->bValid = false;
+         return QCBOR_SUCCESS;
+      }
+      pMe->pPeekCache->bValid = false;
+   }
+
+   if(pMe->bStreaming) {
+      QCBORDecodeNestingSave SaveNesting;
+      const UsefulInputBuf   SaveInBuf = pMe->InBuf;
+
+      DecodeNesting_Save(&(pMe->nesting), &SaveNesting);
+      uErr = QCBORDecode_Private_GetNextTagContent(pMe, pDecodedItem);
+      uErr = QCBORDecode_Private_StreamingRollback(pMe, uErr, &SaveInBuf, &SaveNesting);
+   } else if(!QCBORDecode_Private_GetNextFast(pMe, pDecodedItem, &uErr)) {
+      uErr = QCBORDecode_Private_GetNextTagContent(pMe, pDecodedItem);
+   }
    if(uErr != QCBOR_SUCCESS) {
       pDecodedItem->uDataType  = QCBOR_TYPE_NONE;
       pDecodedItem->uLabelType = QCBOR_TYPE_NONE;
@@ -2704,18 +3309,59 @@ QCBORDecode_GetNext(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 QCBORError
 QCBORDecode_PeekNext(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 {
-   const QCBORDecodeNesting SaveNesting = pMe->nesting;
+   QCBORPeekCache *pCache = pMe->pPeekCache;
+
+   if(QCBORDecode_Private_PeekCacheHit(pMe)) {
+      *pDecodedItem = pCache->Item;
+      return QCBOR_SUCCESS;
+   }
+
+   QCBORDecodeNestingSave SaveNesting;
+   DecodeNesting_Save(&(pMe->nesting), &SaveNesting);
    const UsefulInputBuf Save = pMe->InBuf;
+   const size_t uSaveCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
+   const QCBORDecodeLevel SaveLevel = *DecodeNesting_Current(&(pMe->nesting));
+   const uint8_t uSaveLevelType = DecodeNesting_CurrentType(&(pMe->nesting));
 
    QCBORError uErr = QCBORDecode_GetNext(pMe, pDecodedItem);
 
-   pMe->nesting = SaveNesting;
+   /* Not cached if the levels after it are too many to keep */
+   if(pCache != NULL &&
+      uErr == QCBOR_SUCCESS &&
+      DecodeNesting_SaveFrom(&(pMe->nesting), SaveNesting.uFirst, false, &(pCache->Nesting))) {
+      pCache->Item            = *pDecodedItem;
+      pCache->InBuf           = pMe->InBuf;
+      pCache->pInput          = Save.UB.ptr;
+      pCache->uInputLen       = Save.UB.len;
+      pCache->uCursor         = uSaveCursor;
+      pCache->pLevels         = pMe->nesting.pLevels;
+      pCache->uCurrent        = SaveNesting.uCurrent;
+      pCache->uCurrentBounded = SaveNesting.uCurrentBounded;
+      pCache->Level           = SaveLevel;
+      pCache->uLevelType      = uSaveLevelType;
+      pCache->bValid          = true;
+   }
+
+   DecodeNesting_Restore(&(pMe->nesting), &SaveNesting);
    pMe->InBuf = Save;
 
    return uErr;
 }
 
 
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_SetPeekCache(QCBORDecodeContext *pMe, QCBORPeekCache *pCache)
+{
+   pMe->pPeekCache = pCache;
+   if(pCache != NULL) {
+      pCache->bValid = false;
+   }
+}
+
+
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
@@ -2760,6 +3406,144 @@ QCBORDecode_VGetNext(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 }
 
 
+/**
+ * @brief Decode an integer or definite-length string in an array directly.
+ *
+ * @param[in] pMe     The decode context.
+ * @param[out] pItem  The decoded item.
+ *
+ * @retval true   The item was decoded and the traversal cursor advanced.
+ * @retval false  Nothing was done; the item must be decoded the usual way.
+ *
+ * This is the fast path for QCBORDecode_GetNextLite(). It handles
+ * only items that can't change the nesting, that is ones at the top
+ * level or in a definite-length array that has more items after
+ * them. Any case that needs more than a head and a pointer to the
+ * string contents, including all errors, is left to the full decode
+ * stack so the result is always the same.
+ */
+static bool
+QCBORDecode_Private_GetNextLiteFast(QCBORDecodeContext *pMe, QCBORItemLite *pItem)
+{
+   const QCBORDecodeNesting *pNesting = &(pMe->nesting);
+   int                       nMajorType;
+   int                       nAdditionalInfo;
+   uint64_t                  uArgument;
+   size_t                    uStart;
+
+   if(pMe->bStreaming || pMe->bStringAllocateAll) {
+      return false;
+   }
+   if(!DecodeNesting_IsCurrentAtTop(pNesting) &&
+      (DecodeNesting_CurrentType(pNesting) != QCBOR_TYPE_ARRAY ||
+       !DecodeNesting_IsCurrentDefiniteLength(pNesting) ||
+       DecodeNesting_Current(pNesting)->ma.uCountCursor <= 1 ||
+       DecodeNesting_Current(pNesting)->ma.uCountCursor >= QCBOR_COUNT_INDICATES_ZERO_LENGTH)) {
+      return false;
+   }
+
+   uStart = UsefulInputBuf_Tell(&(pMe->InBuf));
+   if(QCBOR_Private_DecodeHead(&(pMe->InBuf), &nMajorType, &uArgument, &nAdditionalInfo) != QCBOR_SUCCESS) {
+      goto Slow;
+   }
+
+   switch(nMajorType) {
+      case CBOR_MAJOR_TYPE_POSITIVE_INT:
+         if(uArgument > INT64_MAX) {
+            goto Slow;
+         }
+         pItem->val.int64 = (int64_t)uArgument;
+         pItem->uDataType = QCBOR_TYPE_INT64;
+         break;
+
+      case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+         if(uArgument > INT64_MAX) {
+            goto Slow;
+         }
+         pItem->val.int64 = (-(int64_t)uArgument) - 1;
+         pItem->uDataType = QCBOR_TYPE_INT64;
+         break;
+
+      case CBOR_MAJOR_TYPE_BYTE_STRING:
+      case CBOR_MAJOR_TYPE_TEXT_STRING:
+         if(nAdditionalInfo == LEN_IS_INDEFINITE ||
+            uArgument > UsefulInputBuf_BytesUnconsumed(&(pMe->InBuf))) {
+            goto Slow;
+         }
+         /* Cast is safe because of check against bytes left */
+         pItem->val.string = UsefulInputBuf_GetUsefulBuf(&(pMe->InBuf), (size_t)uArgument);
+         pItem->uDataType  = nMajorType == CBOR_MAJOR_TYPE_BYTE_STRING ?
+                                QCBOR_TYPE_BYTE_STRING : QCBOR_TYPE_TEXT_STRING;
+         if(pItem->uDataType == QCBOR_TYPE_TEXT_STRING &&
+            pMe->bCheckUTF8 &&
+            UsefulBuf_IsValidUTF8(pItem->val.string) != SIZE_MAX) {
+            /* The general path sets the error */
+            goto Slow;
+         }
+         break;
+
+      default:
+         goto Slow;
+   }
+
+   pItem->uLabelType    = QCBOR_TYPE_NONE;
+   pItem->uNestingLevel = DecodeNesting_GetCurrentLevel(pNesting);
+   if(!DecodeNesting_IsCurrentAtTop(pNesting)) {
+      /* Can't reach zero because of check above so no ascending */
+      DecodeNesting_Current(&(pMe->nesting))->ma.uCountCursor--;
+   }
+   return true;
+
+Slow:
+   /* Only the cursor has moved. Errors from the head are found again
+    * by the full decode. */
+   UsefulInputBuf_Seek(&(pMe->InBuf), uStart);
+   return false;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+QCBORError
+QCBORDecode_GetNextLite(QCBORDecodeContext *pMe, QCBORItemLite *pItem)
+{
+   QCBORError uErr;
+   QCBORItem  Item;
+
+   if(QCBORDecode_Private_GetNextLiteFast(pMe, pItem)) {
+      return QCBOR_SUCCESS;
+   }
+
+   /* Tag content is not processed, so the item has the type of the
+    * content and fits in the lite item. */
+   if(pMe->bStreaming) {
+      QCBORDecodeNestingSave SaveNesting;
+      const UsefulInputBuf   SaveInBuf = pMe->InBuf;
+
+      DecodeNesting_Save(&(pMe->nesting), &SaveNesting);
+      uErr = QCBORDecode_Private_GetNextMapOrArray(pMe, NULL, &Item);
+      uErr = QCBORDecode_Private_StreamingRollback(pMe, uErr, &SaveInBuf, &SaveNesting);
+   } else {
+      uErr = QCBORDecode_Private_GetNextMapOrArray(pMe, NULL, &Item);
+   }
+   if(uErr != QCBOR_SUCCESS) {
+      pItem->uDataType  = QCBOR_TYPE_NONE;
+      pItem->uLabelType = QCBOR_TYPE_NONE;
+      return uErr;
+   }
+
+   pItem->uDataType     = Item.uDataType;
+   pItem->uLabelType    = Item.uLabelType;
+   pItem->uNestingLevel = Item.uNestingLevel;
+   /* The lite unions have a subset of the members of the full ones */
+   memcpy(&(pItem->val), &(Item.val), sizeof(pItem->val));
+   memcpy(&(pItem->label), &(Item.label), sizeof(pItem->label));
+
+   return QCBOR_SUCCESS;
+}
+
+
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
@@ -2882,203 +3666,416 @@ QCBORDecode_Finish(QCBORDecodeContext *pMe)
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
-uint64_t
-QCBORDecode_GetNthTag(QCBORDecodeContext *pMe,
-                      const QCBORItem    *pItem,
-                      uint32_t            uIndex)
+void
+QCBORDecode_EnableStreaming(QCBORDecodeContext *pMe)
 {
-#ifndef QCBOR_DISABLE_TAGS
-   if(pItem->uDataType == QCBOR_TYPE_NONE) {
-      return CBOR_TAG_INVALID64;
-   }
-   if(uIndex >= QCBOR_MAX_TAGS_PER_ITEM) {
-      return CBOR_TAG_INVALID64;
-   } else {
-      return QCBORDecode_Private_UnMapTagNumber(pMe, pItem->uTags[uIndex]);
+   pMe->bStreaming = true;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+size_t
+QCBORDecode_StreamingConsumed(QCBORDecodeContext *pMe)
+{
+   /* Bounded levels and byte-string wrapped CBOR record offsets in
+    * the input so nothing can be discarded while they are open. */
+   if(DecodeNesting_IsBounded(&(pMe->nesting))) {
+      return 0;
    }
-#else /* QCBOR_DISABLE_TAGS */
-   (void)pMe;
-   (void)pItem;
-   (void)uIndex;
 
-   return CBOR_TAG_INVALID64;
-#endif /* QCBOR_DISABLE_TAGS */
+   return UsefulInputBuf_Tell(&(pMe->InBuf));
 }
 
 
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
-uint64_t
-QCBORDecode_GetNthTagOfLast(const QCBORDecodeContext *pMe,
-                            uint32_t                  uIndex)
+void
+QCBORDecode_ContinueInput(QCBORDecodeContext *pMe,
+                          UsefulBufC          NewInput,
+                          bool                bDiscardConsumed)
 {
-#ifndef QCBOR_DISABLE_TAGS
+   size_t uCursor;
 
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return CBOR_TAG_INVALID64;
+   if(pMe->uLastError == QCBOR_ERR_NEED_MORE_INPUT) {
+      pMe->uLastError = QCBOR_SUCCESS;
    }
-   if(uIndex >= QCBOR_MAX_TAGS_PER_ITEM) {
-      return CBOR_TAG_INVALID64;
-   } else {
-      return QCBORDecode_Private_UnMapTagNumber(pMe, pMe->uLastTags[uIndex]);
+
+   if(NewInput.len > QCBOR_MAX_DECODE_INPUT_SIZE) {
+      pMe->uLastError = QCBOR_ERR_INPUT_TOO_LARGE;
+      return;
    }
-#else /* QCBOR_DISABLE_TAGS */
-   (void)pMe;
-   (void)uIndex;
 
-   return CBOR_TAG_INVALID64;
-#endif /* QCBOR_DISABLE_TAGS */
-}
+   uCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
+   if(bDiscardConsumed && QCBORDecode_StreamingConsumed(pMe) != 0) {
+      /* The new input starts at the cursor. Offsets in a container
+       * index no longer line up. */
+      uCursor                   = 0;
+      pMe->pContainerIndex      = NULL;
+      pMe->uContainerIndexCount = 0;
+      pMe->uMapEndOffsetCache   = QCBOR_MAP_OFFSET_CACHE_INVALID;
+   }
 
+   if(pMe->pPeekCache != NULL) {
+      pMe->pPeekCache->bValid = false;
+   }
 
+   /* String labels in the label index point into the old input */
+   pMe->uLabelIndexMap = QCBOR_NON_BOUNDED_OFFSET;
 
+   UsefulInputBuf_Init(&(pMe->InBuf), NewInput);
+   UsefulInputBuf_Seek(&(pMe->InBuf), uCursor);
+}
 
-#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
 
-/* ===========================================================================
-   MemPool -- BUILT-IN SIMPLE STRING ALLOCATOR
+/* Marks an indefinite-length level in QCBORScanLevels. Can't collide
+ * with a definite-length count because counts larger than the input
+ * are rejected. */
+#define QCBOR_SCAN_INDEFINITE UINT64_MAX
 
-   This implements a simple sting allocator for indefinite-length
-   strings that can be enabled by calling QCBORDecode_SetMemPool(). It
-   implements the function type QCBORStringAllocate and allows easy
-   use of it.
+/* Flags for each level in QCBORScanLevels */
+#define QCBOR_SCAN_IS_MAP      0x01
+#define QCBOR_SCAN_ODD         0x02
+#define QCBOR_SCAN_TAG_PENDING 0x04
+/* Only for the top level. It is a CBOR sequence that ends at the end
+ * of the input, so a break can't end it. */
+#define QCBOR_SCAN_SEQUENCE    0x08
 
-   This particular allocator is built-in for convenience. The caller
-   can implement their own.  All of this following code will get
-   dead-stripped if QCBORDecode_SetMemPool() is not called.
 
-   This is a very primitive memory allocator. It does not track
-   individual allocations, only a high-water mark. A free or
-   reallocation must be of the last chunk allocated.
+/*
+ * The maps and arrays being scanned by QCBOR_Private_Scan(),
+ * QCBORDecode_Walk() and QCBORDecode_CheckDeterministic(). These
+ * don't use QCBORDecodeNesting. Instead, each keeps a count of the
+ * items remaining at each level with the functions here. They share
+ * this rather than one loop so that fast skip and the container
+ * index, which use QCBOR_Private_Scan(), don't test for callbacks or
+ * label checks on every item.
+ */
+typedef struct {
+   int      nLevel;
+   /* Items remaining at each level or QCBOR_SCAN_INDEFINITE. For
+    * maps it is labels plus values. */
+   uint64_t puRemaining[QCBOR_MAX_ARRAY_NESTING + 1];
+   uint8_t  puFlags[QCBOR_MAX_ARRAY_NESTING + 1];
+} QCBORScanLevels;
 
-   The size of the pool and offset to free memory are packed into the
-   first 8 bytes of the memory pool so we don't have to keep them in
-   the decode context. Since the address of the pool may not be
-   aligned, they have to be packed and unpacked as if they were
-   serialized data of the wire or such.
 
-   The sizes packed in are uint32_t to be the same on all CPU types
-   and simplify the code.
-   ========================================================================== */
+static inline void
+ScanLevels_Init(QCBORScanLevels *pLevels,
+                const uint64_t   uTopCount,
+                const uint8_t    uTopFlags)
+{
+   pLevels->nLevel         = 0;
+   pLevels->puRemaining[0] = uTopCount;
+   pLevels->puFlags[0]     = uTopFlags;
+}
 
 
-static int
-MemPool_Unpack(const void *pMem, uint32_t *puPoolSize, uint32_t *puFreeOffset)
+/* Enter a map or array of uCount items or QCBOR_SCAN_INDEFINITE. The
+ * count is not 0 and has been checked against the bytes left so it
+ * can be doubled for a map. */
+static inline QCBORError
+ScanLevels_Enter(QCBORScanLevels *pLevels,
+                 const int        nMaxLevel,
+                 const int        nClass,
+                 uint64_t         uCount)
 {
-   // Use of UsefulInputBuf is overkill, but it is convenient.
-   UsefulInputBuf UIB;
+   if(pLevels->nLevel >= nMaxLevel) {
+      return QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP;
+   }
+   if(nClass == CBOR_MAJOR_TYPE_MAP && uCount != QCBOR_SCAN_INDEFINITE) {
+      uCount *= 2;
+   }
+   pLevels->nLevel++;
+   pLevels->puRemaining[pLevels->nLevel] = uCount;
+   pLevels->puFlags[pLevels->nLevel]     = nClass == CBOR_MAJOR_TYPE_MAP ? QCBOR_SCAN_IS_MAP : 0;
 
-   // Just assume the size here. It was checked during SetUp so
-   // the assumption is safe.
-   UsefulInputBuf_Init(&UIB, (UsefulBufC){pMem,QCBOR_DECODE_MIN_MEM_POOL_SIZE});
-   *puPoolSize     = UsefulInputBuf_GetUint32(&UIB);
-   *puFreeOffset   = UsefulInputBuf_GetUint32(&UIB);
-   return UsefulInputBuf_GetError(&UIB);
+   return QCBOR_SUCCESS;
 }
 
 
-static int
-MemPool_Pack(UsefulBuf Pool, uint32_t uFreeOffset)
+/* A tag number must be followed by its content */
+static inline void
+ScanLevels_TagNumber(QCBORScanLevels *pLevels)
 {
-   // Use of UsefulOutBuf is overkill, but convenient. The
-   // length check performed here is useful.
-   UsefulOutBuf UOB;
-
-   UsefulOutBuf_Init(&UOB, Pool);
-   UsefulOutBuf_AppendUint32(&UOB, (uint32_t)Pool.len); // size of pool
-   UsefulOutBuf_AppendUint32(&UOB, uFreeOffset); // first free position
-   return UsefulOutBuf_GetError(&UOB);
+   pLevels->puFlags[pLevels->nLevel] |= QCBOR_SCAN_TAG_PENDING;
 }
 
 
-/*
- Internal function for an allocation, reallocation free and destuct.
+/* Check a break ends an indefinite-length map or array. The caller
+ * closes it by decrementing nLevel. */
+static inline QCBORError
+ScanLevels_CheckBreak(const QCBORScanLevels *pLevels)
+{
+   if(pLevels->puRemaining[pLevels->nLevel] != QCBOR_SCAN_INDEFINITE ||
+      (pLevels->puFlags[pLevels->nLevel] & (QCBOR_SCAN_ODD | QCBOR_SCAN_TAG_PENDING | QCBOR_SCAN_SEQUENCE))) {
+      /* Not in an indefinite-length array or map, or in the middle
+       * of a map entry or tag. */
+      return QCBOR_ERR_BAD_BREAK;
+   }
+   return QCBOR_SUCCESS;
+}
 
- Having only one function rather than one each per mode saves space in
- QCBORDecodeContext.
 
- Code Reviewers: THIS FUNCTION DOES POINTER MATH
- */
-static UsefulBuf
-MemPool_Function(void *pPool, void *pMem, size_t uNewSize)
+/* Count a complete item at the current level. Returns true if this
+ * completes a definite-length map or array other than the top level.
+ * The caller closes it by decrementing nLevel and then counts it as
+ * an item in the level above. */
+static inline bool
+ScanLevels_CountItem(QCBORScanLevels *pLevels)
 {
-   UsefulBuf ReturnValue = NULLUsefulBuf;
-
-   uint32_t uPoolSize;
-   uint32_t uFreeOffset;
+   const int nLevel = pLevels->nLevel;
 
-   if(uNewSize > UINT32_MAX) {
-      // This allocator is only good up to 4GB.  This check should
-      // optimize out if sizeof(size_t) == sizeof(uint32_t)
-      goto Done;
+   pLevels->puFlags[nLevel] &= (uint8_t)~QCBOR_SCAN_TAG_PENDING;
+   if(pLevels->puRemaining[nLevel] == QCBOR_SCAN_INDEFINITE) {
+      if(pLevels->puFlags[nLevel] & QCBOR_SCAN_IS_MAP) {
+         /* Track label vs value so a break after a label is caught */
+         pLevels->puFlags[nLevel] ^= QCBOR_SCAN_ODD;
+      }
+      return false;
    }
-   const uint32_t uNewSize32 = (uint32_t)uNewSize;
+   pLevels->puRemaining[nLevel]--;
+   return pLevels->puRemaining[nLevel] == 0 && nLevel != 0;
+}
 
-   if(MemPool_Unpack(pPool, &uPoolSize, &uFreeOffset)) {
-      goto Done;
-   }
 
-   if(uNewSize) {
-      if(pMem) {
-         // REALLOCATION MODE
-         // Calculate pointer to the end of the memory pool.  It is
-         // assumed that pPool + uPoolSize won't wrap around by
-         // assuming the caller won't pass a pool buffer in that is
-         // not in legitimate memory space.
-         const void *pPoolEnd = (uint8_t *)pPool + uPoolSize;
+/**
+ * @brief Check well-formedness of data items without decoding them.
+ *
+ * @param[in] pInBuf         Input positioned at the first item to check.
+ * @param[in] uTopCount      Number of items to check or @ref
+ *                           QCBOR_SCAN_INDEFINITE to stop at a break.
+ * @param[in] uTopFlags      @ref QCBOR_SCAN_IS_MAP if the items are the
+ *                           contents of a map.
+ * @param[in] nMaxLevel      How many levels of maps and arrays are allowed.
+ * @param[out] pIndex        Where to record maps and arrays or @c NULL.
+ * @param[in] uIndexSize     Number of entries in @c pIndex.
+ * @param[in,out] puIndexCount  Number of maps and arrays seen so far.
+ * @param[out] puErrorOffset  Offset of the head where an error was found.
+ *
+ * @returns QCBOR_SUCCESS or a not-well-formed error.
+ *
+ * This is the single pass used by QCBORDecode_ValidateWellFormed(),
+ * QCBORDecode_BuildContainerIndex() and the fast skip in
+ * QCBORDecode_Private_ConsumeItem(). It doesn't use
+ * QCBORDecodeNesting or create any QCBORItem. Instead it keeps a
+ * count of the items remaining at each level in @ref
+ * QCBORScanLevels, so @c nMaxLevel can be no more than @ref
+ * QCBOR_MAX_ARRAY_NESTING. Entries are recorded in @c pIndex only
+ * while @c *puIndexCount is less than @c uIndexSize, but the count
+ * is always incremented.
+ *
+ * The top level is either one whole data item or the contents of a
+ * map or array whose head has already been decoded. In the latter
+ * case, the break that ends an indefinite-length map or array is
+ * consumed.
+ */
+static QCBORError
+QCBOR_Private_Scan(UsefulInputBuf           *pInBuf,
+                   const uint64_t            uTopCount,
+                   const uint8_t             uTopFlags,
+                   const int                 nMaxLevel,
+                   QCBORContainerIndexEntry *pIndex,
+                   const size_t              uIndexSize,
+                   size_t                   *puIndexCount,
+                   size_t                   *puErrorOffset)
+{
+   QCBORError      uErr;
+   int             nClass;
+   int             nChunkClass;
+   int             nAdditionalInfo;
+   uint64_t        uArgument;
+   size_t          uItemStart;
+   size_t          uEntry;
+   QCBORScanLevels Levels;
+   /* Index entry for each level, if it is being recorded */
+   size_t          puEntry[QCBOR_MAX_ARRAY_NESTING + 1];
+
+   ScanLevels_Init(&Levels, uTopCount, uTopFlags);
+   puEntry[0] = SIZE_MAX;
+   uItemStart = UsefulInputBuf_Tell(pInBuf);
+
+   while(Levels.puRemaining[0] != 0) {
+      uItemStart = UsefulInputBuf_Tell(pInBuf);
+      uErr = QCBOR_Private_DecodeHead(pInBuf, &nClass, &uArgument, &nAdditionalInfo);
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
 
-         // Check that the pointer for reallocation is in the range of the
-         // pool. This also makes sure that pointer math further down
-         // doesn't wrap under or over.
-         if(pMem >= pPool && pMem < pPoolEnd) {
-            // Offset to start of chunk for reallocation. This won't
-            // wrap under because of check that pMem >= pPool.  Cast
-            // is safe because the pool is always less than UINT32_MAX
-            // because of check in QCBORDecode_SetMemPool().
-            const uint32_t uMemOffset = (uint32_t)((uint8_t *)pMem - (uint8_t *)pPool);
+      switch(nClass) {
+         case CBOR_MAJOR_TYPE_POSITIVE_INT:
+         case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+            break;
 
-            // Check to see if the allocation will fit. uPoolSize -
-            // uMemOffset will not wrap under because of check that
-            // pMem is in the range of the uPoolSize by check above.
-            if(uNewSize <= uPoolSize - uMemOffset) {
-               ReturnValue.ptr = pMem;
-               ReturnValue.len = uNewSize;
+         case CBOR_MAJOR_TYPE_BYTE_STRING:
+         case CBOR_MAJOR_TYPE_TEXT_STRING:
+            if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+               /* Chunks must be definite-length strings of the same
+                * major type. The loop ends at the break. */
+               while(1) {
+                  uItemStart = UsefulInputBuf_Tell(pInBuf);
+                  uErr = QCBOR_Private_DecodeHead(pInBuf,
+                                                  &nChunkClass,
+                                                  &uArgument,
+                                                  &nAdditionalInfo);
+                  if(uErr != QCBOR_SUCCESS) {
+                     goto Done;
+                  }
+                  if(nChunkClass == CBOR_MAJOR_TYPE_SIMPLE &&
+                     nAdditionalInfo == LEN_IS_INDEFINITE) {
+                     break;
+                  }
+                  if(nChunkClass == QCBOR_HEAD_CLASS_RESERVED) {
+                     uErr = QCBOR_ERR_UNSUPPORTED;
+                     goto Done;
+                  }
+                  if(nChunkClass != nClass || nAdditionalInfo == LEN_IS_INDEFINITE) {
+                     uErr = QCBOR_ERR_INDEFINITE_STRING_CHUNK;
+                     goto Done;
+                  }
+                  if(uArgument > UsefulInputBuf_BytesUnconsumed(pInBuf)) {
+                     uErr = QCBOR_ERR_HIT_END;
+                     goto Done;
+                  }
+                  UsefulInputBuf_Seek(pInBuf, UsefulInputBuf_Tell(pInBuf) + (size_t)uArgument);
+               }
+            } else {
+               if(uArgument > UsefulInputBuf_BytesUnconsumed(pInBuf)) {
+                  uErr = QCBOR_ERR_HIT_END;
+                  goto Done;
+               }
+               /* Cast is safe because of check against bytes left */
+               UsefulInputBuf_Seek(pInBuf, UsefulInputBuf_Tell(pInBuf) + (size_t)uArgument);
+            }
+            break;
 
-               // Addition won't wrap around over because uNewSize was
-               // checked to be sure it is less than the pool size.
-               uFreeOffset = uMemOffset + uNewSize32;
+         case CBOR_MAJOR_TYPE_ARRAY:
+         case CBOR_MAJOR_TYPE_MAP:
+            uEntry = *puIndexCount;
+            (*puIndexCount)++;
+            if(uEntry < uIndexSize) {
+               /* Casts are safe because QCBORDecode_BuildContainerIndex()
+                * checks the input size. The end offset and count of
+                * non-empty maps and arrays are filled in when they
+                * close. */
+               pIndex[uEntry].uContentOffset = (QCBOROffset)UsefulInputBuf_Tell(pInBuf);
+               pIndex[uEntry].uEndOffset     = pIndex[uEntry].uContentOffset;
+               pIndex[uEntry].uCount         = 0;
             }
+
+            if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+               uArgument = QCBOR_SCAN_INDEFINITE;
+            } else {
+               /* Every item is at least one byte. Checking this here
+                * keeps uArgument from being QCBOR_SCAN_INDEFINITE and
+                * from overflowing when doubled for a map. */
+               if(uArgument > UsefulInputBuf_BytesUnconsumed(pInBuf)) {
+                  uErr = QCBOR_ERR_HIT_END;
+                  goto Done;
+               }
+               if(uEntry < uIndexSize) {
+                  /* Too many to decode is QCBOR_COUNT_MAX */
+                  pIndex[uEntry].uCount = uArgument > QCBOR_COUNT_MAX ?
+                                             QCBOR_COUNT_MAX : (QCBORCount)uArgument;
+               }
+               if(uArgument == 0) {
+                  /* An empty map or array is a complete item */
+                  break;
+               }
+            }
+            uErr = ScanLevels_Enter(&Levels, nMaxLevel, nClass, uArgument);
+            if(uErr != QCBOR_SUCCESS) {
+               goto Done;
+            }
+            puEntry[Levels.nLevel] = uEntry;
+            continue;
+
+         case CBOR_MAJOR_TYPE_TAG:
+            if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+               /* Only possible with QCBOR_DISABLE_TAGS */
+               uErr = QCBOR_ERR_BAD_INT;
+               goto Done;
+            }
+            ScanLevels_TagNumber(&Levels);
+            continue;
+
+         case CBOR_MAJOR_TYPE_SIMPLE:
+            if(nAdditionalInfo == CBOR_SIMPLE_BREAK) {
+               uErr = ScanLevels_CheckBreak(&Levels);
+               if(uErr != QCBOR_SUCCESS || Levels.nLevel == 0) {
+                  /* At level 0 it is the end of the map or array
+                   * contents being scanned */
+                  goto Done;
+               }
+               /* The array or map is closed and counts as an item in
+                * the level above. */
+               if(puEntry[Levels.nLevel] < uIndexSize) {
+                  pIndex[puEntry[Levels.nLevel]].uEndOffset = (QCBOROffset)UsefulInputBuf_Tell(pInBuf);
+               }
+               Levels.nLevel--;
+            } else if(nAdditionalInfo == CBOR_SIMPLEV_ONEBYTE &&
+                      uArgument <= CBOR_SIMPLE_BREAK) {
+               uErr = QCBOR_ERR_BAD_TYPE_7;
+               goto Done;
+            }
+            break;
+
+         case QCBOR_HEAD_CLASS_BAD_INT:
+            uErr = QCBOR_ERR_BAD_INT;
+            goto Done;
+
+         default:
+            /* QCBOR_HEAD_CLASS_RESERVED */
+            uErr = QCBOR_ERR_UNSUPPORTED;
+            goto Done;
+      }
+
+      /* An item is complete. Count it at its level and close out all
+       * the definite-length arrays and maps that it completes. */
+      while(ScanLevels_CountItem(&Levels)) {
+         if(puEntry[Levels.nLevel] < uIndexSize) {
+            pIndex[puEntry[Levels.nLevel]].uEndOffset = (QCBOROffset)UsefulInputBuf_Tell(pInBuf);
          }
-      } else {
-         // ALLOCATION MODE
-         // uPoolSize - uFreeOffset will not underflow because this
-         // pool implementation makes sure uFreeOffset is always
-         // smaller than uPoolSize through this check here and
-         // reallocation case.
-         if(uNewSize <= uPoolSize - uFreeOffset) {
-            ReturnValue.len = uNewSize;
-            ReturnValue.ptr = (uint8_t *)pPool + uFreeOffset;
-            uFreeOffset    += (uint32_t)uNewSize;
-         }
+         Levels.nLevel--;
       }
-   } else {
-      if(pMem) {
-         // FREE MODE
-         // Cast is safe because of limit on pool size in
-         // QCBORDecode_SetMemPool()
-         uFreeOffset = (uint32_t)((uint8_t *)pMem - (uint8_t *)pPool);
-      } else {
-         // DESTRUCT MODE
-         // Nothing to do for this allocator
+      /* The index count of definite-length ones is from the head */
+      if(puEntry[Levels.nLevel] < uIndexSize &&
+         Levels.puRemaining[Levels.nLevel] == QCBOR_SCAN_INDEFINITE &&
+         !(Levels.puFlags[Levels.nLevel] & QCBOR_SCAN_ODD) &&
+         pIndex[puEntry[Levels.nLevel]].uCount != QCBOR_COUNT_MAX) {
+         pIndex[puEntry[Levels.nLevel]].uCount++;
       }
    }
 
-   UsefulBuf Pool = {pPool, uPoolSize};
-   MemPool_Pack(Pool, uFreeOffset);
+   uErr = QCBOR_SUCCESS;
 
 Done:
-   return ReturnValue;
+   if(uErr == QCBOR_ERR_HIT_END) {
+      uItemStart = UsefulInputBuf_GetBufferLength(pInBuf);
+   }
+   *puErrorOffset = uItemStart;
+   return uErr;
+}
+
+
+/* Check one whole data item; see QCBOR_Private_Scan() */
+static QCBORError
+QCBOR_Private_ScanItem(UsefulInputBuf           *pInBuf,
+                       QCBORContainerIndexEntry *pIndex,
+                       const size_t              uIndexSize,
+                       size_t                   *puIndexCount,
+                       size_t                   *puErrorOffset)
+{
+   return QCBOR_Private_Scan(pInBuf,
+                             1,
+                             0,
+                             QCBOR_MAX_ARRAY_NESTING,
+                             pIndex,
+                             uIndexSize,
+                             puIndexCount,
+                             puErrorOffset);
 }
 
 
@@ -3086,462 +4083,684 @@ Done:
  * Public function, see header qcbor/qcbor_decode.h file
  */
 QCBORError
-QCBORDecode_SetMemPool(QCBORDecodeContext *pMe,
-                       UsefulBuf           Pool,
-                       bool                bAllStrings)
+QCBORDecode_ValidateWellFormed(UsefulBufC EncodedCBOR, size_t *puErrorOffset)
 {
-   // The pool size and free mem offset are packed into the beginning
-   // of the pool memory. This compile time check makes sure the
-   // constant in the header is correct.  This check should optimize
-   // down to nothing.
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable:4127) // conditional expression is constant
-#endif
-   if(QCBOR_DECODE_MIN_MEM_POOL_SIZE < 2 * sizeof(uint32_t)) {
-      return QCBOR_ERR_MEM_POOL_SIZE;
-   }
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
+   UsefulInputBuf InBuf;
+   QCBORError     uErr;
+   size_t         uOffset;
+   size_t         uIndexCount;
 
-   // The pool size and free offset packed in to the beginning of pool
-   // memory are only 32-bits. This check will optimize out on 32-bit
-   // machines.
-   if(Pool.len > UINT32_MAX) {
-      return QCBOR_ERR_MEM_POOL_SIZE;
-   }
+   UsefulInputBuf_Init(&InBuf, EncodedCBOR);
+   uIndexCount = 0;
 
-   // This checks that the pool buffer given is big enough.
-   if(MemPool_Pack(Pool, QCBOR_DECODE_MIN_MEM_POOL_SIZE)) {
-      return QCBOR_ERR_MEM_POOL_SIZE;
+   uErr = QCBOR_Private_ScanItem(&InBuf, NULL, 0, &uIndexCount, &uOffset);
+   if(uErr == QCBOR_SUCCESS) {
+      uOffset = UsefulInputBuf_Tell(&InBuf);
+      if(UsefulInputBuf_BytesUnconsumed(&InBuf) != 0) {
+         uErr = QCBOR_ERR_EXTRA_BYTES;
+      }
    }
 
-   QCBORDecode_SetUpAllocator(pMe, MemPool_Function, Pool.ptr, bAllStrings);
-
-   return QCBOR_SUCCESS;
+   if(puErrorOffset != NULL) {
+      *puErrorOffset = uOffset;
+   }
+   return uErr;
 }
-#endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
-
-
 
 
 /**
- * @brief Consume an entire map or array including its contents.
+ * @brief Check a float is in the shortest form that keeps its value.
  *
- * @param[in]  pMe              The decoder context.
- * @param[in]  pItemToConsume   The array/map whose contents are to be
- *                              consumed.
- * @param[out] pbBreak          Set to true if extra break was consumed.
- *                              Can be NULL.
- * @param[out] puNextNestLevel  The next nesting level after the item was
- *                              fully consumed.
+ * @param[in] nAdditionalInfo  HALF_PREC_FLOAT, SINGLE_PREC_FLOAT or
+ *                             DOUBLE_PREC_FLOAT.
+ * @param[in] uArgument        The bits of the value.
  *
- * This may be called when @c pItemToConsume is not an array or
- * map. In that case, this is just a pass through for @c puNextNestLevel
- * since there is nothing to do.
+ * @retval QCBOR_ERR_NOT_PREFERRED  A smaller float holds the same value.
+ *
+ * This is for QCBORDecode_CheckDeterministic(). It uses the same
+ * reduction as the encoder's preferred serialization.
  */
 static QCBORError
-QCBORDecode_Private_ConsumeItem(QCBORDecodeContext *pMe,
-                                const QCBORItem    *pItemToConsume,
-                                bool               *pbBreak,
-                                uint8_t            *puNextNestLevel)
+QCBOR_Private_CheckPreferredFloat(const int nAdditionalInfo, const uint64_t uArgument)
 {
-   QCBORError uReturn;
-   QCBORItem  Item;
-
-   /* If it is a map or array, this will tell if it is empty. */
-   const bool bIsEmpty = (pItemToConsume->uNextNestLevel <= pItemToConsume->uNestingLevel);
-
-   if(QCBORItem_IsMapOrArray(*pItemToConsume) && !bIsEmpty) {
-      /* There is only real work to do for non-empty maps and arrays */
+#if !defined(QCBOR_DISABLE_PREFERRED_FLOAT) && !defined(USEFULBUF_DISABLE_ALL_FLOAT)
+   IEEE754_union Smaller;
 
-      /* This works for definite- and indefinite-length maps and
-       * arrays by using the nesting level
-       */
-      do {
-         uReturn = QCBORDecode_Private_GetNextMapOrArray(pMe, pbBreak, &Item);
-         if(QCBORDecode_IsUnrecoverableError(uReturn) ||
-            uReturn == QCBOR_ERR_NO_MORE_ITEMS) {
-            goto Done;
+   switch(nAdditionalInfo) {
+      case SINGLE_PREC_FLOAT:
+         Smaller = IEEE754_SingleToHalf(UsefulBufUtil_CopyUint32ToFloat((uint32_t)uArgument));
+         if(Smaller.uSize == IEEE754_UNION_IS_HALF) {
+            return QCBOR_ERR_NOT_PREFERRED;
          }
-      } while(Item.uNextNestLevel >= pItemToConsume->uNextNestLevel);
-
-      *puNextNestLevel = Item.uNextNestLevel;
-
-      uReturn = QCBOR_SUCCESS;
+         break;
 
-   } else {
-      /* pItemToConsume is not a map or array. Just pass the nesting
-       * level through. */
-      *puNextNestLevel = pItemToConsume->uNextNestLevel;
+      case DOUBLE_PREC_FLOAT:
+         Smaller = IEEE754_DoubleToSmaller(UsefulBufUtil_CopyUint64ToDouble(uArgument), true);
+         if(Smaller.uSize != IEEE754_UNION_IS_DOUBLE) {
+            return QCBOR_ERR_NOT_PREFERRED;
+         }
+         break;
 
-      uReturn = QCBOR_SUCCESS;
+      default: /* HALF_PREC_FLOAT is always the shortest */
+         break;
    }
+   return QCBOR_SUCCESS;
 
-Done:
-    return uReturn;
+#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT && ! USEFULBUF_DISABLE_ALL_FLOAT */
+   /* Can't check without the float reduction */
+   (void)nAdditionalInfo;
+   (void)uArgument;
+   return FLOAT_ERR_CODE_NO_HALF_PREC(QCBOR_SUCCESS);
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT && ! USEFULBUF_DISABLE_ALL_FLOAT */
 }
 
 
 /*
  * Public function, see header qcbor/qcbor_decode.h file
+ *
+ * Indefinite lengths are errors here, so every level has a count and
+ * it is odd in a map when the next item is a value.
  */
-void
-QCBORDecode_VGetNextConsume(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
-{
-   QCBORDecode_VGetNext(pMe, pDecodedItem);
-
-   if(pMe->uLastError == QCBOR_SUCCESS) {
-      pMe->uLastError = (uint8_t)QCBORDecode_Private_ConsumeItem(pMe, pDecodedItem, NULL,
-         &pDecodedItem->uNextNestLevel);
-   }
-}
+QCBORError
+QCBORDecode_CheckDeterministic(UsefulBufC EncodedCBOR, size_t *puErrorOffset)
+{
+   UsefulInputBuf  InBuf;
+   QCBORError      uErr;
+   int             nClass;
+   int             nAdditionalInfo;
+   uint64_t        uArgument;
+   size_t          uItemStart;
+   size_t          uKeyLen;
+   size_t          uPrevLen;
+   int             nCompare;
+   int             nLevel;
+   bool            bClosed;
+   QCBORScanLevels Levels;
+   /* Where the current label and the one before it start in maps */
+   size_t          puKeyStart[QCBOR_MAX_ARRAY_NESTING + 1];
+   size_t          puPrevKeyStart[QCBOR_MAX_ARRAY_NESTING + 1];
+   size_t          puPrevKeyEnd[QCBOR_MAX_ARRAY_NESTING + 1];
+
+   UsefulInputBuf_Init(&InBuf, EncodedCBOR);
+   ScanLevels_Init(&Levels, 1, 0);
+   uItemStart = 0;
+
+   while(Levels.puRemaining[0] != 0) {
+      uItemStart = UsefulInputBuf_Tell(&InBuf);
+      nLevel     = Levels.nLevel;
+      if((Levels.puFlags[nLevel] & (QCBOR_SCAN_IS_MAP | QCBOR_SCAN_TAG_PENDING)) == QCBOR_SCAN_IS_MAP &&
+         Levels.puRemaining[nLevel] % 2 == 0) {
+         /* First head of a label, possibly a tag number */
+         puKeyStart[nLevel] = uItemStart;
+      }
 
+      uErr = QCBOR_Private_DecodeHead(&InBuf, &nClass, &uArgument, &nAdditionalInfo);
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-QCBORError
-QCBORDecode_EndCheck(QCBORDecodeContext *pMe)
-{
-   size_t     uCursorOffset;
-   QCBORError uErr;
+      if(nClass < CBOR_MAJOR_TYPE_SIMPLE) {
+         if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+            uErr = QCBOR_ERR_INDEFINITE_NOT_ALLOWED;
+            goto Done;
+         }
+         if((nAdditionalInfo == LEN_IS_ONE_BYTE    && uArgument < 24) ||
+            (nAdditionalInfo == LEN_IS_TWO_BYTES   && uArgument <= UINT8_MAX) ||
+            (nAdditionalInfo == LEN_IS_FOUR_BYTES  && uArgument <= UINT16_MAX) ||
+            (nAdditionalInfo == LEN_IS_EIGHT_BYTES && uArgument <= UINT32_MAX)) {
+            uErr = QCBOR_ERR_NOT_PREFERRED;
+            goto Done;
+         }
+      }
 
-   uErr = QCBORDecode_GetError(pMe);
-   if(uErr != QCBOR_SUCCESS) {
-      return uErr;
-   }
+      switch(nClass) {
+         case CBOR_MAJOR_TYPE_POSITIVE_INT:
+         case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+            break;
 
-   uCursorOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
+         case CBOR_MAJOR_TYPE_BYTE_STRING:
+         case CBOR_MAJOR_TYPE_TEXT_STRING:
+            if(uArgument > UsefulInputBuf_BytesUnconsumed(&InBuf)) {
+               uErr = QCBOR_ERR_HIT_END;
+               goto Done;
+            }
+            /* Cast is safe because of check against bytes left */
+            UsefulInputBuf_Seek(&InBuf, UsefulInputBuf_Tell(&InBuf) + (size_t)uArgument);
+            break;
 
-   if(uCursorOffset == UsefulInputBuf_GetBufferLength(&(pMe->InBuf))) {
-      return QCBOR_ERR_NO_MORE_ITEMS;
-   }
+         case CBOR_MAJOR_TYPE_ARRAY:
+         case CBOR_MAJOR_TYPE_MAP:
+            /* Every item is at least one byte. Checking this keeps
+             * the count from overflowing when doubled for a map. */
+            if(uArgument > UsefulInputBuf_BytesUnconsumed(&InBuf)) {
+               uErr = QCBOR_ERR_HIT_END;
+               goto Done;
+            }
+            if(uArgument == 0) {
+               /* An empty map or array is a complete item */
+               break;
+            }
+            uErr = ScanLevels_Enter(&Levels, QCBOR_MAX_ARRAY_NESTING, nClass, uArgument);
+            if(uErr != QCBOR_SUCCESS) {
+               goto Done;
+            }
+            puPrevKeyStart[Levels.nLevel] = SIZE_MAX;
+            continue;
 
-   return QCBOR_SUCCESS;
-}
+         case CBOR_MAJOR_TYPE_TAG:
+            ScanLevels_TagNumber(&Levels);
+            continue;
 
+         case CBOR_MAJOR_TYPE_SIMPLE:
+            if(nAdditionalInfo == CBOR_SIMPLE_BREAK) {
+               /* There are no indefinite-length maps or arrays to end */
+               uErr = QCBOR_ERR_BAD_BREAK;
+               goto Done;
+            }
+            if(nAdditionalInfo == CBOR_SIMPLEV_ONEBYTE && uArgument <= CBOR_SIMPLE_BREAK) {
+               uErr = QCBOR_ERR_BAD_TYPE_7;
+               goto Done;
+            }
+            if(nAdditionalInfo >= HALF_PREC_FLOAT) {
+               uErr = QCBOR_Private_CheckPreferredFloat(nAdditionalInfo, uArgument);
+               if(uErr != QCBOR_SUCCESS) {
+                  goto Done;
+               }
+            }
+            break;
 
-/**
- * @brief Rewind cursor to start as if map or array were just entered.
- *
- * @param[in]  pMe   The decoding context
- *
- * This affects the nesting tracking and the UsefulInputBuf.
- */
-static void
-QCBORDecode_Private_RewindMapOrArray(QCBORDecodeContext *pMe)
-{
-   /* Reset nesting tracking to the deepest bounded level */
-   DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
+         case QCBOR_HEAD_CLASS_BAD_INT:
+            uErr = QCBOR_ERR_BAD_INT;
+            goto Done;
 
-   DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
+         default:
+            /* QCBOR_HEAD_CLASS_RESERVED */
+            uErr = QCBOR_ERR_UNSUPPORTED;
+            goto Done;
+      }
 
-   /* Reposition traversal cursor to the start of the map/array */
-   UsefulInputBuf_Seek(&(pMe->InBuf),
-                       DecodeNesting_GetMapOrArrayStart(&(pMe->nesting)));
+      /* An item is complete. Count it at its level and close out all
+       * the maps and arrays that it completes. A completed label is
+       * compared to the previous one in the map. */
+      while(1) {
+         bClosed = ScanLevels_CountItem(&Levels);
+         nLevel  = Levels.nLevel;
+         if((Levels.puFlags[nLevel] & QCBOR_SCAN_IS_MAP) && Levels.puRemaining[nLevel] % 2 == 1) {
+            uKeyLen = UsefulInputBuf_Tell(&InBuf) - puKeyStart[nLevel];
+            if(puPrevKeyStart[nLevel] != SIZE_MAX) {
+               /* Bytewise lexicographic order of the encoded labels */
+               uPrevLen = puPrevKeyEnd[nLevel] - puPrevKeyStart[nLevel];
+               nCompare = memcmp((const uint8_t *)EncodedCBOR.ptr + puPrevKeyStart[nLevel],
+                                 (const uint8_t *)EncodedCBOR.ptr + puKeyStart[nLevel],
+                                 uPrevLen < uKeyLen ? uPrevLen : uKeyLen);
+               if(nCompare == 0 && uPrevLen == uKeyLen) {
+                  uItemStart = puKeyStart[nLevel];
+                  uErr = QCBOR_ERR_DUPLICATE_LABEL;
+                  goto Done;
+               }
+               if(nCompare > 0 || (nCompare == 0 && uPrevLen > uKeyLen)) {
+                  uItemStart = puKeyStart[nLevel];
+                  uErr = QCBOR_ERR_UNSORTED;
+                  goto Done;
+               }
+            }
+            puPrevKeyStart[nLevel] = puKeyStart[nLevel];
+            puPrevKeyEnd[nLevel]   = puKeyStart[nLevel] + uKeyLen;
+         }
+         if(!bClosed) {
+            break;
+         }
+         Levels.nLevel--;
+      }
+   }
+
+   uItemStart = UsefulInputBuf_Tell(&InBuf);
+   uErr = QCBOR_SUCCESS;
+   if(UsefulInputBuf_BytesUnconsumed(&InBuf) != 0) {
+      uErr = QCBOR_ERR_EXTRA_BYTES;
+   }
+
+Done:
+   if(uErr == QCBOR_ERR_HIT_END) {
+      uItemStart = EncodedCBOR.len;
+   }
+   if(puErrorOffset != NULL) {
+      *puErrorOffset = uItemStart;
+   }
+   return uErr;
 }
 
 
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
-void
-QCBORDecode_Rewind(QCBORDecodeContext *pMe)
+QCBORError
+QCBORDecode_GetNextSequenceItem(UsefulBufC  Sequence,
+                                size_t     *puOffset,
+                                UsefulBufC *pItem)
 {
-   if(pMe->nesting.pCurrentBounded != NULL) {
-      /* In a bounded map, array or bstr-wrapped CBOR */
+   UsefulInputBuf InBuf;
+   QCBORError     uErr;
+   size_t         uIndexCount;
+   size_t         uErrorOffset;
 
-      if(DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_BYTE_STRING)) {
-         /* In bstr-wrapped CBOR. */
-
-         /* Reposition traversal cursor to start of wrapping byte string */
-         UsefulInputBuf_Seek(&(pMe->InBuf),
-                             pMe->nesting.pCurrentBounded->u.bs.uBstrStartOffset);
-         DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
-
-      } else {
-         /* In a map or array */
-         QCBORDecode_Private_RewindMapOrArray(pMe);
-      }
+   *pItem = NULLUsefulBufC;
 
-   } else {
-      /* Not in anything bounded */
+   if(*puOffset >= Sequence.len) {
+      return QCBOR_ERR_NO_MORE_ITEMS;
+   }
 
-      /* Reposition traversal cursor to the start of input CBOR */
-      UsefulInputBuf_Seek(&(pMe->InBuf), 0ULL);
+   UsefulInputBuf_Init(&InBuf, Sequence);
+   UsefulInputBuf_Seek(&InBuf, *puOffset);
 
-      /* Reset nesting tracking to beginning of input. */
-      DecodeNesting_Init(&(pMe->nesting));
+   uIndexCount = 0;
+   uErr = QCBOR_Private_ScanItem(&InBuf, NULL, 0, &uIndexCount, &uErrorOffset);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
    }
 
-   pMe->uLastError = QCBOR_SUCCESS;
+   *pItem = UsefulBuf_Tail(UsefulBuf_Head(Sequence, UsefulInputBuf_Tell(&InBuf)), *puOffset);
+   *puOffset = UsefulInputBuf_Tell(&InBuf);
+
+   return QCBOR_SUCCESS;
 }
 
 
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+QCBORError
+QCBORDecode_SplitSequence(UsefulBufC  Sequence,
+                          size_t     *puOffset,
+                          size_t     *puEnds,
+                          size_t      uMaxEnds,
+                          size_t     *puNumEnds)
+{
+   UsefulInputBuf InBuf;
+   QCBORError     uErr;
+   size_t         uIndexCount;
+   size_t         uErrorOffset;
+   size_t         uNumEnds;
 
+   *puNumEnds = 0;
 
+   if(*puOffset >= Sequence.len) {
+      return QCBOR_ERR_NO_MORE_ITEMS;
+   }
 
-typedef struct {
-   void               *pCBContext;
-   QCBORItemCallback   pfCallback;
-} MapSearchCallBack;
+   UsefulInputBuf_Init(&InBuf, Sequence);
+   UsefulInputBuf_Seek(&InBuf, *puOffset);
 
-typedef struct {
-   size_t   uStartOffset;
-   uint16_t uItemCount;
-} MapSearchInfo;
+   uErr = QCBOR_SUCCESS;
+   for(uNumEnds = 0; uNumEnds < uMaxEnds; uNumEnds++) {
+      if(UsefulInputBuf_BytesUnconsumed(&InBuf) == 0) {
+         break;
+      }
+      uIndexCount = 0;
+      uErr = QCBOR_Private_ScanItem(&InBuf, NULL, 0, &uIndexCount, &uErrorOffset);
+      if(uErr != QCBOR_SUCCESS) {
+         break;
+      }
+      puEnds[uNumEnds] = UsefulInputBuf_Tell(&InBuf);
+   }
+
+   if(uNumEnds > 0) {
+      *puOffset = puEnds[uNumEnds - 1];
+   }
+   *puNumEnds = uNumEnds;
+
+   return uErr;
+}
 
 
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
 /**
- * @brief Search a map for a set of items.
- *
- * @param[in]  pMe           The decode context to search.
- * @param[in,out] pItemArray The items to search for and the items found.
- * @param[out] pInfo         Several bits of meta-info returned by search.
- * @param[in] pCallBack      Callback object or @c NULL.
- *
- * @retval QCBOR_ERR_NOT_ENTERED     Trying to search without entering a map.
- *
- * @retval QCBOR_ERR_DUPLICATE_LABEL Duplicate items (items with the same label)
- *                                   were found for one of the labels being
- *                                   search for. This duplicate detection is
- *                                   only performed for items in pItemArray,
- *                                   not every item in the map.
- *
- * @retval QCBOR_ERR_UNEXPECTED_TYPE A label was matched, but the type was
- *                                   wrong for the matchd label.
- *
- * @retval Also errors returned by QCBORDecode_GetNext().
+ * @brief Convert a half, single or double-precision head argument to double.
  *
- * On input, @c pItemArray contains a list of labels and data types of
- * items to be found.
- *
- * On output, the fully retrieved items are filled in with values and
- * such. The label was matched, so it never changes.
+ * @param[in] nAdditionalInfo  HALF_PREC_FLOAT, SINGLE_PREC_FLOAT or
+ *                             DOUBLE_PREC_FLOAT.
+ * @param[in] uArgument        The bits of the value.
+ * @param[out] pdValue         The value.
  *
- * If an item was not found, its data type is set to @ref QCBOR_TYPE_NONE.
+ * @returns QCBOR_SUCCESS or an error for a disabled float feature.
  *
- * This also finds the ends of maps and arrays when they are exited.
+ * This is for QCBORDecode_Walk(). It converts the same as
+ * QCBOR_Private_DecodeType7() except single-precision is always
+ * returned as a double.
  */
 static QCBORError
-QCBORDecode_Private_MapSearch(QCBORDecodeContext *pMe,
-                              QCBORItem          *pItemArray,
-                              MapSearchInfo      *pInfo,
-                              MapSearchCallBack  *pCallBack)
+QCBOR_Private_WalkFloat(const int      nAdditionalInfo,
+                        const uint64_t uArgument,
+                        double        *pdValue)
 {
-   QCBORError uReturn;
-   uint64_t   uFoundItemBitMap = 0;
-
-   if(pInfo != NULL) {
-      pInfo->uItemCount = 0;
-      pInfo->uStartOffset = UINT32_MAX;
-   }
-
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      uReturn = pMe->uLastError;
-      goto Done2;
-   }
+   switch(nAdditionalInfo) {
+      case HALF_PREC_FLOAT:
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
+         *pdValue = IEEE754_HalfToDouble((uint16_t)uArgument);
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+         return FLOAT_ERR_CODE_NO_HALF_PREC(QCBOR_SUCCESS);
 
-   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_MAP) &&
-      pItemArray->uLabelType != QCBOR_TYPE_NONE) {
-      /* QCBOR_TYPE_NONE as first item indicates just looking for the
-       * end of an array, so don't give error. */
-      uReturn = QCBOR_ERR_MAP_NOT_ENTERED;
-      goto Done2;
-   }
+      case SINGLE_PREC_FLOAT:
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
+         *pdValue = IEEE754_SingleToDouble((uint32_t)uArgument);
+         return QCBOR_SUCCESS;
+#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+         *pdValue = (double)UsefulBufUtil_CopyUint32ToFloat((uint32_t)uArgument);
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
 
-   if(DecodeNesting_IsBoundedEmpty(&(pMe->nesting))) {
-      /* It is an empty bounded array or map */
-      if(pItemArray->uLabelType == QCBOR_TYPE_NONE) {
-         /* Just trying to find the end of the map or array */
-         pMe->uMapEndOffsetCache = DecodeNesting_GetMapOrArrayStart(&(pMe->nesting));
-         uReturn = QCBOR_SUCCESS;
-      } else {
-         /* Nothing is ever found in an empty array or map. All items
-          * are marked as not found below. */
-         uReturn = QCBOR_SUCCESS;
-      }
-      goto Done2;
+      default: /* DOUBLE_PREC_FLOAT */
+         *pdValue = UsefulBufUtil_CopyUint64ToDouble(uArgument);
+         return QCBOR_SUCCESS;
    }
+}
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
 
-   QCBORDecodeNesting SaveNesting;
-   size_t uSavePos = UsefulInputBuf_Tell(&(pMe->InBuf));
-   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
 
-   /* Reposition to search from the start of the map / array */
-   QCBORDecode_Private_RewindMapOrArray(pMe);
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ *
+ * The top level is the sequence, which ends at the end of the input
+ * rather than at a count or a break.
+ */
+QCBORError
+QCBORDecode_Walk(UsefulBufC                EncodedCBOR,
+                 const QCBORWalkCallbacks *pCallbacks,
+                 void                     *pCBCtx,
+                 size_t                   *puErrorOffset)
+{
+   UsefulInputBuf  InBuf;
+   QCBORError      uErr;
+   int             nClass;
+   int             nAdditionalInfo;
+   uint64_t        uArgument;
+   size_t          uItemStart;
+   uint8_t         uType;
+   UsefulBufC      String;
+   QCBORScanLevels Levels;
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   int             nChunkClass;
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+   double          dValue;
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
 
-   /* Loop over all the items in the map or array. Each item could be
-    * a map or array, but label matching is only at the main
-    * level. This handles definite- and indefinite- length maps and
-    * arrays. The only reason this is ever called on arrays is to find
-    * their end position.
-    *
-    * This will always run over all items in order to do duplicate
-    * detection.
-    *
-    * This will exit with failure if it encounters an unrecoverable
-    * error, but continue on for recoverable errors.
-    *
-    * If a recoverable error occurs on a matched item, then that error
-    * code is returned.
-    */
-   const uint8_t uMapNestLevel = DecodeNesting_GetBoundedModeLevel(&(pMe->nesting));
-   uint8_t       uNextNestLevel;
-   do {
-      QCBORItem   Item;
-      bool        bMatched;
-      QCBORError  uResult;
-      /* Remember offset of the item because sometimes it has to be returned */
-      const size_t uOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
+   UsefulInputBuf_Init(&InBuf, EncodedCBOR);
+   ScanLevels_Init(&Levels, QCBOR_SCAN_INDEFINITE, QCBOR_SCAN_SEQUENCE);
+   uItemStart = 0;
 
-      /* Get the item */
-      /* QCBORDecode_Private_GetNextTagContent() rather than GetNext()
-       * because a label match is performed on recoverable errors to
-       * be able to return the the error code for the found item. */
-      uResult = QCBORDecode_Private_GetNextTagContent(pMe, &Item);
-      if(QCBORDecode_IsUnrecoverableError(uResult)) {
-         /* The map/array can't be decoded when unrecoverable errors occur */
-         uReturn = uResult;
-         goto Done;
-      }
-      if(uResult == QCBOR_ERR_NO_MORE_ITEMS) {
-         /* Unexpected end of map or array. */
-         uReturn = uResult;
+   while(Levels.nLevel > 0 || UsefulInputBuf_BytesUnconsumed(&InBuf) != 0) {
+      uItemStart = UsefulInputBuf_Tell(&InBuf);
+      uErr = QCBOR_Private_DecodeHead(&InBuf, &nClass, &uArgument, &nAdditionalInfo);
+      if(uErr != QCBOR_SUCCESS) {
          goto Done;
       }
 
-      /* See if item has one of the labels that are of interest */
-      bMatched = false;
-      for(int nIndex = 0; pItemArray[nIndex].uLabelType != QCBOR_TYPE_NONE; nIndex++) {
-         if(QCBORItem_MatchLabel(Item, pItemArray[nIndex])) {
-            /* A label match has been found */
-            if(uFoundItemBitMap & (0x01ULL << nIndex)) {
-               uReturn = QCBOR_ERR_DUPLICATE_LABEL;
+      switch(nClass) {
+         case CBOR_MAJOR_TYPE_POSITIVE_INT:
+            if(uArgument <= INT64_MAX) {
+               if(pCallbacks->pfInt != NULL) {
+                  uErr = pCallbacks->pfInt(pCBCtx, (int64_t)uArgument);
+               }
+            } else {
+               if(pCallbacks->pfUInt != NULL) {
+                  uErr = pCallbacks->pfUInt(pCBCtx, uArgument);
+               }
+            }
+            break;
+
+         case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+            /* See QCBOR_Private_DecodeInteger() */
+            if(uArgument > INT64_MAX) {
+               uErr = QCBOR_ERR_INT_OVERFLOW;
                goto Done;
             }
-            if(uResult != QCBOR_SUCCESS) {
-               /* The label matches, but the data item is in error.
-                * It is OK to have recoverable errors on items that
-                * are not matched. */
-               uReturn = uResult;
+            if(pCallbacks->pfInt != NULL) {
+               uErr = pCallbacks->pfInt(pCBCtx, (-(int64_t)uArgument) - 1);
+            }
+            break;
+
+         case CBOR_MAJOR_TYPE_BYTE_STRING:
+         case CBOR_MAJOR_TYPE_TEXT_STRING:
+            uType = nClass == CBOR_MAJOR_TYPE_BYTE_STRING ? QCBOR_TYPE_BYTE_STRING :
+                                                            QCBOR_TYPE_TEXT_STRING;
+            if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+               if(pCallbacks->pfStart != NULL) {
+                  uErr = pCallbacks->pfStart(pCBCtx, uType, QCBOR_WALK_INDEFINITE_LENGTH);
+                  if(uErr != QCBOR_SUCCESS) {
+                     goto Done;
+                  }
+               }
+               /* Chunks must be definite-length strings of the same
+                * major type. The loop ends at the break. */
+               while(1) {
+                  uItemStart = UsefulInputBuf_Tell(&InBuf);
+                  uErr = QCBOR_Private_DecodeHead(&InBuf,
+                                                  &nChunkClass,
+                                                  &uArgument,
+                                                  &nAdditionalInfo);
+                  if(uErr != QCBOR_SUCCESS) {
+                     goto Done;
+                  }
+                  if(nChunkClass == CBOR_MAJOR_TYPE_SIMPLE &&
+                     nAdditionalInfo == LEN_IS_INDEFINITE) {
+                     break;
+                  }
+                  if(nChunkClass == QCBOR_HEAD_CLASS_RESERVED) {
+                     uErr = QCBOR_ERR_UNSUPPORTED;
+                     goto Done;
+                  }
+                  if(nChunkClass != nClass || nAdditionalInfo == LEN_IS_INDEFINITE) {
+                     uErr = QCBOR_ERR_INDEFINITE_STRING_CHUNK;
+                     goto Done;
+                  }
+                  if(uArgument > UsefulInputBuf_BytesUnconsumed(&InBuf)) {
+                     uErr = QCBOR_ERR_HIT_END;
+                     goto Done;
+                  }
+                  String.len = (size_t)uArgument;
+                  String.ptr = UsefulInputBuf_GetBytes(&InBuf, String.len);
+                  if(pCallbacks->pfString != NULL) {
+                     uErr = pCallbacks->pfString(pCBCtx, uType, String);
+                     if(uErr != QCBOR_SUCCESS) {
+                        goto Done;
+                     }
+                  }
+               }
+               if(pCallbacks->pfEnd != NULL) {
+                  uErr = pCallbacks->pfEnd(pCBCtx, uType);
+               }
+#else /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+               uErr = QCBOR_ERR_INDEF_LEN_STRINGS_DISABLED;
                goto Done;
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+            } else {
+               if(uArgument > UsefulInputBuf_BytesUnconsumed(&InBuf)) {
+                  uErr = QCBOR_ERR_HIT_END;
+                  goto Done;
+               }
+               /* Cast is safe because of check against bytes left */
+               String.len = (size_t)uArgument;
+               String.ptr = UsefulInputBuf_GetBytes(&InBuf, String.len);
+               if(pCallbacks->pfString != NULL) {
+                  uErr = pCallbacks->pfString(pCBCtx, uType, String);
+               }
             }
-            if(!QCBORItem_MatchType(Item, pItemArray[nIndex])) {
-               /* The data item is not of the type(s) requested */
-               uReturn = QCBOR_ERR_UNEXPECTED_TYPE;
+            break;
+
+         case CBOR_MAJOR_TYPE_ARRAY:
+         case CBOR_MAJOR_TYPE_MAP:
+            uType = nClass == CBOR_MAJOR_TYPE_MAP ? QCBOR_TYPE_MAP : QCBOR_TYPE_ARRAY;
+            if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+               uArgument = QCBOR_SCAN_INDEFINITE;
+#else /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+               uErr = QCBOR_ERR_INDEF_LEN_ARRAYS_DISABLED;
+               goto Done;
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+            } else if(uArgument > UsefulInputBuf_BytesUnconsumed(&InBuf)) {
+               /* Every item is at least one byte. Checking this here
+                * keeps uArgument from being QCBOR_SCAN_INDEFINITE and
+                * from overflowing when doubled for a map. */
+               uErr = QCBOR_ERR_HIT_END;
+               goto Done;
+            }
+            if(pCallbacks->pfStart != NULL) {
+               uErr = pCallbacks->pfStart(pCBCtx, uType, uArgument);
+               if(uErr != QCBOR_SUCCESS) {
+                  goto Done;
+               }
+            }
+            if(uArgument == 0) {
+               /* An empty map or array is a complete item */
+               if(pCallbacks->pfEnd != NULL) {
+                  uErr = pCallbacks->pfEnd(pCBCtx, uType);
+               }
+               break;
+            }
+            uErr = ScanLevels_Enter(&Levels, QCBOR_MAX_ARRAY_NESTING, nClass, uArgument);
+            if(uErr != QCBOR_SUCCESS) {
                goto Done;
             }
+            continue;
 
-            /* Successful match. Return the item. */
-            pItemArray[nIndex] = Item;
-            uFoundItemBitMap |= 0x01ULL << nIndex;
-            if(pInfo != NULL) {
-               pInfo->uStartOffset = uOffset;
+         case CBOR_MAJOR_TYPE_TAG:
+#ifndef QCBOR_DISABLE_TAGS
+            if(pCallbacks->pfTag != NULL) {
+               uErr = pCallbacks->pfTag(pCBCtx, uArgument);
+               if(uErr != QCBOR_SUCCESS) {
+                  goto Done;
+               }
             }
-            bMatched = true;
-         }
-      }
+            ScanLevels_TagNumber(&Levels);
+            continue;
+#else /* ! QCBOR_DISABLE_TAGS */
+            uErr = QCBOR_ERR_TAGS_DISABLED;
+            goto Done;
+#endif /* ! QCBOR_DISABLE_TAGS */
+
+         case CBOR_MAJOR_TYPE_SIMPLE:
+            if(nAdditionalInfo == CBOR_SIMPLE_BREAK) {
+               uErr = ScanLevels_CheckBreak(&Levels);
+               if(uErr != QCBOR_SUCCESS) {
+                  goto Done;
+               }
+               /* The array or map is closed and counts as an item in
+                * the level above. */
+               if(pCallbacks->pfEnd != NULL) {
+                  uType = (Levels.puFlags[Levels.nLevel] & QCBOR_SCAN_IS_MAP) ? QCBOR_TYPE_MAP : QCBOR_TYPE_ARRAY;
+                  uErr = pCallbacks->pfEnd(pCBCtx, uType);
+               }
+               Levels.nLevel--;
+            } else if(nAdditionalInfo >= HALF_PREC_FLOAT &&
+                      nAdditionalInfo <= DOUBLE_PREC_FLOAT) {
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+               uErr = QCBOR_Private_WalkFloat(nAdditionalInfo, uArgument, &dValue);
+               if(uErr != QCBOR_SUCCESS) {
+                  goto Done;
+               }
+               if(pCallbacks->pfFloat != NULL) {
+                  uErr = pCallbacks->pfFloat(pCBCtx, dValue);
+               }
+#else /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+               uErr = QCBOR_ERR_ALL_FLOAT_DISABLED;
+               goto Done;
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+            } else {
+               if(nAdditionalInfo == CBOR_SIMPLEV_ONEBYTE &&
+                  uArgument <= CBOR_SIMPLE_BREAK) {
+                  uErr = QCBOR_ERR_BAD_TYPE_7;
+                  goto Done;
+               }
+               if(pCallbacks->pfSimple != NULL) {
+                  /* Cast is safe because the float cases are above */
+                  uErr = pCallbacks->pfSimple(pCBCtx, (uint8_t)uArgument);
+               }
+            }
+            break;
 
+         case QCBOR_HEAD_CLASS_BAD_INT:
+            uErr = QCBOR_ERR_BAD_INT;
+            goto Done;
 
-      if(!bMatched && pCallBack != NULL) {
-         /* Call the callback on unmatched labels.
-          * (It is tempting to do duplicate detection here, but that
-          * would require dynamic memory allocation because the number
-          * of labels that might be encountered is unbounded.) */
-         uReturn = (*(pCallBack->pfCallback))(pCallBack->pCBContext, &Item);
-         if(uReturn != QCBOR_SUCCESS) {
+         default:
+            /* QCBOR_HEAD_CLASS_RESERVED */
+            uErr = QCBOR_ERR_UNSUPPORTED;
             goto Done;
-         }
       }
 
-      /* Consume the item whether matched or not. This does the work
-       * of traversing maps and array and everything in them. In this
-       * loop only the items at the current nesting level are examined
-       * to match the labels. */
-      uReturn = QCBORDecode_Private_ConsumeItem(pMe, &Item, NULL, &uNextNestLevel);
-      if(uReturn != QCBOR_SUCCESS) {
+      if(uErr != QCBOR_SUCCESS) {
+         /* From a callback */
          goto Done;
       }
 
-      if(pInfo != NULL) {
-         pInfo->uItemCount++;
+      /* An item is complete. Count it at its level and close out all
+       * the definite-length arrays and maps that it completes. */
+      while(ScanLevels_CountItem(&Levels)) {
+         if(pCallbacks->pfEnd != NULL) {
+            uType = (Levels.puFlags[Levels.nLevel] & QCBOR_SCAN_IS_MAP) ? QCBOR_TYPE_MAP : QCBOR_TYPE_ARRAY;
+            uErr = pCallbacks->pfEnd(pCBCtx, uType);
+            if(uErr != QCBOR_SUCCESS) {
+               goto Done;
+            }
+         }
+         Levels.nLevel--;
       }
-
-   } while (uNextNestLevel >= uMapNestLevel);
-
-   uReturn = QCBOR_SUCCESS;
-
-   const size_t uEndOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
-
-   /* Check here makes sure that this won't accidentally be
-    * QCBOR_MAP_OFFSET_CACHE_INVALID which is larger than
-    * QCBOR_MAX_DECODE_INPUT_SIZE.  Cast to uint32_t to possibly
-    * address cases where SIZE_MAX < UINT32_MAX. It is near-impossible
-    * to test this, so test coverage of this function is not 100%,
-    * but it is 100% when this is commented out. */
-   if((uint32_t)uEndOffset >= QCBOR_MAX_DECODE_INPUT_SIZE) {
-      uReturn = QCBOR_ERR_INPUT_TOO_LARGE;
-      goto Done;
    }
-   /* Cast OK because encoded CBOR is limited to UINT32_MAX */
-   pMe->uMapEndOffsetCache = (uint32_t)uEndOffset;
 
- Done:
-   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
-   UsefulInputBuf_Seek(&(pMe->InBuf), uSavePos);
+   /* A tag number at the end of the input has no content */
+   uErr = (Levels.puFlags[0] & QCBOR_SCAN_TAG_PENDING) ? QCBOR_ERR_HIT_END : QCBOR_SUCCESS;
+   uItemStart = UsefulInputBuf_Tell(&InBuf);
 
- Done2:
-   /* For all items not found, set the data and label type to QCBOR_TYPE_NONE */
-   for(int i = 0; pItemArray[i].uLabelType != 0; i++) {
-      if(!(uFoundItemBitMap & (0x01ULL << i))) {
-         pItemArray[i].uDataType  = QCBOR_TYPE_NONE;
-         pItemArray[i].uLabelType = QCBOR_TYPE_NONE;
-      }
+Done:
+   if(uErr == QCBOR_ERR_HIT_END) {
+      uItemStart = UsefulInputBuf_GetBufferLength(&InBuf);
    }
-
-   return uReturn;
+   if(puErrorOffset != NULL) {
+      *puErrorOffset = uItemStart;
+   }
+   return uErr;
 }
 
 
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
-void
-QCBORDecode_GetItemInMapN(QCBORDecodeContext *pMe,
-                          int64_t             nLabel,
-                          uint8_t             uQcborType,
-                          QCBORItem          *pItem)
+QCBORError
+QCBORDecode_BuildContainerIndex(UsefulBufC                EncodedCBOR,
+                                QCBORContainerIndexEntry *pIndex,
+                                size_t                    uIndexSize,
+                                size_t                   *puIndexCount)
 {
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
-   }
-
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
-   OneItemSearch[0].label.int64 = nLabel;
-   OneItemSearch[0].uDataType   = uQcborType;
-   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE; // Indicates end of array
+   UsefulInputBuf InBuf;
+   QCBORError     uErr;
+   size_t         uErrorOffset;
 
-   QCBORError uReturn = QCBORDecode_Private_MapSearch(pMe, OneItemSearch, NULL, NULL);
+   *puIndexCount = 0;
 
-   if(uReturn != QCBOR_SUCCESS) {
-      pItem->uDataType  = QCBOR_TYPE_NONE;
-      pItem->uLabelType = QCBOR_TYPE_NONE;
-      goto Done;
+   /* Offsets in the index are QCBOROffset */
+   if(EncodedCBOR.len > QCBOR_MAX_DECODE_INPUT_SIZE) {
+      return QCBOR_ERR_INPUT_TOO_LARGE;
    }
 
-   if(OneItemSearch[0].uDataType == QCBOR_TYPE_NONE) {
-      uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
-   }
+   UsefulInputBuf_Init(&InBuf, EncodedCBOR);
 
-   *pItem = OneItemSearch[0];
-   QCBORDecode_Private_CopyTags(pMe, pItem);
+   /* Loop for each item in the CBOR sequence */
+   do {
+      uErr = QCBOR_Private_ScanItem(&InBuf, pIndex, uIndexSize, puIndexCount, &uErrorOffset);
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr;
+      }
+   } while(UsefulInputBuf_BytesUnconsumed(&InBuf) != 0);
 
- Done:
-   pMe->uLastError = (uint8_t)uReturn;
+   if(*puIndexCount > uIndexSize) {
+      return QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL;
+   }
+
+   return QCBOR_SUCCESS;
 }
 
 
@@ -3549,407 +4768,518 @@ QCBORDecode_GetItemInMapN(QCBORDecodeContext *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetItemInMapSZ(QCBORDecodeContext *pMe,
-                           const char         *szLabel,
-                           uint8_t             uQcborType,
-                           QCBORItem          *pItem)
+QCBORDecode_SetContainerIndex(QCBORDecodeContext             *pMe,
+                              const QCBORContainerIndexEntry *pIndex,
+                              size_t                          uIndexCount)
 {
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
+   /* More entries than bytes of input can't be valid */
+   if(uIndexCount > UsefulInputBuf_GetBufferLength(&(pMe->InBuf))) {
+      uIndexCount = 0;
    }
+   pMe->pContainerIndex      = uIndexCount ? pIndex : NULL;
+   pMe->uContainerIndexCount = uIndexCount;
+}
 
-#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
-   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
-   OneItemSearch[0].uDataType    = uQcborType;
-   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE; // Indicates end of array
 
-   QCBORError uReturn = QCBORDecode_Private_MapSearch(pMe, OneItemSearch, NULL, NULL);
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnableFastSkip(QCBORDecodeContext *pMe)
+{
+   pMe->bFastSkip = true;
+}
 
-   if(uReturn != QCBOR_SUCCESS) {
-      pItem->uDataType  = QCBOR_TYPE_NONE;
-      pItem->uLabelType = QCBOR_TYPE_NONE;
-      goto Done;
-   }
-   if(OneItemSearch[0].uDataType == QCBOR_TYPE_NONE) {
-      uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
-      goto Done;
-   }
 
-   *pItem = OneItemSearch[0];
-   QCBORDecode_Private_CopyTags(pMe, pItem);
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnableUTF8Check(QCBORDecodeContext *pMe)
+{
+   pMe->bCheckUTF8 = true;
+}
 
-Done:
-#else
-   (void)pMe;
-   (void)szLabel;
-   (void)uQcborType;
-   (void)pItem;
-   QCBORError uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
-#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
-   pMe->uLastError = (uint8_t)uReturn;
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnableTrustedInput(QCBORDecodeContext *pMe)
+{
+   pMe->bTrustedInput = true;
 }
 
 
-
 /**
- * @brief Semi-private. Get pointer, length and item for an array or map.
- *
- * @param[in] pMe            The decode context.
- * @param[in] uType          CBOR major type, either array/map.
- * @param[out] pItem         The item for the array/map.
- * @param[out] pEncodedCBOR  Pointer and length of the encoded map or array.
+ * @brief Look up a map or array in the container index.
  *
- * The next item to be decoded must be a map or array as specified by @c uType.
+ * @param[in] pMe             The decode context.
+ * @param[in] uContentOffset  Offset just after the head of the map or array.
  *
- * @c pItem will be filled in with the label and tags of the array or map
- * in addition to @c pEncodedCBOR giving the pointer and length of the
- * encoded CBOR.
+ * @returns The index entry or NULL if not in the index.
  *
- * When this is complete, the traversal cursor is at the end of the array or
- * map that was retrieved.
+ * Binary search works because entries are recorded in the order of
+ * their heads.
  */
-void
-QCBORDecode_Private_GetArrayOrMap(QCBORDecodeContext *pMe,
-                                  const uint8_t       uType,
-                                  QCBORItem          *pItem,
-                                  UsefulBufC         *pEncodedCBOR)
+static const QCBORContainerIndexEntry *
+QCBORDecode_Private_LookUpContainer(const QCBORDecodeContext *pMe,
+                                    const size_t              uContentOffset)
 {
-   QCBORError uErr;
-   uint8_t    uNestLevel;
-   size_t     uStartingCursor;
-   size_t     uStartOfReturned;
-   size_t     uEndOfReturned;
-   size_t     uTempSaveCursor;
-   bool       bInMap;
-   QCBORItem  LabelItem;
-   bool       EndedByBreak = false;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMid;
 
-   uStartingCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
-   bInMap = DecodeNesting_IsCurrentTypeMap(&(pMe->nesting));
-
-   /* Could call GetNext here, but don't need to because this
-    * is only interested in arrays and maps. */
-   uErr = QCBORDecode_Private_GetNextMapOrArray(pMe, NULL, pItem);
-   if(uErr != QCBOR_SUCCESS) {
-      pMe->uLastError = (uint8_t)uErr;
-      return;
+   uLow  = 0;
+   uHigh = pMe->uContainerIndexCount;
+   while(uLow < uHigh) {
+      uMid = uLow + (uHigh - uLow) / 2;
+      if(pMe->pContainerIndex[uMid].uContentOffset < uContentOffset) {
+         uLow = uMid + 1;
+      } else {
+         uHigh = uMid;
+      }
    }
 
-   uint8_t uItemDataType = pItem->uDataType;
-#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
-   if(uItemDataType == QCBOR_TYPE_MAP_AS_ARRAY) {
-      uItemDataType = QCBOR_TYPE_ARRAY;
+   if(uLow == pMe->uContainerIndexCount ||
+      pMe->pContainerIndex[uLow].uContentOffset != uContentOffset ||
+      pMe->pContainerIndex[uLow].uEndOffset < uContentOffset) {
+      return NULL;
    }
-#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
-   if(uItemDataType != uType) {
-      pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
-      return;
-   }
+   return &(pMe->pContainerIndex[uLow]);
+}
 
-   if(bInMap) {
-      /* If the item is in a map, the start of the array/map
-       * itself, not the label, must be found. Do this by
-       * rewinding to the starting position and fetching
-       * just the label data item. QCBORDecode_Private_GetNextTagNumber()
-       * doesn't do any of the array/map item counting or nesting
-       * level tracking. Used here it will just fetech the label
-       * data item.
-       *
-       * Have to save the cursor and put it back to the position
-       * after the full item once the label as been fetched by
-       * itself.
-       */
-      uTempSaveCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
-      UsefulInputBuf_Seek(&(pMe->InBuf), uStartingCursor);
-
-      /* Item has been fetched once so safe to ignore error */
-      (void)QCBORDecode_Private_GetNextTagNumber(pMe, &LabelItem);
-
-      uStartOfReturned = UsefulInputBuf_Tell(&(pMe->InBuf));
-      UsefulInputBuf_Seek(&(pMe->InBuf), uTempSaveCursor);
-   } else {
-      uStartOfReturned = uStartingCursor;
-   }
 
-   /* Consume the entire array/map to find the end */
-   uErr = QCBORDecode_Private_ConsumeItem(pMe, pItem, &EndedByBreak, &uNestLevel);
-   if(uErr != QCBOR_SUCCESS) {
-      pMe->uLastError = (uint8_t)uErr;
-      goto Done;
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+uint64_t
+QCBORDecode_GetNthTag(QCBORDecodeContext *pMe,
+                      const QCBORItem    *pItem,
+                      uint32_t            uIndex)
+{
+#ifndef QCBOR_DISABLE_TAGS
+   if(pItem->uDataType == QCBOR_TYPE_NONE) {
+      return CBOR_TAG_INVALID64;
    }
-
-   /* Fill in returned values */
-   uEndOfReturned = UsefulInputBuf_Tell(&(pMe->InBuf));
-   if(EndedByBreak) {
-      /* When ascending nesting levels, a break for the level above
-       * was consumed. That break is not a part of what is consumed here. */
-      uEndOfReturned--;
+   if(uIndex >= QCBOR_MAX_TAGS_PER_ITEM) {
+      return CBOR_TAG_INVALID64;
+   } else {
+      return QCBORDecode_Private_UnMapTagNumber(pMe, pItem->uTags[uIndex]);
    }
-   pEncodedCBOR->ptr = UsefulInputBuf_OffsetToPointer(&(pMe->InBuf), uStartOfReturned);
-   pEncodedCBOR->len = uEndOfReturned - uStartOfReturned;
+#else /* QCBOR_DISABLE_TAGS */
+   (void)pMe;
+   (void)pItem;
+   (void)uIndex;
 
-Done:
-   return;
+   return CBOR_TAG_INVALID64;
+#endif /* QCBOR_DISABLE_TAGS */
 }
 
 
-/**
- * @brief Semi-private. Get pointer, length and item count of an array or map.
- *
- * @param[in] pMe            The decode context.
- * @param[in] pTarget        The label and type of the array or map to retrieve.
- * @param[out] pItem         The item for the array/map.
- * @param[out] pEncodedCBOR  Pointer and length of the encoded map or array.
- *
- * When this is complete, the traversal cursor is unchanged.
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
  */
-void
-QCBORDecode_Private_SearchAndGetArrayOrMap(QCBORDecodeContext *pMe,
-                                           QCBORItem          *pTarget,
-                                           QCBORItem          *pItem,
-                                           UsefulBufC         *pEncodedCBOR)
+uint64_t
+QCBORDecode_GetNthTagOfLast(const QCBORDecodeContext *pMe,
+                            uint32_t                  uIndex)
 {
-   /* Heavy stack use, but it's only for a few QCBOR public methods */
-   MapSearchInfo      Info;
-   QCBORDecodeNesting SaveNesting;
-   size_t             uSaveCursor;
+#ifndef QCBOR_DISABLE_TAGS
 
-   /* Find the array or map of interest */
-   pMe->uLastError = (uint8_t)QCBORDecode_Private_MapSearch(pMe, pTarget, &Info, NULL);
    if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
+      return CBOR_TAG_INVALID64;
    }
-
-   if(pTarget->uDataType == QCBOR_TYPE_NONE) {
-      pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
-      return;
+   if(uIndex >= QCBOR_MAX_TAGS_PER_ITEM) {
+      return CBOR_TAG_INVALID64;
+   } else {
+      return QCBORDecode_Private_UnMapTagNumber(pMe, pMe->uLastTags[uIndex]);
    }
+#else /* QCBOR_DISABLE_TAGS */
+   (void)pMe;
+   (void)uIndex;
 
-   /* Save the traversal cursor and related */
-   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
-   uSaveCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
+   return CBOR_TAG_INVALID64;
+#endif /* QCBOR_DISABLE_TAGS */
+}
 
-   /* Get the array or map of interest */
-   DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
-   UsefulInputBuf_Seek(&(pMe->InBuf), Info.uStartOffset);
-   QCBORDecode_Private_GetArrayOrMap(pMe, pTarget[0].uDataType, pItem, pEncodedCBOR);
 
-   /* Restore the traversal cursor */
-   UsefulInputBuf_Seek(&(pMe->InBuf), uSaveCursor);
-   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
-}
 
 
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
 
+/* ===========================================================================
+   MemPool -- BUILT-IN SIMPLE STRING ALLOCATOR
 
-/**
- * @brief Is a QCBOR_TYPE in the type list?
- *
- * @param[in] uDataType  Type to check for.
- * @param[in] puTypeList  List to check.
- *
- * @retval  QCBOR_SUCCESS             If in the list.
- * @retval QCBOR_ERR_UNEXPECTED_TYPE  Not in the list.
- */
-static QCBORError
-QCBOR_Private_CheckTypeList(const int     uDataType,
-                            const uint8_t puTypeList[QCBOR_TAGSPEC_NUM_TYPES])
+   This implements a simple sting allocator for indefinite-length
+   strings that can be enabled by calling QCBORDecode_SetMemPool(). It
+   implements the function type QCBORStringAllocate and allows easy
+   use of it.
+
+   This particular allocator is built-in for convenience. The caller
+   can implement their own.  All of this following code will get
+   dead-stripped if QCBORDecode_SetMemPool() is not called.
+
+   This is a very primitive memory allocator. It does not track
+   individual allocations, only a high-water mark. A free or
+   reallocation must be of the last chunk allocated.
+
+   The size of the pool and offset to free memory are packed into the
+   first 8 bytes of the memory pool so we don't have to keep them in
+   the decode context. Since the address of the pool may not be
+   aligned, they have to be packed and unpacked as if they were
+   serialized data of the wire or such.
+
+   The sizes packed in are uint32_t to be the same on all CPU types
+   and simplify the code.
+   ========================================================================== */
+
+
+static int
+MemPool_Unpack(const void *pMem, uint32_t *puPoolSize, uint32_t *puFreeOffset)
 {
-   for(size_t i = 0; i < QCBOR_TAGSPEC_NUM_TYPES; i++) {
-      if(uDataType == puTypeList[i]) { /* -Wmaybe-uninitialized falsly warns here */
-         return QCBOR_SUCCESS;
-      }
-   }
-   return QCBOR_ERR_UNEXPECTED_TYPE;
+   // Use of UsefulInputBuf is overkill, but it is convenient.
+   UsefulInputBuf UIB;
+
+   // Just assume the size here. It was checked during SetUp so
+   // the assumption is safe.
+   UsefulInputBuf_Init(&UIB, (UsefulBufC){pMem,QCBOR_DECODE_MIN_MEM_POOL_SIZE});
+   *puPoolSize     = UsefulInputBuf_GetUint32(&UIB);
+   *puFreeOffset   = UsefulInputBuf_GetUint32(&UIB);
+   return UsefulInputBuf_GetError(&UIB);
 }
 
 
-/**
- * Match a tag/type specification against the type of the item.
- *
- * @param[in] TagSpec  Specification for matching tags.
- * @param[in] pItem    The item to check.
- *
- * @retval QCBOR_SUCCESS   @c uDataType is allowed by @c TagSpec
- * @retval QCBOR_ERR_UNEXPECTED_TYPE @c uDataType is not allowed by @c TagSpec
- *
- * This checks the item data type of untagged items as well as of
- * tagged items against a specification to see if decoding should
- * proceed.
- *
- * This relies on the automatic tag decoding done by QCBOR that turns
- * tag numbers into particular QCBOR_TYPEs so there is no actual
- * comparsion of tag numbers, just of QCBOR_TYPEs.
- *
- * This checks the data item type as possibly representing the tag
- * number or as the tag content type.
- *
- * If QCBOR_DISABLE_TAGS is #defined, this primarily checks the item
- * data type against the allowed tag content types, but also checks
- * against the tagged types. The QCBOR_TYPEs checked will never be
- * associated with tag numbers, but this checking is needed for the
- * text and byte string use cases .
- */
-static QCBORError
-QCBOR_Private_CheckTagRequirement(const QCBOR_Private_TagSpec TagSpec,
-                                  const QCBORItem            *pItem)
+static int
+MemPool_Pack(UsefulBuf Pool, uint32_t uFreeOffset)
 {
-   const int nItemType = pItem->uDataType; /* -Wmaybe-uninitialized falsly warns here */
-   const int nTagReq = TagSpec.uTagRequirement & ~QCBOR_TAG_REQUIREMENT_ALLOW_ADDITIONAL_TAGS;
+   // Use of UsefulOutBuf is overkill, but convenient. The
+   // length check performed here is useful.
+   UsefulOutBuf UOB;
 
-#ifndef QCBOR_DISABLE_TAGS
-   /* -Wmaybe-uninitialized falsly warns here */
-   if(!(TagSpec.uTagRequirement & QCBOR_TAG_REQUIREMENT_ALLOW_ADDITIONAL_TAGS) &&
-      pItem->uTags[0] != CBOR_TAG_INVALID16) {
-      /* There are tags that QCBOR couldn't process on this item and
-       * the caller has told us there should not be.
-       */
-      return QCBOR_ERR_UNEXPECTED_TYPE;
-   }
+   UsefulOutBuf_Init(&UOB, Pool);
+   UsefulOutBuf_AppendUint32(&UOB, (uint32_t)Pool.len); // size of pool
+   UsefulOutBuf_AppendUint32(&UOB, uFreeOffset); // first free position
+   return UsefulOutBuf_GetError(&UOB);
+}
 
-   if(nTagReq == QCBOR_TAG_REQUIREMENT_TAG) {
-      /* Must match the tag number and only the tag */
-      return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
-   }
 
-   QCBORError uReturn = QCBOR_Private_CheckTypeList(nItemType, TagSpec.uAllowedContentTypes);
-   if(uReturn == QCBOR_SUCCESS) {
-      return QCBOR_SUCCESS;
-   }
+/*
+ Internal function for an allocation, reallocation free and destuct.
 
-   if(nTagReq == QCBOR_TAG_REQUIREMENT_NOT_A_TAG) {
-      /* Must match the content type and only the content type.
-       * There was no match just above so it is a fail. */
-      return QCBOR_ERR_UNEXPECTED_TYPE;
-   }
+ Having only one function rather than one each per mode saves space in
+ QCBORDecodeContext.
 
-   /* QCBOR_TAG_REQUIREMENT_OPTIONAL_TAG: If here it can match either
-    * the tag or the content and it hasn't matched the content, so the
-    * end result is whether it matches the tag. This is the tag
-    * optional case that the CBOR standard discourages.
-    */
+ Code Reviewers: THIS FUNCTION DOES POINTER MATH
+ */
+static UsefulBuf
+MemPool_Function(void *pPool, void *pMem, size_t uNewSize)
+{
+   UsefulBuf ReturnValue = NULLUsefulBuf;
 
-   return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
+   uint32_t uPoolSize;
+   uint32_t uFreeOffset;
 
-#else /* QCBOR_DISABLE_TAGS */
-   if(nTagReq == QCBOR_TAG_REQUIREMENT_TAG) {
-      /* This is only checking base QCBOR types, not those associated
-       * with tag numbers since you can get here with tag numbers.
-       */
-      return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
+   if(uNewSize > UINT32_MAX) {
+      // This allocator is only good up to 4GB.  This check should
+      // optimize out if sizeof(size_t) == sizeof(uint32_t)
+      goto Done;
    }
+   const uint32_t uNewSize32 = (uint32_t)uNewSize;
 
-   return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uAllowedContentTypes);
+   if(MemPool_Unpack(pPool, &uPoolSize, &uFreeOffset)) {
+      goto Done;
+   }
 
-#endif /* QCBOR_DISABLE_TAGS */
+   if(uNewSize) {
+      if(pMem) {
+         // REALLOCATION MODE
+         // Calculate pointer to the end of the memory pool.  It is
+         // assumed that pPool + uPoolSize won't wrap around by
+         // assuming the caller won't pass a pool buffer in that is
+         // not in legitimate memory space.
+         const void *pPoolEnd = (uint8_t *)pPool + uPoolSize;
+
+         // Check that the pointer for reallocation is in the range of the
+         // pool. This also makes sure that pointer math further down
+         // doesn't wrap under or over.
+         if(pMem >= pPool && pMem < pPoolEnd) {
+            // Offset to start of chunk for reallocation. This won't
+            // wrap under because of check that pMem >= pPool.  Cast
+            // is safe because the pool is always less than UINT32_MAX
+            // because of check in QCBORDecode_SetMemPool().
+            const uint32_t uMemOffset = (uint32_t)((uint8_t *)pMem - (uint8_t *)pPool);
+
+            // Check to see if the allocation will fit. uPoolSize -
+            // uMemOffset will not wrap under because of check that
+            // pMem is in the range of the uPoolSize by check above.
+            if(uNewSize <= uPoolSize - uMemOffset) {
+               ReturnValue.ptr = pMem;
+               ReturnValue.len = uNewSize;
+
+               // Addition won't wrap around over because uNewSize was
+               // checked to be sure it is less than the pool size.
+               uFreeOffset = uMemOffset + uNewSize32;
+            }
+         }
+      } else {
+         // ALLOCATION MODE
+         // uPoolSize - uFreeOffset will not underflow because this
+         // pool implementation makes sure uFreeOffset is always
+         // smaller than uPoolSize through this check here and
+         // reallocation case.
+         if(uNewSize <= uPoolSize - uFreeOffset) {
+            ReturnValue.len = uNewSize;
+            ReturnValue.ptr = (uint8_t *)pPool + uFreeOffset;
+            uFreeOffset    += (uint32_t)uNewSize;
+         }
+      }
+   } else {
+      if(pMem) {
+         // FREE MODE
+         // Cast is safe because of limit on pool size in
+         // QCBORDecode_SetMemPool()
+         uFreeOffset = (uint32_t)((uint8_t *)pMem - (uint8_t *)pPool);
+      } else {
+         // DESTRUCT MODE
+         // Nothing to do for this allocator
+      }
+   }
+
+   UsefulBuf Pool = {pPool, uPoolSize};
+   MemPool_Pack(Pool, uFreeOffset);
+
+Done:
+   return ReturnValue;
 }
 
 
-/**
- * @brief Get an item by label to match a tag specification.
- *
- * @param[in] pMe      The decode context.
- * @param[in] nLabel   The label to search map for.
- * @param[in] TagSpec  The tag number specification to match.
- * @param[out] pItem   The item found.
- *
- * This finds the item with the given label in currently open
- * map. Then checks that its tag number and types matches the tag
- * specification. If not, an error is set in the decode context.
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
  */
-static void
-QCBORDecode_GetTaggedItemInMapN(QCBORDecodeContext         *pMe,
-                                const int64_t               nLabel,
-                                const QCBOR_Private_TagSpec TagSpec,
-                                QCBORItem                  *pItem)
+QCBORError
+QCBORDecode_SetMemPool(QCBORDecodeContext *pMe,
+                       UsefulBuf           Pool,
+                       bool                bAllStrings)
 {
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
+   // The pool size and free mem offset are packed into the beginning
+   // of the pool memory. This compile time check makes sure the
+   // constant in the header is correct.  This check should optimize
+   // down to nothing.
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4127) // conditional expression is constant
+#endif
+   if(QCBOR_DECODE_MIN_MEM_POOL_SIZE < 2 * sizeof(uint32_t)) {
+      return QCBOR_ERR_MEM_POOL_SIZE;
    }
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   // The pool size and free offset packed in to the beginning of pool
+   // memory are only 32-bits. This check will optimize out on 32-bit
+   // machines.
+   if(Pool.len > UINT32_MAX) {
+      return QCBOR_ERR_MEM_POOL_SIZE;
+   }
+
+   // This checks that the pool buffer given is big enough.
+   if(MemPool_Pack(Pool, QCBOR_DECODE_MIN_MEM_POOL_SIZE)) {
+      return QCBOR_ERR_MEM_POOL_SIZE;
+   }
+
+   QCBORDecode_SetUpAllocator(pMe, MemPool_Function, Pool.ptr, bAllStrings);
+
+   return QCBOR_SUCCESS;
 }
+#endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+
 
 
 /**
- * @brief Get an item by label to match a tag specification.
+ * @brief Find the end of a map or array by scanning rather than decoding.
  *
- * @param[in] pMe      The decode context.
- * @param[in] szLabel   The label to search map for.
- * @param[in] TagSpec  The tag number specification to match.
- * @param[out] pItem   The item found.
+ * @param[in] pMe          The decode context.
+ * @param[in] pItem        The map or array just decoded.
+ * @param[out] puEndOffset Offset just past the end of the map or array.
  *
- * This finds the item with the given label in currently open
- * map. Then checks that its tag number and types matches the tag
- * specification. If not, an error is set in the decode context.
+ * @returns QCBOR_SUCCESS or a not-well-formed error.
+ *
+ * The input must be positioned just after the head of @c pItem. Only
+ * heads are decoded and string payloads are jumped over. No
+ * QCBORItem is filled in, no tag content is processed and no string
+ * allocation is done. The input position is left at the end of the
+ * map or array. The nesting limit is the same as for decoding,
+ * except that when nesting storage allows more levels than the
+ * scanner can track, this returns success without moving and without
+ * setting @c *puEndOffset when it runs out.
  */
-static void
-QCBORDecode_GetTaggedItemInMapSZ(QCBORDecodeContext          *pMe,
-                                 const char                  *szLabel,
-                                 const QCBOR_Private_TagSpec  TagSpec,
-                                 QCBORItem                   *pItem)
+static QCBORError
+QCBORDecode_Private_SkipContents(QCBORDecodeContext *pMe,
+                                 const QCBORItem    *pItem,
+                                 size_t             *puEndOffset)
 {
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
+   QCBORError uErr;
+   uint64_t   uCount;
+   uint8_t    uFlags;
+   size_t     uIndexCount;
+   size_t     uErrorOffset;
+   size_t     uStart;
+   int        nMaxLevel;
+   bool       bLimited;
+
+   uFlags = pItem->uDataType == QCBOR_TYPE_ARRAY ? 0 : QCBOR_SCAN_IS_MAP;
+   if(QCBORItem_IsIndefiniteLengthMapOrArray(*pItem)) {
+      uCount = QCBOR_SCAN_INDEFINITE;
+   } else if(pItem->uDataType == QCBOR_TYPE_MAP) {
+      uCount = (uint64_t)pItem->val.uCount * 2;
+   } else {
+      /* Arrays, and maps in QCBOR_DECODE_MODE_MAP_AS_ARRAY where the
+       * count is already of labels and values. */
+      uCount = pItem->val.uCount;
+   }
+
+   /* The scanner tracks at most QCBOR_MAX_ARRAY_NESTING levels.
+    * Caller-provided nesting storage may allow more. */
+   nMaxLevel = pMe->nesting.uMaxLevel - DecodeNesting_GetCurrentLevel(&(pMe->nesting));
+   bLimited  = nMaxLevel > QCBOR_MAX_ARRAY_NESTING;
+   if(bLimited) {
+      nMaxLevel = QCBOR_MAX_ARRAY_NESTING;
+   }
+
+   uStart      = UsefulInputBuf_Tell(&(pMe->InBuf));
+   uIndexCount = 0;
+   uErr = QCBOR_Private_Scan(&(pMe->InBuf),
+                             uCount,
+                             uFlags,
+                             nMaxLevel,
+                             NULL,
+                             0,
+                             &uIndexCount,
+                             &uErrorOffset);
+   if(uErr == QCBOR_SUCCESS) {
+      *puEndOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
+   } else if(uErr == QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP && bLimited) {
+      /* Too deep for the scanner, but not for decoding. Leave
+       * *puEndOffset alone so the caller decodes through it. */
+      UsefulInputBuf_Seek(&(pMe->InBuf), uStart);
+      uErr = QCBOR_SUCCESS;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   return uErr;
 }
 
 
 /**
- * @brief Semi-private to get an string by label to match a tag specification.
+ * @brief Consume an entire map or array including its contents.
  *
- * @param[in] pMe      The decode context.
- * @param[in] nLabel   The label to search map for.
- * @param[in] TagSpec  The tag number specification to match.
- * @param[out] pString   The string found.
+ * @param[in]  pMe              The decoder context.
+ * @param[in]  pItemToConsume   The array/map whose contents are to be
+ *                              consumed.
+ * @param[out] pbBreak          Set to true if extra break was consumed.
+ *                              Can be NULL.
+ * @param[out] puNextNestLevel  The next nesting level after the item was
+ *                              fully consumed.
  *
- * This finds the string  with the given label in currently open
- * map. Then checks that its tag number and types matches the tag
- * specification. If not, an error is set in the decode context.
+ * This may be called when @c pItemToConsume is not an array or
+ * map. In that case, this is just a pass through for @c puNextNestLevel
+ * since there is nothing to do.
  */
-void
-QCBORDecode_Private_GetTaggedStringInMapN(QCBORDecodeContext         *pMe,
-                                          const int64_t               nLabel,
-                                          const QCBOR_Private_TagSpec TagSpec,
-                                          UsefulBufC                 *pString)
+static QCBORError
+QCBORDecode_Private_ConsumeItem(QCBORDecodeContext *pMe,
+                                const QCBORItem    *pItemToConsume,
+                                bool               *pbBreak,
+                                uint8_t            *puNextNestLevel)
 {
-   QCBORItem Item;
-   QCBORDecode_GetTaggedItemInMapN(pMe, nLabel, TagSpec, &Item);
-   if(pMe->uLastError == QCBOR_SUCCESS) {
-      *pString = Item.val.string;
+   QCBORError uReturn;
+   QCBORItem  Item;
+
+   /* If it is a map or array, this will tell if it is empty. */
+   const bool bIsEmpty = (pItemToConsume->uNextNestLevel <= pItemToConsume->uNestingLevel);
+
+   if(QCBORItem_IsMapOrArray(*pItemToConsume) && !bIsEmpty) {
+      /* There is only real work to do for non-empty maps and arrays */
+
+      size_t uEndOffset = SIZE_MAX;
+
+      if(pMe->pContainerIndex != NULL) {
+         const QCBORContainerIndexEntry *pEntry;
+         pEntry = QCBORDecode_Private_LookUpContainer(pMe, UsefulInputBuf_Tell(&(pMe->InBuf)));
+         if(pEntry != NULL &&
+            pEntry->uEndOffset <= UsefulInputBuf_GetBufferLength(&(pMe->InBuf))) {
+            uEndOffset = pEntry->uEndOffset;
+         }
+      }
+
+      if(uEndOffset == SIZE_MAX && pMe->bFastSkip) {
+         uReturn = QCBORDecode_Private_SkipContents(pMe, pItemToConsume, &uEndOffset);
+         if(uReturn != QCBOR_SUCCESS) {
+            goto Done;
+         }
+      }
+
+      if(uEndOffset != SIZE_MAX) {
+         /* Jump to the end and ascend out of the map or array as if
+          * the last item in it was just decoded. This is the same as
+          * the loop below with the same effect on the nesting levels
+          * of the break, if any.
+          */
+         UsefulInputBuf_Seek(&(pMe->InBuf), uEndOffset);
+         if(pbBreak) {
+            *pbBreak = QCBORItem_IsIndefiniteLengthMapOrArray(*pItemToConsume);
+         }
+         DecodeNesting_Ascend(&(pMe->nesting));
+         uReturn = QCBORDecode_Private_NestLevelAscender(pMe, true, pbBreak);
+         if(uReturn != QCBOR_SUCCESS) {
+            goto Done;
+         }
+         if(DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting))) {
+            *puNextNestLevel = 0;
+         } else {
+            *puNextNestLevel = DecodeNesting_GetCurrentLevel(&(pMe->nesting));
+         }
+         goto Done;
+      }
+
+      /* This works for definite- and indefinite-length maps and
+       * arrays by using the nesting level
+       */
+      do {
+         uReturn = QCBORDecode_Private_GetNextMapOrArray(pMe, pbBreak, &Item);
+         if(QCBORDecode_IsUnrecoverableError(uReturn) ||
+            uReturn == QCBOR_ERR_NO_MORE_ITEMS) {
+            goto Done;
+         }
+      } while(Item.uNextNestLevel >= pItemToConsume->uNextNestLevel);
+
+      *puNextNestLevel = Item.uNextNestLevel;
+
+      uReturn = QCBOR_SUCCESS;
+
+   } else {
+      /* pItemToConsume is not a map or array. Just pass the nesting
+       * level through. */
+      *puNextNestLevel = pItemToConsume->uNextNestLevel;
+
+      uReturn = QCBOR_SUCCESS;
    }
+
+Done:
+    return uReturn;
 }
 
 
-/**
- * @brief Semi-private to get an string by label to match a tag specification.
- *
- * @param[in] pMe      The decode context.
- * @param[in] szLabel   The label to search map for.
- * @param[in] TagSpec  The tag number specification to match.
- * @param[out] pString   The string found.
- *
- * This finds the string  with the given label in currently open
- * map. Then checks that its tag number and types matches the tag
- * specification. If not, an error is set in the decode context.
- */void
-QCBORDecode_Private_GetTaggedStringInMapSZ(QCBORDecodeContext         *pMe,
-                                           const char *                szLabel,
-                                           const QCBOR_Private_TagSpec TagSpec,
-                                           UsefulBufC                 *pString)
+/* The work of QCBORDecode_VGetNextConsume() without streaming rollback */
+static void
+QCBORDecode_Private_VGetNextConsume(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 {
-   QCBORItem Item;
-   QCBORDecode_GetTaggedItemInMapSZ(pMe, szLabel, TagSpec, &Item);
+   QCBORDecode_VGetNext(pMe, pDecodedItem);
+
    if(pMe->uLastError == QCBOR_SUCCESS) {
-      *pString = Item.val.string;
+      pMe->uLastError = (uint8_t)QCBORDecode_Private_ConsumeItem(pMe, pDecodedItem, NULL,
+         &pDecodedItem->uNextNestLevel);
    }
 }
 
@@ -3958,92 +5288,67 @@ QCBORDecode_Private_GetTaggedStringInMapSZ(QCBORDecodeContext         *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetItemsInMap(QCBORDecodeContext *pMe, QCBORItem *pItemList)
+QCBORDecode_VGetNextConsume(QCBORDecodeContext *pMe, QCBORItem *pDecodedItem)
 {
-   QCBORError uErr = QCBORDecode_Private_MapSearch(pMe, pItemList, NULL, NULL);
-   pMe->uLastError = (uint8_t)uErr;
-}
+   if(pMe->bStreaming) {
+      /* The whole map or array has to be in the input */
+      QCBORDecodeNestingSave SaveNesting;
+      const UsefulInputBuf   SaveInBuf = pMe->InBuf;
+
+      DecodeNesting_Save(&(pMe->nesting), &SaveNesting);
+      QCBORDecode_Private_VGetNextConsume(pMe, pDecodedItem);
+      pMe->uLastError = (uint8_t)QCBORDecode_Private_StreamingRollback(pMe,
+                                                                       (QCBORError)pMe->uLastError,
+                                                                       &SaveInBuf,
+                                                                       &SaveNesting);
+   } else {
+      QCBORDecode_Private_VGetNextConsume(pMe, pDecodedItem);
+   }
+}
+
 
 /*
  * Public function, see header qcbor/qcbor_decode.h file
  */
-void
-QCBORDecode_GetItemsInMapWithCallback(QCBORDecodeContext *pMe,
-                                      QCBORItem          *pItemList,
-                                      void               *pCallbackCtx,
-                                      QCBORItemCallback   pfCB)
+QCBORError
+QCBORDecode_EndCheck(QCBORDecodeContext *pMe)
 {
-   MapSearchCallBack CallBack;
-   CallBack.pCBContext = pCallbackCtx;
-   CallBack.pfCallback = pfCB;
+   size_t     uCursorOffset;
+   QCBORError uErr;
 
-   QCBORError uErr = QCBORDecode_Private_MapSearch(pMe, pItemList, NULL, &CallBack);
+   uErr = QCBORDecode_GetError(pMe);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
+   }
 
-   pMe->uLastError = (uint8_t)uErr;
+   uCursorOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
+
+   if(uCursorOffset == UsefulInputBuf_GetBufferLength(&(pMe->InBuf))) {
+      return QCBOR_ERR_NO_MORE_ITEMS;
+   }
+
+   return QCBOR_SUCCESS;
 }
 
 
 /**
- * @brief Search for a map/array by label and enter it
- *
- * @param[in] pMe  The decode context.
- * @param[in] pSearch The map/array to search for.
+ * @brief Rewind cursor to start as if map or array were just entered.
  *
- * @c pSearch is expected to contain one item of type map or array
- * with the label specified. The current bounded map will be searched for
- * this and if found  will be entered.
+ * @param[in]  pMe   The decoding context
  *
- * If the label is not found, or the item found is not a map or array,
- * the error state is set.
+ * This affects the nesting tracking and the UsefulInputBuf.
  */
 static void
-QCBORDecode_Private_SearchAndEnter(QCBORDecodeContext *pMe, QCBORItem pSearch[])
+QCBORDecode_Private_RewindMapOrArray(QCBORDecodeContext *pMe)
 {
-   // The first item in pSearch is the one that is to be
-   // entered. It should be the only one filled in. Any other
-   // will be ignored unless it causes an error.
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
-   }
-
-   MapSearchInfo Info;
-   pMe->uLastError = (uint8_t)QCBORDecode_Private_MapSearch(pMe, pSearch, &Info, NULL);
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
-   }
-
-   if(pSearch->uDataType == QCBOR_TYPE_NONE) {
-      pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
-      return;
-   }
-
-
-   /* The map or array was found. Now enter it.
-    *
-    * QCBORDecode_EnterBoundedMapOrArray() used here, requires the
-    * next item for the pre-order traversal cursor to be the map/array
-    * found by MapSearch(). The next few lines of code force the
-    * cursor to that.
-    *
-    * There is no need to retain the old cursor because
-    * QCBORDecode_EnterBoundedMapOrArray() will set it to the
-    * beginning of the map/array being entered.
-    *
-    * The cursor is forced by: 1) setting the input buffer position to
-    * the item offset found by MapSearch(), 2) setting the map/array
-    * counter to the total in the map/array, 3) setting the nesting
-    * level. Setting the map/array counter to the total is not
-    * strictly correct, but this is OK because this cursor only needs
-    * to be used to get one item and MapSearch() has already found it
-    * confirming it exists.
-    */
-   UsefulInputBuf_Seek(&(pMe->InBuf), Info.uStartOffset);
+   /* Reset nesting tracking to the deepest bounded level */
+   DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
 
    DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
 
-   DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
-
-   QCBORDecode_Private_EnterBoundedMapOrArray(pMe, pSearch->uDataType, NULL);
+   /* Reposition traversal cursor to the start of the map/array */
+   UsefulInputBuf_Seek(&(pMe->InBuf),
+                       DecodeNesting_GetMapOrArrayStart(&(pMe->nesting)));
 }
 
 
@@ -4051,512 +5356,543 @@ QCBORDecode_Private_SearchAndEnter(QCBORDecodeContext *pMe, QCBORItem pSearch[])
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_EnterMapFromMapN(QCBORDecodeContext *pMe, int64_t nLabel)
+QCBORDecode_Rewind(QCBORDecodeContext *pMe)
 {
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
-   OneItemSearch[0].label.int64 = nLabel;
-   OneItemSearch[0].uDataType   = QCBOR_TYPE_MAP;
-   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE;
+   if(DecodeNesting_IsBounded(&(pMe->nesting))) {
+      /* In a bounded map, array or bstr-wrapped CBOR */
 
-   /* The map to enter was found, now finish off entering it. */
-   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
-}
+      if(DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_BYTE_STRING)) {
+         /* In bstr-wrapped CBOR. */
 
+         /* Reposition traversal cursor to start of wrapping byte string */
+         UsefulInputBuf_Seek(&(pMe->InBuf),
+                             DecodeNesting_Bounded(&(pMe->nesting))->bs.uBstrStartOffset);
+         DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_EnterMapFromMapSZ(QCBORDecodeContext *pMe, const char  *szLabel)
-{
-#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
-   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
-   OneItemSearch[0].uDataType    = QCBOR_TYPE_MAP;
-   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE;
+      } else {
+         /* In a map or array */
+         QCBORDecode_Private_RewindMapOrArray(pMe);
+      }
 
-   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
-#else
-   (void)szLabel;
-   pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
-#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
-}
+   } else {
+      /* Not in anything bounded */
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_EnterArrayFromMapN(QCBORDecodeContext *pMe, int64_t nLabel)
-{
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
-   OneItemSearch[0].label.int64 = nLabel;
-   OneItemSearch[0].uDataType   = QCBOR_TYPE_ARRAY;
-   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE;
+      /* Reposition traversal cursor to the start of input CBOR */
+      UsefulInputBuf_Seek(&(pMe->InBuf), 0ULL);
 
-   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
+      /* Reset nesting tracking to beginning of input. */
+      DecodeNesting_Init(&(pMe->nesting));
+   }
+
+   pMe->uLastError = QCBOR_SUCCESS;
 }
 
+
 /*
- * Public function, see header qcbor/qcbor_decode.h file
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
  */
 void
-QCBORDecode_EnterArrayFromMapSZ(QCBORDecodeContext *pMe, const char  *szLabel)
+QCBORDecode_SaveCursor(QCBORDecodeContext *pMe, QCBORCursor *pCursor)
 {
-#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
-   QCBORItem OneItemSearch[2];
-   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
-   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
-   OneItemSearch[0].uDataType    = QCBOR_TYPE_ARRAY;
-   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE;
+   /* Unlike decoding ahead, restoring a cursor can exit anything, so
+    * all levels are saved */
+   pCursor->bValid = DecodeNesting_SaveFrom(&(pMe->nesting), 0, false, &(pCursor->Nesting));
+   if(!pCursor->bValid) {
+      pMe->uLastError = QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP;
+      return;
+   }
+   pCursor->uOffset            = (QCBOROffset)UsefulInputBuf_Tell(&(pMe->InBuf));
+   pCursor->uMapEndOffsetCache = pMe->uMapEndOffsetCache;
 
-   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
-#else
-   (void)szLabel;
-   pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
-#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   /* The input length is only less than the whole input in
+    * byte-string wrapped CBOR. Otherwise it's not saved so that
+    * input added in streaming mode isn't lost on restore. */
+   pCursor->uInputLen = QCBOR_OFFSET_MAX;
+   for(uint8_t u = 1; u <= pCursor->Nesting.uCurrent; u++) {
+      if(pCursor->Nesting.puLevelTypes[u] == QCBOR_TYPE_BYTE_STRING) {
+         pCursor->uInputLen = (QCBOROffset)UsefulInputBuf_GetBufferLength(&(pMe->InBuf));
+         break;
+      }
+   }
 }
 
 
-/**
- * @brief Semi-private to do the the work for EnterMap() and EnterArray().
- *
- * @param[in] pMe     The decode context
- * @param[in] uType   QCBOR_TYPE_MAP or QCBOR_TYPE_ARRAY.
- * @param[out] pItem  The data item for the map or array entered.
- *
- * The next item in the traversal must be a map or array.  This
- * consumes that item and does the book keeping to enter the map or
- * array.
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
  */
 void
-QCBORDecode_Private_EnterBoundedMapOrArray(QCBORDecodeContext *pMe,
-                                           const uint8_t       uType,
-                                           QCBORItem          *pItem)
+QCBORDecode_RestoreCursor(QCBORDecodeContext *pMe, const QCBORCursor *pCursor)
 {
-   QCBORError uErr;
-   QCBORItem  Item;
-
-   /* Must only be called on maps and arrays. */
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      // Already in error state; do nothing.
+   if(!pCursor->bValid) {
+      pMe->uLastError = QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP;
       return;
    }
-
-   /* Get the data item that is the map or array being entered. */
-   uErr = QCBORDecode_GetNext(pMe, &Item);
-   if(uErr != QCBOR_SUCCESS) {
-      if(pItem) {
-         *pItem = Item;
-      }
-      goto Done;
+   DecodeNesting_Restore(&(pMe->nesting), &(pCursor->Nesting));
+   if(pCursor->uInputLen != QCBOR_OFFSET_MAX) {
+      /* Before seeking so the seek is checked against it */
+      UsefulInputBuf_SetBufferLength(&(pMe->InBuf), pCursor->uInputLen);
    }
+   UsefulInputBuf_Seek(&(pMe->InBuf), pCursor->uOffset);
+   pMe->uMapEndOffsetCache = pCursor->uMapEndOffsetCache;
+   pMe->uLastError         = QCBOR_SUCCESS;
+}
+
+
+
+
+typedef struct {
+   void               *pCBContext;
+   QCBORItemCallback   pfCallback;
+   size_t              uItemOffset; /* Of the item passed to pfCallback */
+} MapSearchCallBack;
+
+typedef struct {
+   size_t     uStartOffset;
+   QCBORCount uItemCount;
+} MapSearchInfo;
 
-   uint8_t uItemDataType = Item.uDataType;
+
+/* Fingerprint the label of pItem. Fails for label types that are
+ * never matched. */
+static QCBORError
+QCBOR_Private_FingerprintLabel(const QCBORItem *pItem, QCBORLabelFingerprint *pLabel)
+{
+   pLabel->uLabelType = pItem->uLabelType;
+   pLabel->String     = NULLUsefulBufC;
+   switch(pItem->uLabelType) {
+      case QCBOR_TYPE_INT64:
+         pLabel->uKey = (uint64_t)pItem->label.int64;
+         break;
 
 #ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
-   if(uItemDataType == QCBOR_TYPE_MAP_AS_ARRAY ) {
-      uItemDataType = QCBOR_TYPE_ARRAY;
-   }
+      case QCBOR_TYPE_UINT64:
+         pLabel->uKey = pItem->label.uint64;
+         break;
+
+      case QCBOR_TYPE_TEXT_STRING:
+      case QCBOR_TYPE_BYTE_STRING:
+         /* FNV-1a hash so most comparisons are of just the key */
+         pLabel->String = pItem->label.string;
+         pLabel->uKey   = 0xcbf29ce484222325ULL;
+         for(size_t i = 0; i < pItem->label.string.len; i++) {
+            pLabel->uKey ^= ((const uint8_t *)pItem->label.string.ptr)[i];
+            pLabel->uKey *= 0x100000001b3ULL;
+         }
+         break;
 #endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
-   if(uItemDataType != uType) {
-      uErr = QCBOR_ERR_UNEXPECTED_TYPE;
-      goto Done;
+      default:
+         /* The map decode already rejects other label types */
+         return QCBOR_ERR_MAP_LABEL_TYPE;
    }
 
-   QCBORDecode_Private_CopyTags(pMe, &Item);
+   return QCBOR_SUCCESS;
+}
 
 
-   const bool bIsEmpty = (Item.uNextNestLevel <= Item.uNestingLevel);
-   if(bIsEmpty) {
-      if(DecodeNesting_IsCurrentDefiniteLength(&(pMe->nesting))) {
-         // Undo decrement done by QCBORDecode_GetNext() so the the
-         // the decrement when exiting the map/array works correctly
-         pMe->nesting.pCurrent->u.ma.uCountCursor++;
-      }
-      // Special case to increment nesting level for zero-length maps
-      // and arrays entered in bounded mode.
-      DecodeNesting_Descend(&(pMe->nesting), uType);
+static int
+QCBOR_Private_CompareLabels(const QCBORLabelFingerprint *pLabel1,
+                            const QCBORLabelFingerprint *pLabel2)
+{
+   if(pLabel1->uKey != pLabel2->uKey) {
+      return pLabel1->uKey < pLabel2->uKey ? -1 : 1;
    }
+   if(pLabel1->uLabelType != pLabel2->uLabelType) {
+      return pLabel1->uLabelType < pLabel2->uLabelType ? -1 : 1;
+   }
+   return UsefulBuf_Compare(pLabel1->String, pLabel2->String);
+}
 
-   pMe->uMapEndOffsetCache = QCBOR_MAP_OFFSET_CACHE_INVALID;
 
-   uErr = DecodeNesting_EnterBoundedMapOrArray(&(pMe->nesting), bIsEmpty,
-                                               UsefulInputBuf_Tell(&(pMe->InBuf)));
+/* Whether the bounded map has a table from QCBORDecode_SetLabelIndex() */
+static bool
+QCBORDecode_Private_HasLabelIndex(const QCBORDecodeContext *pMe)
+{
+   return pMe->pLabelIndex != NULL &&
+          pMe->uLabelIndexMap != QCBOR_NON_BOUNDED_OFFSET &&
+          DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_MAP) &&
+          DecodeNesting_GetMapOrArrayStart(&(pMe->nesting)) == pMe->uLabelIndexMap;
+}
 
-   if(pItem != NULL) {
-      *pItem = Item;
-   }
 
-Done:
-   pMe->uLastError = (uint8_t)uErr;
-}
+/* Look a label up in the table from QCBORDecode_SetLabelIndex().
+ * The table always has an empty slot to end the probing. */
+static const QCBORLabelIndexEntry *
+QCBORDecode_Private_LookUpLabel(const QCBORDecodeContext *pMe, const QCBORItem *pSearch)
+{
+   QCBORLabelFingerprint       Label;
+   const QCBORLabelIndexEntry *pEntry;
+   size_t                      uSlot;
 
+   if(QCBOR_Private_FingerprintLabel(pSearch, &Label) != QCBOR_SUCCESS) {
+      return NULL;
+   }
 
-/**
- * @brief Exit a bounded map, array or bstr (semi-private).
- *
- * @param[in] pMe         Decode context.
- * @param[in] uEndOffset  The input buffer offset of the end of item exited.
- *
- * @returns  QCBOR_SUCCESS or an error code.
- *
- * This is the common work for exiting a level that is a bounded map,
- * array or bstr wrapped CBOR.
- *
- * One chunk of work is to set up the pre-order traversal so it is at
- * the item just after the bounded map, array or bstr that is being
- * exited. This is somewhat complex.
- *
- * The other work is to level-up the bounded mode to next higest
- * bounded mode or the top level if there isn't one.
- */
-static QCBORError
-QCBORDecode_Private_ExitBoundedLevel(QCBORDecodeContext *pMe,
-                                     const uint32_t      uEndOffset)
-{
-   QCBORError uErr;
-
-   /*
-    * First the pre-order-traversal byte offset is positioned to the
-    * item just after the bounded mode item that was just consumed.
-    */
-   UsefulInputBuf_Seek(&(pMe->InBuf), uEndOffset);
-
-   /*
-    * Next, set the current nesting level to one above the bounded
-    * level that was just exited.
-    *
-    * DecodeNesting_CheckBoundedType() is always called before this
-    * and makes sure pCurrentBounded is valid.
-    */
-   DecodeNesting_LevelUpCurrent(&(pMe->nesting));
-
-   /*
-    * This does the complex work of leveling up the pre-order
-    * traversal when the end of a map or array or another bounded
-    * level is reached.  It may do nothing, or ascend all the way to
-    * the top level.
-    */
-   uErr = QCBORDecode_Private_NestLevelAscender(pMe, false, NULL);
-   if(uErr != QCBOR_SUCCESS) {
-      goto Done;
+   uSlot = (size_t)(Label.uKey % pMe->uLabelIndexSize);
+   while(1) {
+      pEntry = &(pMe->pLabelIndex[uSlot]);
+      if(pEntry->Label.uLabelType == QCBOR_TYPE_NONE) {
+         return NULL;
+      }
+      if(QCBOR_Private_CompareLabels(&(pEntry->Label), &Label) == 0) {
+         return pEntry;
+      }
+      uSlot++;
+      if(uSlot == pMe->uLabelIndexSize) {
+         uSlot = 0;
+      }
    }
-
-   /*
-    * This makes the next highest bounded level the current bounded
-    * level. If there is no next highest level, then no bounded mode
-    * is in effect.
-    */
-   DecodeNesting_LevelUpBounded(&(pMe->nesting));
-
-   pMe->uMapEndOffsetCache = QCBOR_MAP_OFFSET_CACHE_INVALID;
-
-Done:
-   return uErr;
 }
 
 
 /**
- * @brief Get started exiting a map or array (semi-private)
- *
- * @param[in] pMe  The decode context
- * @param[in] uType  QCBOR_TYPE_ARRAY or QCBOR_TYPE_MAP
- *
- * This does some work for map and array exiting (but not
- * bstr exiting). Then QCBORDecode_Private_ExitBoundedLevel()
- * is called to do the rest.
+ * @brief QCBORDecode_Private_MapSearch() using the label index.
+ *
+ * @param[in] pMe                  The decode context to search.
+ * @param[in,out] pItemArray       The items to search for and the items found.
+ * @param[out] pInfo               Offset of the item found or @c NULL.
+ * @param[out] puFoundItemBitMap   Which of @c pItemArray were found.
+ *
+ * Each item is looked up and decoded by itself rather than going
+ * through the whole map. The items found are the same as for the
+ * full search because the map was gone through when it was
+ * indexed. The errors for each item are checked in the same order as
+ * the full search does, item error and type before duplicate, but the
+ * items are checked in the order of @c pItemArray rather than map
+ * order. When there are errors for more than one of them, the one
+ * returned may not be the one the full search would return.
  */
-void
-QCBORDecode_Private_ExitBoundedMapOrArray(QCBORDecodeContext *pMe,
-                                          const uint8_t       uType)
+static QCBORError
+QCBORDecode_Private_IndexSearch(QCBORDecodeContext *pMe,
+                                QCBORItem          *pItemArray,
+                                MapSearchInfo      *pInfo,
+                                uint64_t           *puFoundItemBitMap)
 {
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      /* Already in error state; do nothing. */
-      return;
-   }
+   QCBORError                  uReturn;
+   QCBORItem                   Item;
+   QCBORDecodeNestingSave      SaveNesting;
+   const QCBORLabelIndexEntry *pEntry;
+   const size_t                uSavePos = UsefulInputBuf_Tell(&(pMe->InBuf));
 
-   QCBORError uErr;
+   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
 
-   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), uType)) {
-      uErr = QCBOR_ERR_EXIT_MISMATCH;
-      goto Done;
-   }
+   uReturn = QCBOR_SUCCESS;
+   for(int nIndex = 0; pItemArray[nIndex].uLabelType != QCBOR_TYPE_NONE; nIndex++) {
+      pEntry = QCBORDecode_Private_LookUpLabel(pMe, &pItemArray[nIndex]);
+      if(pEntry == NULL) {
+         continue;
+      }
 
-   /*
-    Have to set the offset to the end of the map/array
-    that is being exited. If there is no cached value,
-    from previous map search, then do a dummy search.
-    */
-   if(pMe->uMapEndOffsetCache == QCBOR_MAP_OFFSET_CACHE_INVALID) {
-      QCBORItem Dummy;
-      Dummy.uLabelType = QCBOR_TYPE_NONE;
-      uErr = QCBORDecode_Private_MapSearch(pMe, &Dummy, NULL, NULL);
-      if(uErr != QCBOR_SUCCESS) {
-         goto Done;
+      /* Position the cursor at the item the same way as
+       * QCBORDecode_Private_SearchAndEnter() */
+      DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
+      DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
+      UsefulInputBuf_Seek(&(pMe->InBuf), pEntry->uOffset);
+
+      /* Errors were found when indexing except for recoverable ones
+       * on the item which are returned the same as by the full
+       * search. */
+      uReturn = QCBORDecode_Private_GetNextTagContent(pMe, &Item);
+      if(uReturn != QCBOR_SUCCESS) {
+         break;
+      }
+      if(!QCBORItem_MatchType(Item, pItemArray[nIndex])) {
+         uReturn = QCBOR_ERR_UNEXPECTED_TYPE;
+         break;
+      }
+      /* The full search finds the duplicate after the first one */
+      if(pEntry->bDuplicate) {
+         uReturn = QCBOR_ERR_DUPLICATE_LABEL;
+         break;
+      }
+
+      pItemArray[nIndex] = Item;
+      *puFoundItemBitMap |= 0x01ULL << nIndex;
+      if(pInfo != NULL) {
+         pInfo->uStartOffset = pEntry->uOffset;
       }
    }
 
-   uErr = QCBORDecode_Private_ExitBoundedLevel(pMe, pMe->uMapEndOffsetCache);
+   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
+   UsefulInputBuf_Seek(&(pMe->InBuf), uSavePos);
 
-Done:
-   pMe->uLastError = (uint8_t)uErr;
+   return uReturn;
 }
 
 
 /**
- * @brief The main work of entering some byte-string wrapped CBOR.
+ * @brief Search a map for a set of items.
  *
- * @param[in] pMe             The decode context.
- * @param[in] pItem           The byte string item.
- * @param[in] uTagRequirement One of @c QCBOR_TAG_REQUIREMENT_XXX
- * @param[out] pBstr          Pointer and length of byte string entered.
+ * @param[in]  pMe           The decode context to search.
+ * @param[in,out] pItemArray The items to search for and the items found.
+ * @param[out] pInfo         Several bits of meta-info returned by search.
+ * @param[in] pCallBack      Callback object or @c NULL.
  *
- * This is called once the byte string item has been decoded to do all
- * the book keeping for descending one nesting level into the
- * wrapped CBOR.
+ * @retval QCBOR_ERR_NOT_ENTERED     Trying to search without entering a map.
  *
- * See QCBORDecode_EnterBstrWrapped() for details on uTagRequirement.
+ * @retval QCBOR_ERR_DUPLICATE_LABEL Duplicate items (items with the same label)
+ *                                   were found for one of the labels being
+ *                                   search for. This duplicate detection is
+ *                                   only performed for items in pItemArray,
+ *                                   not every item in the map.
+ *
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE A label was matched, but the type was
+ *                                   wrong for the matchd label.
+ *
+ * @retval Also errors returned by QCBORDecode_GetNext().
+ *
+ * On input, @c pItemArray contains a list of labels and data types of
+ * items to be found.
+ *
+ * On output, the fully retrieved items are filled in with values and
+ * such. The label was matched, so it never changes.
+ *
+ * If an item was not found, its data type is set to @ref QCBOR_TYPE_NONE.
+ *
+ * This also finds the ends of maps and arrays when they are exited.
  */
-static void
-QCBORDecode_Private_EnterBstrWrapped(QCBORDecodeContext *pMe,
-                                     const QCBORItem    *pItem,
-                                     const uint8_t       uTagRequirement,
-                                     UsefulBufC         *pBstr)
+static QCBORError
+QCBORDecode_Private_MapSearch(QCBORDecodeContext *pMe,
+                              QCBORItem          *pItemArray,
+                              MapSearchInfo      *pInfo,
+                              MapSearchCallBack  *pCallBack)
 {
-   QCBORError uErr;
-   size_t     uStartOfBstr;
-   size_t     uEndOfBstr;
-   size_t     uPreviousLength;
-
-   const QCBOR_Private_TagSpec TagSpec =
-      {
-         uTagRequirement,
-         {QBCOR_TYPE_WRAPPED_CBOR, QBCOR_TYPE_WRAPPED_CBOR_SEQUENCE, QCBOR_TYPE_NONE},
-         {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
-      };
+   QCBORError uReturn;
+   uint64_t   uFoundItemBitMap = 0;
 
-   if(pBstr) {
-      *pBstr = NULLUsefulBufC;
+   if(pInfo != NULL) {
+      pInfo->uItemCount = 0;
+      pInfo->uStartOffset = QCBOR_OFFSET_MAX;
    }
 
    if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
-   }
-
-   if(pItem->uDataAlloc) {
-      uErr = QCBOR_ERR_CANNOT_ENTER_ALLOCATED_STRING;
-      goto Done;
-   }
-
-   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
-   if(uErr != QCBOR_SUCCESS) {
-      goto Done;
+      uReturn = pMe->uLastError;
+      goto Done2;
    }
 
-   if(DecodeNesting_IsCurrentDefiniteLength(&(pMe->nesting))) {
-      /* Reverse the decrement done by GetNext() for the bstr so the
-       * increment in QCBORDecode_NestLevelAscender() called by
-       * ExitBoundedLevel() will work right.
-       */
-      DecodeNesting_ReverseDecrement(&(pMe->nesting));
+   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_MAP) &&
+      pItemArray->uLabelType != QCBOR_TYPE_NONE) {
+      /* QCBOR_TYPE_NONE as first item indicates just looking for the
+       * end of an array, so don't give error. */
+      uReturn = QCBOR_ERR_MAP_NOT_ENTERED;
+      goto Done2;
    }
 
-   if(pBstr) {
-      *pBstr = pItem->val.string;
+   if(DecodeNesting_IsBoundedEmpty(&(pMe->nesting))) {
+      /* It is an empty bounded array or map */
+      if(pItemArray->uLabelType == QCBOR_TYPE_NONE) {
+         /* Just trying to find the end of the map or array */
+         pMe->uMapEndOffsetCache = DecodeNesting_GetMapOrArrayStart(&(pMe->nesting));
+         uReturn = QCBOR_SUCCESS;
+      } else {
+         /* Nothing is ever found in an empty array or map. All items
+          * are marked as not found below. */
+         uReturn = QCBOR_SUCCESS;
+      }
+      goto Done2;
    }
 
-   /* This saves the current length of the UsefulInputBuf and then
-    * narrows the UsefulInputBuf to start and length of the wrapped
-    * CBOR that is being entered.
-    *
-    * Most of these calls are simple inline accessors so this doesn't
-    * amount to much code.
-    */
-
-   uPreviousLength = UsefulInputBuf_GetBufferLength(&(pMe->InBuf));
-   /* This check makes the cast of uPreviousLength to uint32_t below safe. */
-   if(uPreviousLength >= QCBOR_MAX_DECODE_INPUT_SIZE) {
-      uErr = QCBOR_ERR_INPUT_TOO_LARGE;
-      goto Done;
+   if(pCallBack == NULL &&
+      pItemArray->uLabelType != QCBOR_TYPE_NONE &&
+      QCBORDecode_Private_HasLabelIndex(pMe)) {
+      uReturn = QCBORDecode_Private_IndexSearch(pMe, pItemArray, pInfo, &uFoundItemBitMap);
+      goto Done2;
    }
 
-   uStartOfBstr = UsefulInputBuf_PointerToOffset(&(pMe->InBuf), pItem->val.string.ptr);
-
-   if(uStartOfBstr == SIZE_MAX && pItem->val.string.len == 0) {
-      /* When the bstr is zero-length, uStartOfBstr is the start
-       * of the next item. It is never used because the bstr
-       * is zero-length. When the zero-length bstr is
-       * at the end of the input uStartOfBstr, there is no next item
-       * so UsefulInputBuf_PointerToOffset() returns SIZE_MAX.
-       * It is still a legitimate input that must be handled,
-       * so this points uStartOfBstr to the current position.
-       */
-      uStartOfBstr = UsefulInputBuf_Tell(&(pMe->InBuf));
-   } else {
-      /* SIZE_MAX > QCBOR_MAX_DECODE_INPUT_SIZE so this catches the
-       * case where pItem->val.string.len != 0 */
-      if(uStartOfBstr > QCBOR_MAX_DECODE_INPUT_SIZE) {
-         uErr = QCBOR_ERR_INPUT_TOO_LARGE;
-         goto Done;
+   /* With trusted input there are no duplicates to find after all
+    * the labels are found, so the search can stop then. A callback
+    * has to see every item. */
+   uint64_t uAllFoundBitMap = 0;
+   if(pMe->bTrustedInput && pCallBack == NULL) {
+      for(int nIndex = 0; pItemArray[nIndex].uLabelType != QCBOR_TYPE_NONE; nIndex++) {
+         uAllFoundBitMap |= 0x01ULL << nIndex;
       }
    }
 
-   uEndOfBstr = uStartOfBstr + pItem->val.string.len;
+   QCBORDecodeNestingSave SaveNesting;
+   size_t uSavePos = UsefulInputBuf_Tell(&(pMe->InBuf));
+   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
 
-   UsefulInputBuf_Seek(&(pMe->InBuf), uStartOfBstr);
-   UsefulInputBuf_SetBufferLength(&(pMe->InBuf), uEndOfBstr);
+   /* Reposition to search from the start of the map / array */
+   QCBORDecode_Private_RewindMapOrArray(pMe);
 
-   uErr = DecodeNesting_DescendIntoBstrWrapped(&(pMe->nesting),
-                                                 (uint32_t)uPreviousLength,
-                                                 (uint32_t)uStartOfBstr);
-Done:
-   pMe->uLastError = (uint8_t) uErr;
-}
+   /* Loop over all the items in the map or array. Each item could be
+    * a map or array, but label matching is only at the main
+    * level. This handles definite- and indefinite- length maps and
+    * arrays. The only reason this is ever called on arrays is to find
+    * their end position.
+    *
+    * This will always run over all items in order to do duplicate
+    * detection.
+    *
+    * This will exit with failure if it encounters an unrecoverable
+    * error, but continue on for recoverable errors.
+    *
+    * If a recoverable error occurs on a matched item, then that error
+    * code is returned.
+    */
+   const uint8_t uMapNestLevel = DecodeNesting_GetBoundedModeLevel(&(pMe->nesting));
+   uint8_t       uNextNestLevel;
+   do {
+      QCBORItem   Item;
+      bool        bMatched;
+      QCBORError  uResult;
+      /* Remember offset of the item because sometimes it has to be returned */
+      const size_t uOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
 
+      /* Get the item */
+      /* QCBORDecode_Private_GetNextTagContent() rather than GetNext()
+       * because a label match is performed on recoverable errors to
+       * be able to return the the error code for the found item. */
+      uResult = QCBORDecode_Private_GetNextTagContent(pMe, &Item);
+      if(QCBORDecode_IsUnrecoverableError(uResult)) {
+         /* The map/array can't be decoded when unrecoverable errors occur */
+         uReturn = uResult;
+         goto Done;
+      }
+      if(uResult == QCBOR_ERR_NO_MORE_ITEMS) {
+         /* Unexpected end of map or array. */
+         uReturn = uResult;
+         goto Done;
+      }
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_EnterBstrWrapped(QCBORDecodeContext *pMe,
-                             const uint8_t       uTagRequirement,
-                             UsefulBufC         *pBstr)
-{
-   QCBORItem Item;
+      /* See if item has one of the labels that are of interest */
+      bMatched = false;
+      for(int nIndex = 0; pItemArray[nIndex].uLabelType != QCBOR_TYPE_NONE; nIndex++) {
+         if(QCBORItem_MatchLabel(Item, pItemArray[nIndex])) {
+            /* A label match has been found */
+            if(uFoundItemBitMap & (0x01ULL << nIndex)) {
+               uReturn = QCBOR_ERR_DUPLICATE_LABEL;
+               goto Done;
+            }
+            if(uResult != QCBOR_SUCCESS) {
+               /* The label matches, but the data item is in error.
+                * It is OK to have recoverable errors on items that
+                * are not matched. */
+               uReturn = uResult;
+               goto Done;
+            }
+            if(!QCBORItem_MatchType(Item, pItemArray[nIndex])) {
+               /* The data item is not of the type(s) requested */
+               uReturn = QCBOR_ERR_UNEXPECTED_TYPE;
+               goto Done;
+            }
 
-   /* Get the data item that is the byte string being entered */
-   QCBORDecode_VGetNext(pMe, &Item);
-   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
-}
+            /* Successful match. Return the item. */
+            pItemArray[nIndex] = Item;
+            uFoundItemBitMap |= 0x01ULL << nIndex;
+            if(pInfo != NULL) {
+               pInfo->uStartOffset = uOffset;
+            }
+            bMatched = true;
+         }
+      }
 
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_EnterBstrWrappedFromMapN(QCBORDecodeContext *pMe,
-                                     const int64_t       nLabel,
-                                     const uint8_t       uTagRequirement,
-                                     UsefulBufC         *pBstr)
-{
-   QCBORItem Item;
+      if(!bMatched && pCallBack != NULL) {
+         /* Call the callback on unmatched labels. Duplicate
+          * detection for all labels needs memory for every label, so
+          * it is done by QCBORDecode_SetDuplicateLabelCheck() with
+          * caller-provided storage through this callback. */
+         pCallBack->uItemOffset = uOffset;
+         uReturn = (*(pCallBack->pfCallback))(pCallBack->pCBContext, &Item);
+         if(uReturn != QCBOR_SUCCESS) {
+            goto Done;
+         }
+      }
 
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
-}
+      if(uAllFoundBitMap != 0 && uFoundItemBitMap == uAllFoundBitMap) {
+         /* The end of the map isn't known, so uMapEndOffsetCache is
+          * left as it is for QCBORDecode_ExitMap() to deal with. */
+         uReturn = QCBOR_SUCCESS;
+         goto Done;
+      }
 
+      /* Consume the item whether matched or not. This does the work
+       * of traversing maps and array and everything in them. In this
+       * loop only the items at the current nesting level are examined
+       * to match the labels. */
+      uReturn = QCBORDecode_Private_ConsumeItem(pMe, &Item, NULL, &uNextNestLevel);
+      if(uReturn != QCBOR_SUCCESS) {
+         goto Done;
+      }
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_EnterBstrWrappedFromMapSZ(QCBORDecodeContext *pMe,
-                                      const char         *szLabel,
-                                      const uint8_t       uTagRequirement,
-                                      UsefulBufC         *pBstr)
-{
-   QCBORItem Item;
+      if(pInfo != NULL) {
+         pInfo->uItemCount++;
+      }
 
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
-}
+   } while (uNextNestLevel >= uMapNestLevel);
 
+   uReturn = QCBOR_SUCCESS;
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_ExitBstrWrapped(QCBORDecodeContext *pMe)
-{
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      // Already in error state; do nothing.
-      return;
-   }
+   const size_t uEndOffset = UsefulInputBuf_Tell(&(pMe->InBuf));
 
-   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_BYTE_STRING)) {
-      pMe->uLastError = QCBOR_ERR_EXIT_MISMATCH;
-      return;
+   /* Check here makes sure that this won't accidentally be
+    * QCBOR_MAP_OFFSET_CACHE_INVALID which is larger than
+    * QCBOR_MAX_DECODE_INPUT_SIZE.  Cast to QCBOROffset to possibly
+    * address cases where SIZE_MAX < UINT32_MAX. It is near-impossible
+    * to test this, so test coverage of this function is not 100%,
+    * but it is 100% when this is commented out. */
+   if((QCBOROffset)uEndOffset >= QCBOR_MAX_DECODE_INPUT_SIZE) {
+      uReturn = QCBOR_ERR_INPUT_TOO_LARGE;
+      goto Done;
    }
+   /* Cast OK because encoded CBOR is limited to QCBOR_MAX_DECODE_INPUT_SIZE */
+   pMe->uMapEndOffsetCache = (QCBOROffset)uEndOffset;
 
-   const uint32_t uEndOfBstr = (uint32_t)UsefulInputBuf_GetBufferLength(&(pMe->InBuf));
-
-   /*
-    Reset the length of the UsefulInputBuf to what it was before
-    the bstr wrapped CBOR was entered.
-    */
-   UsefulInputBuf_SetBufferLength(&(pMe->InBuf),
-                               DecodeNesting_GetPreviousBoundedEnd(&(pMe->nesting)));
+ Done:
+   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
+   UsefulInputBuf_Seek(&(pMe->InBuf), uSavePos);
 
+ Done2:
+   /* For all items not found, set the data and label type to QCBOR_TYPE_NONE */
+   for(int i = 0; pItemArray[i].uLabelType != 0; i++) {
+      if(!(uFoundItemBitMap & (0x01ULL << i))) {
+         pItemArray[i].uDataType  = QCBOR_TYPE_NONE;
+         pItemArray[i].uLabelType = QCBOR_TYPE_NONE;
+      }
+   }
 
-   QCBORError uErr = QCBORDecode_Private_ExitBoundedLevel(pMe, uEndOfBstr);
-   pMe->uLastError = (uint8_t)uErr;
+   return uReturn;
 }
 
 
-
-/**
- * @brief Process simple type true and false, a boolean
- *
- * @param[in] pMe     The decode context.
- * @param[in] pItem   The item with either true or false.
- * @param[out] pBool  The boolean value output.
- *
- * Sets the internal error if the item isn't a true or a false. Also
- * records any tag numbers as the tag numbers of the last item.
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
  */
-static void
-QCBORDecode_Private_ProcessBool(QCBORDecodeContext *pMe,
-                                const QCBORItem    *pItem,
-                                bool               *pBool)
+void
+QCBORDecode_GetItemInMapN(QCBORDecodeContext *pMe,
+                          int64_t             nLabel,
+                          uint8_t             uQcborType,
+                          QCBORItem          *pItem)
 {
    if(pMe->uLastError != QCBOR_SUCCESS) {
-      /* Already in error state, do nothing */
       return;
    }
 
-   switch(pItem->uDataType) {
-      case QCBOR_TYPE_TRUE:
-         *pBool = true;
-         break;
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
+   OneItemSearch[0].label.int64 = nLabel;
+   OneItemSearch[0].uDataType   = uQcborType;
+   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE; // Indicates end of array
 
-      case QCBOR_TYPE_FALSE:
-         *pBool = false;
-         break;
+   QCBORError uReturn = QCBORDecode_Private_MapSearch(pMe, OneItemSearch, NULL, NULL);
 
-      default:
-         pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
-         break;
+   if(uReturn != QCBOR_SUCCESS) {
+      pItem->uDataType  = QCBOR_TYPE_NONE;
+      pItem->uLabelType = QCBOR_TYPE_NONE;
+      goto Done;
    }
-}
-
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_GetBool(QCBORDecodeContext *pMe, bool *pValue)
-{
-   QCBORItem  Item;
-   QCBORDecode_VGetNext(pMe, &Item);
-   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
-}
+   if(OneItemSearch[0].uDataType == QCBOR_TYPE_NONE) {
+      uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
+   }
 
+   *pItem = OneItemSearch[0];
+   QCBORDecode_Private_CopyTags(pMe, pItem);
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_GetBoolInMapN(QCBORDecodeContext *pMe,
-                          const int64_t       nLabel,
-                          bool               *pValue)
-{
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
+ Done:
+   pMe->uLastError = (uint8_t)uReturn;
 }
 
 
@@ -4564,850 +5900,2947 @@ QCBORDecode_GetBoolInMapN(QCBORDecodeContext *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetBoolInMapSZ(QCBORDecodeContext *pMe,
+QCBORDecode_GetItemInMapSZ(QCBORDecodeContext *pMe,
                            const char         *szLabel,
-                           bool               *pValue)
+                           uint8_t             uQcborType,
+                           QCBORItem          *pItem)
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
-}
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
+   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
+   OneItemSearch[0].uDataType    = uQcborType;
+   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE; // Indicates end of array
+
+   QCBORError uReturn = QCBORDecode_Private_MapSearch(pMe, OneItemSearch, NULL, NULL);
+
+   if(uReturn != QCBOR_SUCCESS) {
+      pItem->uDataType  = QCBOR_TYPE_NONE;
+      pItem->uLabelType = QCBOR_TYPE_NONE;
+      goto Done;
+   }
+   if(OneItemSearch[0].uDataType == QCBOR_TYPE_NONE) {
+      uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
+      goto Done;
+   }
+
+   *pItem = OneItemSearch[0];
+   QCBORDecode_Private_CopyTags(pMe, pItem);
+
+Done:
+#else
+   (void)pMe;
+   (void)szLabel;
+   (void)uQcborType;
+   (void)pItem;
+   QCBORError uReturn = QCBOR_ERR_LABEL_NOT_FOUND;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   pMe->uLastError = (uint8_t)uReturn;
+}
+
 
 
 /**
- * @brief Process simple values.
+ * @brief Semi-private. Get pointer, length and item for an array or map.
  *
- * @param[in] pMe     The decode context.
- * @param[in] pItem   The item with the simple value.
- * @param[out] puSimple  The simple value output.
+ * @param[in] pMe            The decode context.
+ * @param[in] uType          CBOR major type, either array/map.
+ * @param[out] pItem         The item for the array/map.
+ * @param[out] pEncodedCBOR  Pointer and length of the encoded map or array.
  *
- * Sets the internal error if the item isn't a true or a false. Also
- * records any tag numbers as the tag numbers of the last item.
+ * The next item to be decoded must be a map or array as specified by @c uType.
+ *
+ * @c pItem will be filled in with the label and tags of the array or map
+ * in addition to @c pEncodedCBOR giving the pointer and length of the
+ * encoded CBOR.
+ *
+ * When this is complete, the traversal cursor is at the end of the array or
+ * map that was retrieved.
  */
-static void
-QCBORDecode_Private_ProcessSimple(QCBORDecodeContext *pMe,
-                                  const QCBORItem    *pItem,
-                                  uint8_t            *puSimple)
+void
+QCBORDecode_Private_GetArrayOrMap(QCBORDecodeContext *pMe,
+                                  const uint8_t       uType,
+                                  QCBORItem          *pItem,
+                                  UsefulBufC         *pEncodedCBOR)
 {
-   if(pMe->uLastError != QCBOR_SUCCESS) {
+   QCBORError uErr;
+   uint8_t    uNestLevel;
+   size_t     uStartingCursor;
+   size_t     uStartOfReturned;
+   size_t     uEndOfReturned;
+   size_t     uTempSaveCursor;
+   bool       bInMap;
+   QCBORItem  LabelItem;
+   bool       EndedByBreak = false;
+
+   uStartingCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
+   bInMap = DecodeNesting_IsCurrentTypeMap(&(pMe->nesting));
+
+   /* Could call GetNext here, but don't need to because this
+    * is only interested in arrays and maps. */
+   uErr = QCBORDecode_Private_GetNextMapOrArray(pMe, NULL, pItem);
+   if(uErr != QCBOR_SUCCESS) {
+      pMe->uLastError = (uint8_t)uErr;
       return;
    }
 
-   /* It's kind of lame to remap true...undef back to simple values, but
-    * this function isn't used much and to not do it would require
-    * changing GetNext() behavior in an incompatible way.
-    */
-   switch(pItem->uDataType) {
-      case QCBOR_TYPE_UKNOWN_SIMPLE:
-         *puSimple = pItem->val.uSimple;
-         break;
-
-      case QCBOR_TYPE_TRUE:
-         *puSimple = CBOR_SIMPLEV_TRUE;
-         break;
+   uint8_t uItemDataType = pItem->uDataType;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   if(uItemDataType == QCBOR_TYPE_MAP_AS_ARRAY) {
+      uItemDataType = QCBOR_TYPE_ARRAY;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
-      case QCBOR_TYPE_FALSE:
-         *puSimple = CBOR_SIMPLEV_FALSE;
-         break;
+   if(uItemDataType != uType) {
+      pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
+      return;
+   }
 
-      case QCBOR_TYPE_NULL:
-         *puSimple = CBOR_SIMPLEV_NULL;
-         break;
+   if(bInMap) {
+      /* If the item is in a map, the start of the array/map
+       * itself, not the label, must be found. Do this by
+       * rewinding to the starting position and fetching
+       * just the label data item. QCBORDecode_Private_GetNextTagNumber()
+       * doesn't do any of the array/map item counting or nesting
+       * level tracking. Used here it will just fetech the label
+       * data item.
+       *
+       * Have to save the cursor and put it back to the position
+       * after the full item once the label as been fetched by
+       * itself.
+       */
+      uTempSaveCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
+      UsefulInputBuf_Seek(&(pMe->InBuf), uStartingCursor);
 
-      case QCBOR_TYPE_UNDEF:
-         *puSimple = CBOR_SIMPLEV_UNDEF;
-         break;
+      /* Item has been fetched once so safe to ignore error */
+      (void)QCBORDecode_Private_GetNextTagNumber(pMe, &LabelItem);
 
-      default:
-         pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
-         return;
+      uStartOfReturned = UsefulInputBuf_Tell(&(pMe->InBuf));
+      UsefulInputBuf_Seek(&(pMe->InBuf), uTempSaveCursor);
+   } else {
+      uStartOfReturned = uStartingCursor;
    }
-}
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_GetSimple(QCBORDecodeContext *pMe, uint8_t *puSimple)
-{
-   QCBORItem Item;
-   QCBORDecode_VGetNext(pMe, &Item);
-   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimple);
-}
+   /* Consume the entire array/map to find the end */
+   uErr = QCBORDecode_Private_ConsumeItem(pMe, pItem, &EndedByBreak, &uNestLevel);
+   if(uErr != QCBOR_SUCCESS) {
+      pMe->uLastError = (uint8_t)uErr;
+      goto Done;
+   }
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_GetSimpleInMapN(QCBORDecodeContext *pMe,
-                            int64_t             nLabel,
-                            uint8_t            *puSimpleValue)
-{
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimpleValue);
-}
+   /* Fill in returned values */
+   uEndOfReturned = UsefulInputBuf_Tell(&(pMe->InBuf));
+   if(EndedByBreak) {
+      /* When ascending nesting levels, a break for the level above
+       * was consumed. That break is not a part of what is consumed here. */
+      uEndOfReturned--;
+   }
+   pEncodedCBOR->ptr = UsefulInputBuf_OffsetToPointer(&(pMe->InBuf), uStartOfReturned);
+   pEncodedCBOR->len = uEndOfReturned - uStartOfReturned;
 
-/*
- * Public function, see header qcbor/qcbor_decode.h file
- */
-void
-QCBORDecode_GetSimpleInMapSZ(QCBORDecodeContext *pMe,
-                             const char         *szLabel,
-                             uint8_t            *puSimpleValue)
-{
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimpleValue);
+Done:
+   return;
 }
 
 
-
 /**
- * @brief Common processing for an epoch date.
+ * @brief Semi-private. Get pointer, length and item count of an array or map.
  *
- * @param[in] pMe              The decode context.
- * @param[in] pItem            The item with the date.
- * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
- * @param[out] pnTime          The returned date.
+ * @param[in] pMe            The decode context.
+ * @param[in] pTarget        The label and type of the array or map to retrieve.
+ * @param[out] pItem         The item for the array/map.
+ * @param[out] pEncodedCBOR  Pointer and length of the encoded map or array.
  *
- * Common processing for the date tag. Mostly make sure the tag
- * content is correct and copy forward any further other tag numbers.
+ * When this is complete, the traversal cursor is unchanged.
  */
-static void
-QCBORDecode_Private_ProcessEpochDate(QCBORDecodeContext *pMe,
-                                     QCBORItem          *pItem,
-                                     const uint8_t       uTagRequirement,
-                                     int64_t            *pnTime)
+void
+QCBORDecode_Private_SearchAndGetArrayOrMap(QCBORDecodeContext *pMe,
+                                           QCBORItem          *pTarget,
+                                           QCBORItem          *pItem,
+                                           UsefulBufC         *pEncodedCBOR)
 {
+   /* Heavy stack use, but it's only for a few QCBOR public methods */
+   MapSearchInfo          Info;
+   QCBORDecodeNestingSave SaveNesting;
+   size_t                 uSaveCursor;
+
+   /* Find the array or map of interest */
+   pMe->uLastError = (uint8_t)QCBORDecode_Private_MapSearch(pMe, pTarget, &Info, NULL);
    if(pMe->uLastError != QCBOR_SUCCESS) {
-      // Already in error state, do nothing
       return;
    }
 
-   QCBORError uErr;
-
-   const QCBOR_Private_TagSpec TagSpec =
-   {
-      uTagRequirement,
-      {QCBOR_TYPE_DATE_EPOCH, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
-      {QCBOR_TYPE_INT64, QCBOR_TYPE_DOUBLE, QCBOR_TYPE_FLOAT, QCBOR_TYPE_UINT64}
-   };
-
-   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
-   if(uErr != QCBOR_SUCCESS) {
-      goto Done;
+   if(pTarget->uDataType == QCBOR_TYPE_NONE) {
+      pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+      return;
    }
 
-   if(pItem->uDataType != QCBOR_TYPE_DATE_EPOCH) {
-      uErr = QCBOR_Private_DecodeDateEpoch(pItem);
-      if(uErr != QCBOR_SUCCESS) {
-         goto Done;
-      }
-   }
+   /* Save the traversal cursor and related */
+   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
+   uSaveCursor = UsefulInputBuf_Tell(&(pMe->InBuf));
 
-   *pnTime = pItem->val.epochDate.nSeconds;
+   /* Get the array or map of interest */
+   DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
+   UsefulInputBuf_Seek(&(pMe->InBuf), Info.uStartOffset);
+   QCBORDecode_Private_GetArrayOrMap(pMe, pTarget[0].uDataType, pItem, pEncodedCBOR);
 
-Done:
-   pMe->uLastError = (uint8_t)uErr;
+   /* Restore the traversal cursor */
+   UsefulInputBuf_Seek(&(pMe->InBuf), uSaveCursor);
+   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
 }
 
 
 
-/*
- * Public function, see header qcbor/qcbor_spiffy_decode.h file
- */
-void
-QCBORDecode_GetEpochDate(QCBORDecodeContext *pMe,
-                         uint8_t             uTagRequirement,
-                         int64_t            *pnTime)
-{
-   QCBORItem  Item;
-   QCBORDecode_VGetNext(pMe, &Item);
-   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
-}
-
 
-/*
- * Public function, see header qcbor/qcbor_spiffy_decode.h file
+/**
+ * @brief Is a QCBOR_TYPE in the type list?
+ *
+ * @param[in] uDataType  Type to check for.
+ * @param[in] puTypeList  List to check.
+ *
+ * @retval  QCBOR_SUCCESS             If in the list.
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE  Not in the list.
  */
-void
-QCBORDecode_GetEpochDateInMapN(QCBORDecodeContext *pMe,
-                               int64_t             nLabel,
-                               uint8_t             uTagRequirement,
-                               int64_t            *pnTime)
+static QCBORError
+QCBOR_Private_CheckTypeList(const int     uDataType,
+                            const uint8_t puTypeList[QCBOR_TAGSPEC_NUM_TYPES])
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
+   for(size_t i = 0; i < QCBOR_TAGSPEC_NUM_TYPES; i++) {
+      if(uDataType == puTypeList[i]) { /* -Wmaybe-uninitialized falsly warns here */
+         return QCBOR_SUCCESS;
+      }
+   }
+   return QCBOR_ERR_UNEXPECTED_TYPE;
 }
 
 
-/*
- * Public function, see header qcbor/qcbor_spiffy_decode.h file
+/**
+ * Match a tag/type specification against the type of the item.
+ *
+ * @param[in] TagSpec  Specification for matching tags.
+ * @param[in] pItem    The item to check.
+ *
+ * @retval QCBOR_SUCCESS   @c uDataType is allowed by @c TagSpec
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE @c uDataType is not allowed by @c TagSpec
+ *
+ * This checks the item data type of untagged items as well as of
+ * tagged items against a specification to see if decoding should
+ * proceed.
+ *
+ * This relies on the automatic tag decoding done by QCBOR that turns
+ * tag numbers into particular QCBOR_TYPEs so there is no actual
+ * comparsion of tag numbers, just of QCBOR_TYPEs.
+ *
+ * This checks the data item type as possibly representing the tag
+ * number or as the tag content type.
+ *
+ * If QCBOR_DISABLE_TAGS is #defined, this primarily checks the item
+ * data type against the allowed tag content types, but also checks
+ * against the tagged types. The QCBOR_TYPEs checked will never be
+ * associated with tag numbers, but this checking is needed for the
+ * text and byte string use cases .
  */
-void
-QCBORDecode_GetEpochDateInMapSZ(QCBORDecodeContext *pMe,
-                                const char         *szLabel,
-                                uint8_t             uTagRequirement,
-                                int64_t            *pnTime)
+static QCBORError
+QCBOR_Private_CheckTagRequirement(const QCBOR_Private_TagSpec TagSpec,
+                                  const QCBORItem            *pItem)
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
-}
+   const int nItemType = pItem->uDataType; /* -Wmaybe-uninitialized falsly warns here */
+   const int nTagReq = TagSpec.uTagRequirement & ~QCBOR_TAG_REQUIREMENT_ALLOW_ADDITIONAL_TAGS;
+
+#ifndef QCBOR_DISABLE_TAGS
+   /* -Wmaybe-uninitialized falsly warns here */
+   if(!(TagSpec.uTagRequirement & QCBOR_TAG_REQUIREMENT_ALLOW_ADDITIONAL_TAGS) &&
+      pItem->uTags[0] != CBOR_TAG_INVALID16) {
+      /* There are tags that QCBOR couldn't process on this item and
+       * the caller has told us there should not be.
+       */
+      return QCBOR_ERR_UNEXPECTED_TYPE;
+   }
+
+   if(nTagReq == QCBOR_TAG_REQUIREMENT_TAG) {
+      /* Must match the tag number and only the tag */
+      return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
+   }
+
+   QCBORError uReturn = QCBOR_Private_CheckTypeList(nItemType, TagSpec.uAllowedContentTypes);
+   if(uReturn == QCBOR_SUCCESS) {
+      return QCBOR_SUCCESS;
+   }
 
+   if(nTagReq == QCBOR_TAG_REQUIREMENT_NOT_A_TAG) {
+      /* Must match the content type and only the content type.
+       * There was no match just above so it is a fail. */
+      return QCBOR_ERR_UNEXPECTED_TYPE;
+   }
+
+   /* QCBOR_TAG_REQUIREMENT_OPTIONAL_TAG: If here it can match either
+    * the tag or the content and it hasn't matched the content, so the
+    * end result is whether it matches the tag. This is the tag
+    * optional case that the CBOR standard discourages.
+    */
+
+   return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
+
+#else /* QCBOR_DISABLE_TAGS */
+   if(nTagReq == QCBOR_TAG_REQUIREMENT_TAG) {
+      /* This is only checking base QCBOR types, not those associated
+       * with tag numbers since you can get here with tag numbers.
+       */
+      return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uTaggedTypes);
+   }
+
+   return QCBOR_Private_CheckTypeList(nItemType, TagSpec.uAllowedContentTypes);
+
+#endif /* QCBOR_DISABLE_TAGS */
+}
 
 
 /**
- * @brief Common processing for an epoch date.
+ * @brief Get an item by label to match a tag specification.
  *
- * @param[in] pMe              The decode context.
- * @param[in] pItem            The item with the date.
- * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
- * @param[out] pnDays          The returned day count.
+ * @param[in] pMe      The decode context.
+ * @param[in] nLabel   The label to search map for.
+ * @param[in] TagSpec  The tag number specification to match.
+ * @param[out] pItem   The item found.
  *
- * Common processing for the RFC 8943 day-count tag. Mostly make sure
- * the tag content is correct and copy forward any further other tag
- * numbers.
+ * This finds the item with the given label in currently open
+ * map. Then checks that its tag number and types matches the tag
+ * specification. If not, an error is set in the decode context.
  */
 static void
-QCBORDecode_Private_ProcessEpochDays(QCBORDecodeContext *pMe,
-                                     QCBORItem          *pItem,
-                                     uint8_t             uTagRequirement,
-                                     int64_t            *pnDays)
+QCBORDecode_GetTaggedItemInMapN(QCBORDecodeContext         *pMe,
+                                const int64_t               nLabel,
+                                const QCBOR_Private_TagSpec TagSpec,
+                                QCBORItem                  *pItem)
 {
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
    if(pMe->uLastError != QCBOR_SUCCESS) {
-      /* Already in error state, do nothing */
       return;
    }
 
-   QCBORError uErr;
-
-   const QCBOR_Private_TagSpec TagSpec =
-   {
-      uTagRequirement,
-      {QCBOR_TYPE_DAYS_EPOCH, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
-      {QCBOR_TYPE_INT64, QCBOR_TYPE_UINT64, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
-   };
+   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+}
 
-   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
-   if(uErr != QCBOR_SUCCESS) {
-      goto Done;
-   }
 
-   if(pItem->uDataType != QCBOR_TYPE_DAYS_EPOCH) {
-      uErr = QCBOR_Private_DecodeDaysEpoch(pItem);
-      if(uErr != QCBOR_SUCCESS) {
-         goto Done;
-      }
+/**
+ * @brief Get an item by label to match a tag specification.
+ *
+ * @param[in] pMe      The decode context.
+ * @param[in] szLabel   The label to search map for.
+ * @param[in] TagSpec  The tag number specification to match.
+ * @param[out] pItem   The item found.
+ *
+ * This finds the item with the given label in currently open
+ * map. Then checks that its tag number and types matches the tag
+ * specification. If not, an error is set in the decode context.
+ */
+static void
+QCBORDecode_GetTaggedItemInMapSZ(QCBORDecodeContext          *pMe,
+                                 const char                  *szLabel,
+                                 const QCBOR_Private_TagSpec  TagSpec,
+                                 QCBORItem                   *pItem)
+{
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
    }
 
-   *pnDays = pItem->val.epochDays;
-
-Done:
-   pMe->uLastError = (uint8_t)uErr;
+   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
 }
 
 
-/*
- * Public function, see header qcbor/qcbor_decode.h
+/**
+ * @brief Semi-private to get an string by label to match a tag specification.
+ *
+ * @param[in] pMe      The decode context.
+ * @param[in] nLabel   The label to search map for.
+ * @param[in] TagSpec  The tag number specification to match.
+ * @param[out] pString   The string found.
+ *
+ * This finds the string  with the given label in currently open
+ * map. Then checks that its tag number and types matches the tag
+ * specification. If not, an error is set in the decode context.
  */
 void
-QCBORDecode_GetEpochDays(QCBORDecodeContext *pMe,
-                         uint8_t             uTagRequirement,
-                         int64_t            *pnDays)
+QCBORDecode_Private_GetTaggedStringInMapN(QCBORDecodeContext         *pMe,
+                                          const int64_t               nLabel,
+                                          const QCBOR_Private_TagSpec TagSpec,
+                                          UsefulBufC                 *pString)
 {
-   QCBORItem  Item;
-   QCBORDecode_VGetNext(pMe, &Item);
-   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+   QCBORItem Item;
+   QCBORDecode_GetTaggedItemInMapN(pMe, nLabel, TagSpec, &Item);
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      *pString = Item.val.string;
+   }
 }
 
 
-/*
- * Public function, see header qcbor/qcbor_decode.h
- */
-void
-QCBORDecode_GetEpochDaysInMapN(QCBORDecodeContext *pMe,
-                               int64_t             nLabel,
-                               uint8_t             uTagRequirement,
-                               int64_t            *pnDays)
+/**
+ * @brief Semi-private to get an string by label to match a tag specification.
+ *
+ * @param[in] pMe      The decode context.
+ * @param[in] szLabel   The label to search map for.
+ * @param[in] TagSpec  The tag number specification to match.
+ * @param[out] pString   The string found.
+ *
+ * This finds the string  with the given label in currently open
+ * map. Then checks that its tag number and types matches the tag
+ * specification. If not, an error is set in the decode context.
+ */void
+QCBORDecode_Private_GetTaggedStringInMapSZ(QCBORDecodeContext         *pMe,
+                                           const char *                szLabel,
+                                           const QCBOR_Private_TagSpec TagSpec,
+                                           UsefulBufC                 *pString)
 {
    QCBORItem Item;
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+   QCBORDecode_GetTaggedItemInMapSZ(pMe, szLabel, TagSpec, &Item);
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      *pString = Item.val.string;
+   }
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_decode.h
+ * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetEpochDaysInMapSZ(QCBORDecodeContext *pMe,
-                                const char         *szLabel,
-                                uint8_t             uTagRequirement,
-                                int64_t            *pnDays)
+QCBORDecode_GetItemsInMap(QCBORDecodeContext *pMe, QCBORItem *pItemList)
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+   QCBORError uErr = QCBORDecode_Private_MapSearch(pMe, pItemList, NULL, NULL);
+   pMe->uLastError = (uint8_t)uErr;
 }
 
-
-
 /*
- * @brief Get a string that matches the type/tag specification.
+ * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_Private_GetTaggedString(QCBORDecodeContext         *pMe,
-                                    const QCBOR_Private_TagSpec TagSpec,
-                                    UsefulBufC                 *pBstr)
+QCBORDecode_GetItemsInMapWithCallback(QCBORDecodeContext *pMe,
+                                      QCBORItem          *pItemList,
+                                      void               *pCallbackCtx,
+                                      QCBORItemCallback   pfCB)
 {
-   QCBORItem  Item;
-
-   QCBORDecode_VGetNext(pMe, &Item);
-   if(pMe->uLastError) {
-      return;
-   }
+   MapSearchCallBack CallBack;
+   CallBack.pCBContext = pCallbackCtx;
+   CallBack.pfCallback = pfCB;
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, &Item);
+   QCBORError uErr = QCBORDecode_Private_MapSearch(pMe, pItemList, NULL, &CallBack);
 
-   if(pMe->uLastError == QCBOR_SUCCESS) {
-      *pBstr = Item.val.string;
-   } else {
-      *pBstr = NULLUsefulBufC;
-   }
+   pMe->uLastError = (uint8_t)uErr;
 }
 
 
-
-
 /**
- * @brief Common processing for a big number tag.
+ * @brief Search for a map/array by label and enter it
  *
- * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
- * @param[in] pItem            The item with the date.
- * @param[out] pValue          The returned big number
- * @param[out] pbIsNegative  The returned sign of the big number.
+ * @param[in] pMe  The decode context.
+ * @param[in] pSearch The map/array to search for.
  *
- * Common processing for the big number tag. Mostly make sure
- * the tag content is correct and copy forward any further other tag
- * numbers.
+ * @c pSearch is expected to contain one item of type map or array
+ * with the label specified. The current bounded map will be searched for
+ * this and if found  will be entered.
+ *
+ * If the label is not found, or the item found is not a map or array,
+ * the error state is set.
  */
-static QCBORError
-QCBOR_Private_ProcessBigNum(const uint8_t   uTagRequirement,
-                            const QCBORItem *pItem,
-                            UsefulBufC      *pValue,
-                            bool            *pbIsNegative)
+static void
+QCBORDecode_Private_SearchAndEnter(QCBORDecodeContext *pMe, QCBORItem pSearch[])
 {
-   const QCBOR_Private_TagSpec TagSpec =
-   {
-      uTagRequirement,
-      {QCBOR_TYPE_POSBIGNUM, QCBOR_TYPE_NEGBIGNUM, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
-      {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
-   };
-
-   QCBORError uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
-   if(uErr != QCBOR_SUCCESS) {
-      return uErr;
+   // The first item in pSearch is the one that is to be
+   // entered. It should be the only one filled in. Any other
+   // will be ignored unless it causes an error.
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
    }
 
-   *pValue = pItem->val.string;
+   MapSearchInfo Info;
+   pMe->uLastError = (uint8_t)QCBORDecode_Private_MapSearch(pMe, pSearch, &Info, NULL);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
 
-   if(pItem->uDataType == QCBOR_TYPE_POSBIGNUM) {
-      *pbIsNegative = false;
-   } else if(pItem->uDataType == QCBOR_TYPE_NEGBIGNUM) {
-      *pbIsNegative = true;
+   if(pSearch->uDataType == QCBOR_TYPE_NONE) {
+      pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+      return;
    }
 
-   return QCBOR_SUCCESS;
+
+   /* The map or array was found. Now enter it.
+    *
+    * QCBORDecode_EnterBoundedMapOrArray() used here, requires the
+    * next item for the pre-order traversal cursor to be the map/array
+    * found by MapSearch(). The next few lines of code force the
+    * cursor to that.
+    *
+    * There is no need to retain the old cursor because
+    * QCBORDecode_EnterBoundedMapOrArray() will set it to the
+    * beginning of the map/array being entered.
+    *
+    * The cursor is forced by: 1) setting the input buffer position to
+    * the item offset found by MapSearch(), 2) setting the map/array
+    * counter to the total in the map/array, 3) setting the nesting
+    * level. Setting the map/array counter to the total is not
+    * strictly correct, but this is OK because this cursor only needs
+    * to be used to get one item and MapSearch() has already found it
+    * confirming it exists.
+    */
+   UsefulInputBuf_Seek(&(pMe->InBuf), Info.uStartOffset);
+
+   DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
+
+   DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
+
+   QCBORDecode_Private_EnterBoundedMapOrArray(pMe, pSearch->uDataType, NULL);
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_spiffy_decode.h
+ * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetBignum(QCBORDecodeContext *pMe,
-                      const uint8_t       uTagRequirement,
-                      UsefulBufC         *pValue,
-                      bool               *pbIsNegative)
+QCBORDecode_EnterMapFromMapN(QCBORDecodeContext *pMe, int64_t nLabel)
 {
-   QCBORItem  Item;
-   QCBORDecode_VGetNext(pMe, &Item);
-   if(pMe->uLastError) {
-      return;
-   }
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
+   OneItemSearch[0].label.int64 = nLabel;
+   OneItemSearch[0].uDataType   = QCBOR_TYPE_MAP;
+   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE;
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
-                                                          &Item,
-                                                          pValue,
-                                                          pbIsNegative);
+   /* The map to enter was found, now finish off entering it. */
+   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_spiffy_decode.h
+ * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetBignumInMapN(QCBORDecodeContext *pMe,
-                            const int64_t       nLabel,
-                            const uint8_t       uTagRequirement,
-                            UsefulBufC         *pValue,
-                            bool               *pbIsNegative)
+QCBORDecode_EnterMapFromMapSZ(QCBORDecodeContext *pMe, const char  *szLabel)
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
-   }
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
+   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
+   OneItemSearch[0].uDataType    = QCBOR_TYPE_MAP;
+   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE;
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
-                                                          &Item,
-                                                          pValue,
-                                                          pbIsNegative);
+   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
+#else
+   (void)szLabel;
+   pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 }
 
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnterArrayFromMapN(QCBORDecodeContext *pMe, int64_t nLabel)
+{
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
+   OneItemSearch[0].label.int64 = nLabel;
+   OneItemSearch[0].uDataType   = QCBOR_TYPE_ARRAY;
+   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE;
+
+   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
+}
 
 /*
- * Public function, see header qcbor/qcbor_spiffy_decode.h
+ * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetBignumInMapSZ(QCBORDecodeContext *pMe,
-                             const char         *szLabel,
-                             const uint8_t       uTagRequirement,
-                             UsefulBufC         *pValue,
-                             bool               *pbIsNegative)
+QCBORDecode_EnterArrayFromMapSZ(QCBORDecodeContext *pMe, const char  *szLabel)
 {
-   QCBORItem Item;
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
-   if(pMe->uLastError != QCBOR_SUCCESS) {
-      return;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
+   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
+   OneItemSearch[0].uDataType    = QCBOR_TYPE_ARRAY;
+   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE;
+
+   QCBORDecode_Private_SearchAndEnter(pMe, OneItemSearch);
+#else
+   (void)szLabel;
+   pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_SetDuplicateLabelCheck(QCBORDecodeContext    *pMe,
+                                   QCBORLabelFingerprint *pLabels,
+                                   size_t                 uLabelsCount)
+{
+   /* No map has more items than this so more storage isn't needed */
+   if(uLabelsCount > QCBOR_MAX_ITEMS_IN_MAP) {
+      uLabelsCount = QCBOR_MAX_ITEMS_IN_MAP;
    }
+   pMe->pLabelCheck      = pLabels;
+   pMe->uLabelCheckCount = (QCBORCount)uLabelsCount;
+}
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
-                                                          &Item,
-                                                          pValue,
-                                                          pbIsNegative);
+
+typedef struct {
+   QCBORLabelFingerprint *pLabels;
+   size_t                 uSize;
+   size_t                 uCount;
+} LabelCheckInfo;
+
+
+/* Callback for QCBORDecode_Private_MapSearch() that fingerprints each
+ * label in the map */
+static QCBORError
+QCBORDecode_Private_AddLabel(void *pCallbackCtx, const QCBORItem *pItem)
+{
+   LabelCheckInfo        *pInfo = (LabelCheckInfo *)pCallbackCtx;
+   QCBORLabelFingerprint *pLabel;
+
+   if(pInfo->uCount >= pInfo->uSize) {
+      return QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL;
+   }
+   pLabel = &(pInfo->pLabels[pInfo->uCount]);
+   pInfo->uCount++;
+
+   return QCBOR_Private_FingerprintLabel(pItem, pLabel);
 }
 
 
+/* Heap sort because it needs no memory or recursion */
+static void
+QCBOR_Private_SiftDownLabels(QCBORLabelFingerprint *pLabels,
+                             size_t                 uRoot,
+                             size_t                 uCount)
+{
+   QCBORLabelFingerprint Swap;
+   size_t                uChild;
+
+   for(;;) {
+      uChild = 2 * uRoot + 1;
+      if(uChild >= uCount) {
+         break;
+      }
+      if(uChild + 1 < uCount &&
+         QCBOR_Private_CompareLabels(&pLabels[uChild], &pLabels[uChild + 1]) < 0) {
+         uChild++;
+      }
+      if(QCBOR_Private_CompareLabels(&pLabels[uRoot], &pLabels[uChild]) >= 0) {
+         break;
+      }
+      Swap            = pLabels[uRoot];
+      pLabels[uRoot]  = pLabels[uChild];
+      pLabels[uChild] = Swap;
+      uRoot           = uChild;
+   }
+}
+
 
 /**
- * @brief Common processing for MIME tag (semi-private).
+ * @brief Check the map just entered for duplicate labels.
  *
- * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
- * @param[in] pItem            The item with the date.
- * @param[out] pMessage        The returned MIME message.
- * @param[out] pbIsTag257      If true, binary MIME, if not, text MIME.
+ * @param[in] pMe  The decode context.
  *
- * Common processing for the MIME tag. Mostly make sure the tag
- * content is correct and copy forward any further other tag
- * numbers. See QCBORDecode_GetMIMEMessage().
+ * @retval QCBOR_ERR_DUPLICATE_LABEL            Two labels are the same.
+ * @retval QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL  Not enough storage.
+ *
+ * See QCBORDecode_SetDuplicateLabelCheck(). The map search collects
+ * the labels. It also finds the end of the map which makes exiting it
+ * faster.
  */
-QCBORError
-QCBORDecode_Private_GetMIME(const uint8_t     uTagRequirement,
-                            const QCBORItem  *pItem,
-                            UsefulBufC       *pMessage,
-                            bool             *pbIsTag257)
-{
-   const QCBOR_Private_TagSpec TagSpecText =
-      {
-         uTagRequirement,
-         {QCBOR_TYPE_MIME, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
-         {QCBOR_TYPE_TEXT_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
-      };
-   const QCBOR_Private_TagSpec TagSpecBinary =
-      {
-         uTagRequirement,
-         {QCBOR_TYPE_BINARY_MIME, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
-         {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
-      };
+static QCBORError
+QCBORDecode_Private_CheckDuplicateLabels(QCBORDecodeContext *pMe)
+{
+   QCBORError            uErr;
+   QCBORItem             Dummy;
+   MapSearchCallBack     CallBack;
+   LabelCheckInfo        Info;
+   QCBORLabelFingerprint Swap;
+   size_t                i;
+
+   Info.pLabels        = pMe->pLabelCheck;
+   Info.uSize          = pMe->uLabelCheckCount;
+   Info.uCount         = 0;
+   CallBack.pCBContext = &Info;
+   CallBack.pfCallback = QCBORDecode_Private_AddLabel;
+   Dummy.uLabelType    = QCBOR_TYPE_NONE;
+
+   uErr = QCBORDecode_Private_MapSearch(pMe, &Dummy, NULL, &CallBack);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
+   }
 
-   QCBORError uReturn;
+   for(i = Info.uCount / 2; i > 0; i--) {
+      QCBOR_Private_SiftDownLabels(Info.pLabels, i - 1, Info.uCount);
+   }
+   for(i = Info.uCount; i > 1; i--) {
+      Swap                = Info.pLabels[0];
+      Info.pLabels[0]     = Info.pLabels[i - 1];
+      Info.pLabels[i - 1] = Swap;
+      QCBOR_Private_SiftDownLabels(Info.pLabels, 0, i - 1);
+   }
 
-   if(QCBOR_Private_CheckTagRequirement(TagSpecText, pItem) == QCBOR_SUCCESS) {
-      *pMessage = pItem->val.string;
-      if(pbIsTag257 != NULL) {
-         *pbIsTag257 = false;
-      }
-      uReturn = QCBOR_SUCCESS;
-   } else if(QCBOR_Private_CheckTagRequirement(TagSpecBinary, pItem) == QCBOR_SUCCESS) {
-      *pMessage = pItem->val.string;
-      if(pbIsTag257 != NULL) {
-         *pbIsTag257 = true;
+   /* Same labels are next to each other after sorting */
+   for(i = 1; i < Info.uCount; i++) {
+      if(QCBOR_Private_CompareLabels(&(Info.pLabels[i - 1]), &(Info.pLabels[i])) == 0) {
+         return QCBOR_ERR_DUPLICATE_LABEL;
       }
-      uReturn = QCBOR_SUCCESS;
-
-   } else {
-      uReturn = QCBOR_ERR_UNEXPECTED_TYPE;
    }
 
-   return uReturn;
+   return QCBOR_SUCCESS;
 }
 
-// Improvement: add methods for wrapped CBOR, a simple alternate
-// to EnterBstrWrapped
-
-
 
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_SetLabelIndex(QCBORDecodeContext   *pMe,
+                          QCBORLabelIndexEntry *pEntries,
+                          size_t                uEntriesCount)
+{
+   /* No map needs a table bigger than twice its items */
+   if(uEntriesCount > QCBOR_MAX_ITEMS_IN_ARRAY) {
+      uEntriesCount = QCBOR_MAX_ITEMS_IN_ARRAY;
+   }
+   pMe->pLabelIndex      = pEntries;
+   pMe->uLabelIndexCount = (QCBORCount)uEntriesCount;
+   pMe->uLabelIndexMap   = QCBOR_NON_BOUNDED_OFFSET;
+}
 
-#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
 
-/**
- * @brief Prototype for conversion of exponent and mantissa to unsigned integer.
- *
- * @param[in] uMantissa    The mantissa.
- * @param[in] nExponent    The exponent.
- * @param[out] puResult  The resulting integer.
- *
- * Concrete implementations of this are for exponent base 10 and 2 supporting
- * decimal fractions and big floats.
- */
-typedef QCBORError (*fExponentiator)(uint64_t uMantissa, int64_t nExponent, uint64_t *puResult);
+typedef struct {
+   QCBORLabelIndexEntry    *pEntries;
+   size_t                   uSize;
+   size_t                   uMaxCount;
+   size_t                   uCount;
+   const MapSearchCallBack *pCallBack;
+} LabelIndexInfo;
 
 
-/**
- * @brief  Base 10 exponentiate a mantissa and exponent into an unsigned 64-bit integer.
- *
- * @param[in] uMantissa  The unsigned integer mantissa.
- * @param[in] nExponent  The signed integer exponent.
- * @param[out] puResult  Place to return the unsigned integer result.
- *
- * This computes: mantissa * 10 ^^ exponent as for a decimal fraction. The output is a 64-bit
- * unsigned integer.
- *
- * There are many inputs for which the result will not fit in the
- * 64-bit integer and @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW will
- * be returned.
- */
+/* Callback for QCBORDecode_Private_MapSearch() that puts each label
+ * in the map in the hash table. Linear probing. */
 static QCBORError
-QCBOR_Private_Exponentitate10(const uint64_t uMantissa,
-                              int64_t        nExponent,
-                              uint64_t      *puResult)
+QCBORDecode_Private_IndexLabel(void *pCallbackCtx, const QCBORItem *pItem)
 {
-   uint64_t uResult = uMantissa;
+   LabelIndexInfo       *pInfo = (LabelIndexInfo *)pCallbackCtx;
+   QCBORLabelFingerprint Label;
+   QCBORLabelIndexEntry *pEntry;
+   size_t                uSlot;
+   QCBORError            uErr;
 
-   if(uResult != 0) {
-      /* This loop will run a maximum of 19 times because
-       * UINT64_MAX < 10 ^^ 19. More than that will cause
-       * exit with the overflow error
-       */
-      for(; nExponent > 0; nExponent--) {
-         if(uResult > UINT64_MAX / 10) {
-            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-         }
-         uResult = uResult * 10;
-      }
+   if(pInfo->uCount > pInfo->uMaxCount) {
+      /* Too full to index. Keep going only to find the end. */
+      return QCBOR_SUCCESS;
+   }
 
-      for(; nExponent < 0; nExponent++) {
-         uResult = uResult / 10;
-         if(uResult == 0) {
-            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-         }
+   uErr = QCBOR_Private_FingerprintLabel(pItem, &Label);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
+   }
+
+   uSlot = (size_t)(Label.uKey % pInfo->uSize);
+   while(1) {
+      pEntry = &(pInfo->pEntries[uSlot]);
+      if(pEntry->Label.uLabelType == QCBOR_TYPE_NONE) {
+         break;
+      }
+      if(QCBOR_Private_CompareLabels(&(pEntry->Label), &Label) == 0) {
+         pEntry->bDuplicate = true;
+         return QCBOR_SUCCESS;
+      }
+      uSlot++;
+      if(uSlot == pInfo->uSize) {
+         uSlot = 0;
       }
    }
-   /* else, mantissa is zero so this returns zero */
 
-   *puResult = uResult;
+   pInfo->uCount++;
+   if(pInfo->uCount > pInfo->uMaxCount) {
+      return QCBOR_SUCCESS;
+   }
+   pEntry->Label      = Label;
+   /* Cast is safe because decoder input size is restricted. */
+   pEntry->uOffset    = (QCBOROffset)pInfo->pCallBack->uItemOffset;
+   pEntry->bDuplicate = false;
 
    return QCBOR_SUCCESS;
 }
 
 
 /**
- * @brief  Base 2 exponentiate a mantissa and exponent into an unsigned 64-bit integer.
- *
- * @param[in] uMantissa  The unsigned integer mantissa.
- * @param[in] nExponent  The signed integer exponent.
- * @param[out] puResult  Place to return the unsigned integer result.
+ * @brief Index the labels of the map just entered.
  *
- * This computes: mantissa * 2 ^^ exponent as for a big float. The
- * output is a 64-bit unsigned integer.
+ * @param[in] pMe        The decode context.
+ * @param[in] uMapCount  Number of items in the map.
  *
- * There are many inputs for which the result will not fit in the
- * 64-bit integer and @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW will
- * be returned.
+ * See QCBORDecode_SetLabelIndex(). This never fails. If the map
+ * can't be indexed, it is searched item by item which reports any
+ * errors in it. The map search also finds the end of the map which
+ * is kept for exiting it.
  */
-static QCBORError
-QCBOR_Private_Exponentitate2(const uint64_t uMantissa,
-                             int64_t        nExponent,
-                             uint64_t      *puResult)
+static void
+QCBORDecode_Private_BuildLabelIndex(QCBORDecodeContext *pMe, const QCBORCount uMapCount)
 {
-   uint64_t uResult;
+   QCBORItem         Dummy;
+   MapSearchCallBack CallBack;
+   LabelIndexInfo    Info;
+   UsefulInputBuf    SaveInBuf;
 
-   uResult = uMantissa;
+   pMe->uLabelIndexMap = QCBOR_NON_BOUNDED_OFFSET;
 
-   /* This loop will run a maximum of 64 times because INT64_MAX <
-    * 2^31. More than that will cause exit with the overflow error
-    */
-   while(nExponent > 0) {
-      if(uResult > UINT64_MAX >> 1) {
-         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-      }
-      uResult = uResult << 1;
-      nExponent--;
+   Info.uSize = pMe->uLabelIndexCount;
+   if(uMapCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH &&
+      (size_t)uMapCount * 2 < Info.uSize) {
+      /* Only clear and probe as much as this map needs */
+      Info.uSize = (size_t)uMapCount * 2;
    }
-
-   while(nExponent < 0 ) {
-      if(uResult == 0) {
-         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-      }
-      uResult = uResult >> 1;
-      nExponent++;
+   /* Always leaves an empty slot to end probing */
+   Info.uMaxCount = Info.uSize * 3 / 4;
+   if(Info.uMaxCount == 0) {
+      return;
+   }
+   Info.pEntries  = pMe->pLabelIndex;
+   Info.uCount    = 0;
+   Info.pCallBack = &CallBack;
+   memset(Info.pEntries, 0, Info.uSize * sizeof(QCBORLabelIndexEntry));
+
+   CallBack.pCBContext = &Info;
+   CallBack.pfCallback = QCBORDecode_Private_IndexLabel;
+   Dummy.uLabelType    = QCBOR_TYPE_NONE;
+
+   /* Saved so a map that runs off the end of the input doesn't leave
+    * the sticky input buffer error set for the searches that report
+    * errors. */
+   SaveInBuf = pMe->InBuf;
+   if(QCBORDecode_Private_MapSearch(pMe, &Dummy, NULL, &CallBack) != QCBOR_SUCCESS ||
+      Info.uCount > Info.uMaxCount) {
+      pMe->InBuf = SaveInBuf;
+      return;
    }
 
-   *puResult = uResult;
-
-   return QCBOR_SUCCESS;
+   pMe->uLabelIndexSize = (QCBORCount)Info.uSize;
+   pMe->uLabelIndexMap  = DecodeNesting_GetMapOrArrayStart(&(pMe->nesting));
+   pMe->uLabelIndexEnd  = pMe->uMapEndOffsetCache;
 }
 
 
 /**
- * @brief Exponentiate a signed mantissa and signed exponent to produce a signed result.
+ * @brief Enter a map or array that was just gotten with GetNext().
  *
- * @param[in] nMantissa  Signed integer mantissa.
- * @param[in] nExponent  Signed integer exponent.
- * @param[out] pnResult  Place to put the signed integer result.
- * @param[in] pfExp      Exponentiation function.
+ * @param[in] pMe     The decode context
+ * @param[in] uType   QCBOR_TYPE_MAP or QCBOR_TYPE_ARRAY.
+ * @param[in] pItem   The data item for the map or array.
  *
- * @returns Error code
+ * @returns QCBOR_SUCCESS or an error code.
  *
- * @c pfExp performs exponentiation on and unsigned mantissa and
- * produces an unsigned result. This converts the mantissa from signed
- * and converts the result to signed. The exponentiation function is
- * either for base 2 or base 10 (and could be other if needed).
+ * This is the book keeping for entering once QCBORDecode_GetNext()
+ * has returned @c pItem and descended into it. It is separate so
+ * QCBORDecode_GetStruct() can enter nested maps it finds.
  */
 static QCBORError
-QCBOR_Private_ExponentiateNN(const int64_t  nMantissa,
-                             const int64_t  nExponent,
-                             int64_t       *pnResult,
-                             fExponentiator pfExp)
+QCBORDecode_Private_EnterBoundedItem(QCBORDecodeContext *pMe,
+                                     const uint8_t       uType,
+                                     const QCBORItem    *pItem)
 {
-   uint64_t uResult;
-   uint64_t uMantissa;
+   QCBORError uErr;
+   uint8_t    uItemDataType = pItem->uDataType;
 
-   /* Take the absolute value and put it into an unsigned. */
-   if(nMantissa >= 0) {
-      /* Positive case is straightforward */
-      uMantissa = (uint64_t)nMantissa;
-   } else if(nMantissa != INT64_MIN) {
-      /* The common negative case. See next. */
-      uMantissa = (uint64_t)-nMantissa;
-   } else {
-      /* int64_t and uint64_t are always two's complement per the
-       * C standard (and since QCBOR uses these it only works with
-       * two's complement, which is pretty much universal these
-       * days). The range of a negative two's complement integer is
-       * one more that than a positive, so the simple code above might
-       * not work all the time because you can't simply negate the
-       * value INT64_MIN because it can't be represented in an
-       * int64_t. -INT64_MIN can however be represented in a
-       * uint64_t. Some compilers seem to recognize this case for the
-       * above code and put the correct value in uMantissa, however
-       * they are not required to do this by the C standard. This next
-       * line does however work for all compilers.
-       *
-       * This does assume two's complement where -INT64_MIN ==
-       * INT64_MAX + 1 (which wouldn't be true for one's complement or
-       * sign and magnitude (but we know we're using two's complement
-       * because int64_t requires it)).
-       *
-       * See these, particularly the detailed commentary:
-       * https://stackoverflow.com/questions/54915742/does-c99-mandate-a-int64-t-type-be-available-always
-       * https://stackoverflow.com/questions/37301078/is-negating-int-min-undefined-behaviour
-       */
-      uMantissa = (uint64_t)INT64_MAX+1;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   if(uItemDataType == QCBOR_TYPE_MAP_AS_ARRAY ) {
+      uItemDataType = QCBOR_TYPE_ARRAY;
    }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 
-   /* Call the exponentiator passed for either base 2 or base 10.
-    * Here is where most of the overflow errors are caught. */
-   QCBORError uReturn = (*pfExp)(uMantissa, nExponent, &uResult);
-   if(uReturn) {
-      return uReturn;
+   if(uItemDataType != uType) {
+      return QCBOR_ERR_UNEXPECTED_TYPE;
    }
 
-   /* Convert back to the sign of the original mantissa */
-   if(nMantissa >= 0) {
-      if(uResult > INT64_MAX) {
-         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-      }
-      *pnResult = (int64_t)uResult;
-   } else {
-      /* (uint64_t)INT64_MAX+1 is used to represent the absolute value
-       * of INT64_MIN. This assumes two's compliment representation
-       * where INT64_MIN is one increment farther from 0 than
-       * INT64_MAX.  Trying to write -INT64_MIN doesn't work to get
-       * this because the compiler makes it an int64_t which can't
-       * represent -INT64_MIN. Also see above.
-       */
-      if(uResult > (uint64_t)INT64_MAX+1) {
-         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+   QCBORDecode_Private_CopyTags(pMe, pItem);
+
+
+   const bool bIsEmpty = (pItem->uNextNestLevel <= pItem->uNestingLevel);
+   if(bIsEmpty) {
+      if(DecodeNesting_IsCurrentDefiniteLength(&(pMe->nesting))) {
+         // Undo decrement done by QCBORDecode_GetNext() so the the
+         // the decrement when exiting the map/array works correctly
+         DecodeNesting_Current(&(pMe->nesting))->ma.uCountCursor++;
       }
-      *pnResult = -(int64_t)uResult;
+      // Special case to increment nesting level for zero-length maps
+      // and arrays entered in bounded mode.
+      DecodeNesting_Descend(&(pMe->nesting), uType);
    }
 
-   return QCBOR_SUCCESS;
+   pMe->uMapEndOffsetCache = QCBOR_MAP_OFFSET_CACHE_INVALID;
+
+   uErr = DecodeNesting_EnterBoundedMapOrArray(&(pMe->nesting), bIsEmpty,
+                                               UsefulInputBuf_Tell(&(pMe->InBuf)));
+
+   if(uErr == QCBOR_SUCCESS && uType == QCBOR_TYPE_MAP && !bIsEmpty &&
+      pMe->pLabelCheck != NULL) {
+      uErr = QCBORDecode_Private_CheckDuplicateLabels(pMe);
+   }
+
+   if(uErr == QCBOR_SUCCESS && uType == QCBOR_TYPE_MAP && !bIsEmpty &&
+      pMe->pLabelIndex != NULL) {
+      QCBORDecode_Private_BuildLabelIndex(pMe, pItem->val.uCount);
+   }
+
+   return uErr;
 }
 
 
 /**
- * @brief Exponentiate an unsigned mantissa and signed exponent to produce an unsigned result.
+ * @brief Semi-private to do the the work for EnterMap() and EnterArray().
  *
- * @param[in] nMantissa  Signed integer mantissa.
- * @param[in] nExponent  Signed integer exponent.
- * @param[out] puResult  Place to put the signed integer result.
- * @param[in] pfExp      Exponentiation function.
+ * @param[in] pMe     The decode context
+ * @param[in] uType   QCBOR_TYPE_MAP or QCBOR_TYPE_ARRAY.
+ * @param[out] pItem  The data item for the map or array entered.
  *
- * @returns Error code
- *
- * @c pfExp performs exponentiation on and unsigned mantissa and
- * produces an unsigned result. This errors out if the mantissa
- * is negative because the output is unsigned.
+ * The next item in the traversal must be a map or array.  This
+ * consumes that item and does the book keeping to enter the map or
+ * array.
  */
-static QCBORError
-QCBOR_Private_ExponentitateNU(const int64_t  nMantissa,
-                              const int64_t  nExponent,
-                              uint64_t      *puResult,
-                              fExponentiator pfExp)
+void
+QCBORDecode_Private_EnterBoundedMapOrArray(QCBORDecodeContext *pMe,
+                                           const uint8_t       uType,
+                                           QCBORItem          *pItem)
 {
-   if(nMantissa < 0) {
-      return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+   QCBORError uErr;
+   QCBORItem  Item;
+
+   /* Must only be called on maps and arrays. */
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      // Already in error state; do nothing.
+      return;
    }
 
-   /* Cast to unsigned is OK because of check for negative.
-    * Cast to unsigned is OK because UINT64_MAX > INT64_MAX.
-    * Exponentiation is straight forward
-    */
-   return (*pfExp)((uint64_t)nMantissa, nExponent, puResult);
+   /* Get the data item that is the map or array being entered. */
+   uErr = QCBORDecode_GetNext(pMe, &Item);
+   if(uErr == QCBOR_SUCCESS) {
+      uErr = QCBORDecode_Private_EnterBoundedItem(pMe, uType, &Item);
+   }
+
+   if(pItem != NULL) {
+      *pItem = Item;
+   }
+
+   pMe->uLastError = (uint8_t)uErr;
 }
 
 
 /**
- * @brief Exponentiate an usnigned mantissa and unsigned exponent to produce an unsigned result.
+ * @brief Exit a bounded map, array or bstr (semi-private).
  *
- * @param[in] uMantissa  Unsigned integer mantissa.
- * @param[in] nExponent  Unsigned integer exponent.
- * @param[out] puResult  Place to put the unsigned integer result.
- * @param[in] pfExp      Exponentiation function.
+ * @param[in] pMe         Decode context.
+ * @param[in] uEndOffset  The input buffer offset of the end of item exited.
  *
- * @returns Error code
+ * @returns  QCBOR_SUCCESS or an error code.
  *
- * @c pfExp performs exponentiation on and unsigned mantissa and
- * produces an unsigned result so this is just a wrapper that does
- * nothing (and is likely inlined).
+ * This is the common work for exiting a level that is a bounded map,
+ * array or bstr wrapped CBOR.
+ *
+ * One chunk of work is to set up the pre-order traversal so it is at
+ * the item just after the bounded map, array or bstr that is being
+ * exited. This is somewhat complex.
+ *
+ * The other work is to level-up the bounded mode to next higest
+ * bounded mode or the top level if there isn't one.
  */
 static QCBORError
-QCBOR_Private_ExponentitateUU(const uint64_t uMantissa,
-                              const int64_t  nExponent,
-                              uint64_t      *puResult,
-                              fExponentiator pfExp)
+QCBORDecode_Private_ExitBoundedLevel(QCBORDecodeContext *pMe,
+                                     const QCBOROffset   uEndOffset)
 {
-   return (*pfExp)(uMantissa, nExponent, puResult);
-}
+   QCBORError uErr;
 
-#endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
+   /*
+    * First the pre-order-traversal byte offset is positioned to the
+    * item just after the bounded mode item that was just consumed.
+    */
+   UsefulInputBuf_Seek(&(pMe->InBuf), uEndOffset);
+
+   /*
+    * Next, set the current nesting level to one above the bounded
+    * level that was just exited.
+    *
+    * DecodeNesting_CheckBoundedType() is always called before this
+    * and makes sure pCurrentBounded is valid.
+    */
+   DecodeNesting_LevelUpCurrent(&(pMe->nesting));
+
+   /*
+    * This does the complex work of leveling up the pre-order
+    * traversal when the end of a map or array or another bounded
+    * level is reached.  It may do nothing, or ascend all the way to
+    * the top level.
+    */
+   uErr = QCBORDecode_Private_NestLevelAscender(pMe, false, NULL);
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
 
+   /*
+    * This makes the next highest bounded level the current bounded
+    * level. If there is no next highest level, then no bounded mode
+    * is in effect.
+    */
+   DecodeNesting_LevelUpBounded(&(pMe->nesting));
+
+   pMe->uMapEndOffsetCache = QCBOR_MAP_OFFSET_CACHE_INVALID;
 
+Done:
+   return uErr;
+}
 
 
 /**
- * @brief Convert a CBOR big number to a uint64_t.
- *
- * @param[in] BigNum  Bytes of the big number to convert.
- * @param[in] uMax  Maximum value allowed for the result.
- * @param[out] pResult  Place to put the unsigned integer result.
+ * @brief Get started exiting a map or array (semi-private)
  *
- * @returns Error code
+ * @param[in] pMe  The decode context
+ * @param[in] uType  QCBOR_TYPE_ARRAY or QCBOR_TYPE_MAP
  *
- * Many values will overflow because  a big num can represent a much
- * larger range than uint64_t.
+ * This does some work for map and array exiting (but not
+ * bstr exiting). Then QCBORDecode_Private_ExitBoundedLevel()
+ * is called to do the rest.
  */
-static QCBORError
-QCBOR_Private_ConvertBigNumToUnsigned(const UsefulBufC BigNum,
-                                      const uint64_t   uMax,
-                                      uint64_t        *pResult)
+void
+QCBORDecode_Private_ExitBoundedMapOrArray(QCBORDecodeContext *pMe,
+                                          const uint8_t       uType)
 {
-   uint64_t uResult;
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      /* Already in error state; do nothing. */
+      return;
+   }
 
-   uResult = 0;
-   const uint8_t *pByte = BigNum.ptr;
-   size_t uLen = BigNum.len;
-   while(uLen--) {
-      if(uResult > (uMax >> 8)) {
-         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+   QCBORError uErr;
+
+   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), uType)) {
+      uErr = QCBOR_ERR_EXIT_MISMATCH;
+      goto Done;
+   }
+
+   /*
+    Have to set the offset to the end of the map/array
+    that is being exited. If there is no cached value,
+    from previous map search, then do a dummy search.
+    */
+   if(pMe->uMapEndOffsetCache == QCBOR_MAP_OFFSET_CACHE_INVALID &&
+      QCBORDecode_Private_HasLabelIndex(pMe)) {
+      pMe->uMapEndOffsetCache = pMe->uLabelIndexEnd;
+   }
+   if(pMe->uMapEndOffsetCache == QCBOR_MAP_OFFSET_CACHE_INVALID &&
+      pMe->pContainerIndex != NULL) {
+      const QCBORContainerIndexEntry *pEntry;
+      pEntry = QCBORDecode_Private_LookUpContainer(pMe, DecodeNesting_GetMapOrArrayStart(&(pMe->nesting)));
+      if(pEntry != NULL &&
+         pEntry->uEndOffset <= UsefulInputBuf_GetBufferLength(&(pMe->InBuf))) {
+         pMe->uMapEndOffsetCache = pEntry->uEndOffset;
+      }
+   }
+   if(pMe->uMapEndOffsetCache == QCBOR_MAP_OFFSET_CACHE_INVALID) {
+      QCBORItem Dummy;
+      Dummy.uLabelType = QCBOR_TYPE_NONE;
+      uErr = QCBORDecode_Private_MapSearch(pMe, &Dummy, NULL, NULL);
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
       }
-      uResult = (uResult << 8) + *pByte++;
    }
 
-   *pResult = uResult;
-   return QCBOR_SUCCESS;
+   uErr = QCBORDecode_Private_ExitBoundedLevel(pMe, pMe->uMapEndOffsetCache);
+
+   if(uType == QCBOR_TYPE_MAP) {
+      /* The label index is only ever for the map most recently
+       * entered which is this one */
+      pMe->uLabelIndexMap = QCBOR_NON_BOUNDED_OFFSET;
+   }
+
+Done:
+   pMe->uLastError = (uint8_t)uErr;
 }
 
 
-/**
- * @brief Convert a CBOR postive big number to a uint64_t.
- *
- * @param[in] BigNum  Bytes of the big number to convert.
- * @param[out] pResult  Place to put the unsigned integer result.
- *
- * @returns Error code
- *
- * Many values will overflow because  a big num can represent a much
- * larger range than uint64_t.
- */
-static QCBORError
-QCBOR_Private_ConvertPositiveBigNumToUnsigned(const UsefulBufC BigNum,
-                                              uint64_t        *pResult)
+/* Whether an item's label is a field's; see QCBORDecode_GetStruct() */
+static bool
+QCBOR_Private_MatchFieldLabel(const QCBORStructField *pField, const QCBORItem *pItem)
 {
-   return QCBOR_Private_ConvertBigNumToUnsigned(BigNum, UINT64_MAX, pResult);
+   if(pField->szLabel == NULL) {
+      return pItem->uLabelType == QCBOR_TYPE_INT64 &&
+             pItem->label.int64 == pField->nLabel;
+   }
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   return pItem->uLabelType == QCBOR_TYPE_TEXT_STRING &&
+          UsefulBuf_Compare(pItem->label.string, UsefulBuf_FromSZ(pField->szLabel)) == 0;
+#else /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   return false;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
 }
 
 
 /**
- * @brief Convert a CBOR positive big number to an int64_t.
+ * @brief Put a decoded item in a structure field.
  *
- * @param[in] BigNum  Bytes of the big number to convert.
- * @param[out] pResult  Place to put the signed integer result.
+ * @param[in] pField   The field description.
+ * @param[in] pItem    The item with the field's label.
+ * @param[out] pTarget Where the field is in the structure.
  *
- * @returns Error code
+ * @returns QCBOR_SUCCESS or the error for the field.
  *
- * Many values will overflow because  a big num can represent a much
- * larger range than int64_t.
+ * This is for all the types except @ref QCBOR_TYPE_MAP.  The
+ * structure might not be aligned for the field if the caller got
+ * uOffset wrong, so memcpy() is used rather than a cast.
  */
 static QCBORError
-QCBOR_Private_ConvertPositiveBigNumToSigned(const UsefulBufC BigNum,
-                                            int64_t         *pResult)
+QCBOR_Private_StoreField(const QCBORStructField *pField,
+                         const QCBORItem        *pItem,
+                         uint8_t                *pTarget)
 {
-   uint64_t uResult;
-   QCBORError uError = QCBOR_Private_ConvertBigNumToUnsigned(BigNum,
-                                                             INT64_MAX,
-                                                             &uResult);
-   if(uError) {
-      return uError;
+   uint64_t uValue;
+   bool     bValue;
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+   double   dValue;
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+   switch(pField->uType) {
+      case QCBOR_TYPE_INT64:
+         if(pItem->uDataType == QCBOR_TYPE_UINT64) {
+            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+         }
+         if(pItem->uDataType != QCBOR_TYPE_INT64) {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         memcpy(pTarget, &(pItem->val.int64), sizeof(int64_t));
+         break;
+
+      case QCBOR_TYPE_UINT64:
+         if(pItem->uDataType == QCBOR_TYPE_INT64) {
+            if(pItem->val.int64 < 0) {
+               return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+            }
+            uValue = (uint64_t)pItem->val.int64;
+         } else if(pItem->uDataType == QCBOR_TYPE_UINT64) {
+            uValue = pItem->val.uint64;
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         memcpy(pTarget, &uValue, sizeof(uint64_t));
+         break;
+
+      case QCBOR_TYPE_DOUBLE:
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+         if(pItem->uDataType == QCBOR_TYPE_DOUBLE) {
+            dValue = pItem->val.dfnum;
+         } else if(pItem->uDataType == QCBOR_TYPE_FLOAT) {
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+            dValue = (double)pItem->val.fnum;
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+            return QCBOR_ERR_HW_FLOAT_DISABLED;
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         memcpy(pTarget, &dValue, sizeof(double));
+         break;
+#else /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+         return QCBOR_ERR_ALL_FLOAT_DISABLED;
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+      case QCBOR_TYPE_TRUE:
+         if(pItem->uDataType != QCBOR_TYPE_TRUE && pItem->uDataType != QCBOR_TYPE_FALSE) {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         bValue = pItem->uDataType == QCBOR_TYPE_TRUE;
+         memcpy(pTarget, &bValue, sizeof(bool));
+         break;
+
+      case QCBOR_TYPE_TEXT_STRING:
+      case QCBOR_TYPE_BYTE_STRING:
+         if(pItem->uDataType != pField->uType) {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         memcpy(pTarget, &(pItem->val.string), sizeof(UsefulBufC));
+         break;
+
+      default:
+         /* QCBOR_TYPE_ANY. Others are ruled out by the descriptor check */
+         memcpy(pTarget, pItem, sizeof(QCBORItem));
+         break;
    }
-   /* Cast is safe because ConvertBigNumToUnsigned limits to INT64_MAX */
-   *pResult = (int64_t)uResult;
+
    return QCBOR_SUCCESS;
 }
 
 
 /**
- * @brief Convert a CBOR negative big number to an int64_t.
+ * @brief Fill in a structure from the map just entered.
  *
- * @param[in] BigNum  Bytes of the big number to convert.
- * @param[out] pnResult  Place to put the signed integer result.
+ * @param[in] pMe             The decode context.
+ * @param[in] pDescriptor     The fields of the structure.
+ * @param[out] pStruct        The structure.
+ * @param[out] puFieldErrors  Error for each field or @c NULL.
+ * @param[out] puFirstError   The first error in field order.
  *
- * @returns Error code
+ * @returns An error that stops decoding or @ref QCBOR_SUCCESS.
  *
- * Many values will overflow because  a big num can represent a much
- * larger range than int64_t.
+ * This gets every item in the map once with QCBORDecode_GetNext()
+ * rather than doing a map search per field. Nested maps for nested
+ * structures are entered and filled in recursively as they come up.
+ * Field errors don't stop decoding; they are returned in
+ * @c puFirstError. On success, this is at the end of the map and the
+ * end offset is cached so exiting doesn't have to search for it.
  */
 static QCBORError
-QCBOR_Private_ConvertNegativeBigNumToSigned(const UsefulBufC BigNum,
-                                            int64_t         *pnResult)
-{
-   uint64_t uResult;
+QCBORDecode_Private_FillStruct(QCBORDecodeContext          *pMe,
+                               const QCBORStructDescriptor *pDescriptor,
+                               uint8_t                     *pStruct,
+                               QCBORError                  *puFieldErrors,
+                               QCBORError                  *puFirstError)
+{
+   QCBORItem               Item;
+   QCBORError              uErr;
+   QCBORError              uFieldErr;
+   const QCBORStructField *pField;
+   uint64_t                uFound;
+   size_t                  uField;
+   size_t                  uNext;
+   size_t                  uTries;
+   size_t                  uFirstErrorField;
+   uint8_t                 uNextNestLevel;
+   bool                    bConsumed;
+
+   if(pDescriptor->uNumFields > QCBOR_MAX_STRUCT_FIELDS) {
+      return QCBOR_ERR_STRUCT_DESCRIPTOR;
+   }
+   for(uField = 0; uField < pDescriptor->uNumFields; uField++) {
+      pField = &(pDescriptor->pFields[uField]);
+      switch(pField->uType) {
+         case QCBOR_TYPE_INT64:
+         case QCBOR_TYPE_UINT64:
+         case QCBOR_TYPE_DOUBLE:
+         case QCBOR_TYPE_TRUE:
+         case QCBOR_TYPE_TEXT_STRING:
+         case QCBOR_TYPE_BYTE_STRING:
+         case QCBOR_TYPE_ANY:
+            break;
+
+         case QCBOR_TYPE_MAP:
+            if(pField->pNested != NULL) {
+               break;
+            }
+            return QCBOR_ERR_STRUCT_DESCRIPTOR;
+
+         default:
+            return QCBOR_ERR_STRUCT_DESCRIPTOR;
+      }
+      if(puFieldErrors != NULL) {
+         puFieldErrors[uField] = QCBOR_SUCCESS;
+      }
+   }
+
+   uFound           = 0;
+   uNext            = 0;
+   uFirstErrorField = SIZE_MAX;
+   *puFirstError    = QCBOR_SUCCESS;
+
+   while(1) {
+      uErr = QCBORDecode_GetNext(pMe, &Item);
+      if(uErr == QCBOR_ERR_NO_MORE_ITEMS) {
+         break;
+      }
+      if(QCBORDecode_IsNotWellFormedError(uErr) ||
+         QCBORDecode_IsUnrecoverableError(uErr)) {
+         return uErr;
+      }
+
+      /* Look first at the field after the last one matched */
+      pField = NULL;
+      uField = 0;
+      for(uTries = 0; uTries < pDescriptor->uNumFields; uTries++) {
+         uField = uNext + uTries;
+         if(uField >= pDescriptor->uNumFields) {
+            uField -= pDescriptor->uNumFields;
+         }
+         if(QCBOR_Private_MatchFieldLabel(&(pDescriptor->pFields[uField]), &Item)) {
+            pField = &(pDescriptor->pFields[uField]);
+            break;
+         }
+      }
+
+      bConsumed = false;
+      if(pField != NULL) {
+         uNext = uField + 1;
+         if(uFound & (0x01ULL << uField)) {
+            uFieldErr = QCBOR_ERR_DUPLICATE_LABEL;
+         } else if(uErr != QCBOR_SUCCESS) {
+            /* Recoverable error decoding the item */
+            uFieldErr = uErr;
+         } else if(pField->uType == QCBOR_TYPE_MAP) {
+            if(Item.uDataType != QCBOR_TYPE_MAP) {
+               uFieldErr = QCBOR_ERR_UNEXPECTED_TYPE;
+            } else {
+               uErr = QCBORDecode_Private_EnterBoundedItem(pMe, QCBOR_TYPE_MAP, &Item);
+               if(uErr != QCBOR_SUCCESS) {
+                  return uErr;
+               }
+               uErr = QCBORDecode_Private_FillStruct(pMe,
+                                                     pField->pNested,
+                                                     pStruct + pField->uOffset,
+                                                     NULL,
+                                                     &uFieldErr);
+               if(uErr != QCBOR_SUCCESS) {
+                  return uErr;
+               }
+               QCBORDecode_Private_ExitBoundedMapOrArray(pMe, QCBOR_TYPE_MAP);
+               if(pMe->uLastError != QCBOR_SUCCESS) {
+                  return (QCBORError)pMe->uLastError;
+               }
+               bConsumed = true;
+            }
+         } else {
+            uFieldErr = QCBOR_Private_StoreField(pField, &Item, pStruct + pField->uOffset);
+         }
+         uFound |= 0x01ULL << uField;
+
+         if(uFieldErr != QCBOR_SUCCESS) {
+            if(puFieldErrors != NULL && puFieldErrors[uField] == QCBOR_SUCCESS) {
+               puFieldErrors[uField] = uFieldErr;
+            }
+            if(uField < uFirstErrorField) {
+               uFirstErrorField = uField;
+               *puFirstError    = uFieldErr;
+            }
+         }
+      }
+
+      if(!bConsumed) {
+         uErr = QCBORDecode_Private_ConsumeItem(pMe, &Item, NULL, &uNextNestLevel);
+         if(uErr != QCBOR_SUCCESS) {
+            return uErr;
+         }
+      }
+   }
+
+   /* Cast is safe because decoder input size is restricted. */
+   pMe->uMapEndOffsetCache = (QCBOROffset)UsefulInputBuf_Tell(&(pMe->InBuf));
+
+   for(uField = 0; uField < pDescriptor->uNumFields; uField++) {
+      if(uFound & (0x01ULL << uField)) {
+         continue;
+      }
+      if(puFieldErrors != NULL) {
+         puFieldErrors[uField] = QCBOR_ERR_LABEL_NOT_FOUND;
+      }
+      if((pDescriptor->pFields[uField].uFlags & QCBOR_FIELD_REQUIRED) &&
+         uField < uFirstErrorField) {
+         uFirstErrorField = uField;
+         *puFirstError    = QCBOR_ERR_LABEL_NOT_FOUND;
+      }
+   }
+
+   return QCBOR_SUCCESS;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetStruct(QCBORDecodeContext          *pMe,
+                      const QCBORStructDescriptor *pDescriptor,
+                      void                        *pStruct,
+                      QCBORError                  *puFieldErrors)
+{
+   QCBORError uErr;
+   QCBORError uFieldErr;
+
+   QCBORDecode_Private_EnterBoundedMapOrArray(pMe, QCBOR_TYPE_MAP, NULL);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   uErr = QCBORDecode_Private_FillStruct(pMe, pDescriptor, pStruct, puFieldErrors, &uFieldErr);
+   if(uErr != QCBOR_SUCCESS) {
+      pMe->uLastError = (uint8_t)uErr;
+      return;
+   }
+
+   QCBORDecode_Private_ExitBoundedMapOrArray(pMe, QCBOR_TYPE_MAP);
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      pMe->uLastError = (uint8_t)uFieldErr;
+   }
+}
+
+
+/* Parse the decimal digits from pStart up to pEnd. Fails if there
+ * aren't any, there is anything else or the value is more than
+ * uMax. */
+static bool
+QCBOR_Private_ParsePathNumber(const char     *pStart,
+                              const char     *pEnd,
+                              const uint64_t  uMax,
+                              uint64_t       *puValue)
+{
+   uint64_t uValue;
+   uint64_t uDigit;
+
+   if(pStart == pEnd) {
+      return false;
+   }
+
+   uValue = 0;
+   for(; pStart < pEnd; pStart++) {
+      if(*pStart < '0' || *pStart > '9') {
+         return false;
+      }
+      uDigit = (uint64_t)(*pStart - '0');
+      if(uValue > (uMax - uDigit) / 10) {
+         return false;
+      }
+      uValue = uValue * 10 + uDigit;
+   }
+
+   *puValue = uValue;
+   return true;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+QCBORError
+QCBORPath_Compile(const char *szPath, QCBORPath *pPath)
+{
+   const char    *pStart;
+   const char    *pEnd;
+   uint64_t       uValue;
+   QCBORPathStep *pStep;
+
+   pPath->uNumSteps = 0;
+   pStart           = szPath;
+
+   while(1) {
+      if(pPath->uNumSteps >= QCBOR_MAX_PATH_STEPS) {
+         return QCBOR_ERR_PATH_SYNTAX;
+      }
+      pStep = &(pPath->Steps[pPath->uNumSteps]);
+
+      if(*pStart == '\'') {
+         /* A quoted text string label runs to the next quote */
+         for(pEnd = pStart + 1; *pEnd != '\''; pEnd++) {
+            if(*pEnd == '\0') {
+               return QCBOR_ERR_PATH_SYNTAX;
+            }
+         }
+         pStep->uType     = QCBOR_TYPE_TEXT_STRING;
+         pStep->Label.ptr = pStart + 1;
+         pStep->Label.len = (size_t)(pEnd - pStart - 1);
+         pEnd++;
+         if(*pEnd != '/' && *pEnd != '\0') {
+            return QCBOR_ERR_PATH_SYNTAX;
+         }
+
+      } else {
+         for(pEnd = pStart; *pEnd != '/' && *pEnd != '\0'; pEnd++);
+         if(pEnd == pStart) {
+            return QCBOR_ERR_PATH_SYNTAX;
+         }
+
+         if(*pStart == '[') {
+            if(pEnd[-1] != ']' ||
+               !QCBOR_Private_ParsePathNumber(pStart + 1, pEnd - 1, INT64_MAX, &uValue)) {
+               return QCBOR_ERR_PATH_SYNTAX;
+            }
+            pStep->uType  = QCBOR_TYPE_ARRAY;
+            pStep->nValue = (int64_t)uValue;
+
+         } else if(*pStart == '-' &&
+                   QCBOR_Private_ParsePathNumber(pStart + 1, pEnd, (uint64_t)INT64_MAX + 1, &uValue)) {
+            /* Done this way so INT64_MIN doesn't overflow */
+            pStep->uType  = QCBOR_TYPE_INT64;
+            pStep->nValue = uValue == 0 ? 0 : -(int64_t)(uValue - 1) - 1;
+
+         } else if(QCBOR_Private_ParsePathNumber(pStart, pEnd, INT64_MAX, &uValue)) {
+            pStep->uType  = QCBOR_TYPE_INT64;
+            pStep->nValue = (int64_t)uValue;
+
+         } else {
+            pStep->uType     = QCBOR_TYPE_TEXT_STRING;
+            pStep->Label.ptr = pStart;
+            pStep->Label.len = (size_t)(pEnd - pStart);
+         }
+      }
+
+      pPath->uNumSteps++;
+      if(*pEnd == '\0') {
+         break;
+      }
+      pStart = pEnd + 1;
+   }
+
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Skip one data item for QCBORDecode_GetByPath().
+ *
+ * @param[in] pMe      The decode context for the container index.
+ * @param[in] pInBuf   Input positioned at the item to skip.
+ *
+ * @returns QCBOR_SUCCESS or a not-well-formed error.
+ *
+ * Maps and arrays in the container index are jumped over. Everything
+ * else is scanned without decoding.
+ */
+static QCBORError
+QCBORDecode_Private_PathSkipItem(const QCBORDecodeContext *pMe,
+                                 UsefulInputBuf           *pInBuf)
+{
+   QCBORError                      uErr;
+   int                             nClass;
+   int                             nAdditionalInfo;
+   uint64_t                        uArgument;
+   size_t                          uIndexCount;
+   size_t                          uErrorOffset;
+   const QCBORContainerIndexEntry *pEntry;
+   const size_t                    uStart = UsefulInputBuf_Tell(pInBuf);
+
+   if(pMe->pContainerIndex != NULL) {
+      do {
+         uErr = QCBOR_Private_DecodeHead(pInBuf, &nClass, &uArgument, &nAdditionalInfo);
+      } while(uErr == QCBOR_SUCCESS && nClass == CBOR_MAJOR_TYPE_TAG);
+
+      if(uErr == QCBOR_SUCCESS &&
+         (nClass == CBOR_MAJOR_TYPE_ARRAY || nClass == CBOR_MAJOR_TYPE_MAP)) {
+         pEntry = QCBORDecode_Private_LookUpContainer(pMe, UsefulInputBuf_Tell(pInBuf));
+         if(pEntry != NULL &&
+            pEntry->uEndOffset <= UsefulInputBuf_GetBufferLength(pInBuf)) {
+            UsefulInputBuf_Seek(pInBuf, pEntry->uEndOffset);
+            return QCBOR_SUCCESS;
+         }
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr;
+      }
+      UsefulInputBuf_Seek(pInBuf, uStart);
+   }
+
+   uIndexCount = 0;
+   return QCBOR_Private_ScanItem(pInBuf, NULL, 0, &uIndexCount, &uErrorOffset);
+}
+
+
+/**
+ * @brief See if a map label matches a path step.
+ *
+ * @param[in] pMe       The decode context.
+ * @param[in] pInBuf    Input positioned at the label.
+ * @param[in] pStep     The step to match.
+ * @param[out] pbMatch  Whether it matched.
+ * @param[out] pLabel   The label bytes of a matched text string label.
+ *
+ * Only the head of integer and definite-length text string labels is
+ * decoded. Other labels never match and are skipped. The input is
+ * left after the label.
+ */
+static QCBORError
+QCBORDecode_Private_PathMatchLabel(const QCBORDecodeContext *pMe,
+                                   UsefulInputBuf           *pInBuf,
+                                   const QCBORPathStep      *pStep,
+                                   bool                     *pbMatch,
+                                   UsefulBufC               *pLabel)
+{
+   QCBORError   uErr;
+   int          nClass;
+   int          nAdditionalInfo;
+   uint64_t     uArgument;
+   const size_t uStart = UsefulInputBuf_Tell(pInBuf);
+
+   *pbMatch = false;
+#ifdef QCBOR_DISABLE_NON_INTEGER_LABELS
+   (void)pLabel;
+#endif /* QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   uErr = QCBOR_Private_DecodeHead(pInBuf, &nClass, &uArgument, &nAdditionalInfo);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
+   }
+
+   switch(nClass) {
+      case CBOR_MAJOR_TYPE_POSITIVE_INT:
+         *pbMatch = pStep->uType == QCBOR_TYPE_INT64 &&
+                    pStep->nValue >= 0 &&
+                    uArgument == (uint64_t)pStep->nValue;
+         return QCBOR_SUCCESS;
+
+      case CBOR_MAJOR_TYPE_NEGATIVE_INT:
+         /* -(nValue + 1) can't overflow for a negative nValue */
+         *pbMatch = pStep->uType == QCBOR_TYPE_INT64 &&
+                    pStep->nValue < 0 &&
+                    uArgument == (uint64_t)-(pStep->nValue + 1);
+         return QCBOR_SUCCESS;
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+      case CBOR_MAJOR_TYPE_TEXT_STRING:
+         if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+            break;
+         }
+         if(uArgument > UsefulInputBuf_BytesUnconsumed(pInBuf)) {
+            return QCBOR_ERR_HIT_END;
+         }
+         /* Cast is safe because of check against bytes left */
+         pLabel->len = (size_t)uArgument;
+         pLabel->ptr = UsefulInputBuf_GetBytes(pInBuf, pLabel->len);
+         *pbMatch = pStep->uType == QCBOR_TYPE_TEXT_STRING &&
+                    UsefulBuf_Compare(*pLabel, pStep->Label) == 0;
+         return QCBOR_SUCCESS;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+      default:
+         break;
+   }
+
+   UsefulInputBuf_Seek(pInBuf, uStart);
+   return QCBORDecode_Private_PathSkipItem(pMe, pInBuf);
+}
+
+
+/**
+ * @brief Decode the head of a map or array for a path step.
+ *
+ * @param[in] pMe           The decode context.
+ * @param[in] pInBuf        Input positioned at the map or array.
+ * @param[out] puRemaining  Number of items or map entries in it or
+ *                          @ref QCBOR_SCAN_INDEFINITE.
+ * @param[out] pbIsMap      Whether it is a map.
+ *
+ * Tag numbers before the head are skipped.
+ */
+static QCBORError
+QCBORDecode_Private_PathOpen(const QCBORDecodeContext *pMe,
+                             UsefulInputBuf           *pInBuf,
+                             uint64_t                 *puRemaining,
+                             bool                     *pbIsMap)
+{
+   QCBORError uErr;
+   int        nClass;
+   int        nAdditionalInfo;
+   uint64_t   uArgument;
+
+   do {
+      uErr = QCBOR_Private_DecodeHead(pInBuf, &nClass, &uArgument, &nAdditionalInfo);
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr;
+      }
+   } while(nClass == CBOR_MAJOR_TYPE_TAG);
+
+   if(nClass != CBOR_MAJOR_TYPE_ARRAY && nClass != CBOR_MAJOR_TYPE_MAP) {
+      return QCBOR_ERR_UNEXPECTED_TYPE;
+   }
+
+   *pbIsMap = nClass == CBOR_MAJOR_TYPE_MAP;
+   if(nAdditionalInfo == LEN_IS_INDEFINITE) {
+      uArgument = QCBOR_SCAN_INDEFINITE;
+   } else if(uArgument > UsefulInputBuf_BytesUnconsumed(pInBuf)) {
+      /* Keeps it from being QCBOR_SCAN_INDEFINITE or overflowing below */
+      return QCBOR_ERR_HIT_END;
+   }
+   if(*pbIsMap && pMe->uDecodeMode == QCBOR_DECODE_MODE_MAP_AS_ARRAY) {
+      *pbIsMap = false;
+      if(uArgument != QCBOR_SCAN_INDEFINITE) {
+         uArgument *= 2;
+      }
+   }
+   *puRemaining = uArgument;
+
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Find the item at the end of a path without decoding.
+ *
+ * @param[in] pMe        The decode context.
+ * @param[in] pPath      The path to follow.
+ * @param[out] puOffset  Offset of the item found.
+ * @param[out] pLabel    Label of the item found if it is a text string.
+ *
+ * This works on a copy of the input so the traversal cursor doesn't
+ * move.
+ */
+static QCBORError
+QCBORDecode_Private_FindByPath(const QCBORDecodeContext *pMe,
+                               const QCBORPath          *pPath,
+                               size_t                   *puOffset,
+                               UsefulBufC               *pLabel)
+{
+   QCBORError                uErr;
+   UsefulInputBuf            InBuf;
+   uint64_t                  uRemaining;
+   uint64_t                  uIndex;
+   bool                      bIsMap;
+   bool                      bMatch;
+   uint8_t                   uStep;
+   size_t                    uItemStart;
+   const QCBORPathStep      *pStep;
+   const QCBORDecodeLevel   *pLevel;
+
+   if(pPath->uNumSteps == 0 || pPath->uNumSteps > QCBOR_MAX_PATH_STEPS) {
+      return QCBOR_ERR_PATH_SYNTAX;
+   }
+
+   InBuf = pMe->InBuf;
+
+   if(DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_MAP) ||
+      DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_ARRAY)) {
+      /* Start in the entered map or array */
+      pLevel = DecodeNesting_Bounded(&(pMe->nesting));
+      bIsMap = DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_MAP);
+      if(DecodeNesting_IsBoundedEmpty(&(pMe->nesting))) {
+         uRemaining = 0;
+      } else if(pLevel->ma.uCountTotal == QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
+         uRemaining = QCBOR_SCAN_INDEFINITE;
+      } else {
+         uRemaining = pLevel->ma.uCountTotal;
+      }
+      UsefulInputBuf_Seek(&InBuf, pLevel->ma.uStartOffset);
+
+   } else {
+      /* Start at the first item in the input or bstr-wrapped CBOR */
+      if(DecodeNesting_IsBounded(&(pMe->nesting))) {
+         UsefulInputBuf_Seek(&InBuf, DecodeNesting_Bounded(&(pMe->nesting))->bs.uBstrStartOffset);
+      } else {
+         UsefulInputBuf_Seek(&InBuf, 0);
+      }
+      uErr = QCBORDecode_Private_PathOpen(pMe, &InBuf, &uRemaining, &bIsMap);
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr;
+      }
+   }
+
+   for(uStep = 0; ; uStep++) {
+      pStep = &(pPath->Steps[uStep]);
+      if(bIsMap != (pStep->uType != QCBOR_TYPE_ARRAY)) {
+         return QCBOR_ERR_UNEXPECTED_TYPE;
+      }
+
+      /* Look through the items or map entries for the step */
+      uIndex = 0;
+      while(1) {
+         if(uRemaining == 0) {
+            return QCBOR_ERR_LABEL_NOT_FOUND;
+         }
+         if(uRemaining == QCBOR_SCAN_INDEFINITE) {
+            uItemStart = UsefulInputBuf_Tell(&InBuf);
+            if(UsefulInputBuf_GetByte(&InBuf) == ((CBOR_MAJOR_TYPE_SIMPLE << 5) | CBOR_SIMPLE_BREAK)) {
+               return QCBOR_ERR_LABEL_NOT_FOUND;
+            }
+            UsefulInputBuf_Seek(&InBuf, uItemStart);
+         }
+
+         if(bIsMap) {
+            uErr = QCBORDecode_Private_PathMatchLabel(pMe, &InBuf, pStep, &bMatch, pLabel);
+            if(uErr != QCBOR_SUCCESS) {
+               return uErr;
+            }
+         } else {
+            bMatch = uIndex == (uint64_t)pStep->nValue;
+            uIndex++;
+         }
+         if(bMatch) {
+            break;
+         }
+
+         uErr = QCBORDecode_Private_PathSkipItem(pMe, &InBuf);
+         if(uErr != QCBOR_SUCCESS) {
+            return uErr;
+         }
+         if(uRemaining != QCBOR_SCAN_INDEFINITE) {
+            uRemaining--;
+         }
+      }
+
+      if(uStep + 1 == pPath->uNumSteps) {
+         break;
+      }
+      uErr = QCBORDecode_Private_PathOpen(pMe, &InBuf, &uRemaining, &bIsMap);
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr;
+      }
+   }
+
+   *puOffset = UsefulInputBuf_Tell(&InBuf);
+   return QCBOR_SUCCESS;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetByPath(QCBORDecodeContext *pMe,
+                      const QCBORPath    *pPath,
+                      QCBORItem          *pItem)
+{
+   QCBORError             uErr;
+   size_t                 uOffset;
+   UsefulBufC             Label;
+   QCBORDecodeNestingSave SaveNesting;
+   UsefulInputBuf         SaveInBuf;
+   const QCBORPathStep   *pLastStep;
+
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      pItem->uDataType  = QCBOR_TYPE_NONE;
+      pItem->uLabelType = QCBOR_TYPE_NONE;
+      return;
+   }
+
+   uErr = QCBORDecode_Private_FindByPath(pMe, pPath, &uOffset, &Label);
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
+
+   /* Decode the item found as if it were at the top level and then
+    * put the nesting and input back. All the levels are saved
+    * because decoding a map or array at the top level writes over
+    * level 1 and on. */
+   SaveInBuf = pMe->InBuf;
+   (void)DecodeNesting_SaveFrom(&(pMe->nesting), 0, true, &SaveNesting);
+   DecodeNesting_Init(&(pMe->nesting));
+   UsefulInputBuf_Seek(&(pMe->InBuf), uOffset);
+
+   uErr = QCBORDecode_Private_GetNextTagContent(pMe, pItem);
+
+   DecodeNesting_Restore(&(pMe->nesting), &SaveNesting);
+   pMe->InBuf = SaveInBuf;
+
+   pLastStep = &(pPath->Steps[pPath->uNumSteps - 1]);
+   if(pLastStep->uType == QCBOR_TYPE_INT64) {
+      pItem->uLabelType  = QCBOR_TYPE_INT64;
+      pItem->label.int64 = pLastStep->nValue;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   } else if(pLastStep->uType == QCBOR_TYPE_TEXT_STRING) {
+      pItem->uLabelType   = QCBOR_TYPE_TEXT_STRING;
+      pItem->label.string = Label;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   }
+
+Done:
+   if(uErr != QCBOR_SUCCESS) {
+      pItem->uDataType  = QCBOR_TYPE_NONE;
+      pItem->uLabelType = QCBOR_TYPE_NONE;
+   }
+   pMe->uLastError = (uint8_t)uErr;
+   QCBORDecode_Private_CopyTags(pMe, pItem);
+}
+
+
+/**
+ * @brief The main work of entering some byte-string wrapped CBOR.
+ *
+ * @param[in] pMe             The decode context.
+ * @param[in] pItem           The byte string item.
+ * @param[in] uTagRequirement One of @c QCBOR_TAG_REQUIREMENT_XXX
+ * @param[out] pBstr          Pointer and length of byte string entered.
+ *
+ * This is called once the byte string item has been decoded to do all
+ * the book keeping for descending one nesting level into the
+ * wrapped CBOR.
+ *
+ * See QCBORDecode_EnterBstrWrapped() for details on uTagRequirement.
+ */
+static void
+QCBORDecode_Private_EnterBstrWrapped(QCBORDecodeContext *pMe,
+                                     const QCBORItem    *pItem,
+                                     const uint8_t       uTagRequirement,
+                                     UsefulBufC         *pBstr)
+{
+   QCBORError uErr;
+   size_t     uStartOfBstr;
+   size_t     uEndOfBstr;
+   size_t     uPreviousLength;
+
+   const QCBOR_Private_TagSpec TagSpec =
+      {
+         uTagRequirement,
+         {QBCOR_TYPE_WRAPPED_CBOR, QBCOR_TYPE_WRAPPED_CBOR_SEQUENCE, QCBOR_TYPE_NONE},
+         {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
+      };
+
+   if(pBstr) {
+      *pBstr = NULLUsefulBufC;
+   }
+
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   if(pItem->uDataAlloc) {
+      uErr = QCBOR_ERR_CANNOT_ENTER_ALLOCATED_STRING;
+      goto Done;
+   }
+
+   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
+
+   if(DecodeNesting_IsCurrentDefiniteLength(&(pMe->nesting))) {
+      /* Reverse the decrement done by GetNext() for the bstr so the
+       * increment in QCBORDecode_NestLevelAscender() called by
+       * ExitBoundedLevel() will work right.
+       */
+      DecodeNesting_ReverseDecrement(&(pMe->nesting));
+   }
+
+   if(pBstr) {
+      *pBstr = pItem->val.string;
+   }
+
+   /* This saves the current length of the UsefulInputBuf and then
+    * narrows the UsefulInputBuf to start and length of the wrapped
+    * CBOR that is being entered.
+    *
+    * Most of these calls are simple inline accessors so this doesn't
+    * amount to much code.
+    */
+
+   uPreviousLength = UsefulInputBuf_GetBufferLength(&(pMe->InBuf));
+   /* This check makes the cast of uPreviousLength to QCBOROffset below safe. */
+   if(uPreviousLength >= QCBOR_MAX_DECODE_INPUT_SIZE) {
+      uErr = QCBOR_ERR_INPUT_TOO_LARGE;
+      goto Done;
+   }
+
+   uStartOfBstr = UsefulInputBuf_PointerToOffset(&(pMe->InBuf), pItem->val.string.ptr);
+
+   if(uStartOfBstr == SIZE_MAX && pItem->val.string.len == 0) {
+      /* When the bstr is zero-length, uStartOfBstr is the start
+       * of the next item. It is never used because the bstr
+       * is zero-length. When the zero-length bstr is
+       * at the end of the input uStartOfBstr, there is no next item
+       * so UsefulInputBuf_PointerToOffset() returns SIZE_MAX.
+       * It is still a legitimate input that must be handled,
+       * so this points uStartOfBstr to the current position.
+       */
+      uStartOfBstr = UsefulInputBuf_Tell(&(pMe->InBuf));
+   } else {
+      /* SIZE_MAX > QCBOR_MAX_DECODE_INPUT_SIZE so this catches the
+       * case where pItem->val.string.len != 0 */
+      if(uStartOfBstr > QCBOR_MAX_DECODE_INPUT_SIZE) {
+         uErr = QCBOR_ERR_INPUT_TOO_LARGE;
+         goto Done;
+      }
+   }
+
+   uEndOfBstr = uStartOfBstr + pItem->val.string.len;
+
+   UsefulInputBuf_Seek(&(pMe->InBuf), uStartOfBstr);
+   UsefulInputBuf_SetBufferLength(&(pMe->InBuf), uEndOfBstr);
+
+   uErr = DecodeNesting_DescendIntoBstrWrapped(&(pMe->nesting),
+                                                 (QCBOROffset)uPreviousLength,
+                                                 (QCBOROffset)uStartOfBstr);
+Done:
+   pMe->uLastError = (uint8_t) uErr;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnterBstrWrapped(QCBORDecodeContext *pMe,
+                             const uint8_t       uTagRequirement,
+                             UsefulBufC         *pBstr)
+{
+   QCBORItem Item;
+
+   /* Get the data item that is the byte string being entered */
+   QCBORDecode_VGetNext(pMe, &Item);
+   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnterBstrWrappedFromMapN(QCBORDecodeContext *pMe,
+                                     const int64_t       nLabel,
+                                     const uint8_t       uTagRequirement,
+                                     UsefulBufC         *pBstr)
+{
+   QCBORItem Item;
+
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_EnterBstrWrappedFromMapSZ(QCBORDecodeContext *pMe,
+                                      const char         *szLabel,
+                                      const uint8_t       uTagRequirement,
+                                      UsefulBufC         *pBstr)
+{
+   QCBORItem Item;
+
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_EnterBstrWrapped(pMe, &Item, uTagRequirement, pBstr);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_ExitBstrWrapped(QCBORDecodeContext *pMe)
+{
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      // Already in error state; do nothing.
+      return;
+   }
+
+   if(!DecodeNesting_IsBoundedType(&(pMe->nesting), QCBOR_TYPE_BYTE_STRING)) {
+      pMe->uLastError = QCBOR_ERR_EXIT_MISMATCH;
+      return;
+   }
+
+   const QCBOROffset uEndOfBstr = (QCBOROffset)UsefulInputBuf_GetBufferLength(&(pMe->InBuf));
+
+   /*
+    Reset the length of the UsefulInputBuf to what it was before
+    the bstr wrapped CBOR was entered.
+    */
+   UsefulInputBuf_SetBufferLength(&(pMe->InBuf),
+                               DecodeNesting_GetPreviousBoundedEnd(&(pMe->nesting)));
+
+
+   QCBORError uErr = QCBORDecode_Private_ExitBoundedLevel(pMe, uEndOfBstr);
+   pMe->uLastError = (uint8_t)uErr;
+}
+
+
+
+/**
+ * @brief Process simple type true and false, a boolean
+ *
+ * @param[in] pMe     The decode context.
+ * @param[in] pItem   The item with either true or false.
+ * @param[out] pBool  The boolean value output.
+ *
+ * Sets the internal error if the item isn't a true or a false. Also
+ * records any tag numbers as the tag numbers of the last item.
+ */
+static void
+QCBORDecode_Private_ProcessBool(QCBORDecodeContext *pMe,
+                                const QCBORItem    *pItem,
+                                bool               *pBool)
+{
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      /* Already in error state, do nothing */
+      return;
+   }
+
+   switch(pItem->uDataType) {
+      case QCBOR_TYPE_TRUE:
+         *pBool = true;
+         break;
+
+      case QCBOR_TYPE_FALSE:
+         *pBool = false;
+         break;
+
+      default:
+         pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
+         break;
+   }
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetBool(QCBORDecodeContext *pMe, bool *pValue)
+{
+   QCBORItem  Item;
+   QCBORDecode_VGetNext(pMe, &Item);
+   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetBoolInMapN(QCBORDecodeContext *pMe,
+                          const int64_t       nLabel,
+                          bool               *pValue)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetBoolInMapSZ(QCBORDecodeContext *pMe,
+                           const char         *szLabel,
+                           bool               *pValue)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessBool(pMe, &Item, pValue);
+}
+
+
+/**
+ * @brief Process simple values.
+ *
+ * @param[in] pMe     The decode context.
+ * @param[in] pItem   The item with the simple value.
+ * @param[out] puSimple  The simple value output.
+ *
+ * Sets the internal error if the item isn't a true or a false. Also
+ * records any tag numbers as the tag numbers of the last item.
+ */
+static void
+QCBORDecode_Private_ProcessSimple(QCBORDecodeContext *pMe,
+                                  const QCBORItem    *pItem,
+                                  uint8_t            *puSimple)
+{
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   /* It's kind of lame to remap true...undef back to simple values, but
+    * this function isn't used much and to not do it would require
+    * changing GetNext() behavior in an incompatible way.
+    */
+   switch(pItem->uDataType) {
+      case QCBOR_TYPE_UKNOWN_SIMPLE:
+         *puSimple = pItem->val.uSimple;
+         break;
+
+      case QCBOR_TYPE_TRUE:
+         *puSimple = CBOR_SIMPLEV_TRUE;
+         break;
+
+      case QCBOR_TYPE_FALSE:
+         *puSimple = CBOR_SIMPLEV_FALSE;
+         break;
+
+      case QCBOR_TYPE_NULL:
+         *puSimple = CBOR_SIMPLEV_NULL;
+         break;
+
+      case QCBOR_TYPE_UNDEF:
+         *puSimple = CBOR_SIMPLEV_UNDEF;
+         break;
+
+      default:
+         pMe->uLastError = QCBOR_ERR_UNEXPECTED_TYPE;
+         return;
+   }
+}
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetSimple(QCBORDecodeContext *pMe, uint8_t *puSimple)
+{
+   QCBORItem Item;
+   QCBORDecode_VGetNext(pMe, &Item);
+   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimple);
+}
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetSimpleInMapN(QCBORDecodeContext *pMe,
+                            int64_t             nLabel,
+                            uint8_t            *puSimpleValue)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimpleValue);
+}
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetSimpleInMapSZ(QCBORDecodeContext *pMe,
+                             const char         *szLabel,
+                             uint8_t            *puSimpleValue)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessSimple(pMe, &Item, puSimpleValue);
+}
+
+
+
+/**
+ * @brief Common processing for an epoch date.
+ *
+ * @param[in] pMe              The decode context.
+ * @param[in] pItem            The item with the date.
+ * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
+ * @param[out] pnTime          The returned date.
+ *
+ * Common processing for the date tag. Mostly make sure the tag
+ * content is correct and copy forward any further other tag numbers.
+ */
+static void
+QCBORDecode_Private_ProcessEpochDate(QCBORDecodeContext *pMe,
+                                     QCBORItem          *pItem,
+                                     const uint8_t       uTagRequirement,
+                                     int64_t            *pnTime)
+{
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      // Already in error state, do nothing
+      return;
+   }
+
+   QCBORError uErr;
+
+   const QCBOR_Private_TagSpec TagSpec =
+   {
+      uTagRequirement,
+      {QCBOR_TYPE_DATE_EPOCH, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
+      {QCBOR_TYPE_INT64, QCBOR_TYPE_DOUBLE, QCBOR_TYPE_FLOAT, QCBOR_TYPE_UINT64}
+   };
+
+   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
+
+   if(pItem->uDataType != QCBOR_TYPE_DATE_EPOCH) {
+      uErr = QCBOR_Private_DecodeDateEpoch(pItem);
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+   }
+
+   *pnTime = pItem->val.epochDate.nSeconds;
+
+Done:
+   pMe->uLastError = (uint8_t)uErr;
+}
+
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetEpochDate(QCBORDecodeContext *pMe,
+                         uint8_t             uTagRequirement,
+                         int64_t            *pnTime)
+{
+   QCBORItem  Item;
+   QCBORDecode_VGetNext(pMe, &Item);
+   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetEpochDateInMapN(QCBORDecodeContext *pMe,
+                               int64_t             nLabel,
+                               uint8_t             uTagRequirement,
+                               int64_t            *pnTime)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetEpochDateInMapSZ(QCBORDecodeContext *pMe,
+                                const char         *szLabel,
+                                uint8_t             uTagRequirement,
+                                int64_t            *pnTime)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessEpochDate(pMe, &Item, uTagRequirement, pnTime);
+}
+
+
+
+/**
+ * @brief Common processing for an epoch date.
+ *
+ * @param[in] pMe              The decode context.
+ * @param[in] pItem            The item with the date.
+ * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
+ * @param[out] pnDays          The returned day count.
+ *
+ * Common processing for the RFC 8943 day-count tag. Mostly make sure
+ * the tag content is correct and copy forward any further other tag
+ * numbers.
+ */
+static void
+QCBORDecode_Private_ProcessEpochDays(QCBORDecodeContext *pMe,
+                                     QCBORItem          *pItem,
+                                     uint8_t             uTagRequirement,
+                                     int64_t            *pnDays)
+{
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      /* Already in error state, do nothing */
+      return;
+   }
+
+   QCBORError uErr;
+
+   const QCBOR_Private_TagSpec TagSpec =
+   {
+      uTagRequirement,
+      {QCBOR_TYPE_DAYS_EPOCH, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
+      {QCBOR_TYPE_INT64, QCBOR_TYPE_UINT64, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
+   };
+
+   uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
+
+   if(pItem->uDataType != QCBOR_TYPE_DAYS_EPOCH) {
+      uErr = QCBOR_Private_DecodeDaysEpoch(pItem);
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+   }
+
+   *pnDays = pItem->val.epochDays;
+
+Done:
+   pMe->uLastError = (uint8_t)uErr;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h
+ */
+void
+QCBORDecode_GetEpochDays(QCBORDecodeContext *pMe,
+                         uint8_t             uTagRequirement,
+                         int64_t            *pnDays)
+{
+   QCBORItem  Item;
+   QCBORDecode_VGetNext(pMe, &Item);
+   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h
+ */
+void
+QCBORDecode_GetEpochDaysInMapN(QCBORDecodeContext *pMe,
+                               int64_t             nLabel,
+                               uint8_t             uTagRequirement,
+                               int64_t            *pnDays)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h
+ */
+void
+QCBORDecode_GetEpochDaysInMapSZ(QCBORDecodeContext *pMe,
+                                const char         *szLabel,
+                                uint8_t             uTagRequirement,
+                                int64_t            *pnDays)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   QCBORDecode_Private_ProcessEpochDays(pMe, &Item, uTagRequirement, pnDays);
+}
+
+
+
+/*
+ * @brief Get a string that matches the type/tag specification.
+ */
+void
+QCBORDecode_Private_GetTaggedString(QCBORDecodeContext         *pMe,
+                                    const QCBOR_Private_TagSpec TagSpec,
+                                    UsefulBufC                 *pBstr)
+{
+   QCBORItem  Item;
+
+   QCBORDecode_VGetNext(pMe, &Item);
+   if(pMe->uLastError) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_CheckTagRequirement(TagSpec, &Item);
+
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      *pBstr = Item.val.string;
+   } else {
+      *pBstr = NULLUsefulBufC;
+   }
+}
+
+
+
+
+/**
+ * @brief Common processing for a big number tag.
+ *
+ * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
+ * @param[in] pItem            The item with the date.
+ * @param[out] pValue          The returned big number
+ * @param[out] pbIsNegative  The returned sign of the big number.
+ *
+ * Common processing for the big number tag. Mostly make sure
+ * the tag content is correct and copy forward any further other tag
+ * numbers.
+ */
+static QCBORError
+QCBOR_Private_ProcessBigNum(const uint8_t   uTagRequirement,
+                            const QCBORItem *pItem,
+                            UsefulBufC      *pValue,
+                            bool            *pbIsNegative)
+{
+   const QCBOR_Private_TagSpec TagSpec =
+   {
+      uTagRequirement,
+      {QCBOR_TYPE_POSBIGNUM, QCBOR_TYPE_NEGBIGNUM, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
+      {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
+   };
+
+   QCBORError uErr = QCBOR_Private_CheckTagRequirement(TagSpec, pItem);
+   if(uErr != QCBOR_SUCCESS) {
+      return uErr;
+   }
+
+   *pValue = pItem->val.string;
+
+   if(pItem->uDataType == QCBOR_TYPE_POSBIGNUM) {
+      *pbIsNegative = false;
+   } else if(pItem->uDataType == QCBOR_TYPE_NEGBIGNUM) {
+      *pbIsNegative = true;
+   }
+
+   return QCBOR_SUCCESS;
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h
+ */
+void
+QCBORDecode_GetBignum(QCBORDecodeContext *pMe,
+                      const uint8_t       uTagRequirement,
+                      UsefulBufC         *pValue,
+                      bool               *pbIsNegative)
+{
+   QCBORItem  Item;
+   QCBORDecode_VGetNext(pMe, &Item);
+   if(pMe->uLastError) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
+                                                          &Item,
+                                                          pValue,
+                                                          pbIsNegative);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h
+ */
+void
+QCBORDecode_GetBignumInMapN(QCBORDecodeContext *pMe,
+                            const int64_t       nLabel,
+                            const uint8_t       uTagRequirement,
+                            UsefulBufC         *pValue,
+                            bool               *pbIsNegative)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, &Item);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
+                                                          &Item,
+                                                          pValue,
+                                                          pbIsNegative);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h
+ */
+void
+QCBORDecode_GetBignumInMapSZ(QCBORDecodeContext *pMe,
+                             const char         *szLabel,
+                             const uint8_t       uTagRequirement,
+                             UsefulBufC         *pValue,
+                             bool               *pbIsNegative)
+{
+   QCBORItem Item;
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, &Item);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ProcessBigNum(uTagRequirement,
+                                                          &Item,
+                                                          pValue,
+                                                          pbIsNegative);
+}
+
+
+
+/**
+ * @brief Common processing for MIME tag (semi-private).
+ *
+ * @param[in] uTagRequirement  One of @c QCBOR_TAG_REQUIREMENT_XXX.
+ * @param[in] pItem            The item with the date.
+ * @param[out] pMessage        The returned MIME message.
+ * @param[out] pbIsTag257      If true, binary MIME, if not, text MIME.
+ *
+ * Common processing for the MIME tag. Mostly make sure the tag
+ * content is correct and copy forward any further other tag
+ * numbers. See QCBORDecode_GetMIMEMessage().
+ */
+QCBORError
+QCBORDecode_Private_GetMIME(const uint8_t     uTagRequirement,
+                            const QCBORItem  *pItem,
+                            UsefulBufC       *pMessage,
+                            bool             *pbIsTag257)
+{
+   const QCBOR_Private_TagSpec TagSpecText =
+      {
+         uTagRequirement,
+         {QCBOR_TYPE_MIME, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
+         {QCBOR_TYPE_TEXT_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
+      };
+   const QCBOR_Private_TagSpec TagSpecBinary =
+      {
+         uTagRequirement,
+         {QCBOR_TYPE_BINARY_MIME, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE},
+         {QCBOR_TYPE_BYTE_STRING, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE, QCBOR_TYPE_NONE}
+      };
+
+   QCBORError uReturn;
+
+   if(QCBOR_Private_CheckTagRequirement(TagSpecText, pItem) == QCBOR_SUCCESS) {
+      *pMessage = pItem->val.string;
+      if(pbIsTag257 != NULL) {
+         *pbIsTag257 = false;
+      }
+      uReturn = QCBOR_SUCCESS;
+   } else if(QCBOR_Private_CheckTagRequirement(TagSpecBinary, pItem) == QCBOR_SUCCESS) {
+      *pMessage = pItem->val.string;
+      if(pbIsTag257 != NULL) {
+         *pbIsTag257 = true;
+      }
+      uReturn = QCBOR_SUCCESS;
+
+   } else {
+      uReturn = QCBOR_ERR_UNEXPECTED_TYPE;
+   }
+
+   return uReturn;
+}
+
+// Improvement: add methods for wrapped CBOR, a simple alternate
+// to EnterBstrWrapped
+
+
+
+
+#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
+
+/**
+ * @brief Prototype for conversion of exponent and mantissa to unsigned integer.
+ *
+ * @param[in] uMantissa    The mantissa.
+ * @param[in] nExponent    The exponent.
+ * @param[out] puResult  The resulting integer.
+ *
+ * Concrete implementations of this are for exponent base 10 and 2 supporting
+ * decimal fractions and big floats.
+ */
+typedef QCBORError (*fExponentiator)(uint64_t uMantissa, int64_t nExponent, uint64_t *puResult);
+
+
+/**
+ * @brief  Base 10 exponentiate a mantissa and exponent into an unsigned 64-bit integer.
+ *
+ * @param[in] uMantissa  The unsigned integer mantissa.
+ * @param[in] nExponent  The signed integer exponent.
+ * @param[out] puResult  Place to return the unsigned integer result.
+ *
+ * This computes: mantissa * 10 ^^ exponent as for a decimal fraction. The output is a 64-bit
+ * unsigned integer.
+ *
+ * There are many inputs for which the result will not fit in the
+ * 64-bit integer and @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW will
+ * be returned.
+ */
+static QCBORError
+QCBOR_Private_Exponentitate10(const uint64_t uMantissa,
+                              int64_t        nExponent,
+                              uint64_t      *puResult)
+{
+   uint64_t uResult = uMantissa;
+
+   if(uResult != 0) {
+      /* This loop will run a maximum of 19 times because
+       * UINT64_MAX < 10 ^^ 19. More than that will cause
+       * exit with the overflow error
+       */
+      for(; nExponent > 0; nExponent--) {
+         if(uResult > UINT64_MAX / 10) {
+            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+         }
+         uResult = uResult * 10;
+      }
+
+      for(; nExponent < 0; nExponent++) {
+         uResult = uResult / 10;
+         if(uResult == 0) {
+            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+         }
+      }
+   }
+   /* else, mantissa is zero so this returns zero */
+
+   *puResult = uResult;
+
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief  Base 2 exponentiate a mantissa and exponent into an unsigned 64-bit integer.
+ *
+ * @param[in] uMantissa  The unsigned integer mantissa.
+ * @param[in] nExponent  The signed integer exponent.
+ * @param[out] puResult  Place to return the unsigned integer result.
+ *
+ * This computes: mantissa * 2 ^^ exponent as for a big float. The
+ * output is a 64-bit unsigned integer.
+ *
+ * There are many inputs for which the result will not fit in the
+ * 64-bit integer and @ref QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW will
+ * be returned.
+ */
+static QCBORError
+QCBOR_Private_Exponentitate2(const uint64_t uMantissa,
+                             int64_t        nExponent,
+                             uint64_t      *puResult)
+{
+   uint64_t uResult;
+
+   uResult = uMantissa;
+
+   /* This loop will run a maximum of 64 times because INT64_MAX <
+    * 2^31. More than that will cause exit with the overflow error
+    */
+   while(nExponent > 0) {
+      if(uResult > UINT64_MAX >> 1) {
+         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+      }
+      uResult = uResult << 1;
+      nExponent--;
+   }
+
+   while(nExponent < 0 ) {
+      if(uResult == 0) {
+         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+      }
+      uResult = uResult >> 1;
+      nExponent++;
+   }
+
+   *puResult = uResult;
+
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Exponentiate a signed mantissa and signed exponent to produce a signed result.
+ *
+ * @param[in] nMantissa  Signed integer mantissa.
+ * @param[in] nExponent  Signed integer exponent.
+ * @param[out] pnResult  Place to put the signed integer result.
+ * @param[in] pfExp      Exponentiation function.
+ *
+ * @returns Error code
+ *
+ * @c pfExp performs exponentiation on and unsigned mantissa and
+ * produces an unsigned result. This converts the mantissa from signed
+ * and converts the result to signed. The exponentiation function is
+ * either for base 2 or base 10 (and could be other if needed).
+ */
+static QCBORError
+QCBOR_Private_ExponentiateNN(const int64_t  nMantissa,
+                             const int64_t  nExponent,
+                             int64_t       *pnResult,
+                             fExponentiator pfExp)
+{
+   uint64_t uResult;
+   uint64_t uMantissa;
+
+   /* Take the absolute value and put it into an unsigned. */
+   if(nMantissa >= 0) {
+      /* Positive case is straightforward */
+      uMantissa = (uint64_t)nMantissa;
+   } else if(nMantissa != INT64_MIN) {
+      /* The common negative case. See next. */
+      uMantissa = (uint64_t)-nMantissa;
+   } else {
+      /* int64_t and uint64_t are always two's complement per the
+       * C standard (and since QCBOR uses these it only works with
+       * two's complement, which is pretty much universal these
+       * days). The range of a negative two's complement integer is
+       * one more that than a positive, so the simple code above might
+       * not work all the time because you can't simply negate the
+       * value INT64_MIN because it can't be represented in an
+       * int64_t. -INT64_MIN can however be represented in a
+       * uint64_t. Some compilers seem to recognize this case for the
+       * above code and put the correct value in uMantissa, however
+       * they are not required to do this by the C standard. This next
+       * line does however work for all compilers.
+       *
+       * This does assume two's complement where -INT64_MIN ==
+       * INT64_MAX + 1 (which wouldn't be true for one's complement or
+       * sign and magnitude (but we know we're using two's complement
+       * because int64_t requires it)).
+       *
+       * See these, particularly the detailed commentary:
+       * https://stackoverflow.com/questions/54915742/does-c99-mandate-a-int64-t-type-be-available-always
+       * https://stackoverflow.com/questions/37301078/is-negating-int-min-undefined-behaviour
+       */
+      uMantissa = (uint64_t)INT64_MAX+1;
+   }
+
+   /* Call the exponentiator passed for either base 2 or base 10.
+    * Here is where most of the overflow errors are caught. */
+   QCBORError uReturn = (*pfExp)(uMantissa, nExponent, &uResult);
+   if(uReturn) {
+      return uReturn;
+   }
+
+   /* Convert back to the sign of the original mantissa */
+   if(nMantissa >= 0) {
+      if(uResult > INT64_MAX) {
+         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+      }
+      *pnResult = (int64_t)uResult;
+   } else {
+      /* (uint64_t)INT64_MAX+1 is used to represent the absolute value
+       * of INT64_MIN. This assumes two's compliment representation
+       * where INT64_MIN is one increment farther from 0 than
+       * INT64_MAX.  Trying to write -INT64_MIN doesn't work to get
+       * this because the compiler makes it an int64_t which can't
+       * represent -INT64_MIN. Also see above.
+       */
+      if(uResult > (uint64_t)INT64_MAX+1) {
+         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+      }
+      *pnResult = -(int64_t)uResult;
+   }
+
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Exponentiate an unsigned mantissa and signed exponent to produce an unsigned result.
+ *
+ * @param[in] nMantissa  Signed integer mantissa.
+ * @param[in] nExponent  Signed integer exponent.
+ * @param[out] puResult  Place to put the signed integer result.
+ * @param[in] pfExp      Exponentiation function.
+ *
+ * @returns Error code
+ *
+ * @c pfExp performs exponentiation on and unsigned mantissa and
+ * produces an unsigned result. This errors out if the mantissa
+ * is negative because the output is unsigned.
+ */
+static QCBORError
+QCBOR_Private_ExponentitateNU(const int64_t  nMantissa,
+                              const int64_t  nExponent,
+                              uint64_t      *puResult,
+                              fExponentiator pfExp)
+{
+   if(nMantissa < 0) {
+      return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+   }
+
+   /* Cast to unsigned is OK because of check for negative.
+    * Cast to unsigned is OK because UINT64_MAX > INT64_MAX.
+    * Exponentiation is straight forward
+    */
+   return (*pfExp)((uint64_t)nMantissa, nExponent, puResult);
+}
+
+
+/**
+ * @brief Exponentiate an usnigned mantissa and unsigned exponent to produce an unsigned result.
+ *
+ * @param[in] uMantissa  Unsigned integer mantissa.
+ * @param[in] nExponent  Unsigned integer exponent.
+ * @param[out] puResult  Place to put the unsigned integer result.
+ * @param[in] pfExp      Exponentiation function.
+ *
+ * @returns Error code
+ *
+ * @c pfExp performs exponentiation on and unsigned mantissa and
+ * produces an unsigned result so this is just a wrapper that does
+ * nothing (and is likely inlined).
+ */
+static QCBORError
+QCBOR_Private_ExponentitateUU(const uint64_t uMantissa,
+                              const int64_t  nExponent,
+                              uint64_t      *puResult,
+                              fExponentiator pfExp)
+{
+   return (*pfExp)(uMantissa, nExponent, puResult);
+}
+
+#endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
+
+
+
+
+/**
+ * @brief Convert a CBOR big number to a uint64_t.
+ *
+ * @param[in] BigNum  Bytes of the big number to convert.
+ * @param[in] uMax  Maximum value allowed for the result.
+ * @param[out] pResult  Place to put the unsigned integer result.
+ *
+ * @returns Error code
+ *
+ * Many values will overflow because  a big num can represent a much
+ * larger range than uint64_t.
+ */
+static QCBORError
+QCBOR_Private_ConvertBigNumToUnsigned(const UsefulBufC BigNum,
+                                      const uint64_t   uMax,
+                                      uint64_t        *pResult)
+{
+   uint64_t uResult;
+
+   uResult = 0;
+   const uint8_t *pByte = BigNum.ptr;
+   size_t uLen = BigNum.len;
+   while(uLen--) {
+      if(uResult > (uMax >> 8)) {
+         return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+      }
+      uResult = (uResult << 8) + *pByte++;
+   }
+
+   *pResult = uResult;
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Convert a CBOR postive big number to a uint64_t.
+ *
+ * @param[in] BigNum  Bytes of the big number to convert.
+ * @param[out] pResult  Place to put the unsigned integer result.
+ *
+ * @returns Error code
+ *
+ * Many values will overflow because  a big num can represent a much
+ * larger range than uint64_t.
+ */
+static QCBORError
+QCBOR_Private_ConvertPositiveBigNumToUnsigned(const UsefulBufC BigNum,
+                                              uint64_t        *pResult)
+{
+   return QCBOR_Private_ConvertBigNumToUnsigned(BigNum, UINT64_MAX, pResult);
+}
+
+
+/**
+ * @brief Convert a CBOR positive big number to an int64_t.
+ *
+ * @param[in] BigNum  Bytes of the big number to convert.
+ * @param[out] pResult  Place to put the signed integer result.
+ *
+ * @returns Error code
+ *
+ * Many values will overflow because  a big num can represent a much
+ * larger range than int64_t.
+ */
+static QCBORError
+QCBOR_Private_ConvertPositiveBigNumToSigned(const UsefulBufC BigNum,
+                                            int64_t         *pResult)
+{
+   uint64_t uResult;
+   QCBORError uError = QCBOR_Private_ConvertBigNumToUnsigned(BigNum,
+                                                             INT64_MAX,
+                                                             &uResult);
+   if(uError) {
+      return uError;
+   }
+   /* Cast is safe because ConvertBigNumToUnsigned limits to INT64_MAX */
+   *pResult = (int64_t)uResult;
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Convert a CBOR negative big number to an int64_t.
+ *
+ * @param[in] BigNum  Bytes of the big number to convert.
+ * @param[out] pnResult  Place to put the signed integer result.
+ *
+ * @returns Error code
+ *
+ * Many values will overflow because  a big num can represent a much
+ * larger range than int64_t.
+ */
+static QCBORError
+QCBOR_Private_ConvertNegativeBigNumToSigned(const UsefulBufC BigNum,
+                                            int64_t         *pnResult)
+{
+   uint64_t uResult;
    /* The negative integer furthest from zero for a C int64_t is
     * INT64_MIN which is expressed as -INT64_MAX - 1. The value of a
     * negative number in CBOR is computed as -n - 1 where n is the
@@ -5427,218 +8860,630 @@ QCBOR_Private_ConvertNegativeBigNumToSigned(const UsefulBufC BigNum,
       return uError;
    }
 
-   /* Now apply -n - 1. The cast is safe because
-    * ConvertBigNumToUnsigned() is limited to INT64_MAX which does fit
-    * is the largest positive integer that an int64_t can
-    * represent. */
-   *pnResult =  -(int64_t)uResult - 1;
+   /* Now apply -n - 1. The cast is safe because
+    * ConvertBigNumToUnsigned() is limited to INT64_MAX which does fit
+    * is the largest positive integer that an int64_t can
+    * represent. */
+   *pnResult =  -(int64_t)uResult - 1;
+
+   return QCBOR_SUCCESS;
+}
+
+
+
+
+/**
+ * @brief Convert integers and floats to an int64_t.
+ *
+ * @param[in] pItem   The item to convert.
+ * @param[in] uConvertTypes  Bit mask list of conversion options.
+ * @param[out] pnValue  The resulting converted value.
+ *
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
+ *                                    in uConvertTypes.
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE  Of a type that can't be converted
+ * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
+ *                                               or too small.
+ * @retval QCBOR_ERR_FLOAT_EXCEPTION   Encountered NaN or infinity or such.
+ */
+static QCBORError
+QCBOR_Private_ConvertInt64(const QCBORItem *pItem,
+                           const uint32_t   uConvertTypes,
+                           int64_t         *pnValue)
+{
+   switch(pItem->uDataType) {
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+      case QCBOR_TYPE_FLOAT:
+         if(!(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT)) {
+            return  QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         if(isnan(pItem->val.fnum)) {
+            /* In some environments, llround() will succeed on NaN
+             * when it really shouldn't, so catch the error here. */
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         if(pItem->val.fnum == INFINITY || pItem->val.fnum == -INFINITY) {
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         /* https://pubs.opengroup.org/onlinepubs/009695399/functions/llround.html
+          * http://www.cplusplus.com/reference/cmath/llround/
+          */
+         /* Not interested in FE_INEXACT */
+         feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
+         *pnValue = lroundf(pItem->val.fnum);
+         if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
+            /* llround() shouldn't result in divide by zero, but catch
+             * it here in case it unexpectedly does.  Don't try to
+             * distinguish between the various exceptions because it seems
+             * they vary by CPU, compiler and OS.
+             */
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         break;
+
+      case QCBOR_TYPE_DOUBLE:
+         if(!(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT)) {
+            return  QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         if(isnan(pItem->val.dfnum)) {
+            /* In some environments, llround() will succeed on NaN
+             * when it really shouldn't, so catch the error here. */
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         if(pItem->val.dfnum == INFINITY || pItem->val.dfnum == -INFINITY) {
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         /* https://pubs.opengroup.org/onlinepubs/009695399/functions/llround.html
+          * http://www.cplusplus.com/reference/cmath/llround/
+          */
+         /* Not interested in FE_INEXACT */
+         feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
+         *pnValue = llround(pItem->val.dfnum);
+         if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
+            /* llround() shouldn't result in divide by zero, but catch
+             * it here in case it unexpectedly does.  Don't try to
+             * distinguish between the various exceptions because it seems
+             * they vary by CPU, compiler and OS.
+             */
+            return QCBOR_ERR_FLOAT_EXCEPTION;
+         }
+         break;
+
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+      case QCBOR_TYPE_FLOAT:
+      case QCBOR_TYPE_DOUBLE:
+         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+         break;
+
+      case QCBOR_TYPE_INT64:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
+            *pnValue = pItem->val.int64;
+         } else {
+            return  QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_UINT64:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
+            if(pItem->val.uint64 < INT64_MAX) {
+               *pnValue = pItem->val.int64;
+            } else {
+               return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+            }
+         } else {
+            return  QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      default:
+         return  QCBOR_ERR_UNEXPECTED_TYPE;
+   }
+   return QCBOR_SUCCESS;
+}
+
+
+/**
+ * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ *
+ * @param[in] pMe            The decode context.
+ * @param[in] uConvertTypes  Bit mask list of conversion options.
+ * @param[out] pnValue       Result of the conversion.
+ * @param[in,out] pItem      Temporary space to store Item, returned item.
+ *
+ * See QCBORDecode_GetInt64Convert().
+ */
+void
+QCBORDecode_Private_GetInt64Convert(QCBORDecodeContext *pMe,
+                                    uint32_t            uConvertTypes,
+                                    int64_t            *pnValue,
+                                    QCBORItem          *pItem)
+{
+   QCBORDecode_VGetNext(pMe, pItem);
+   if(pMe->uLastError) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
+                                                         uConvertTypes,
+                                                         pnValue);
+}
+
+/**
+ * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ *
+ * @param[in] pMe            The decode context.
+ * @param[in] nLabel         Label to find in map.
+ * @param[in] uConvertTypes  Bit mask list of conversion options.
+ * @param[out] pnValue       Result of the conversion.
+ * @param[in,out] pItem      Temporary space to store Item, returned item.
+ *
+ * See QCBORDecode_GetInt64ConvertInMapN().
+ */
+void
+QCBORDecode_Private_GetInt64ConvertInMapN(QCBORDecodeContext *pMe,
+                                          int64_t             nLabel,
+                                          uint32_t            uConvertTypes,
+                                          int64_t            *pnValue,
+                                          QCBORItem          *pItem)
+{
+   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
+                                                         uConvertTypes,
+                                                         pnValue);
+}
+
+/**
+ * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ *
+ * @param[in] pMe            The decode context.
+ * @param[in] szLabel        Label to find in map.
+ * @param[in] uConvertTypes  Bit mask list of conversion options.
+ * @param[out] pnValue       Result of the conversion.
+ * @param[in,out] pItem      Temporary space to store Item, returned item.
+ *
+ * See QCBORDecode_GetInt64ConvertInMapSZ().
+ */
+void
+QCBORDecode_Private_GetInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
+                                           const char *         szLabel,
+                                           uint32_t             uConvertTypes,
+                                           int64_t             *pnValue,
+                                           QCBORItem           *pItem)
+{
+   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
+                                                         uConvertTypes,
+                                                         pnValue);
+}
+
+
+/**
+ * @brief Convert many number types to an int64_t.
+ *
+ * @param[in] pItem   The item to convert.
+ * @param[in] uConvertTypes  Bit mask list of conversion options.
+ * @param[out] pnValue  The resulting converted value.
+ *
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
+ *                                    in uConvertTypes.
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE  Of a type that can't be converted
+ * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
+ *                                               or too small.
+ */
+static QCBORError
+QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
+                              const uint32_t   uConvertTypes,
+                              int64_t         *pnValue)
+{
+   switch(pItem->uDataType) {
+
+      case QCBOR_TYPE_POSBIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
+            return QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.bigNum, pnValue);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_NEGBIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
+            return QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.bigNum, pnValue);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
+      case QCBOR_TYPE_DECIMAL_FRACTION:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            return QCBOR_Private_ExponentiateNN(pItem->val.expAndMantissa.Mantissa.nInt,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                 &QCBOR_Private_Exponentitate10);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_BIGFLOAT:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
+            return QCBOR_Private_ExponentiateNN(pItem->val.expAndMantissa.Mantissa.nInt,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                  QCBOR_Private_Exponentitate2);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_DECIMAL_FRACTION_POS_BIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            int64_t    nMantissa;
+            QCBORError uErr;
+            uErr = QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
+            if(uErr) {
+               return uErr;
+            }
+            return QCBOR_Private_ExponentiateNN(nMantissa,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                  QCBOR_Private_Exponentitate10);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_DECIMAL_FRACTION_NEG_BIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            int64_t    nMantissa;
+            QCBORError uErr;
+            uErr = QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
+            if(uErr) {
+               return uErr;
+            }
+            return QCBOR_Private_ExponentiateNN(nMantissa,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                  QCBOR_Private_Exponentitate10);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_BIGFLOAT_POS_BIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            int64_t    nMantissa;
+            QCBORError uErr;
+            uErr = QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
+            if(uErr) {
+               return uErr;
+            }
+            return QCBOR_Private_ExponentiateNN(nMantissa,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                  QCBOR_Private_Exponentitate2);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+
+      case QCBOR_TYPE_BIGFLOAT_NEG_BIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            int64_t    nMantissa;
+            QCBORError uErr;
+            uErr = QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
+            if(uErr) {
+               return uErr;
+            }
+            return QCBOR_Private_ExponentiateNN(nMantissa,
+                                  pItem->val.expAndMantissa.nExponent,
+                                  pnValue,
+                                  QCBOR_Private_Exponentitate2);
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
+         }
+         break;
+#endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
+
+
+      default:
+         return QCBOR_ERR_UNEXPECTED_TYPE;   }
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetInt64ConvertAll(QCBORDecodeContext *pMe,
+                               const uint32_t      uConvertTypes,
+                               int64_t            *pnValue)
+{
+   QCBORItem Item;
+
+   QCBORDecode_Private_GetInt64Convert(pMe, uConvertTypes, pnValue, &Item);
+
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      // The above conversion succeeded
+      return;
+   }
+
+   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
+      // The above conversion failed in a way that code below can't correct
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
+                                                            uConvertTypes,
+                                                            pnValue);
+}
+
+
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
+                                     const int64_t       nLabel,
+                                     const uint32_t      uConvertTypes,
+                                     int64_t            *pnValue)
+{
+   QCBORItem Item;
+
+   QCBORDecode_Private_GetInt64ConvertInMapN(pMe,
+                                             nLabel,
+                                             uConvertTypes,
+                                             pnValue,
+                                             &Item);
+
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      // The above conversion succeeded
+      return;
+   }
+
+   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
+      // The above conversion failed in a way that code below can't correct
+      return;
+   }
 
-   return QCBOR_SUCCESS;
+   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
+                                                            uConvertTypes,
+                                                            pnValue);
 }
 
 
+/*
+ * Public function, see header qcbor/qcbor_decode.h file
+ */
+void
+QCBORDecode_GetInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
+                                      const char         *szLabel,
+                                      const uint32_t      uConvertTypes,
+                                      int64_t            *pnValue)
+{
+   QCBORItem Item;
+   QCBORDecode_Private_GetInt64ConvertInMapSZ(pMe,
+                                              szLabel,
+                                              uConvertTypes,
+                                              pnValue,
+                                              &Item);
+
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      // The above conversion succeeded
+      return;
+   }
+
+   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
+      // The above conversion failed in a way that code below can't correct
+      return;
+   }
+
+   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
+                                                            uConvertTypes,
+                                                            pnValue);
+}
 
 
 /**
- * @brief Convert integers and floats to an int64_t.
+ * @brief Convert many number types to an uint64_t.
  *
  * @param[in] pItem   The item to convert.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pnValue  The resulting converted value.
+ * @param[out] puValue  The resulting converted value.
  *
  * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
  *                                    in uConvertTypes.
  * @retval QCBOR_ERR_UNEXPECTED_TYPE  Of a type that can't be converted
  * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
  *                                               or too small.
- * @retval QCBOR_ERR_FLOAT_EXCEPTION   Encountered NaN or infinity or such.
  */
 static QCBORError
-QCBOR_Private_ConvertInt64(const QCBORItem *pItem,
-                           const uint32_t   uConvertTypes,
-                           int64_t         *pnValue)
+QCBOR_Private_ConvertUInt64(const QCBORItem *pItem,
+                            const uint32_t   uConvertTypes,
+                            uint64_t        *puValue)
 {
    switch(pItem->uDataType) {
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+      case QCBOR_TYPE_DOUBLE:
       case QCBOR_TYPE_FLOAT:
-         if(!(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT)) {
-            return  QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         if(isnan(pItem->val.fnum)) {
-            /* In some environments, llround() will succeed on NaN
-             * when it really shouldn't, so catch the error here. */
-            return QCBOR_ERR_FLOAT_EXCEPTION;
-         }
-         if(pItem->val.fnum == INFINITY || pItem->val.fnum == -INFINITY) {
-            return QCBOR_ERR_FLOAT_EXCEPTION;
-         }
-         /* https://pubs.opengroup.org/onlinepubs/009695399/functions/llround.html
-          * http://www.cplusplus.com/reference/cmath/llround/
-          */
-         /* Not interested in FE_INEXACT */
-         feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
-         *pnValue = lroundf(pItem->val.fnum);
-         if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
-            /* llround() shouldn't result in divide by zero, but catch
-             * it here in case it unexpectedly does.  Don't try to
-             * distinguish between the various exceptions because it seems
-             * they vary by CPU, compiler and OS.
-             */
-            return QCBOR_ERR_FLOAT_EXCEPTION;
-         }
-         break;
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
+            // Can't use llround here because it will not convert values
+            // greater than INT64_MAX and less than UINT64_MAX that
+            // need to be converted so it is more complicated.
+            feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
+            if(pItem->uDataType == QCBOR_TYPE_DOUBLE) {
+               if(isnan(pItem->val.dfnum)) {
+                  return QCBOR_ERR_FLOAT_EXCEPTION;
+               } else if(pItem->val.dfnum < 0) {
+                  return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+               } else {
+                  double dRounded = round(pItem->val.dfnum);
+                  // See discussion in DecodeDateEpoch() for
+                  // explanation of - 0x7ff
+                  if(dRounded > (double)(UINT64_MAX- 0x7ff)) {
+                     return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+                  }
+                  *puValue = (uint64_t)dRounded;
+               }
+            } else {
+               if(isnan(pItem->val.fnum)) {
+                  return QCBOR_ERR_FLOAT_EXCEPTION;
+               } else if(pItem->val.fnum < 0) {
+                  return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+               } else {
+                  float fRounded = roundf(pItem->val.fnum);
+                  // See discussion in DecodeDateEpoch() for
+                  // explanation of - 0x7ff
+                  if(fRounded > (float)(UINT64_MAX- 0x7ff)) {
+                     return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
+                  }
+                  *puValue = (uint64_t)fRounded;
+               }
+            }
+            if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
+               // round() and roundf() shouldn't result in exceptions here, but
+               // catch them to be robust and thorough. Don't try to
+               // distinguish between the various exceptions because it seems
+               // they vary by CPU, compiler and OS.
+               return QCBOR_ERR_FLOAT_EXCEPTION;
+            }
 
-      case QCBOR_TYPE_DOUBLE:
-         if(!(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT)) {
-            return  QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         if(isnan(pItem->val.dfnum)) {
-            /* In some environments, llround() will succeed on NaN
-             * when it really shouldn't, so catch the error here. */
-            return QCBOR_ERR_FLOAT_EXCEPTION;
-         }
-         if(pItem->val.dfnum == INFINITY || pItem->val.dfnum == -INFINITY) {
-            return QCBOR_ERR_FLOAT_EXCEPTION;
-         }
-         /* https://pubs.opengroup.org/onlinepubs/009695399/functions/llround.html
-          * http://www.cplusplus.com/reference/cmath/llround/
-          */
-         /* Not interested in FE_INEXACT */
-         feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
-         *pnValue = llround(pItem->val.dfnum);
-         if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
-            /* llround() shouldn't result in divide by zero, but catch
-             * it here in case it unexpectedly does.  Don't try to
-             * distinguish between the various exceptions because it seems
-             * they vary by CPU, compiler and OS.
-             */
-            return QCBOR_ERR_FLOAT_EXCEPTION;
+         } else {
+            return QCBOR_ERR_UNEXPECTED_TYPE;
          }
-         break;
-
 #else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
-      case QCBOR_TYPE_FLOAT:
-      case QCBOR_TYPE_DOUBLE:
          return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
 #endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
          break;
 
       case QCBOR_TYPE_INT64:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            *pnValue = pItem->val.int64;
+            if(pItem->val.int64 >= 0) {
+               *puValue = (uint64_t)pItem->val.int64;
+            } else {
+               return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+            }
          } else {
-            return  QCBOR_ERR_UNEXPECTED_TYPE;
+            return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
       case QCBOR_TYPE_UINT64:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            if(pItem->val.uint64 < INT64_MAX) {
-               *pnValue = pItem->val.int64;
-            } else {
-               return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-            }
+            *puValue =  pItem->val.uint64;
          } else {
-            return  QCBOR_ERR_UNEXPECTED_TYPE;
+            return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
       default:
-         return  QCBOR_ERR_UNEXPECTED_TYPE;
+         return QCBOR_ERR_UNEXPECTED_TYPE;
    }
+
    return QCBOR_SUCCESS;
 }
 
 
 /**
- * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
  *
  * @param[in] pMe            The decode context.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pnValue       Result of the conversion.
+ * @param[out] puValue       Result of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetInt64Convert().
+ * See QCBORDecode_GetUInt64Convert().
  */
 void
-QCBORDecode_Private_GetInt64Convert(QCBORDecodeContext *pMe,
-                                    uint32_t            uConvertTypes,
-                                    int64_t            *pnValue,
-                                    QCBORItem          *pItem)
+QCBORDecode_Private_GetUInt64Convert(QCBORDecodeContext *pMe,
+                                     const uint32_t      uConvertTypes,
+                                     uint64_t           *puValue,
+                                     QCBORItem          *pItem)
 {
    QCBORDecode_VGetNext(pMe, pItem);
    if(pMe->uLastError) {
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
-                                                         uConvertTypes,
-                                                         pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+                                                          uConvertTypes,
+                                                          puValue);
 }
 
+
 /**
- * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
  *
  * @param[in] pMe            The decode context.
  * @param[in] nLabel         Label to find in map.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pnValue       Result of the conversion.
+ * @param[out] puValue       Result of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetInt64ConvertInMapN().
+ * See QCBORDecode_GetUInt64ConvertInMapN().
  */
 void
-QCBORDecode_Private_GetInt64ConvertInMapN(QCBORDecodeContext *pMe,
-                                          int64_t             nLabel,
-                                          uint32_t            uConvertTypes,
-                                          int64_t            *pnValue,
-                                          QCBORItem          *pItem)
+QCBORDecode_Private_GetUInt64ConvertInMapN(QCBORDecodeContext *pMe,
+                                           const int64_t       nLabel,
+                                           const uint32_t      uConvertTypes,
+                                           uint64_t            *puValue,
+                                           QCBORItem          *pItem)
 {
    QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
    if(pMe->uLastError != QCBOR_SUCCESS) {
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
-                                                         uConvertTypes,
-                                                         pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+                                                          uConvertTypes,
+                                                          puValue);
 }
 
+
 /**
- * @brief Almost-public method to decode a number and convert to int64_t (semi-private).
+ * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
  *
  * @param[in] pMe            The decode context.
- * @param[in] szLabel        Label to find in map.
+ * @param[in] szLabel         Label to find in map.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pnValue       Result of the conversion.
+ * @param[out] puValue       Result of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetInt64ConvertInMapSZ().
+ * See QCBORDecode_GetUInt64ConvertInMapSZ().
  */
 void
-QCBORDecode_Private_GetInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
-                                           const char *         szLabel,
-                                           uint32_t             uConvertTypes,
-                                           int64_t             *pnValue,
-                                           QCBORItem           *pItem)
+QCBORDecode_Private_GetUInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
+                                            const char         *szLabel,
+                                            const uint32_t      uConvertTypes,
+                                            uint64_t           *puValue,
+                                            QCBORItem          *pItem)
 {
    QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
    if(pMe->uLastError != QCBOR_SUCCESS) {
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertInt64(pItem,
-                                                         uConvertTypes,
-                                                         pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+                                                          uConvertTypes,
+                                                          puValue);
 }
 
 
 /**
- * @brief Convert many number types to an int64_t.
+ * @brief Convert many number types to an unt64_t.
  *
  * @param[in] pItem   The item to convert.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pnValue  The resulting converted value.
+ * @param[out] puValue  The resulting converted value.
  *
  * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
  *                                    in uConvertTypes.
@@ -5646,16 +9491,16 @@ QCBORDecode_Private_GetInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
  * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
  *                                               or too small.
  */
-static QCBORError
-QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
-                              const uint32_t   uConvertTypes,
-                              int64_t         *pnValue)
+static QCBORError
+QCBOR_Private_UInt64ConvertAll(const QCBORItem *pItem,
+                               const uint32_t   uConvertTypes,
+                               uint64_t        *puValue)
 {
-   switch(pItem->uDataType) {
+   switch(pItem->uDataType) { /* -Wmaybe-uninitialized falsly warns here */
 
       case QCBOR_TYPE_POSBIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            return QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.bigNum, pnValue);
+            return QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.bigNum, puValue);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5663,19 +9508,20 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_NEGBIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            return QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.bigNum, pnValue);
+            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
 #ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
+
       case QCBOR_TYPE_DECIMAL_FRACTION:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            return QCBOR_Private_ExponentiateNN(pItem->val.expAndMantissa.Mantissa.nInt,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                 &QCBOR_Private_Exponentitate10);
+            return QCBOR_Private_ExponentitateNU(pItem->val.expAndMantissa.Mantissa.nInt,
+                                   pItem->val.expAndMantissa.nExponent,
+                                   puValue,
+                                   QCBOR_Private_Exponentitate10);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5683,10 +9529,10 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_BIGFLOAT:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
-            return QCBOR_Private_ExponentiateNN(pItem->val.expAndMantissa.Mantissa.nInt,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                  QCBOR_Private_Exponentitate2);
+            return QCBOR_Private_ExponentitateNU(pItem->val.expAndMantissa.Mantissa.nInt,
+                                   pItem->val.expAndMantissa.nExponent,
+                                   puValue,
+                                   QCBOR_Private_Exponentitate2);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5694,16 +9540,16 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_DECIMAL_FRACTION_POS_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            int64_t    nMantissa;
+            uint64_t   uMantissa;
             QCBORError uErr;
-            uErr = QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
-            if(uErr) {
+            uErr = QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.expAndMantissa.Mantissa.bigNum, &uMantissa);
+            if(uErr != QCBOR_SUCCESS) {
                return uErr;
             }
-            return QCBOR_Private_ExponentiateNN(nMantissa,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                  QCBOR_Private_Exponentitate10);
+            return QCBOR_Private_ExponentitateUU(uMantissa,
+                                                 pItem->val.expAndMantissa.nExponent,
+                                                 puValue,
+                                                 QCBOR_Private_Exponentitate10);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5711,16 +9557,7 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_DECIMAL_FRACTION_NEG_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            int64_t    nMantissa;
-            QCBORError uErr;
-            uErr = QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
-            if(uErr) {
-               return uErr;
-            }
-            return QCBOR_Private_ExponentiateNN(nMantissa,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                  QCBOR_Private_Exponentitate10);
+            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5728,16 +9565,17 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_BIGFLOAT_POS_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            int64_t    nMantissa;
+            uint64_t   uMantissa;
             QCBORError uErr;
-            uErr = QCBOR_Private_ConvertPositiveBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
-            if(uErr) {
+            uErr = QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.expAndMantissa.Mantissa.bigNum,
+                                                                 &uMantissa);
+            if(uErr != QCBOR_SUCCESS) {
                return uErr;
             }
-            return QCBOR_Private_ExponentiateNN(nMantissa,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                  QCBOR_Private_Exponentitate2);
+            return QCBOR_Private_ExponentitateUU(uMantissa,
+                                                 pItem->val.expAndMantissa.nExponent,
+                                                 puValue,
+                                                 QCBOR_Private_Exponentitate2);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -5745,25 +9583,15 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_BIGFLOAT_NEG_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            int64_t    nMantissa;
-            QCBORError uErr;
-            uErr = QCBOR_Private_ConvertNegativeBigNumToSigned(pItem->val.expAndMantissa.Mantissa.bigNum, &nMantissa);
-            if(uErr) {
-               return uErr;
-            }
-            return QCBOR_Private_ExponentiateNN(nMantissa,
-                                  pItem->val.expAndMantissa.nExponent,
-                                  pnValue,
-                                  QCBOR_Private_Exponentitate2);
+            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 #endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
-
-
       default:
-         return QCBOR_ERR_UNEXPECTED_TYPE;   }
+         return QCBOR_ERR_UNEXPECTED_TYPE;
+   }
 }
 
 
@@ -5771,13 +9599,13 @@ QCBOR_Private_Int64ConvertAll(const QCBORItem *pItem,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetInt64ConvertAll(QCBORDecodeContext *pMe,
-                               const uint32_t      uConvertTypes,
-                               int64_t            *pnValue)
+QCBORDecode_GetUInt64ConvertAll(QCBORDecodeContext *pMe,
+                                const uint32_t      uConvertTypes,
+                                uint64_t           *puValue)
 {
    QCBORItem Item;
 
-   QCBORDecode_Private_GetInt64Convert(pMe, uConvertTypes, pnValue, &Item);
+   QCBORDecode_Private_GetUInt64Convert(pMe, uConvertTypes, puValue, &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
       // The above conversion succeeded
@@ -5789,9 +9617,9 @@ QCBORDecode_GetInt64ConvertAll(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
-                                                            uConvertTypes,
-                                                            pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
+                                                             uConvertTypes,
+                                                             puValue);
 }
 
 
@@ -5799,18 +9627,18 @@ QCBORDecode_GetInt64ConvertAll(QCBORDecodeContext *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
-                                     const int64_t       nLabel,
-                                     const uint32_t      uConvertTypes,
-                                     int64_t            *pnValue)
+QCBORDecode_GetUInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
+                                      const int64_t       nLabel,
+                                      const uint32_t      uConvertTypes,
+                                      uint64_t           *puValue)
 {
    QCBORItem Item;
 
-   QCBORDecode_Private_GetInt64ConvertInMapN(pMe,
-                                             nLabel,
-                                             uConvertTypes,
-                                             pnValue,
-                                             &Item);
+   QCBORDecode_Private_GetUInt64ConvertInMapN(pMe,
+                                              nLabel,
+                                              uConvertTypes,
+                                              puValue,
+                                              &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
       // The above conversion succeeded
@@ -5822,9 +9650,9 @@ QCBORDecode_GetInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
-                                                            uConvertTypes,
-                                                            pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
+                                                             uConvertTypes,
+                                                             puValue);
 }
 
 
@@ -5832,17 +9660,17 @@ QCBORDecode_GetInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
-                                      const char         *szLabel,
-                                      const uint32_t      uConvertTypes,
-                                      int64_t            *pnValue)
+QCBORDecode_GetUInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
+                                       const char         *szLabel,
+                                       const uint32_t      uConvertTypes,
+                                       uint64_t           *puValue)
 {
    QCBORItem Item;
-   QCBORDecode_Private_GetInt64ConvertInMapSZ(pMe,
-                                              szLabel,
-                                              uConvertTypes,
-                                              pnValue,
-                                              &Item);
+   QCBORDecode_Private_GetUInt64ConvertInMapSZ(pMe,
+                                               szLabel,
+                                               uConvertTypes,
+                                               puValue,
+                                               &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
       // The above conversion succeeded
@@ -5854,103 +9682,86 @@ QCBORDecode_GetInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_Int64ConvertAll(&Item,
-                                                            uConvertTypes,
-                                                            pnValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
+                                                             uConvertTypes,
+                                                             puValue);
 }
 
 
+
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
 /**
- * @brief Convert many number types to an uint64_t.
+ * @brief Basic conversions to a double.
  *
- * @param[in] pItem   The item to convert.
- * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] puValue  The resulting converted value.
+ * @param[in] pItem          The item to convert
+ * @param[in] uConvertTypes  Bit flags indicating source types for conversion
+ * @param[out] pdValue       The value converted to a double
  *
- * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
- *                                    in uConvertTypes.
- * @retval QCBOR_ERR_UNEXPECTED_TYPE  Of a type that can't be converted
- * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
- *                                               or too small.
+ * This does the conversions that don't need much object code,
+ * the conversions from int, uint and float to double.
+ *
+ * See QCBOR_Private_DoubleConvertAll() for the full set
+ * of conversions.
  */
 static QCBORError
-QCBOR_Private_ConvertUInt64(const QCBORItem *pItem,
+QCBOR_Private_ConvertDouble(const QCBORItem *pItem,
                             const uint32_t   uConvertTypes,
-                            uint64_t        *puValue)
+                            double          *pdValue)
 {
    switch(pItem->uDataType) {
-      case QCBOR_TYPE_DOUBLE:
       case QCBOR_TYPE_FLOAT:
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
          if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
-            // Can't use llround here because it will not convert values
-            // greater than INT64_MAX and less than UINT64_MAX that
-            // need to be converted so it is more complicated.
-            feclearexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO);
-            if(pItem->uDataType == QCBOR_TYPE_DOUBLE) {
-               if(isnan(pItem->val.dfnum)) {
-                  return QCBOR_ERR_FLOAT_EXCEPTION;
-               } else if(pItem->val.dfnum < 0) {
-                  return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
-               } else {
-                  double dRounded = round(pItem->val.dfnum);
-                  // See discussion in DecodeDateEpoch() for
-                  // explanation of - 0x7ff
-                  if(dRounded > (double)(UINT64_MAX- 0x7ff)) {
-                     return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-                  }
-                  *puValue = (uint64_t)dRounded;
-               }
+            if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
+               *pdValue = IEEE754_SingleToDouble( UsefulBufUtil_CopyFloatToUint32(pItem->val.fnum));
             } else {
-               if(isnan(pItem->val.fnum)) {
-                  return QCBOR_ERR_FLOAT_EXCEPTION;
-               } else if(pItem->val.fnum < 0) {
-                  return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
-               } else {
-                  float fRounded = roundf(pItem->val.fnum);
-                  // See discussion in DecodeDateEpoch() for
-                  // explanation of - 0x7ff
-                  if(fRounded > (float)(UINT64_MAX- 0x7ff)) {
-                     return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
-                  }
-                  *puValue = (uint64_t)fRounded;
-               }
-            }
-            if(fetestexcept(FE_INVALID|FE_OVERFLOW|FE_UNDERFLOW|FE_DIVBYZERO)) {
-               // round() and roundf() shouldn't result in exceptions here, but
-               // catch them to be robust and thorough. Don't try to
-               // distinguish between the various exceptions because it seems
-               // they vary by CPU, compiler and OS.
-               return QCBOR_ERR_FLOAT_EXCEPTION;
+               return QCBOR_ERR_UNEXPECTED_TYPE;
             }
+         }
+#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+         return QCBOR_ERR_HALF_PRECISION_DISABLED;
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+         break;
 
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
+      case QCBOR_TYPE_DOUBLE:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
+            if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
+               *pdValue = pItem->val.dfnum;
+            } else {
+               return QCBOR_ERR_UNEXPECTED_TYPE;
+            }
          }
-#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
-         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
-#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
          break;
 
       case QCBOR_TYPE_INT64:
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
          if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            if(pItem->val.int64 >= 0) {
-               *puValue = (uint64_t)pItem->val.int64;
-            } else {
-               return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
-            }
+            // A simple cast seems to do the job with no worry of exceptions.
+            // There will be precision loss for some values.
+            *pdValue = (double)pItem->val.int64;
+
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
+#else
+         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
+#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
          break;
 
       case QCBOR_TYPE_UINT64:
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
          if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            *puValue =  pItem->val.uint64;
+            // A simple cast seems to do the job with no worry of exceptions.
+            // There will be precision loss for some values.
+            *pdValue = (double)pItem->val.uint64;
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
+#else
+         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
+#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
 
       default:
          return QCBOR_ERR_UNEXPECTED_TYPE;
@@ -5961,19 +9772,19 @@ QCBOR_Private_ConvertUInt64(const QCBORItem *pItem,
 
 
 /**
- * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
+ * @brief  Almost-public method to decode a number and convert to double (semi-private).
  *
  * @param[in] pMe            The decode context.
- * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] puValue       Result of the conversion.
+ * @param[in] uConvertTypes  Bit mask list of conversion options
+ * @param[out] pdValue       The output of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetUInt64Convert().
+ * See QCBORDecode_GetDoubleConvert().
  */
 void
-QCBORDecode_Private_GetUInt64Convert(QCBORDecodeContext *pMe,
+QCBORDecode_Private_GetDoubleConvert(QCBORDecodeContext *pMe,
                                      const uint32_t      uConvertTypes,
-                                     uint64_t           *puValue,
+                                     double             *pdValue,
                                      QCBORItem          *pItem)
 {
    QCBORDecode_VGetNext(pMe, pItem);
@@ -5981,28 +9792,28 @@ QCBORDecode_Private_GetUInt64Convert(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
                                                           uConvertTypes,
-                                                          puValue);
+                                                          pdValue);
 }
 
 
 /**
- * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
+ * @brief  Almost-public method to decode a number and convert to double (semi-private).
  *
  * @param[in] pMe            The decode context.
  * @param[in] nLabel         Label to find in map.
- * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] puValue       Result of the conversion.
+ * @param[in] uConvertTypes  Bit mask list of conversion options
+ * @param[out] pdValue       The output of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetUInt64ConvertInMapN().
+ * See QCBORDecode_GetDoubleConvertInMapN().
  */
 void
-QCBORDecode_Private_GetUInt64ConvertInMapN(QCBORDecodeContext *pMe,
+QCBORDecode_Private_GetDoubleConvertInMapN(QCBORDecodeContext *pMe,
                                            const int64_t       nLabel,
                                            const uint32_t      uConvertTypes,
-                                           uint64_t            *puValue,
+                                           double             *pdValue,
                                            QCBORItem          *pItem)
 {
    QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
@@ -6010,28 +9821,28 @@ QCBORDecode_Private_GetUInt64ConvertInMapN(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
                                                           uConvertTypes,
-                                                          puValue);
+                                                          pdValue);
 }
 
 
 /**
- * @brief Almost-public method to decode a number and convert to uint64_t (semi-private).
+ * @brief  Almost-public method to decode a number and convert to double (semi-private).
  *
  * @param[in] pMe            The decode context.
- * @param[in] szLabel         Label to find in map.
- * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] puValue       Result of the conversion.
+ * @param[in] szLabel        Label to find in map.
+ * @param[in] uConvertTypes  Bit mask list of conversion options
+ * @param[out] pdValue       The output of the conversion.
  * @param[in,out] pItem      Temporary space to store Item, returned item.
  *
- * See QCBORDecode_GetUInt64ConvertInMapSZ().
+ * See QCBORDecode_GetDoubleConvertInMapSZ().
  */
 void
-QCBORDecode_Private_GetUInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
+QCBORDecode_Private_GetDoubleConvertInMapSZ(QCBORDecodeContext *pMe,
                                             const char         *szLabel,
                                             const uint32_t      uConvertTypes,
-                                            uint64_t           *puValue,
+                                            double             *pdValue,
                                             QCBORItem          *pItem)
 {
    QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
@@ -6039,18 +9850,52 @@ QCBORDecode_Private_GetUInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertUInt64(pItem,
+   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
                                                           uConvertTypes,
-                                                          puValue);
+                                                          pdValue);
 }
 
 
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
 /**
- * @brief Convert many number types to an unt64_t.
+ * @brief Convert a big number to double-precision float.
+ *
+ * @param[in] BigNum   The big number to convert
+ *
+ * @returns  The double value.
+ *
+ * This will always succeed. It will lose precision for larger
+ * numbers. If the big number is too large to fit (more than
+ * 1.7976931348623157E+308) infinity will be returned. NaN is never
+ * returned.
+ */
+static double
+QCBOR_Private_ConvertBigNumToDouble(const UsefulBufC BigNum)
+{
+   double dResult;
+
+   dResult = 0.0;
+   const uint8_t *pByte = BigNum.ptr;
+   size_t uLen = BigNum.len;
+   /* This will overflow and become the float value INFINITY if the number
+    * is too large to fit. */
+   while(uLen--) {
+      dResult = (dResult * 256.0) + (double)*pByte++;
+   }
+
+   return dResult;
+}
+#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
+
+
+
+
+/**
+ * @brief Convert many number types to a double.
  *
  * @param[in] pItem   The item to convert.
  * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] puValue  The resulting converted value.
+ * @param[out] pdValue  The resulting converted value.
  *
  * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
  *                                    in uConvertTypes.
@@ -6059,64 +9904,60 @@ QCBORDecode_Private_GetUInt64ConvertInMapSZ(QCBORDecodeContext *pMe,
  *                                               or too small.
  */
 static QCBORError
-QCBOR_Private_UInt64ConvertAll(const QCBORItem *pItem,
+QCBOR_Private_DoubleConvertAll(const QCBORItem *pItem,
                                const uint32_t   uConvertTypes,
-                               uint64_t        *puValue)
+                               double          *pdValue)
 {
-   switch(pItem->uDataType) { /* -Wmaybe-uninitialized falsly warns here */
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   /*
+    * What Every Computer Scientist Should Know About Floating-Point Arithmetic
+    * https://docs.oracle.com/cd/E19957-01/806-3568/ncg_goldberg.html
+    */
+   switch(pItem->uDataType) {
 
-      case QCBOR_TYPE_POSBIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            return QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.bigNum, puValue);
+#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
+      case QCBOR_TYPE_DECIMAL_FRACTION:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
+            // Underflow gives 0, overflow gives infinity
+            *pdValue = (double)pItem->val.expAndMantissa.Mantissa.nInt *
+                        pow(10.0, (double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
-      case QCBOR_TYPE_NEGBIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+      case QCBOR_TYPE_BIGFLOAT:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT ) {
+            // Underflow gives 0, overflow gives infinity
+            *pdValue = (double)pItem->val.expAndMantissa.Mantissa.nInt *
+                              exp2((double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
+#endif /* ! QCBOR_DISABLE_EXP_AND_MANTISSA */
 
-#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
-
-      case QCBOR_TYPE_DECIMAL_FRACTION:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            return QCBOR_Private_ExponentitateNU(pItem->val.expAndMantissa.Mantissa.nInt,
-                                   pItem->val.expAndMantissa.nExponent,
-                                   puValue,
-                                   QCBOR_Private_Exponentitate10);
+      case QCBOR_TYPE_POSBIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
+            *pdValue = QCBOR_Private_ConvertBigNumToDouble(pItem->val.bigNum);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
-      case QCBOR_TYPE_BIGFLOAT:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
-            return QCBOR_Private_ExponentitateNU(pItem->val.expAndMantissa.Mantissa.nInt,
-                                   pItem->val.expAndMantissa.nExponent,
-                                   puValue,
-                                   QCBOR_Private_Exponentitate2);
+      case QCBOR_TYPE_NEGBIGNUM:
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
+            *pdValue = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.bigNum);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
+#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
       case QCBOR_TYPE_DECIMAL_FRACTION_POS_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            uint64_t   uMantissa;
-            QCBORError uErr;
-            uErr = QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.expAndMantissa.Mantissa.bigNum, &uMantissa);
-            if(uErr != QCBOR_SUCCESS) {
-               return uErr;
-            }
-            return QCBOR_Private_ExponentitateUU(uMantissa,
-                                                 pItem->val.expAndMantissa.nExponent,
-                                                 puValue,
-                                                 QCBOR_Private_Exponentitate10);
+            double dMantissa = QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
+            *pdValue = dMantissa * pow(10, (double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
@@ -6124,41 +9965,46 @@ QCBOR_Private_UInt64ConvertAll(const QCBORItem *pItem,
 
       case QCBOR_TYPE_DECIMAL_FRACTION_NEG_BIGNUM:
          if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+            /* Must subtract 1 for CBOR negative integer offset */
+            double dMantissa = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
+            *pdValue = dMantissa * pow(10, (double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
       case QCBOR_TYPE_BIGFLOAT_POS_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            uint64_t   uMantissa;
-            QCBORError uErr;
-            uErr = QCBOR_Private_ConvertPositiveBigNumToUnsigned(pItem->val.expAndMantissa.Mantissa.bigNum,
-                                                                 &uMantissa);
-            if(uErr != QCBOR_SUCCESS) {
-               return uErr;
-            }
-            return QCBOR_Private_ExponentitateUU(uMantissa,
-                                                 pItem->val.expAndMantissa.nExponent,
-                                                 puValue,
-                                                 QCBOR_Private_Exponentitate2);
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
+            double dMantissa = QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
+            *pdValue = dMantissa * exp2((double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
 
       case QCBOR_TYPE_BIGFLOAT_NEG_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            return QCBOR_ERR_NUMBER_SIGN_CONVERSION;
+         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
+            double dMantissa = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
+            *pdValue = dMantissa * exp2((double)pItem->val.expAndMantissa.nExponent);
          } else {
             return QCBOR_ERR_UNEXPECTED_TYPE;
          }
          break;
-#endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
+#endif /* ! QCBOR_DISABLE_EXP_AND_MANTISSA */
+
       default:
          return QCBOR_ERR_UNEXPECTED_TYPE;
    }
+
+   return QCBOR_SUCCESS;
+
+#else
+   (void)pItem;
+   (void)uConvertTypes;
+   (void)pdValue;
+   return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
+#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
+
 }
 
 
@@ -6166,13 +10012,14 @@ QCBOR_Private_UInt64ConvertAll(const QCBORItem *pItem,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetUInt64ConvertAll(QCBORDecodeContext *pMe,
+QCBORDecode_GetDoubleConvertAll(QCBORDecodeContext *pMe,
                                 const uint32_t      uConvertTypes,
-                                uint64_t           *puValue)
+                                double             *pdValue)
 {
+
    QCBORItem Item;
 
-   QCBORDecode_Private_GetUInt64Convert(pMe, uConvertTypes, puValue, &Item);
+   QCBORDecode_Private_GetDoubleConvert(pMe, uConvertTypes, pdValue, &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
       // The above conversion succeeded
@@ -6184,27 +10031,27 @@ QCBORDecode_GetUInt64ConvertAll(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
+   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
                                                              uConvertTypes,
-                                                             puValue);
+                                                             pdValue);
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_decode.h file
+ *  Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetUInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
+QCBORDecode_GetDoubleConvertAllInMapN(QCBORDecodeContext *pMe,
                                       const int64_t       nLabel,
                                       const uint32_t      uConvertTypes,
-                                      uint64_t           *puValue)
+                                      double             *pdValue)
 {
    QCBORItem Item;
 
-   QCBORDecode_Private_GetUInt64ConvertInMapN(pMe,
+   QCBORDecode_Private_GetDoubleConvertInMapN(pMe,
                                               nLabel,
                                               uConvertTypes,
-                                              puValue,
+                                              pdValue,
                                               &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
@@ -6217,9 +10064,9 @@ QCBORDecode_GetUInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
+   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
                                                              uConvertTypes,
-                                                             puValue);
+                                                             pdValue);
 }
 
 
@@ -6227,16 +10074,16 @@ QCBORDecode_GetUInt64ConvertAllInMapN(QCBORDecodeContext *pMe,
  * Public function, see header qcbor/qcbor_decode.h file
  */
 void
-QCBORDecode_GetUInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
+QCBORDecode_GetDoubleConvertAllInMapSZ(QCBORDecodeContext *pMe,
                                        const char         *szLabel,
                                        const uint32_t      uConvertTypes,
-                                       uint64_t           *puValue)
+                                       double             *pdValue)
 {
    QCBORItem Item;
-   QCBORDecode_Private_GetUInt64ConvertInMapSZ(pMe,
+   QCBORDecode_Private_GetDoubleConvertInMapSZ(pMe,
                                                szLabel,
                                                uConvertTypes,
-                                               puValue,
+                                               pdValue,
                                                &Item);
 
    if(pMe->uLastError == QCBOR_SUCCESS) {
@@ -6249,425 +10096,771 @@ QCBORDecode_GetUInt64ConvertAllInMapSZ(QCBORDecodeContext *pMe,
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_UInt64ConvertAll(&Item,
-                                                             uConvertTypes,
-                                                             puValue);
+   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
+                                                             uConvertTypes,
+                                                             pdValue);
+}
+#endif /* USEFULBUF_DISABLE_ALL_FLOAT */
+
+
+
+
+/**
+ * @brief Decode integers in an entered array into a C array.
+ *
+ * @param[in] pMe         The decode context.
+ * @param[in] uMaxCount   Number of elements in @c pnValues or @c puValues.
+ * @param[out] pnValues   Place to put int64_t values or NULL.
+ * @param[out] puValues   Place to put uint64_t values or NULL.
+ * @param[in,out] puCount The number of values output.
+ *
+ * @returns QCBOR_SUCCESS or an error code.
+ *
+ * Exactly one of @c pnValues and @c puValues is non-NULL and that
+ * determines whether the values are signed or unsigned.
+ *
+ * This stops at the end of the array or when @c uMaxCount values have
+ * been output. The array must have just been entered so the current
+ * nesting level is the bounded level for the array.
+ *
+ * The inner loop decodes the head of each item straight from the
+ * input buffer and does the item count book keeping directly on the
+ * nesting level. This is what QCBORDecode_Private_GetNextMapOrArray()
+ * would do for an untagged integer in a definite-length array, but
+ * without filling in a QCBORItem or checking for tags, map labels or
+ * strings. Anything else, including indefinite-length arrays, falls
+ * back to QCBORDecode_GetNext() so the result is the same as decoding
+ * each item with QCBORDecode_GetInt64() or QCBORDecode_GetUInt64().
+ */
+static QCBORError
+QCBORDecode_Private_GetXInt64Items(QCBORDecodeContext *pMe,
+                                   const size_t        uMaxCount,
+                                   int64_t            *pnValues,
+                                   uint64_t           *puValues,
+                                   size_t             *puCount)
+{
+   QCBORError          uErr;
+   QCBORDecodeNesting *pNesting;
+   size_t              uCount;
+   int                 nClass;
+   int                 nAdditionalInfo;
+   uint64_t            uArgument;
+   size_t              uItemStart;
+   QCBORItem           Item;
+
+   pNesting = &(pMe->nesting);
+   uCount   = 0;
+   uErr     = QCBOR_SUCCESS;
+
+   /* ---- Fast path for untagged integers in a definite-length array ---- */
+   if(DecodeNesting_IsCurrentDefiniteLength(pNesting) &&
+      !DecodeNesting_IsBoundedEmpty(pNesting)) {
+      while(uCount < uMaxCount && DecodeNesting_Current(pNesting)->ma.uCountCursor != 0) {
+         uItemStart = UsefulInputBuf_Tell(&(pMe->InBuf));
+         uErr = QCBOR_Private_DecodeHead(&(pMe->InBuf),
+                                         &nClass,
+                                         &uArgument,
+                                         &nAdditionalInfo);
+         if(uErr != QCBOR_SUCCESS) {
+            goto Done;
+         }
+
+         /* Out-of-range values and everything that is not an integer
+          * go back to the general path to get the right error.
+          */
+         if(nClass == CBOR_MAJOR_TYPE_POSITIVE_INT) {
+            if(puValues != NULL) {
+               puValues[uCount] = uArgument;
+            } else if(uArgument <= INT64_MAX) {
+               pnValues[uCount] = (int64_t)uArgument;
+            } else {
+               UsefulInputBuf_Seek(&(pMe->InBuf), uItemStart);
+               break;
+            }
+         } else if(nClass == CBOR_MAJOR_TYPE_NEGATIVE_INT &&
+                   pnValues != NULL &&
+                   uArgument <= INT64_MAX) {
+            /* See QCBOR_Private_DecodeInteger() */
+            pnValues[uCount] = (-(int64_t)uArgument) - 1;
+         } else {
+            UsefulInputBuf_Seek(&(pMe->InBuf), uItemStart);
+            break;
+         }
+
+         DecodeNesting_DecrementDefiniteLengthMapOrArrayCount(pNesting);
+         uCount++;
+      }
+   }
+
+   /* ---- General path for everything else ---- */
+   while(uCount < uMaxCount) {
+      uErr = QCBORDecode_GetNext(pMe, &Item);
+      if(uErr == QCBOR_ERR_NO_MORE_ITEMS) {
+         uErr = QCBOR_SUCCESS;
+         break;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+
+      if(puValues != NULL) {
+         uErr = QCBOR_Private_ConvertUInt64(&Item,
+                                            QCBOR_CONVERT_TYPE_XINT64,
+                                            &puValues[uCount]);
+      } else {
+         uErr = QCBOR_Private_ConvertInt64(&Item,
+                                           QCBOR_CONVERT_TYPE_XINT64,
+                                           &pnValues[uCount]);
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+      uCount++;
+   }
+
+Done:
+   *puCount = uCount;
+   return uErr;
 }
 
 
-
-
 #ifndef USEFULBUF_DISABLE_ALL_FLOAT
+
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
 /**
- * @brief Basic conversions to a double.
+ * @brief Convert a decoded floating-point item to a float.
  *
- * @param[in] pItem          The item to convert
- * @param[in] uConvertTypes  Bit flags indicating source types for conversion
- * @param[out] pdValue       The value converted to a double
+ * @param[in] pItem     The item to convert.
+ * @param[out] pfValue  The converted value.
  *
- * This does the conversions that don't need much object code,
- * the conversions from int, uint and float to double.
+ * @retval QCBOR_ERR_UNEXPECTED_TYPE             Not a floating-point item.
+ * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  A double that is not
+ *                                               exactly representable
+ *                                               as a float.
  *
- * See QCBOR_Private_DoubleConvertAll() for the full set
- * of conversions.
+ * Half and single-precision are always exact. A double is only
+ * converted if no precision is lost. NaN always converts.
  */
 static QCBORError
-QCBOR_Private_ConvertDouble(const QCBORItem *pItem,
-                            const uint32_t   uConvertTypes,
-                            double          *pdValue)
+QCBOR_Private_ConvertFloat(const QCBORItem *pItem, float *pfValue)
 {
    switch(pItem->uDataType) {
       case QCBOR_TYPE_FLOAT:
-#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
-            if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
-               *pdValue = IEEE754_SingleToDouble( UsefulBufUtil_CopyFloatToUint32(pItem->val.fnum));
-            } else {
-               return QCBOR_ERR_UNEXPECTED_TYPE;
-            }
-         }
-#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
-         return QCBOR_ERR_HALF_PRECISION_DISABLED;
-#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+         *pfValue = pItem->val.fnum;
          break;
 
       case QCBOR_TYPE_DOUBLE:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
-            if(uConvertTypes & QCBOR_CONVERT_TYPE_FLOAT) {
-               *pdValue = pItem->val.dfnum;
-            } else {
-               return QCBOR_ERR_UNEXPECTED_TYPE;
-            }
-         }
-         break;
-
-      case QCBOR_TYPE_INT64:
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            // A simple cast seems to do the job with no worry of exceptions.
-            // There will be precision loss for some values.
-            *pdValue = (double)pItem->val.int64;
-
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-#else
-         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
-#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
-         break;
-
-      case QCBOR_TYPE_UINT64:
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_XINT64) {
-            // A simple cast seems to do the job with no worry of exceptions.
-            // There will be precision loss for some values.
-            *pdValue = (double)pItem->val.uint64;
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
+         *pfValue = (float)pItem->val.dfnum;
+         if((double)*pfValue != pItem->val.dfnum && !isnan(pItem->val.dfnum)) {
+            return QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW;
          }
          break;
-#else
-         return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
-#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
 
       default:
          return QCBOR_ERR_UNEXPECTED_TYPE;
    }
-
    return QCBOR_SUCCESS;
 }
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+
+
+/* The initial bytes for half, single and double-precision */
+#define QCBOR_PRIVATE_HEAD_HALF   ((CBOR_MAJOR_TYPE_SIMPLE << 5) + HALF_PREC_FLOAT)
+#define QCBOR_PRIVATE_HEAD_SINGLE ((CBOR_MAJOR_TYPE_SIMPLE << 5) + SINGLE_PREC_FLOAT)
+#define QCBOR_PRIVATE_HEAD_DOUBLE ((CBOR_MAJOR_TYPE_SIMPLE << 5) + DOUBLE_PREC_FLOAT)
 
 
 /**
- * @brief  Almost-public method to decode a number and convert to double (semi-private).
+ * @brief Decode floating-point values in an entered array into a C array.
  *
- * @param[in] pMe            The decode context.
- * @param[in] uConvertTypes  Bit mask list of conversion options
- * @param[out] pdValue       The output of the conversion.
- * @param[in,out] pItem      Temporary space to store Item, returned item.
+ * @param[in] pMe         The decode context.
+ * @param[in] uMaxCount   Number of elements in @c pdValues or @c pfValues.
+ * @param[out] pdValues   Place to put double values or NULL.
+ * @param[out] pfValues   Place to put float values or NULL.
+ * @param[in,out] puCount The number of values output.
  *
- * See QCBORDecode_GetDoubleConvert().
+ * @returns QCBOR_SUCCESS or an error code.
+ *
+ * This is the floating-point counterpart of
+ * QCBORDecode_Private_GetXInt64Items(). Exactly one of @c pdValues
+ * and @c pfValues is non-NULL. @c pfValues is never non-NULL if
+ * QCBOR_DISABLE_FLOAT_HW_USE is defined.
+ *
+ * The fast path handles untagged half, single and double-precision
+ * values in a definite-length array. Each item is one initial byte
+ * check, one bounds-checked load and a widening to double. The
+ * general path is the same as QCBORDecode_GetDouble() for double
+ * output.
  */
-void
-QCBORDecode_Private_GetDoubleConvert(QCBORDecodeContext *pMe,
-                                     const uint32_t      uConvertTypes,
-                                     double             *pdValue,
-                                     QCBORItem          *pItem)
-{
-   QCBORDecode_VGetNext(pMe, pItem);
-   if(pMe->uLastError) {
-      return;
+static QCBORError
+QCBORDecode_Private_GetFloatItems(QCBORDecodeContext *pMe,
+                                  const size_t        uMaxCount,
+                                  double             *pdValues,
+                                  float              *pfValues,
+                                  size_t             *puCount)
+{
+   QCBORError          uErr;
+   QCBORDecodeNesting *pNesting;
+   UsefulInputBuf     *pInBuf;
+   size_t              uCount;
+   size_t              uItemStart;
+   double              dValue;
+   bool                bFastPath;
+   QCBORItem           Item;
+
+   pNesting = &(pMe->nesting);
+   pInBuf   = &(pMe->InBuf);
+   uCount   = 0;
+   uErr     = QCBOR_SUCCESS;
+
+   /* ---- Fast path for untagged floats in a definite-length array ---- */
+   bFastPath = DecodeNesting_IsCurrentDefiniteLength(pNesting) &&
+               !DecodeNesting_IsBoundedEmpty(pNesting);
+   while(bFastPath &&
+         uCount < uMaxCount &&
+         DecodeNesting_Current(pNesting)->ma.uCountCursor != 0) {
+      uItemStart = UsefulInputBuf_Tell(pInBuf);
+
+      switch(UsefulInputBuf_GetByte(pInBuf)) {
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
+         case QCBOR_PRIVATE_HEAD_HALF:
+            dValue = IEEE754_HalfToDouble(UsefulInputBuf_GetUint16(pInBuf));
+            break;
+
+         case QCBOR_PRIVATE_HEAD_SINGLE:
+            dValue = IEEE754_SingleToDouble(UsefulInputBuf_GetUint32(pInBuf));
+            break;
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+
+         case QCBOR_PRIVATE_HEAD_DOUBLE:
+            dValue = UsefulBufUtil_CopyUint64ToDouble(UsefulInputBuf_GetUint64(pInBuf));
+            break;
+
+         default:
+            /* Not a float or not supported here; general path decides */
+            dValue    = 0;
+            bFastPath = false;
+            break;
+      }
+
+      if(UsefulInputBuf_GetError(pInBuf)) {
+         uErr = QCBOR_ERR_HIT_END;
+         goto Done;
+      }
+
+      if(pdValues != NULL) {
+         pdValues[uCount] = dValue;
+      } else {
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+         /* Half and single are always exact. Doubles that aren't go
+          * to the general path for the error. */
+         const float fValue = (float)dValue;
+         if((double)fValue != dValue && !isnan(dValue)) {
+            bFastPath = false;
+         }
+         pfValues[uCount] = fValue;
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+         bFastPath = false;
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+      }
+
+      if(!bFastPath) {
+         UsefulInputBuf_Seek(pInBuf, uItemStart);
+         break;
+      }
+
+      DecodeNesting_DecrementDefiniteLengthMapOrArrayCount(pNesting);
+      uCount++;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
-                                                          uConvertTypes,
-                                                          pdValue);
+   /* ---- General path for everything else ---- */
+   while(uCount < uMaxCount) {
+      uErr = QCBORDecode_GetNext(pMe, &Item);
+      if(uErr == QCBOR_ERR_NO_MORE_ITEMS) {
+         uErr = QCBOR_SUCCESS;
+         break;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+
+      if(pdValues != NULL) {
+         uErr = QCBOR_Private_ConvertDouble(&Item,
+                                            QCBOR_CONVERT_TYPE_FLOAT,
+                                            &pdValues[uCount]);
+      } else {
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+         uErr = QCBOR_Private_ConvertFloat(&Item, &pfValues[uCount]);
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+         (void)pfValues;
+         uErr = QCBOR_ERR_HW_FLOAT_DISABLED;
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         goto Done;
+      }
+      uCount++;
+   }
+
+Done:
+   *puCount = uCount;
+   return uErr;
 }
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
 
 
 /**
- * @brief  Almost-public method to decode a number and convert to double (semi-private).
+ * @brief Common work for decoding an array of numbers into a C array.
  *
- * @param[in] pMe            The decode context.
- * @param[in] nLabel         Label to find in map.
- * @param[in] uConvertTypes  Bit mask list of conversion options
- * @param[out] pdValue       The output of the conversion.
- * @param[in,out] pItem      Temporary space to store Item, returned item.
+ * @param[in] pMe         The decode context.
+ * @param[in] uType       @ref QCBOR_TYPE_INT64, @ref QCBOR_TYPE_UINT64,
+ *                        @ref QCBOR_TYPE_DOUBLE or @ref QCBOR_TYPE_FLOAT.
+ * @param[in] uMaxCount   Number of elements in @c pValues.
+ * @param[out] pValues    C array of the type given by @c uType.
+ * @param[out] puCount    The number of values output.
  *
- * See QCBORDecode_GetDoubleConvertInMapN().
+ * The next item must be an array. It is entered, decoded and exited.
+ *
+ * Once the end of the array has been reached, the cursor is at the
+ * end of the array so it is given to the exit as the end offset. This
+ * avoids the search over the whole array that exiting would otherwise
+ * do.
  */
-void
-QCBORDecode_Private_GetDoubleConvertInMapN(QCBORDecodeContext *pMe,
-                                           const int64_t       nLabel,
-                                           const uint32_t      uConvertTypes,
-                                           double             *pdValue,
-                                           QCBORItem          *pItem)
+static void
+QCBORDecode_Private_GetNumberArray(QCBORDecodeContext *pMe,
+                                   const uint8_t       uType,
+                                   const size_t        uMaxCount,
+                                   void               *pValues,
+                                   size_t             *puCount)
 {
-   QCBORDecode_GetItemInMapN(pMe, nLabel, QCBOR_TYPE_ANY, pItem);
+   QCBORError uErr;
+
+   *puCount = 0;
+
+   QCBORDecode_Private_EnterBoundedMapOrArray(pMe, QCBOR_TYPE_ARRAY, NULL);
    if(pMe->uLastError != QCBOR_SUCCESS) {
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
-                                                          uConvertTypes,
-                                                          pdValue);
+   switch(uType) {
+      case QCBOR_TYPE_INT64:
+         uErr = QCBORDecode_Private_GetXInt64Items(pMe, uMaxCount, pValues, NULL, puCount);
+         break;
+
+      case QCBOR_TYPE_UINT64:
+         uErr = QCBORDecode_Private_GetXInt64Items(pMe, uMaxCount, NULL, pValues, puCount);
+         break;
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+      case QCBOR_TYPE_DOUBLE:
+         uErr = QCBORDecode_Private_GetFloatItems(pMe, uMaxCount, pValues, NULL, puCount);
+         break;
+
+      case QCBOR_TYPE_FLOAT:
+         uErr = QCBORDecode_Private_GetFloatItems(pMe, uMaxCount, NULL, pValues, puCount);
+         break;
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+      default:
+         uErr = QCBOR_ERR_UNEXPECTED_TYPE;
+         break;
+   }
+   if(uErr != QCBOR_SUCCESS) {
+      goto Done;
+   }
+
+   if(!DecodeNesting_IsAtEndOfBoundedLevel(&(pMe->nesting))) {
+      /* Filled uMaxCount values and there are more items */
+      uErr = QCBOR_ERR_ARRAY_DECODE_TOO_LONG;
+      goto Done;
+   }
+
+   /* At the end of the array so the cursor is the end offset. The
+    * cast is safe because of the check against
+    * QCBOR_MAX_DECODE_INPUT_SIZE when the array was entered. */
+   pMe->uMapEndOffsetCache = (QCBOROffset)UsefulInputBuf_Tell(&(pMe->InBuf));
+   QCBORDecode_Private_ExitBoundedMapOrArray(pMe, QCBOR_TYPE_ARRAY);
+   uErr = pMe->uLastError;
+
+Done:
+   pMe->uLastError = (uint8_t)uErr;
 }
 
 
 /**
- * @brief  Almost-public method to decode a number and convert to double (semi-private).
+ * @brief Common work for the InMapN and InMapSZ number array functions.
  *
- * @param[in] pMe            The decode context.
- * @param[in] szLabel        Label to find in map.
- * @param[in] uConvertTypes  Bit mask list of conversion options
- * @param[out] pdValue       The output of the conversion.
- * @param[in,out] pItem      Temporary space to store Item, returned item.
+ * @param[in] pMe       The decode context.
+ * @param[in] pSearch   One-item search list with the label of the array.
  *
- * See QCBORDecode_GetDoubleConvertInMapSZ().
+ * See QCBORDecode_Private_GetNumberArray() for the other parameters.
+ *
+ * This finds the array in the current map, decodes it and then puts
+ * the traversal cursor back where it was.
  */
-void
-QCBORDecode_Private_GetDoubleConvertInMapSZ(QCBORDecodeContext *pMe,
-                                            const char         *szLabel,
-                                            const uint32_t      uConvertTypes,
-                                            double             *pdValue,
-                                            QCBORItem          *pItem)
+static void
+QCBORDecode_Private_GetNumberArrayInMap(QCBORDecodeContext *pMe,
+                                        QCBORItem          *pSearch,
+                                        const uint8_t       uType,
+                                        const size_t        uMaxCount,
+                                        void               *pValues,
+                                        size_t             *puCount)
 {
-   QCBORDecode_GetItemInMapSZ(pMe, szLabel, QCBOR_TYPE_ANY, pItem);
+   /* Heavy stack use, but it's only for a few QCBOR public methods */
+   MapSearchInfo          Info;
+   QCBORDecodeNestingSave SaveNesting;
+   size_t                 uSaveCursor;
+   QCBOROffset            uSaveMapEndOffset;
+
+   *puCount = 0;
+
    if(pMe->uLastError != QCBOR_SUCCESS) {
       return;
    }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_ConvertDouble(pItem,
-                                                          uConvertTypes,
-                                                          pdValue);
+   pMe->uLastError = (uint8_t)QCBORDecode_Private_MapSearch(pMe, pSearch, &Info, NULL);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   if(pSearch->uDataType == QCBOR_TYPE_NONE) {
+      pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+      return;
+   }
+
+   /* Save the traversal cursor and related */
+   DecodeNesting_PrepareForMapSearch(&(pMe->nesting), &SaveNesting);
+   uSaveCursor       = UsefulInputBuf_Tell(&(pMe->InBuf));
+   uSaveMapEndOffset = pMe->uMapEndOffsetCache;
+
+   /* Position the cursor on the array found and enter it. See
+    * QCBORDecode_Private_SearchAndEnter(). */
+   UsefulInputBuf_Seek(&(pMe->InBuf), Info.uStartOffset);
+   DecodeNesting_ResetMapOrArrayCount(&(pMe->nesting));
+   DecodeNesting_SetCurrentToBoundedLevel(&(pMe->nesting));
+   QCBORDecode_Private_GetNumberArray(pMe, uType, uMaxCount, pValues, puCount);
+   if(pMe->uLastError != QCBOR_SUCCESS) {
+      return;
+   }
+
+   /* Restore the traversal cursor */
+   UsefulInputBuf_Seek(&(pMe->InBuf), uSaveCursor);
+   DecodeNesting_RestoreFromMapSearch(&(pMe->nesting), &SaveNesting);
+   pMe->uMapEndOffsetCache = uSaveMapEndOffset;
 }
 
 
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
 /**
- * @brief Convert a big number to double-precision float.
- *
- * @param[in] BigNum   The big number to convert
- *
- * @returns  The double value.
- *
- * This will always succeed. It will lose precision for larger
- * numbers. If the big number is too large to fit (more than
- * 1.7976931348623157E+308) infinity will be returned. NaN is never
- * returned.
+ * @brief Common work for the InMapN number array functions.
  */
-static double
-QCBOR_Private_ConvertBigNumToDouble(const UsefulBufC BigNum)
+static void
+QCBORDecode_Private_GetNumberArrayInMapN(QCBORDecodeContext *pMe,
+                                         const int64_t       nLabel,
+                                         const uint8_t       uType,
+                                         const size_t        uMaxCount,
+                                         void               *pValues,
+                                         size_t             *puCount)
 {
-   double dResult;
-
-   dResult = 0.0;
-   const uint8_t *pByte = BigNum.ptr;
-   size_t uLen = BigNum.len;
-   /* This will overflow and become the float value INFINITY if the number
-    * is too large to fit. */
-   while(uLen--) {
-      dResult = (dResult * 256.0) + (double)*pByte++;
-   }
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType  = QCBOR_TYPE_INT64;
+   OneItemSearch[0].label.int64 = nLabel;
+   OneItemSearch[0].uDataType   = QCBOR_TYPE_ARRAY;
+   OneItemSearch[1].uLabelType  = QCBOR_TYPE_NONE;
 
-   return dResult;
+   QCBORDecode_Private_GetNumberArrayInMap(pMe,
+                                           OneItemSearch,
+                                           uType,
+                                           uMaxCount,
+                                           pValues,
+                                           puCount);
 }
-#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
-
-
 
 
 /**
- * @brief Convert many number types to a double.
- *
- * @param[in] pItem   The item to convert.
- * @param[in] uConvertTypes  Bit mask list of conversion options.
- * @param[out] pdValue  The resulting converted value.
- *
- * @retval QCBOR_ERR_UNEXPECTED_TYPE  Conversion, possible, but not requested
- *                                    in uConvertTypes.
- * @retval QCBOR_ERR_UNEXPECTED_TYPE  Of a type that can't be converted
- * @retval QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW  Conversion result is too large
- *                                               or too small.
+ * @brief Common work for the InMapSZ number array functions.
  */
-static QCBORError
-QCBOR_Private_DoubleConvertAll(const QCBORItem *pItem,
-                               const uint32_t   uConvertTypes,
-                               double          *pdValue)
+static void
+QCBORDecode_Private_GetNumberArrayInMapSZ(QCBORDecodeContext *pMe,
+                                          const char         *szLabel,
+                                          const uint8_t       uType,
+                                          const size_t        uMaxCount,
+                                          void               *pValues,
+                                          size_t             *puCount)
 {
-#ifndef QCBOR_DISABLE_FLOAT_HW_USE
-   /*
-    * What Every Computer Scientist Should Know About Floating-Point Arithmetic
-    * https://docs.oracle.com/cd/E19957-01/806-3568/ncg_goldberg.html
-    */
-   switch(pItem->uDataType) {
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORItem OneItemSearch[2];
+   OneItemSearch[0].uLabelType   = QCBOR_TYPE_TEXT_STRING;
+   OneItemSearch[0].label.string = UsefulBuf_FromSZ(szLabel);
+   OneItemSearch[0].uDataType    = QCBOR_TYPE_ARRAY;
+   OneItemSearch[1].uLabelType   = QCBOR_TYPE_NONE;
 
-#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
-      case QCBOR_TYPE_DECIMAL_FRACTION:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            // Underflow gives 0, overflow gives infinity
-            *pdValue = (double)pItem->val.expAndMantissa.Mantissa.nInt *
-                        pow(10.0, (double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
+   QCBORDecode_Private_GetNumberArrayInMap(pMe,
+                                           OneItemSearch,
+                                           uType,
+                                           uMaxCount,
+                                           pValues,
+                                           puCount);
+#else
+   (void)szLabel;
+   (void)uType;
+   (void)uMaxCount;
+   (void)pValues;
+   *puCount = 0;
+   pMe->uLastError = QCBOR_ERR_LABEL_NOT_FOUND;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+}
 
-      case QCBOR_TYPE_BIGFLOAT:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT ) {
-            // Underflow gives 0, overflow gives infinity
-            *pdValue = (double)pItem->val.expAndMantissa.Mantissa.nInt *
-                              exp2((double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
-#endif /* ! QCBOR_DISABLE_EXP_AND_MANTISSA */
 
-      case QCBOR_TYPE_POSBIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            *pdValue = QCBOR_Private_ConvertBigNumToDouble(pItem->val.bigNum);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
 
-      case QCBOR_TYPE_NEGBIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIG_NUM) {
-            *pdValue = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.bigNum);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetInt64Array(QCBORDecodeContext *pMe,
+                          const size_t        uMaxCount,
+                          int64_t            *pnValues,
+                          size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArray(pMe,
+                                      QCBOR_TYPE_INT64,
+                                      uMaxCount,
+                                      pnValues,
+                                      puCount);
+}
 
-#ifndef QCBOR_DISABLE_EXP_AND_MANTISSA
-      case QCBOR_TYPE_DECIMAL_FRACTION_POS_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            double dMantissa = QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
-            *pdValue = dMantissa * pow(10, (double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
 
-      case QCBOR_TYPE_DECIMAL_FRACTION_NEG_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_DECIMAL_FRACTION) {
-            /* Must subtract 1 for CBOR negative integer offset */
-            double dMantissa = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
-            *pdValue = dMantissa * pow(10, (double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetInt64ArrayInMapN(QCBORDecodeContext *pMe,
+                                const int64_t       nLabel,
+                                const size_t        uMaxCount,
+                                int64_t            *pnValues,
+                                size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArrayInMapN(pMe,
+                                            nLabel,
+                                            QCBOR_TYPE_INT64,
+                                            uMaxCount,
+                                            pnValues,
+                                            puCount);
+}
 
-      case QCBOR_TYPE_BIGFLOAT_POS_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
-            double dMantissa = QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
-            *pdValue = dMantissa * exp2((double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
 
-      case QCBOR_TYPE_BIGFLOAT_NEG_BIGNUM:
-         if(uConvertTypes & QCBOR_CONVERT_TYPE_BIGFLOAT) {
-            double dMantissa = -1-QCBOR_Private_ConvertBigNumToDouble(pItem->val.expAndMantissa.Mantissa.bigNum);
-            *pdValue = dMantissa * exp2((double)pItem->val.expAndMantissa.nExponent);
-         } else {
-            return QCBOR_ERR_UNEXPECTED_TYPE;
-         }
-         break;
-#endif /* ! QCBOR_DISABLE_EXP_AND_MANTISSA */
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetInt64ArrayInMapSZ(QCBORDecodeContext *pMe,
+                                 const char         *szLabel,
+                                 const size_t        uMaxCount,
+                                 int64_t            *pnValues,
+                                 size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArrayInMapSZ(pMe,
+                                             szLabel,
+                                             QCBOR_TYPE_INT64,
+                                             uMaxCount,
+                                             pnValues,
+                                             puCount);
+}
 
-      default:
-         return QCBOR_ERR_UNEXPECTED_TYPE;
-   }
 
-   return QCBOR_SUCCESS;
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetUInt64Array(QCBORDecodeContext *pMe,
+                           const size_t        uMaxCount,
+                           uint64_t           *puValues,
+                           size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArray(pMe,
+                                      QCBOR_TYPE_UINT64,
+                                      uMaxCount,
+                                      puValues,
+                                      puCount);
+}
 
-#else
-   (void)pItem;
-   (void)uConvertTypes;
-   (void)pdValue;
-   return FLOAT_ERR_CODE_NO_FLOAT_HW(QCBOR_SUCCESS);
-#endif /* QCBOR_DISABLE_FLOAT_HW_USE */
 
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetUInt64ArrayInMapN(QCBORDecodeContext *pMe,
+                                 const int64_t       nLabel,
+                                 const size_t        uMaxCount,
+                                 uint64_t           *puValues,
+                                 size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArrayInMapN(pMe,
+                                            nLabel,
+                                            QCBOR_TYPE_UINT64,
+                                            uMaxCount,
+                                            puValues,
+                                            puCount);
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_decode.h file
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
  */
 void
-QCBORDecode_GetDoubleConvertAll(QCBORDecodeContext *pMe,
-                                const uint32_t      uConvertTypes,
-                                double             *pdValue)
+QCBORDecode_GetUInt64ArrayInMapSZ(QCBORDecodeContext *pMe,
+                                  const char         *szLabel,
+                                  const size_t        uMaxCount,
+                                  uint64_t           *puValues,
+                                  size_t             *puCount)
 {
+   QCBORDecode_Private_GetNumberArrayInMapSZ(pMe,
+                                             szLabel,
+                                             QCBOR_TYPE_UINT64,
+                                             uMaxCount,
+                                             puValues,
+                                             puCount);
+}
 
-   QCBORItem Item;
-
-   QCBORDecode_Private_GetDoubleConvert(pMe, uConvertTypes, pdValue, &Item);
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
 
-   if(pMe->uLastError == QCBOR_SUCCESS) {
-      // The above conversion succeeded
-      return;
-   }
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetDoubleArray(QCBORDecodeContext *pMe,
+                           const size_t        uMaxCount,
+                           double             *pdValues,
+                           size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArray(pMe,
+                                      QCBOR_TYPE_DOUBLE,
+                                      uMaxCount,
+                                      pdValues,
+                                      puCount);
+}
 
-   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
-      // The above conversion failed in a way that code below can't correct
-      return;
-   }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
-                                                             uConvertTypes,
-                                                             pdValue);
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetDoubleArrayInMapN(QCBORDecodeContext *pMe,
+                                 const int64_t       nLabel,
+                                 const size_t        uMaxCount,
+                                 double             *pdValues,
+                                 size_t             *puCount)
+{
+   QCBORDecode_Private_GetNumberArrayInMapN(pMe,
+                                            nLabel,
+                                            QCBOR_TYPE_DOUBLE,
+                                            uMaxCount,
+                                            pdValues,
+                                            puCount);
 }
 
 
 /*
- *  Public function, see header qcbor/qcbor_decode.h file
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
  */
 void
-QCBORDecode_GetDoubleConvertAllInMapN(QCBORDecodeContext *pMe,
-                                      const int64_t       nLabel,
-                                      const uint32_t      uConvertTypes,
-                                      double             *pdValue)
+QCBORDecode_GetDoubleArrayInMapSZ(QCBORDecodeContext *pMe,
+                                  const char         *szLabel,
+                                  const size_t        uMaxCount,
+                                  double             *pdValues,
+                                  size_t             *puCount)
 {
-   QCBORItem Item;
+   QCBORDecode_Private_GetNumberArrayInMapSZ(pMe,
+                                             szLabel,
+                                             QCBOR_TYPE_DOUBLE,
+                                             uMaxCount,
+                                             pdValues,
+                                             puCount);
+}
 
-   QCBORDecode_Private_GetDoubleConvertInMapN(pMe,
-                                              nLabel,
-                                              uConvertTypes,
-                                              pdValue,
-                                              &Item);
 
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetFloatArray(QCBORDecodeContext *pMe,
+                          const size_t        uMaxCount,
+                          float              *pfValues,
+                          size_t             *puCount)
+{
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   QCBORDecode_Private_GetNumberArray(pMe,
+                                      QCBOR_TYPE_FLOAT,
+                                      uMaxCount,
+                                      pfValues,
+                                      puCount);
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+   (void)uMaxCount;
+   (void)pfValues;
+   *puCount = 0;
    if(pMe->uLastError == QCBOR_SUCCESS) {
-      // The above conversion succeeded
-      return;
+      pMe->uLastError = QCBOR_ERR_HW_FLOAT_DISABLED;
    }
-
-   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
-      // The above conversion failed in a way that code below can't correct
-      return;
-   }
-
-   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
-                                                             uConvertTypes,
-                                                             pdValue);
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
 }
 
 
 /*
- * Public function, see header qcbor/qcbor_decode.h file
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
  */
 void
-QCBORDecode_GetDoubleConvertAllInMapSZ(QCBORDecodeContext *pMe,
-                                       const char         *szLabel,
-                                       const uint32_t      uConvertTypes,
-                                       double             *pdValue)
+QCBORDecode_GetFloatArrayInMapN(QCBORDecodeContext *pMe,
+                                const int64_t       nLabel,
+                                const size_t        uMaxCount,
+                                float              *pfValues,
+                                size_t             *puCount)
 {
-   QCBORItem Item;
-   QCBORDecode_Private_GetDoubleConvertInMapSZ(pMe,
-                                               szLabel,
-                                               uConvertTypes,
-                                               pdValue,
-                                               &Item);
-
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   QCBORDecode_Private_GetNumberArrayInMapN(pMe,
+                                            nLabel,
+                                            QCBOR_TYPE_FLOAT,
+                                            uMaxCount,
+                                            pfValues,
+                                            puCount);
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+   (void)uMaxCount;
+   (void)pfValues;
+   (void)nLabel;
+   *puCount = 0;
    if(pMe->uLastError == QCBOR_SUCCESS) {
-      // The above conversion succeeded
-      return;
+      pMe->uLastError = QCBOR_ERR_HW_FLOAT_DISABLED;
    }
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+}
 
-   if(pMe->uLastError != QCBOR_ERR_UNEXPECTED_TYPE) {
-      // The above conversion failed in a way that code below can't correct
-      return;
-   }
 
-   pMe->uLastError = (uint8_t)QCBOR_Private_DoubleConvertAll(&Item,
-                                                             uConvertTypes,
-                                                             pdValue);
+/*
+ * Public function, see header qcbor/qcbor_spiffy_decode.h file
+ */
+void
+QCBORDecode_GetFloatArrayInMapSZ(QCBORDecodeContext *pMe,
+                                 const char         *szLabel,
+                                 const size_t        uMaxCount,
+                                 float              *pfValues,
+                                 size_t             *puCount)
+{
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   QCBORDecode_Private_GetNumberArrayInMapSZ(pMe,
+                                             szLabel,
+                                             QCBOR_TYPE_FLOAT,
+                                             uMaxCount,
+                                             pfValues,
+                                             puCount);
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+   (void)uMaxCount;
+   (void)pfValues;
+   (void)szLabel;
+   *puCount = 0;
+   if(pMe->uLastError == QCBOR_SUCCESS) {
+      pMe->uLastError = QCBOR_ERR_HW_FLOAT_DISABLED;
+   }
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
 }
-#endif /* USEFULBUF_DISABLE_ALL_FLOAT */
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
 
 
 
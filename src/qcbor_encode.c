@@ -132,7 +132,7 @@ Nesting_Decrement(QCBORTrackNesting *pNesting)
    pNesting->pCurrentNesting->uCount--;
 }
 
-static uint16_t
+static QCBORCount
 Nesting_GetCount(QCBORTrackNesting *pNesting)
 {
    /* The nesting count recorded is always the actual number of
@@ -143,8 +143,8 @@ Nesting_GetCount(QCBORTrackNesting *pNesting)
     * number of pairs.
     */
    if(pNesting->pCurrentNesting->uMajorType == CBOR_MAJOR_TYPE_MAP) {
-      /* Cast back to uint16_t after integer promotion from bit shift */
-      return (uint16_t)(pNesting->pCurrentNesting->uCount >> 1);
+      /* Cast back to QCBORCount after integer promotion from bit shift */
+      return (QCBORCount)(pNesting->pCurrentNesting->uCount >> 1);
    } else {
       return pNesting->pCurrentNesting->uCount;
    }
@@ -225,7 +225,7 @@ Nesting_IsInNest(QCBORTrackNesting *pNesting)
  *
  * QCBOR_DISABLE_ENCODE_USAGE_GUARDS also disables the check for more
  * than QCBOR_MAX_ITEMS_IN_ARRAY in an array. Since
- * QCBOR_MAX_ITEMS_IN_ARRAY is very large (65,534) it is very unlikely
+ * QCBOR_MAX_ITEMS_IN_ARRAY is very large (65,534 or more) it is very unlikely
  * to be reached. If it is reached, the count will wrap around to zero
  * and CBOR that is not well formed will be produced, but there will
  * be no buffers overrun and new security issues in the code.
@@ -262,6 +262,16 @@ QCBOREncode_Init(QCBOREncodeContext *pMe, UsefulBuf Storage)
 }
 
 
+/*
+ * Public function. See qcbor/qcbor_encode.h
+ */
+void
+QCBOREncode_EnableUTF8Check(QCBOREncodeContext *pMe)
+{
+   pMe->bCheckUTF8 = true;
+}
+
+
 /*
  * Public function to encode a CBOR head. See qcbor/qcbor_encode.h
  */
@@ -616,6 +626,13 @@ QCBOREncode_Private_AddBuffer(QCBOREncodeContext *pMe,
                               const uint8_t       uMajorType,
                               const UsefulBufC    Bytes)
 {
+   if(uMajorType == CBOR_MAJOR_TYPE_TEXT_STRING &&
+      pMe->bCheckUTF8 &&
+      UsefulBuf_IsValidUTF8(Bytes) != SIZE_MAX) {
+      pMe->uError = QCBOR_ERR_INVALID_UTF8;
+      return;
+   }
+
    QCBOREncode_Private_AppendCBORHead(pMe, uMajorType, Bytes.len, 0);
    UsefulOutBuf_AppendUsefulBuf(&(pMe->OutBuf), Bytes);
 }
@@ -72,6 +72,16 @@ qcbor_err_to_str(const QCBORError uErr) {
    ERR_TO_STR_CASE(QCBOR_ERR_ALL_FLOAT_DISABLED)
    ERR_TO_STR_CASE(QCBOR_ERR_RECOVERABLE_BAD_TAG_CONTENT)
    ERR_TO_STR_CASE(QCBOR_ERR_CANNOT_ENTER_ALLOCATED_STRING)
+   ERR_TO_STR_CASE(QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL)
+   ERR_TO_STR_CASE(QCBOR_ERR_NEED_MORE_INPUT)
+   ERR_TO_STR_CASE(QCBOR_ERR_NESTING_STORAGE)
+   ERR_TO_STR_CASE(QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL)
+   ERR_TO_STR_CASE(QCBOR_ERR_NOT_PREFERRED)
+   ERR_TO_STR_CASE(QCBOR_ERR_INDEFINITE_NOT_ALLOWED)
+   ERR_TO_STR_CASE(QCBOR_ERR_UNSORTED)
+   ERR_TO_STR_CASE(QCBOR_ERR_INVALID_UTF8)
+   ERR_TO_STR_CASE(QCBOR_ERR_STRUCT_DESCRIPTOR)
+   ERR_TO_STR_CASE(QCBOR_ERR_PATH_SYNTAX)
 
    default:
       if(uErr >= QCBOR_ERR_FIRST_USER_DEFINED && uErr <= QCBOR_ERR_LAST_USER_DEFINED) {
@@ -1040,3 +1040,65 @@ const char *UBAdvanceTest(void)
 
    return NULL;
 }
+
+
+struct UTF8TestInput {
+   UsefulBufC Input;
+   size_t     uExpected;
+};
+
+static const struct UTF8TestInput UTF8TestInputs[] = {
+   {{"", 0}, SIZE_MAX},
+   {{"a", 1}, SIZE_MAX},
+   /* ASCII longer than the eight-byte fast path */
+   {{"abcdefghijklmnopqrstuvwxyz", 26}, SIZE_MAX},
+   /* Two, three and four-byte sequences amid ASCII */
+   {{"abcdefgh\xc3\xa9" "abcdefgh\xe2\x82\xac" "abcdefgh\xf0\x9f\x98\x80", 33}, SIZE_MAX},
+   /* Smallest and largest of each length */
+   {{"\xc2\x80\xdf\xbf\xe0\xa0\x80\xef\xbf\xbf\xf0\x90\x80\x80\xf4\x8f\xbf\xbf", 18}, SIZE_MAX},
+   /* Either side of the surrogates */
+   {{"\xed\x9f\xbf\xee\x80\x80", 6}, SIZE_MAX},
+   /* Invalid byte after the fast path */
+   {{"abcdefghij\xff", 11}, 10},
+   /* Lone continuation byte */
+   {{"ab\x80" "cdefghijkl", 13}, 2},
+   /* Overlong two-byte form of '/' */
+   {{"\xc0\xaf", 2}, 0},
+   /* Overlong two-byte with lead 0xc1 */
+   {{"\xc1\xbf", 2}, 0},
+   /* Overlong three-byte */
+   {{"a\xe0\x9f\xbf", 4}, 1},
+   /* Overlong four-byte */
+   {{"\xf0\x8f\xbf\xbf", 4}, 0},
+   /* Surrogate U+D800 */
+   {{"\xed\xa0\x80", 3}, 0},
+   /* U+110000 */
+   {{"\xf4\x90\x80\x80", 4}, 0},
+   /* Lead byte that is never valid */
+   {{"\xf5\x80\x80\x80", 4}, 0},
+   /* Cut off by the end */
+   {{"abc\xe2\x82", 5}, 3},
+   {{"\xf0\x9f\x98", 3}, 0},
+   /* Bad second and third continuation bytes */
+   {{"\xe2\x28\xa1", 3}, 0},
+   {{"\xc3\xa9\xe2\x82\x28", 5}, 2},
+   {{"\xf0\x9f\x98\x28", 4}, 0},
+};
+
+
+const char *UBUTF8Test(void)
+{
+   size_t uIndex;
+
+   for(uIndex = 0; uIndex < sizeof(UTF8TestInputs)/sizeof(struct UTF8TestInput); uIndex++) {
+      if(UsefulBuf_IsValidUTF8(UTF8TestInputs[uIndex].Input) != UTF8TestInputs[uIndex].uExpected) {
+         return "UTF-8 check wrong";
+      }
+   }
+
+   if(UsefulBuf_IsValidUTF8(NULLUsefulBufC) != SIZE_MAX) {
+      return "NULL not valid UTF-8";
+   }
+
+   return NULL;
+}
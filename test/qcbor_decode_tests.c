@@ -1505,7 +1505,11 @@ int32_t ParseMapAsArrayTest(void)
     map that when interpreted as an array will be too many. Test
     data just has the start of the map, not all the items in the map.
     */
+#ifndef QCBOR_WIDE_COUNTS
    static const uint8_t pTooLargeMap[] = {0xb9, 0xff, 0xfd};
+#else /* ! QCBOR_WIDE_COUNTS */
+   static const uint8_t pTooLargeMap[] = {0xba, 0xff, 0xff, 0xff, 0xfd};
+#endif /* ! QCBOR_WIDE_COUNTS */
 
    QCBORDecode_Init(&DCtx,
                     UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pTooLargeMap),
@@ -1798,7 +1802,7 @@ int32_t ParseMapAsArrayTest(void)
    }
    if(Item.uLabelType != QCBOR_TYPE_NONE ||
       Item.uDataType != QCBOR_TYPE_MAP_AS_ARRAY ||
-      Item.val.uCount != UINT16_MAX) {
+      Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return MakeTestResultCode(10, 51, 0);
    }
 
@@ -1818,7 +1822,7 @@ int32_t ParseMapAsArrayTest(void)
    }
    if(Item.uLabelType != QCBOR_TYPE_NONE ||
       Item.uDataType != QCBOR_TYPE_ARRAY ||
-      Item.val.uCount != UINT16_MAX) {
+      Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return MakeTestResultCode(10, 55, 0);
    }
 
@@ -1869,7 +1873,7 @@ int32_t ParseMapAsArrayTest(void)
    if(Item.uLabelType != QCBOR_TYPE_NONE ||
       Item.uDataType != QCBOR_TYPE_MAP_AS_ARRAY ||
       !QCBORDecode_IsTagged(&DCtx, &Item, 258) ||
-      Item.val.uCount != UINT16_MAX) {
+      Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return MakeTestResultCode(10, 65, 0);
    }
 
@@ -2050,7 +2054,7 @@ int32_t ParseMapAsArrayTest(void)
    if(Item.uDataType != QCBOR_TYPE_MAP_AS_ARRAY) {
       return MakeTestResultCode(11, 18, 0);
    }
-   if(Item.val.uCount != UINT16_MAX) {
+   if(Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return MakeTestResultCode(11, 19, 0);
    }
    QCBORDecode_GetTextString(&DCtx, &Encoded);
@@ -2300,6 +2304,7 @@ static int32_t ExtraBytesTest(int nLevel)
 /* These are just the item that open large maps and arrays, not
  * the items in the array. This is sufficient to test the
  * boundary condition. */
+#ifndef QCBOR_WIDE_COUNTS
 static const uint8_t spLargeArrayFake[] = {
    0x99, 0xff, 0xfe};
 
@@ -2311,6 +2316,19 @@ static const uint8_t spLargeMapFake[] = {
 
 static const uint8_t spTooLargeMapFake[] = {
    0xba, 0x00, 0x00, 0x80, 0x00};
+#else /* ! QCBOR_WIDE_COUNTS */
+static const uint8_t spLargeArrayFake[] = {
+   0x9a, 0xff, 0xff, 0xff, 0xfe};
+
+static const uint8_t spTooLargeArrayFake[] = {
+   0x9a, 0xff, 0xff, 0xff, 0xff};
+
+static const uint8_t spLargeMapFake[] = {
+   0xba, 0x7f, 0xff, 0xff, 0xff};
+
+static const uint8_t spTooLargeMapFake[] = {
+   0xbb, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00};
+#endif /* ! QCBOR_WIDE_COUNTS */
 
 
 int32_t ParseMapTest(void)
@@ -8332,6 +8350,124 @@ int32_t CBORSequenceDecodeTests(void)
 #endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
 
 
+   // --- A head cut off part way through its argument ---
+   /* All of it is consumed so there are no extra bytes */
+   QCBORDecode_Init(&DCtx,
+                    UsefulBuf_FROM_SZ_LITERAL("\x3b\x19\x19\xf5\x30\xfa\x60\xc4"),
+                    QCBOR_DECODE_MODE_NORMAL);
+   uCBORError = QCBORDecode_GetNext(&DCtx, &Item);
+   if(uCBORError != QCBOR_ERR_HIT_END) {
+      return 21;
+   }
+   uCBORError = QCBORDecode_PartialFinish(&DCtx, &uConsumed);
+   if(uCBORError != QCBOR_SUCCESS || uConsumed != 8) {
+      return 22;
+   }
+   uCBORError = QCBORDecode_Finish(&DCtx);
+   if(uCBORError != QCBOR_SUCCESS) {
+      return 23;
+   }
+
+
+   // --- Split up sequences without decoding ---
+   static const size_t aSequenceEnds[] = {11, 12, 17, 20};
+   UsefulBufC          Sequence;
+   UsefulBufC          SequenceItem;
+   size_t              uOffset;
+   size_t              uItemStart;
+   size_t              uIndex;
+
+   Sequence = UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput);
+   uOffset  = 0;
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(aSequenceEnds, size_t); uIndex++) {
+      uItemStart = uOffset;
+      uCBORError = QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+      if(uCBORError != QCBOR_SUCCESS) {
+         return (int32_t)(30 + uIndex);
+      }
+      if(uOffset != aSequenceEnds[uIndex] ||
+         SequenceItem.ptr != (const uint8_t *)Sequence.ptr + uItemStart ||
+         SequenceItem.len != uOffset - uItemStart) {
+         return (int32_t)(40 + uIndex);
+      }
+   }
+   uCBORError = QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+   if(uCBORError != QCBOR_ERR_NO_MORE_ITEMS || uOffset != 20 ||
+      !UsefulBuf_IsNULLC(SequenceItem)) {
+      return 50;
+   }
+
+   /* Each item split out decodes on its own */
+   uOffset = 0;
+   QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+   QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+   QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+   QCBORDecode_Init(&DCtx, SequenceItem, QCBOR_DECODE_MODE_NORMAL);
+   uCBORError = QCBORDecode_GetNext(&DCtx, &Item);
+   if(uCBORError != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_INT64 ||
+      Item.val.int64 != 1400000000 ||
+      QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 51;
+   }
+
+   /* Splitting doesn't depend on the decoder's indefinite-length
+    * support */
+   Sequence = UsefulBuf_FROM_BYTE_ARRAY_LITERAL(yy);
+   uOffset  = 0;
+   if(QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem) != QCBOR_SUCCESS ||
+      QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem) != QCBOR_SUCCESS ||
+      SequenceItem.len != 2 ||
+      QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 52;
+   }
+
+   /* An error leaves the offset at the start of the bad item */
+   Sequence = UsefulBuf_FROM_BYTE_ARRAY_LITERAL(xx);
+   uOffset  = 0;
+   if(QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem) != QCBOR_SUCCESS) {
+      return 53;
+   }
+   uCBORError = QCBORDecode_GetNextSequenceItem(Sequence, &uOffset, &SequenceItem);
+   if(uCBORError != QCBOR_ERR_HIT_END || uOffset != 1 ||
+      !UsefulBuf_IsNULLC(SequenceItem)) {
+      return 54;
+   }
+
+
+   // --- Find the item ends in batches ---
+   size_t auEnds[3];
+   size_t uNumEnds;
+
+   Sequence = UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput);
+   uOffset  = 0;
+   uCBORError = QCBORDecode_SplitSequence(Sequence, &uOffset, auEnds, 3, &uNumEnds);
+   if(uCBORError != QCBOR_SUCCESS || uNumEnds != 3 || uOffset != 17 ||
+      memcmp(auEnds, aSequenceEnds, 3 * sizeof(size_t))) {
+      return 60;
+   }
+   /* Stops at the end of the sequence */
+   uCBORError = QCBORDecode_SplitSequence(Sequence, &uOffset, auEnds, 3, &uNumEnds);
+   if(uCBORError != QCBOR_SUCCESS || uNumEnds != 1 || uOffset != 20 || auEnds[0] != 20) {
+      return 61;
+   }
+   uCBORError = QCBORDecode_SplitSequence(Sequence, &uOffset, auEnds, 3, &uNumEnds);
+   if(uCBORError != QCBOR_ERR_NO_MORE_ITEMS || uNumEnds != 0 || uOffset != 20) {
+      return 62;
+   }
+
+   /* The items before an error are found */
+   Sequence = UsefulBuf_FROM_BYTE_ARRAY_LITERAL(xx);
+   uOffset  = 0;
+   uCBORError = QCBORDecode_SplitSequence(Sequence, &uOffset, auEnds, 3, &uNumEnds);
+   if(uCBORError != QCBOR_ERR_HIT_END || uNumEnds != 1 || uOffset != 1 || auEnds[0] != 1) {
+      return 63;
+   }
+   uCBORError = QCBORDecode_SplitSequence(Sequence, &uOffset, auEnds, 3, &uNumEnds);
+   if(uCBORError != QCBOR_ERR_HIT_END || uNumEnds != 0 || uOffset != 1) {
+      return 64;
+   }
+
    return 0;
 }
 
@@ -10272,7 +10408,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE) {
       return 40;
    }
-   if(UINT32_MAX != QCBORDecode_Tell(&DCtx)) {
+   if(QCBOR_OFFSET_MAX != QCBORDecode_Tell(&DCtx)) {
       return 41;
    }
    QCBORDecode_GetAndResetError(&DCtx);
@@ -10415,7 +10551,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx)) {
       return 60;
    }
-   if(Item.val.uCount != UINT16_MAX) {
+   if(Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return 61;
    }
    if(UsefulBuf_Compare(ReturnedEncodedCBOR, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedArray2sIndef))) {
@@ -10434,7 +10570,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx)) {
       return 70;
    }
-   if(Item.val.uCount != UINT16_MAX) {
+   if(Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return 71;
    }
    if(UsefulBuf_Compare(ReturnedEncodedCBOR, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedMap4Indef))) {
@@ -10450,7 +10586,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx)) {
       return 80;
    }
-   if(Item.val.uCount != UINT16_MAX) {
+   if(Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return 81;
    }
    if(UsefulBuf_Compare(ReturnedEncodedCBOR, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedArray2sIndef))) {
@@ -10467,7 +10603,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx)) {
       return 90;
    }
-   if(Item.val.uCount != UINT16_MAX) {
+   if(Item.val.uCount != QCBOR_COUNT_INDICATES_INDEFINITE_LENGTH) {
       return 91;
    }
    if(UsefulBuf_Compare(ReturnedEncodedCBOR, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedMap4Indef))) {
@@ -10482,7 +10618,7 @@ int32_t GetMapAndArrayTest(void)
    if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE) {
       return 100;
    }
-   if(UINT32_MAX != QCBORDecode_Tell(&DCtx)) {
+   if(QCBOR_OFFSET_MAX != QCBORDecode_Tell(&DCtx)) {
       return 101;
    }
    QCBORDecode_GetAndResetError(&DCtx);
@@ -10641,7 +10777,7 @@ int32_t TellTests(void)
 {
    QCBORDecodeContext DCtx;
    QCBORItem          Item;
-   uint32_t           uPosition;
+   QCBOROffset        uPosition;
    int                nIndex;
    int64_t            nDecodedInt;
 
@@ -10787,7 +10923,7 @@ int32_t TellTests(void)
                     0);
    /* Cause an error */
    QCBORDecode_GetInt64InMapSZ(&DCtx, "another int", &nDecodedInt);
-   if(QCBORDecode_Tell(&DCtx) != UINT32_MAX) {
+   if(QCBORDecode_Tell(&DCtx) != QCBOR_OFFSET_MAX) {
       return 3000;
    }
    if(QCBORDecode_EndCheck(&DCtx) != QCBOR_ERR_MAP_NOT_ENTERED) {
@@ -10958,3 +11094,3345 @@ int32_t TellTests(void)
 
    return 0;
 }
+
+
+int32_t InitialByteTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   QCBORError         uErr;
+   QCBORError         uExpected;
+   uint8_t            pInput[9];
+   int                nInitialByte;
+
+   /* The initial byte followed by enough zero bytes for the largest
+    * argument. Only checks the errors that come from the initial byte
+    * alone. The zero bytes may cause other errors.
+    */
+   memset(pInput, 0, sizeof(pInput));
+
+   for(nInitialByte = 0; nInitialByte < 256; nInitialByte++) {
+      const int nMajorType      = nInitialByte >> 5;
+      const int nAdditionalInfo = nInitialByte & 0x1f;
+
+      pInput[0] = (uint8_t)nInitialByte;
+      QCBORDecode_Init(&DCtx, (UsefulBufC){pInput, sizeof(pInput)}, 0);
+      uErr = QCBORDecode_GetNext(&DCtx, &Item);
+
+      uExpected = QCBOR_SUCCESS;
+      if(nAdditionalInfo >= 28 && nAdditionalInfo <= 30) {
+         uExpected = QCBOR_ERR_UNSUPPORTED;
+      } else if(nAdditionalInfo == 31) {
+         if(nMajorType == CBOR_MAJOR_TYPE_POSITIVE_INT ||
+            nMajorType == CBOR_MAJOR_TYPE_NEGATIVE_INT) {
+            uExpected = QCBOR_ERR_BAD_INT;
+         } else if(nMajorType == CBOR_MAJOR_TYPE_TAG) {
+#ifndef QCBOR_DISABLE_TAGS
+            uExpected = QCBOR_ERR_BAD_INT;
+#else /* QCBOR_DISABLE_TAGS */
+            uExpected = QCBOR_ERR_TAGS_DISABLED;
+#endif /* QCBOR_DISABLE_TAGS */
+         }
+      }
+
+      if(uExpected != QCBOR_SUCCESS) {
+         if(uErr != uExpected) {
+            return nInitialByte + 1000;
+         }
+      } else {
+         if(uErr == QCBOR_ERR_UNSUPPORTED || uErr == QCBOR_ERR_BAD_INT) {
+            return nInitialByte + 2000;
+         }
+      }
+   }
+
+   return 0;
+}
+
+
+static const uint8_t spIntArray[] = {
+   0x85, 0x01, 0x20, 0x18, 0x18,
+   0x1b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x18, 0x63};
+
+static const uint8_t spIntArrayTagged[] = {
+   0x83, 0x01, 0xd9, 0x04, 0xd2, 0x02, 0x03};
+
+static const uint8_t spIntArrayIndef[] = {
+   0x9f, 0x01, 0x02, 0x03, 0xff, 0x04};
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+static const uint8_t spIntArraysInMap[] = {
+   0xa3, 0x01, 0x82, 0x01, 0x02, 0x61, 0x61, 0x82, 0x03, 0x04, 0x02, 0x05};
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+static const uint8_t spIntArrayBigUint[] = {
+   0x82, 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+
+static const uint8_t spIntArrayNegative[] = {0x82, 0x00, 0x20};
+
+static const uint8_t spIntArrayString[] = {0x82, 0x01, 0x61, 0x61};
+
+static const uint8_t spIntArrayEmpty[] = {0x80, 0x01};
+
+static const uint8_t spIntArrayTruncated[] = {0x83, 0x01, 0x02};
+
+
+int32_t IntArrayTest(void)
+{
+   QCBORDecodeContext DCtx;
+   int64_t            pnValues[6];
+   uint64_t           puValues[6];
+   size_t             uCount;
+   int64_t            nInt;
+   QCBORError         uErr;
+
+   /* Definite length, all through the fast path, cursor after array */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArray), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 5) {
+      return 1;
+   }
+   if(pnValues[0] != 1 ||
+      pnValues[1] != -1 ||
+      pnValues[2] != 24 ||
+      pnValues[3] != INT64_MAX ||
+      pnValues[4] != INT64_MIN) {
+      return 2;
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   if(nInt != 99 || QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 3;
+   }
+
+   /* Negative integer goes from the fast path to the general path for the error */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArray), 0);
+   QCBORDecode_GetUInt64Array(&DCtx, 5, puValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_NUMBER_SIGN_CONVERSION || uCount != 1) {
+      return 4;
+   }
+
+   /* Buffer too small */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArray), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 2, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_ARRAY_DECODE_TOO_LONG || uCount != 2) {
+      return 5;
+   }
+
+   /* A tag in the middle falls back to the general path */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayTagged), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+#ifndef QCBOR_DISABLE_TAGS
+   if(uErr != QCBOR_SUCCESS || uCount != 3 ||
+      pnValues[0] != 1 || pnValues[1] != 2 || pnValues[2] != 3) {
+      return 6;
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 7;
+   }
+#else /* QCBOR_DISABLE_TAGS */
+   if(uErr != QCBOR_ERR_TAGS_DISABLED || uCount != 1) {
+      return 6;
+   }
+#endif /* QCBOR_DISABLE_TAGS */
+
+   /* Indefinite length */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayIndef), 0);
+   QCBORDecode_GetUInt64Array(&DCtx, 3, puValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   if(uErr != QCBOR_SUCCESS || uCount != 3 ||
+      puValues[0] != 1 || puValues[1] != 2 || puValues[2] != 3) {
+      return 8;
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   if(nInt != 4 || QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 9;
+   }
+#else /* QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   if(uErr != QCBOR_ERR_INDEF_LEN_ARRAYS_DISABLED) {
+      return 8;
+   }
+#endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+   /* Too large for int64_t, but not for uint64_t */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayBigUint), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW || uCount != 0) {
+      return 10;
+   }
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayBigUint), 0);
+   QCBORDecode_GetUInt64Array(&DCtx, 6, puValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_SUCCESS || uCount != 2 ||
+      puValues[0] != UINT64_MAX || puValues[1] != 0) {
+      return 11;
+   }
+
+   /* Negative into unsigned */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayNegative), 0);
+   QCBORDecode_GetUInt64Array(&DCtx, 6, puValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_NUMBER_SIGN_CONVERSION || uCount != 1) {
+      return 12;
+   }
+
+   /* Not an integer */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayString), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_UNEXPECTED_TYPE || uCount != 1) {
+      return 13;
+   }
+
+   /* Not an array */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayNegative), 0);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_UNEXPECTED_TYPE || uCount != 0) {
+      return 14;
+   }
+
+   /* Empty */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayEmpty), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 0, pnValues, &uCount);
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || uCount != 0 || nInt != 1) {
+      return 15;
+   }
+
+   /* Truncated input */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArrayTruncated), 0);
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+   if(uErr != QCBOR_ERR_HIT_END || uCount != 2) {
+      return 16;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   /* In a map. The searches don't move the traversal cursor */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArraysInMap), 0);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64ArrayInMapN(&DCtx, 1, 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pnValues[0] != 1 || pnValues[1] != 2) {
+      return 17;
+   }
+   QCBORDecode_GetUInt64ArrayInMapN(&DCtx, 1, 6, puValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      puValues[0] != 1 || puValues[1] != 2) {
+      return 18;
+   }
+   QCBORDecode_GetInt64InMapN(&DCtx, 2, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 5) {
+      return 19;
+   }
+   QCBORDecode_GetInt64ArrayInMapSZ(&DCtx, "a", 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pnValues[0] != 3 || pnValues[1] != 4) {
+      return 20;
+   }
+   QCBORDecode_GetUInt64ArrayInMapSZ(&DCtx, "a", 6, puValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      puValues[0] != 3 || puValues[1] != 4) {
+      return 21;
+   }
+
+   /* Traverse in order from where the cursor was left */
+   QCBORDecode_GetInt64Array(&DCtx, 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pnValues[0] != 1 || pnValues[1] != 2) {
+      return 22;
+   }
+   QCBORDecode_GetUInt64Array(&DCtx, 6, puValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      puValues[0] != 3 || puValues[1] != 4) {
+      return 23;
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || nInt != 5) {
+      return 24;
+   }
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArraysInMap), 0);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64ArrayInMapN(&DCtx, 2, 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE || uCount != 0) {
+      return 25;
+   }
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIntArraysInMap), 0);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64ArrayInMapN(&DCtx, 3, 6, pnValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_LABEL_NOT_FOUND || uCount != 0) {
+      return 26;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   return 0;
+}
+
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+static const uint8_t spFloatArrayDouble[] = {
+   0xa1, 0x01, 0x82,
+   0xfb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+   0xfb, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+static const uint8_t spFloatArray[] = {
+   0x85,
+   0xf9, 0x3c, 0x00,
+   0xf9, 0xc0, 0x00,
+   0xfa, 0x47, 0xc3, 0x50, 0x00,
+   0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a,
+   0xf9, 0x7c, 0x00,
+   0x01};
+
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+static const uint8_t spFloatArrayExact[] = {
+   0x83,
+   0xf9, 0x3c, 0x00,
+   0xfa, 0x3f, 0xc0, 0x00, 0x00,
+   0xfb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+static const uint8_t spFloatArrayIndef[] = {
+   0x9f, 0xf9, 0x3c, 0x00, 0xf9, 0x40, 0x00, 0xff};
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+static const uint8_t spFloatArrayString[] = {0x82, 0xf9, 0x3c, 0x00, 0x61, 0x61};
+
+static const uint8_t spFloatArrayTruncated[] = {0x82, 0xf9, 0x3c, 0x00, 0xf9, 0x3c};
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+
+
+int32_t FloatArrayTest(void)
+{
+   QCBORDecodeContext DCtx;
+   double             pdValues[6];
+   float              pfValues[6];
+   size_t             uCount;
+   int64_t            nInt;
+   QCBORError         uErr;
+
+   /* Doubles only, in a map */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArrayDouble), 0);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetDoubleArrayInMapN(&DCtx, 1, 6, pdValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pdValues[0] != 1.5 || pdValues[1] != -2.0) {
+      return 1;
+   }
+   QCBORDecode_GetFloatArrayInMapN(&DCtx, 1, 6, pfValues, &uCount);
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pfValues[0] != 1.5f || pfValues[1] != -2.0f) {
+      return 2;
+   }
+   QCBORDecode_GetDoubleArray(&DCtx, 6, pdValues, &uCount);
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || uCount != 2) {
+      return 3;
+   }
+#else /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_HW_FLOAT_DISABLED || uCount != 0) {
+      return 2;
+   }
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+
+   /* Mixed widths */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArray), 0);
+   QCBORDecode_GetDoubleArray(&DCtx, 6, pdValues, &uCount);
+   uErr = QCBORDecode_GetError(&DCtx);
+#ifndef QCBOR_DISABLE_PREFERRED_FLOAT
+   if(uErr != QCBOR_SUCCESS || uCount != 5) {
+      return 10;
+   }
+   if(pdValues[0] != 1.0 ||
+      pdValues[1] != -2.0 ||
+      pdValues[2] != 100000.0 ||
+      pdValues[3] != 1.1 ||
+      pdValues[4] != INFINITY) {
+      return 11;
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   if(nInt != 1 || QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 12;
+   }
+
+   /* Buffer too small */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArray), 0);
+   QCBORDecode_GetDoubleArray(&DCtx, 4, pdValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_ARRAY_DECODE_TOO_LONG || uCount != 4) {
+      return 13;
+   }
+
+#ifndef QCBOR_DISABLE_FLOAT_HW_USE
+   /* 1.1 is not exact as a float */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArray), 0);
+   QCBORDecode_GetFloatArray(&DCtx, 6, pfValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_CONVERSION_UNDER_OVER_FLOW || uCount != 3) {
+      return 14;
+   }
+   if(pfValues[0] != 1.0f || pfValues[1] != -2.0f || pfValues[2] != 100000.0f) {
+      return 15;
+   }
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArrayExact), 0);
+   QCBORDecode_GetFloatArray(&DCtx, 6, pfValues, &uCount);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || uCount != 3 ||
+      pfValues[0] != 1.0f || pfValues[1] != 1.5f || pfValues[2] != 1.5f) {
+      return 16;
+   }
+#endif /* ! QCBOR_DISABLE_FLOAT_HW_USE */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArrayIndef), 0);
+   QCBORDecode_GetDoubleArray(&DCtx, 6, pdValues, &uCount);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || uCount != 2 ||
+      pdValues[0] != 1.0 || pdValues[1] != 2.0) {
+      return 17;
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+   /* Not a float */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArrayString), 0);
+   QCBORDecode_GetDoubleArray(&DCtx, 6, pdValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE || uCount != 1) {
+      return 18;
+   }
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFloatArrayTruncated), 0);
+   QCBORDecode_GetDoubleArray(&DCtx, 6, pdValues, &uCount);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_HIT_END || uCount != 1) {
+      return 19;
+   }
+#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+   (void)nInt;
+   if(uErr != QCBOR_ERR_HALF_PRECISION_DISABLED || uCount != 0) {
+      return 10;
+   }
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT */
+
+   return 0;
+}
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+
+struct ValidateTestInput {
+   UsefulBufC Input;
+   QCBORError uExpectedErr;
+   size_t     uExpectedOffset;
+};
+
+static const struct ValidateTestInput ValidateTestInputs[] = {
+   /* Integer */
+   {{"\x01", 1}, QCBOR_SUCCESS, 1},
+   /* [_ 1] */
+   {{"\x9f\x01\xff", 3}, QCBOR_SUCCESS, 3},
+   /* [_ 1, 2] */
+   {{"\x9f\x01\x02\xff", 4}, QCBOR_SUCCESS, 4},
+   /* Empty input */
+   {{"", 0}, QCBOR_ERR_HIT_END, 0},
+   /* [1, [], {}] */
+   {{"\x83\x01\x80\xa0", 4}, QCBOR_SUCCESS, 4},
+   /* {1: h'0102', "a": [true]} */
+   {{"\xa2\x01\x42\x01\x02\x61\x61\x81\xf5", 9}, QCBOR_SUCCESS, 9},
+   /* 1(1(2)) */
+   {{"\xc1\xc1\x02", 3}, QCBOR_SUCCESS, 3},
+   /* [_ 1, {_ 1: (_ "a", "b")}] */
+   {{"\x9f\x01\xbf\x01\x7f\x61\x61\x61\x62\xff\xff\xff", 12}, QCBOR_SUCCESS, 12},
+   /* Extra byte after the item */
+   {{"\x82\x01\x02\x03", 4}, QCBOR_ERR_EXTRA_BYTES, 3},
+   /* Array one item short */
+   {{"\x83\x01\x02", 3}, QCBOR_ERR_HIT_END, 3},
+   /* Array count larger than the input */
+   {{"\x9a\xff\xff\xff\xff\x00", 6}, QCBOR_ERR_HIT_END, 6},
+   /* String longer than the input */
+   {{"\x82\x01\x43\x01\x02", 5}, QCBOR_ERR_HIT_END, 5},
+   /* Reserved additional info in an array */
+   {{"\x82\x01\x1c", 3}, QCBOR_ERR_UNSUPPORTED, 2},
+   /* Indefinite-length negative integer */
+   {{"\x81\x3f", 2}, QCBOR_ERR_BAD_INT, 1},
+   /* Indefinite-length tag */
+   {{"\xdf\x01", 2}, QCBOR_ERR_BAD_INT, 0},
+   /* Break in definite-length array */
+   {{"\x82\x01\xff", 3}, QCBOR_ERR_BAD_BREAK, 2},
+   /* Break at top level */
+   {{"\xff", 1}, QCBOR_ERR_BAD_BREAK, 0},
+   /* Break after a map label */
+   {{"\xbf\x01\xff", 3}, QCBOR_ERR_BAD_BREAK, 2},
+   /* Break after a tag number */
+   {{"\x9f\xc1\xff", 3}, QCBOR_ERR_BAD_BREAK, 2},
+   /* Tag number with no content */
+   {{"\xc1", 1}, QCBOR_ERR_HIT_END, 1},
+   /* Simple value in two bytes less than 32 */
+   {{"\x81\xf8\x1f", 3}, QCBOR_ERR_BAD_TYPE_7, 1},
+   /* Text string chunk in byte string */
+   {{"\x5f\x41\x00\x61\x61\xff", 6}, QCBOR_ERR_INDEFINITE_STRING_CHUNK, 3},
+   /* Indefinite-length chunk */
+   {{"\x5f\x5f\xff\xff", 4}, QCBOR_ERR_INDEFINITE_STRING_CHUNK, 1},
+   /* Unterminated indefinite-length string */
+   {{"\x7f\x61\x61", 3}, QCBOR_ERR_HIT_END, 3},
+   /* Nesting one level too deep */
+   {{"\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x00", 17},
+     QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP, 15},
+   /* Nesting at the maximum */
+   {{"\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x00", 16},
+     QCBOR_SUCCESS, 16},
+};
+
+
+int32_t WellFormedValidateTest(void)
+{
+   QCBORError uErr;
+   size_t     uOffset;
+   size_t     uIndex;
+
+   /* Everything in the not-well-formed corpus must fail */
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(paNotWellFormedCBOR, struct someBinaryBytes); uIndex++) {
+      const struct someBinaryBytes *pBytes = &paNotWellFormedCBOR[uIndex];
+
+      uErr = QCBORDecode_ValidateWellFormed((UsefulBufC){pBytes->p, pBytes->n}, &uOffset);
+      if(uErr == QCBOR_SUCCESS) {
+         return (int32_t)(1000 + uIndex);
+      }
+      if(uOffset > pBytes->n) {
+         return (int32_t)(2000 + uIndex);
+      }
+   }
+
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(ValidateTestInputs, struct ValidateTestInput); uIndex++) {
+      const struct ValidateTestInput *pTest = &ValidateTestInputs[uIndex];
+
+      uErr = QCBORDecode_ValidateWellFormed(pTest->Input, &uOffset);
+      if(uErr != pTest->uExpectedErr) {
+         return (int32_t)(3000 + uIndex * 100 + uErr);
+      }
+      if(uOffset != pTest->uExpectedOffset) {
+         return (int32_t)(4000 + uIndex);
+      }
+   }
+
+   /* A NULL offset pointer is allowed */
+   if(QCBORDecode_ValidateWellFormed(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSimpleArray), NULL) != QCBOR_SUCCESS) {
+      return 10;
+   }
+
+   /* Larger well-formed inputs used elsewhere in these tests */
+   if(QCBORDecode_ValidateWellFormed(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), NULL) != QCBOR_SUCCESS) {
+      return 11;
+   }
+   if(QCBORDecode_ValidateWellFormed(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts), NULL) != QCBOR_SUCCESS) {
+      return 12;
+   }
+
+   return 0;
+}
+
+
+/* [_ {_ 1: [_ 2, 3], 2: {}}, [1, [2, [3]]], [_ ], {1: [_ 4]}, 5] */
+static const uint8_t spNestedForIndex[] = {
+   0x9f, 0xbf, 0x01, 0x9f, 0x02, 0x03, 0xff, 0x02,
+   0xa0, 0xff, 0x82, 0x01, 0x82, 0x02, 0x81, 0x03,
+   0x9f, 0xff, 0xa1, 0x01, 0x9f, 0x04, 0xff, 0x05,
+   0xff
+};
+
+static const QCBORContainerIndexEntry spExpectedIndex[] = {
+   { 1, 25, 5},
+   { 2, 10, 2},
+   { 4,  7, 2},
+   { 9,  9, 0},
+   {11, 16, 2},
+   {13, 16, 2},
+   {15, 16, 1},
+   {17, 18, 0},
+   {19, 23, 1},
+   {21, 23, 1}
+};
+
+
+/* Traverse the input with and without the index, or with and
+ * without fast skip, mixing QCBORDecode_VGetNext() and
+ * QCBORDecode_VGetNextConsume() per the bits in uPattern. Everything
+ * must be the same both ways. */
+static int32_t
+CompareIndexedTraversal(UsefulBufC Input, unsigned uPattern, bool bFastSkip)
+{
+   QCBORDecodeContext       DCtx;
+   QCBORDecodeContext       DCtxIndexed;
+   QCBORItem                Item;
+   QCBORItem                ItemIndexed;
+   QCBORContainerIndexEntry Index[20];
+   size_t                   uIndexCount;
+   QCBORError               uErr;
+   unsigned                 uStep;
+
+   if(QCBORDecode_BuildContainerIndex(Input, Index, C_ARRAY_COUNT(Index, QCBORContainerIndexEntry), &uIndexCount)) {
+      return 1;
+   }
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_Init(&DCtxIndexed, Input, QCBOR_DECODE_MODE_NORMAL);
+   if(bFastSkip) {
+      QCBORDecode_EnableFastSkip(&DCtxIndexed);
+   } else {
+      QCBORDecode_SetContainerIndex(&DCtxIndexed, Index, uIndexCount);
+   }
+
+   for(uStep = 0; uStep < 100; uStep++) {
+      if((uPattern >> (uStep % 4)) & 1) {
+         QCBORDecode_VGetNextConsume(&DCtx, &Item);
+         QCBORDecode_VGetNextConsume(&DCtxIndexed, &ItemIndexed);
+      } else {
+         QCBORDecode_VGetNext(&DCtx, &Item);
+         QCBORDecode_VGetNext(&DCtxIndexed, &ItemIndexed);
+      }
+      uErr = QCBORDecode_GetAndResetError(&DCtx);
+      if(uErr != QCBORDecode_GetAndResetError(&DCtxIndexed)) {
+         return 2;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         return uErr == QCBOR_ERR_NO_MORE_ITEMS ? 0 : 3;
+      }
+      if(Item.uDataType != ItemIndexed.uDataType ||
+         Item.uNestingLevel != ItemIndexed.uNestingLevel ||
+         Item.uNextNestLevel != ItemIndexed.uNextNestLevel ||
+         QCBORDecode_Tell(&DCtx) != QCBORDecode_Tell(&DCtxIndexed)) {
+         return 4;
+      }
+   }
+
+   return 5;
+}
+
+
+int32_t ContainerIndexTest(void)
+{
+   QCBORContainerIndexEntry Index[20];
+   size_t                   uIndexCount;
+   size_t                   uEntry;
+   unsigned                 uPattern;
+   int32_t                  nResult;
+   QCBORError               uErr;
+
+   /* Sizing call */
+   uErr = QCBORDecode_BuildContainerIndex(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex), NULL, 0, &uIndexCount);
+   if(uErr != QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL || uIndexCount != 10) {
+      return 1;
+   }
+
+   uErr = QCBORDecode_BuildContainerIndex(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex), Index, 9, &uIndexCount);
+   if(uErr != QCBOR_ERR_CONTAINER_INDEX_TOO_SMALL || uIndexCount != 10) {
+      return 2;
+   }
+
+   uErr = QCBORDecode_BuildContainerIndex(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex), Index, 20, &uIndexCount);
+   if(uErr != QCBOR_SUCCESS || uIndexCount != 10) {
+      return 3;
+   }
+   for(uEntry = 0; uEntry < uIndexCount; uEntry++) {
+      if(Index[uEntry].uContentOffset != spExpectedIndex[uEntry].uContentOffset ||
+         Index[uEntry].uEndOffset != spExpectedIndex[uEntry].uEndOffset ||
+         Index[uEntry].uCount != spExpectedIndex[uEntry].uCount) {
+         return (int32_t)(10 + uEntry);
+      }
+   }
+
+   /* Not-well-formed input is rejected */
+   uErr = QCBORDecode_BuildContainerIndex((UsefulBufC){spNestedForIndex, sizeof(spNestedForIndex)-1}, Index, 20, &uIndexCount);
+   if(uErr != QCBOR_ERR_HIT_END) {
+      return 4;
+   }
+
+   for(uPattern = 0; uPattern < 16; uPattern++) {
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+      nResult = CompareIndexedTraversal(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex), uPattern, false);
+      if(nResult) {
+         return 100 + (int32_t)uPattern * 10 + nResult;
+      }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+      nResult = CompareIndexedTraversal(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), uPattern, false);
+      if(nResult) {
+         return 300 + (int32_t)uPattern * 10 + nResult;
+      }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   UsefulBufC         Encoded;
+   int64_t            nInt;
+
+   /* Map search, GetMap and ExitMap jump over the map in a map */
+   QCBORDecode_BuildContainerIndex(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), Index, 20, &uIndexCount);
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetContainerIndex(&DCtx, Index, uIndexCount);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetMapFromMapSZ(&DCtx, "map in a map", &Item, &Encoded);
+   if(QCBORDecode_GetError(&DCtx) ||
+      UsefulBuf_Compare(Encoded, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedMap4))) {
+      return 500;
+   }
+   QCBORDecode_EnterMapFromMapSZ(&DCtx, "map in a map");
+   QCBORDecode_GetInt64InMapSZ(&DCtx, "another int", &nInt);
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_GetInt64InMapSZ(&DCtx, "first integer", &nInt);
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || nInt != 42) {
+      return 501;
+   }
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   /* GetArray must return the same bytes with and without the index */
+   UsefulBufC EncodedIndexed;
+   QCBORDecode_BuildContainerIndex(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapIndefEncoded), Index, 20, &uIndexCount);
+   for(uEntry = 0; uEntry < 2; uEntry++) {
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapIndefEncoded), QCBOR_DECODE_MODE_NORMAL);
+      if(uEntry == 1) {
+         EncodedIndexed = Encoded;
+         QCBORDecode_SetContainerIndex(&DCtx, Index, uIndexCount);
+      }
+      QCBORDecode_EnterMap(&DCtx, NULL);
+      QCBORDecode_VGetNextConsume(&DCtx, &Item);
+      QCBORDecode_GetArray(&DCtx, &Item, &Encoded);
+      QCBORDecode_EnterMapFromMapSZ(&DCtx, "map in a map");
+      QCBORDecode_ExitMap(&DCtx);
+      QCBORDecode_ExitMap(&DCtx);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || Item.uDataType != QCBOR_TYPE_ARRAY) {
+         return 502;
+      }
+   }
+   if(UsefulBuf_Compare(Encoded, EncodedIndexed)) {
+      return 503;
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   return 0;
+}
+
+
+/* {1: [(_ "a", "b"), 2], 3: 4} */
+static const uint8_t spIndefStringInArray[] = {
+   0xa2, 0x01, 0x82, 0x7f, 0x61, 0x61, 0x61, 0x62,
+   0xff, 0x02, 0x03, 0x04
+};
+
+/* [1, [0x1c]] -- Reserved additional info in a nested array */
+static const uint8_t spBadInNestedArray[] = {
+   0x82, 0x01, 0x81, 0x1c
+};
+
+
+int32_t FastSkipTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORDecodeContext DCtxFast;
+   QCBORItem          Item;
+   unsigned           uPattern;
+   int32_t            nResult;
+   size_t             uDepth;
+   UsefulBufC         Deep;
+   QCBORError         uErr;
+
+   for(uPattern = 0; uPattern < 16; uPattern++) {
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+      nResult = CompareIndexedTraversal(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex), uPattern, true);
+      if(nResult) {
+         return 100 + (int32_t)uPattern * 10 + nResult;
+      }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+      nResult = CompareIndexedTraversal(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), uPattern, true);
+      if(nResult) {
+         return 300 + (int32_t)uPattern * 10 + nResult;
+      }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   }
+
+   /* The nesting limit is the same skipping as decoding at every depth */
+   for(uDepth = 1; uDepth <= sizeof(spTooDeepArrays); uDepth++) {
+      Deep = UsefulBuf_Tail(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spTooDeepArrays),
+                            sizeof(spTooDeepArrays) - uDepth);
+      QCBORDecode_Init(&DCtx, Deep, QCBOR_DECODE_MODE_NORMAL);
+      QCBORDecode_Init(&DCtxFast, Deep, QCBOR_DECODE_MODE_NORMAL);
+      QCBORDecode_EnableFastSkip(&DCtxFast);
+      QCBORDecode_VGetNextConsume(&DCtx, &Item);
+      QCBORDecode_VGetNextConsume(&DCtxFast, &Item);
+      uErr = QCBORDecode_Finish(&DCtx);
+      if(uErr != QCBORDecode_Finish(&DCtxFast)) {
+         return (int32_t)(500 + uDepth);
+      }
+      if(uErr != (uDepth <= QCBOR_MAX_ARRAY_NESTING + 1 ? QCBOR_SUCCESS : QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP)) {
+         return (int32_t)(600 + uDepth);
+      }
+   }
+
+   /* Not-well-formed input in skipped content is still an error */
+   QCBORDecode_Init(&DCtxFast, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spBadInNestedArray), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableFastSkip(&DCtxFast);
+   QCBORDecode_VGetNextConsume(&DCtxFast, &Item);
+   if(QCBORDecode_GetError(&DCtxFast) != QCBOR_ERR_UNSUPPORTED) {
+      return 700;
+   }
+
+   /* A map search skips over the indefinite-length string without
+    * needing a string allocator */
+   int64_t nInt;
+   QCBORDecode_Init(&DCtxFast, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIndefStringInArray), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableFastSkip(&DCtxFast);
+   QCBORDecode_EnterMap(&DCtxFast, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtxFast, 3, &nInt);
+   QCBORDecode_ExitMap(&DCtxFast);
+   if(QCBORDecode_Finish(&DCtxFast) != QCBOR_SUCCESS || nInt != 4) {
+      return 701;
+   }
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spIndefStringInArray), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtx, 3, &nInt);
+   if(QCBORDecode_GetError(&DCtx) == QCBOR_SUCCESS) {
+      return 702;
+   }
+
+   return 0;
+}
+
+
+/* Traverse the input with QCBORDecode_GetNext() and again mixing
+ * QCBORDecode_GetNextLite() and QCBORDecode_GetNext() per the bits
+ * in uPattern. The items and errors must be the same. */
+static int32_t
+LiteDecodeCompare(UsefulBufC Input, unsigned uPattern)
+{
+   QCBORDecodeContext DCtx;
+   QCBORDecodeContext DCtxRef;
+   QCBORItem          Item;
+   QCBORItem          ItemRef;
+   QCBORItemLite      Lite;
+   QCBORError         uErr;
+   unsigned           uStep;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_Init(&DCtxRef, Input, QCBOR_DECODE_MODE_NORMAL);
+
+   for(uStep = 0; uStep < 200; uStep++) {
+      uErr = QCBORDecode_GetNext(&DCtxRef, &ItemRef);
+      if((uPattern >> (uStep % 4)) & 1) {
+         if(uErr != QCBORDecode_GetNextLite(&DCtx, &Lite)) {
+            return 1;
+         }
+      } else {
+         if(uErr != QCBORDecode_GetNext(&DCtx, &Item)) {
+            return 1;
+         }
+         Lite.uDataType     = Item.uDataType;
+         Lite.uLabelType    = Item.uLabelType;
+         Lite.uNestingLevel = Item.uNestingLevel;
+         Lite.val.string    = Item.val.string;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+         Lite.label.string  = Item.label.string;
+#else
+         Lite.label.int64   = Item.label.int64;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         return 0;
+      }
+      if(Lite.uDataType != ItemRef.uDataType ||
+         Lite.uLabelType != ItemRef.uLabelType ||
+         Lite.uNestingLevel != ItemRef.uNestingLevel ||
+         QCBORDecode_Tell(&DCtx) != QCBORDecode_Tell(&DCtxRef)) {
+         return 2;
+      }
+      if((Lite.uDataType == QCBOR_TYPE_INT64 && Lite.val.int64 != ItemRef.val.int64) ||
+         (Lite.uDataType == QCBOR_TYPE_UINT64 && Lite.val.uint64 != ItemRef.val.uint64) ||
+         ((Lite.uDataType == QCBOR_TYPE_TEXT_STRING || Lite.uDataType == QCBOR_TYPE_BYTE_STRING) &&
+          (Lite.val.string.ptr != ItemRef.val.string.ptr || Lite.val.string.len != ItemRef.val.string.len))) {
+         return 3;
+      }
+      if(Lite.uLabelType == QCBOR_TYPE_INT64 && Lite.label.int64 != ItemRef.label.int64) {
+         return 4;
+      }
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+      if(Lite.uLabelType == QCBOR_TYPE_TEXT_STRING &&
+         UsefulBuf_Compare(Lite.label.string, ItemRef.label.string)) {
+         return 4;
+      }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   }
+
+   return 5;
+}
+
+
+int32_t LiteDecodeTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItemLite      Lite;
+   QCBORError         uErr;
+   unsigned           uPattern;
+   size_t             uInput;
+   int32_t            nResult;
+   const UsefulBufC   Inputs[] = {
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput),
+      /* [18446744073709551615, -18446744073709551616, 1] */
+      UsefulBuf_FROM_SZ_LITERAL("\x83\x1b\xff\xff\xff\xff\xff\xff\xff\xff\x3b\xff\xff\xff\xff\xff\xff\xff\xff\x01"),
+      /* ["a", h'6263', 2, 3] with the last string cut short */
+      UsefulBuf_FROM_SZ_LITERAL("\x84\x61\x61\x42\x62"),
+      /* [1, [2, 3], "abc"] */
+      UsefulBuf_FROM_SZ_LITERAL("\x83\x01\x82\x02\x03\x63\x61\x62\x63")
+   };
+
+   for(uInput = 0; uInput < C_ARRAY_COUNT(Inputs, UsefulBufC); uInput++) {
+      for(uPattern = 0; uPattern < 16; uPattern++) {
+         nResult = LiteDecodeCompare(Inputs[uInput], uPattern);
+         if(nResult) {
+            return (int32_t)(uInput * 100 + uPattern * 5) + nResult;
+         }
+      }
+   }
+
+#ifndef QCBOR_DISABLE_TAGS
+   /* Tag content is returned without processing */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xc1\x1a\x53\x72\x4e\x00"), QCBOR_DECODE_MODE_NORMAL);
+   uErr = QCBORDecode_GetNextLite(&DCtx, &Lite);
+   if(uErr != QCBOR_SUCCESS ||
+      Lite.uDataType != QCBOR_TYPE_INT64 ||
+      Lite.val.int64 != 1400000000 ||
+      QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 1000;
+   }
+#endif /* ! QCBOR_DISABLE_TAGS */
+
+   /* Errors leave the type as none */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x1c"), QCBOR_DECODE_MODE_NORMAL);
+   uErr = QCBORDecode_GetNextLite(&DCtx, &Lite);
+   if(uErr != QCBOR_ERR_UNSUPPORTED || Lite.uDataType != QCBOR_TYPE_NONE) {
+      return 1001;
+   }
+
+   return 0;
+}
+
+
+/* Field by field so padding doesn't matter */
+static bool
+SameItem(const QCBORItem *pItem1, const QCBORItem *pItem2)
+{
+   return pItem1->uDataType == pItem2->uDataType &&
+          pItem1->uLabelType == pItem2->uLabelType &&
+          pItem1->uNestingLevel == pItem2->uNestingLevel &&
+          pItem1->uNextNestLevel == pItem2->uNextNestLevel &&
+          pItem1->uDataAlloc == pItem2->uDataAlloc &&
+          pItem1->uLabelAlloc == pItem2->uLabelAlloc &&
+          !memcmp(&(pItem1->val), &(pItem2->val), sizeof(pItem1->val)) &&
+          !memcmp(&(pItem1->label), &(pItem2->label), sizeof(pItem1->label));
+}
+
+
+/* Traverse the input with and without a peek cache, peeking at
+ * items in different ways per the bits in uPattern. Everything must
+ * be the same both ways. */
+static int32_t
+PeekCacheCompare(UsefulBufC Input, unsigned uPattern)
+{
+   QCBORDecodeContext DCtx;
+   QCBORDecodeContext DCtxCached;
+   QCBORPeekCache     Cache;
+   QCBORItem          Item;
+   QCBORItem          ItemCached;
+   QCBORError         uErr;
+   unsigned           uStep;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_Init(&DCtxCached, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetPeekCache(&DCtxCached, &Cache);
+
+   for(uStep = 0; uStep < 100; uStep++) {
+      switch((uPattern >> ((uStep % 4) * 2)) & 0x03) {
+         case 0:
+            QCBORDecode_VGetNext(&DCtx, &Item);
+            QCBORDecode_VGetNext(&DCtxCached, &ItemCached);
+            break;
+
+         case 1:
+            QCBORDecode_VPeekNext(&DCtx, &Item);
+            QCBORDecode_VPeekNext(&DCtxCached, &ItemCached);
+            if(!SameItem(&Item, &ItemCached)) {
+               return 1;
+            }
+            QCBORDecode_VGetNext(&DCtx, &Item);
+            QCBORDecode_VGetNext(&DCtxCached, &ItemCached);
+            break;
+
+         case 2:
+            QCBORDecode_VPeekNext(&DCtx, &Item);
+            QCBORDecode_VPeekNext(&DCtxCached, &ItemCached);
+            QCBORDecode_VPeekNext(&DCtxCached, &ItemCached);
+            QCBORDecode_VGetNextConsume(&DCtx, &Item);
+            QCBORDecode_VGetNextConsume(&DCtxCached, &ItemCached);
+            break;
+
+         default:
+            /* Peek then move the cursor some other way */
+            QCBORDecode_VPeekNext(&DCtxCached, &ItemCached);
+            QCBORDecode_Rewind(&DCtx);
+            QCBORDecode_Rewind(&DCtxCached);
+            QCBORDecode_VGetNextConsume(&DCtx, &Item);
+            QCBORDecode_VGetNextConsume(&DCtxCached, &ItemCached);
+            break;
+      }
+      uErr = QCBORDecode_GetAndResetError(&DCtx);
+      if(uErr != QCBORDecode_GetAndResetError(&DCtxCached)) {
+         return 2;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         /* Same error both ways, which may be a disabled feature */
+         return 0;
+      }
+      if(!SameItem(&Item, &ItemCached) ||
+         QCBORDecode_Tell(&DCtx) != QCBORDecode_Tell(&DCtxCached)) {
+         return 4;
+      }
+   }
+
+   return 0;
+}
+
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+struct CountingAllocator {
+   uint8_t  pBuf[16];
+   unsigned uCount;
+};
+
+/* Counts the allocations to see how many times a string is decoded */
+static UsefulBuf CountingAllocate(void *pCtx, void *pOldMem, size_t uNewSize)
+{
+   struct CountingAllocator *pCounter = (struct CountingAllocator *)pCtx;
+
+   (void)pOldMem;
+   if(uNewSize == 0 || uNewSize > sizeof(pCounter->pBuf)) {
+      return NULLUsefulBuf;
+   }
+   pCounter->uCount++;
+   return (UsefulBuf){pCounter->pBuf, uNewSize};
+}
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+
+int32_t PeekCacheTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORPeekCache     Cache;
+   QCBORItem          Item;
+   QCBORItem          Peeked;
+   unsigned           uPattern;
+   size_t             uInput;
+   int32_t            nResult;
+   const UsefulBufC   Inputs[] = {
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput)
+   };
+
+   for(uInput = 0; uInput < C_ARRAY_COUNT(Inputs, UsefulBufC); uInput++) {
+      for(uPattern = 0; uPattern < 256; uPattern++) {
+         nResult = PeekCacheCompare(Inputs[uInput], uPattern);
+         if(nResult) {
+            return (int32_t)(uInput * 10000 + uPattern * 10) + nResult;
+         }
+      }
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   /* A map search after a peek doesn't disturb the peeked item and
+    * entering a map after a peek gets the right items */
+   int64_t nInt;
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetPeekCache(&DCtx, &Cache);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_VPeekNext(&DCtx, &Peeked);
+   QCBORDecode_GetInt64InMapSZ(&DCtx, "first integer", &nInt);
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      !SameItem(&Item, &Peeked) || nInt != 42 ||
+      Item.uDataType != QCBOR_TYPE_INT64 || Item.val.int64 != 42) {
+      return 100000;
+   }
+   QCBORDecode_VPeekNext(&DCtx, &Peeked);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_VPeekNext(&DCtx, &Peeked);
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_TEXT_STRING ||
+      UsefulBuf_Compare(Item.val.string, UsefulBuf_FROM_SZ_LITERAL("string1"))) {
+      return 100001;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   /* With the cache a peek and a get decode each string once, both
+    * at the top level and in an array */
+   struct CountingAllocator Counter;
+   unsigned                 uCached;
+   const UsefulBufC         Strings[] = {
+      UsefulBuf_FROM_SZ_LITERAL("\x62\x48\x69"),
+      UsefulBuf_FROM_SZ_LITERAL("\x82\x62\x48\x69\x62\x48\x69")
+   };
+
+   for(uCached = 0; uCached < 4; uCached++) {
+      Counter.uCount = 0;
+      QCBORDecode_Init(&DCtx, Strings[uCached / 2], QCBOR_DECODE_MODE_NORMAL);
+      QCBORDecode_SetUpAllocator(&DCtx, CountingAllocate, &Counter, true);
+      if(uCached % 2) {
+         QCBORDecode_SetPeekCache(&DCtx, &Cache);
+      }
+      do {
+         QCBORDecode_VPeekNext(&DCtx, &Peeked);
+         QCBORDecode_VGetNext(&DCtx, &Item);
+      } while(Item.uNextNestLevel != 0);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS ||
+         Counter.uCount != (uCached / 2 + 1) * (2 - uCached % 2) ||
+         Item.uDataType != QCBOR_TYPE_TEXT_STRING ||
+         Item.uDataAlloc != 1) {
+         return (int32_t)(100010 + uCached);
+      }
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+   return 0;
+}
+
+
+/* Decode uSaveAt items, save the cursor, decode the rest, restore
+ * and check the rest decodes the same again. */
+static int32_t
+CursorCompare(UsefulBufC Input, unsigned uSaveAt)
+{
+   QCBORDecodeContext DCtx;
+   QCBORCursor        Cursor;
+   QCBORItem          Items[40];
+   QCBORItem          Item;
+   QCBORError         uErr;
+   QCBORError         uLastErr;
+   unsigned           uCount;
+   unsigned           u;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   for(u = 0; u < uSaveAt; u++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS) {
+         return 0;
+      }
+   }
+   QCBORDecode_SaveCursor(&DCtx, &Cursor);
+
+   for(uCount = 0; uCount < C_ARRAY_COUNT(Items, QCBORItem); uCount++) {
+      uLastErr = QCBORDecode_GetNext(&DCtx, &Items[uCount]);
+      if(uLastErr != QCBOR_SUCCESS) {
+         break;
+      }
+   }
+
+   /* Twice to show a cursor can be used more than once */
+   for(unsigned uPass = 0; uPass < 2; uPass++) {
+      QCBORDecode_RestoreCursor(&DCtx, &Cursor);
+      for(u = 0; u < uCount; u++) {
+         uErr = QCBORDecode_GetNext(&DCtx, &Item);
+         if(uErr != QCBOR_SUCCESS || !SameItem(&Item, &Items[u])) {
+            return (int32_t)(1 + uPass);
+         }
+      }
+      if(uCount < C_ARRAY_COUNT(Items, QCBORItem) &&
+         QCBORDecode_GetNext(&DCtx, &Item) != uLastErr) {
+         return (int32_t)(3 + uPass);
+      }
+   }
+
+   return 0;
+}
+
+
+int32_t CursorTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORCursor        Cursor;
+   unsigned           uSaveAt;
+   size_t             uInput;
+   int32_t            nResult;
+   const UsefulBufC   Inputs[] = {
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spBadInNestedArray)
+   };
+
+   for(uInput = 0; uInput < C_ARRAY_COUNT(Inputs, UsefulBufC); uInput++) {
+      for(uSaveAt = 0; uSaveAt < 60; uSaveAt++) {
+         nResult = CursorCompare(Inputs[uInput], uSaveAt);
+         if(nResult) {
+            return (int32_t)(uInput * 1000 + uSaveAt * 10) + nResult;
+         }
+      }
+   }
+
+   /* Save inside nested byte-string wrapped CBOR and an array, then
+    * exit out of all of them twice from the same cursor */
+   UsefulBuf_MAKE_STACK_UB(OutputBuffer, 100);
+   int64_t n3, n4, n5, n6, n7;
+   int64_t n4Again, n5Again, n6Again;
+
+   QCBORDecode_Init(&DCtx, EncodeBstrWrapTestData(OutputBuffer), 0);
+#ifndef QCBOR_DISABLE_TAGS
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_TAG, NULL);
+#else
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+#endif /* ! QCBOR_DISABLE_TAGS */
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_GetInt64(&DCtx, &n3);
+   QCBORDecode_SaveCursor(&DCtx, &Cursor);
+
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+   QCBORDecode_GetInt64(&DCtx, &n4);
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_GetInt64(&DCtx, &n5);
+   QCBORDecode_ExitArray(&DCtx);
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_GetInt64(&DCtx, &n6);
+
+   /* An error is cleared by restoring */
+   QCBORDecode_GetInt64(&DCtx, &n7);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 10000;
+   }
+
+   QCBORDecode_RestoreCursor(&DCtx, &Cursor);
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+   QCBORDecode_GetInt64(&DCtx, &n4Again);
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_GetInt64(&DCtx, &n5Again);
+   QCBORDecode_ExitArray(&DCtx);
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_GetInt64(&DCtx, &n6Again);
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_GetInt64(&DCtx, &n7);
+   QCBORDecode_GetInt64(&DCtx, &n7);
+   QCBORDecode_ExitArray(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS ||
+      n4 != n4Again || n5 != n5Again || n6 != n6Again) {
+      return 10001;
+   }
+
+   return 0;
+}
+
+
+/* Decode the input in streaming mode fed uChunk bytes at a time and
+ * check every item is the same as decoding it all at once. */
+static int32_t
+StreamingDecodeCompare(UsefulBufC Input, size_t uChunk, bool bDiscard)
+{
+   QCBORDecodeContext DCtx;
+   QCBORDecodeContext DCtxRef;
+   QCBORItem          Item;
+   QCBORItem          ItemRef;
+   QCBORError         uErr;
+   uint8_t            pBuf[512];
+   size_t             uHave;
+   size_t             uFed;
+   size_t             uDiscard;
+   size_t             uMore;
+
+   uFed = uChunk < Input.len ? uChunk : Input.len;
+   memcpy(pBuf, Input.ptr, uFed);
+   uHave = uFed;
+
+   QCBORDecode_Init(&DCtx, (UsefulBufC){pBuf, uHave}, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_Init(&DCtxRef, Input, QCBOR_DECODE_MODE_NORMAL);
+
+   while(1) {
+      uErr = QCBORDecode_GetNext(&DCtx, &Item);
+      if(uErr == QCBOR_ERR_NEED_MORE_INPUT ||
+         (uErr == QCBOR_ERR_NO_MORE_ITEMS && uFed < Input.len)) {
+         if(uFed == Input.len) {
+            return 1;
+         }
+         uDiscard = bDiscard ? QCBORDecode_StreamingConsumed(&DCtx) : 0;
+         memmove(pBuf, pBuf + uDiscard, uHave - uDiscard);
+         uHave -= uDiscard;
+         uMore = Input.len - uFed < uChunk ? Input.len - uFed : uChunk;
+         memcpy(pBuf + uHave, (const uint8_t *)Input.ptr + uFed, uMore);
+         uHave += uMore;
+         uFed  += uMore;
+         QCBORDecode_ContinueInput(&DCtx, (UsefulBufC){pBuf, uHave}, bDiscard);
+         continue;
+      }
+
+      if(uErr != QCBORDecode_GetNext(&DCtxRef, &ItemRef)) {
+         return 2;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         break;
+      }
+      if(Item.uDataType != ItemRef.uDataType ||
+         Item.uLabelType != ItemRef.uLabelType ||
+         Item.uNestingLevel != ItemRef.uNestingLevel ||
+         Item.uNextNestLevel != ItemRef.uNextNestLevel) {
+         return 3;
+      }
+      if(Item.uDataType == QCBOR_TYPE_INT64 && Item.val.int64 != ItemRef.val.int64) {
+         return 4;
+      }
+      if((Item.uDataType == QCBOR_TYPE_TEXT_STRING || Item.uDataType == QCBOR_TYPE_BYTE_STRING) &&
+         UsefulBuf_Compare(Item.val.string, ItemRef.val.string)) {
+         return 5;
+      }
+   }
+
+   return 0;
+}
+
+
+int32_t StreamingDecodeTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   size_t             uChunk;
+   int32_t            nResult;
+   const UsefulBufC   Inputs[] = {
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex),
+      UsefulBuf_FROM_SZ_LITERAL("\x01\x82\x02\x03\x64\x61\x62\x63\x64")
+   };
+   size_t uInput;
+
+   for(uInput = 0; uInput < C_ARRAY_COUNT(Inputs, UsefulBufC); uInput++) {
+      for(uChunk = 1; uChunk < 8; uChunk++) {
+         nResult = StreamingDecodeCompare(Inputs[uInput], uChunk, false);
+         if(nResult) {
+            return (int32_t)(uInput * 1000 + uChunk * 10) + nResult;
+         }
+         nResult = StreamingDecodeCompare(Inputs[uInput], uChunk, true);
+         if(nResult) {
+            return (int32_t)(uInput * 1000 + 100 + uChunk * 10) + nResult;
+         }
+      }
+   }
+
+   /* Without streaming mode it is the usual error */
+   QCBORDecode_Init(&DCtx, (UsefulBufC){spExpectedEncodedInts, 10}, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_HIT_END) {
+      return 5000;
+   }
+
+   /* VGetNextConsume needs the whole array and the error is sticky
+    * until more input is given */
+   QCBORDecode_Init(&DCtx, (UsefulBufC){spExpectedEncodedInts, 10}, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_VGetNextConsume(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_NEED_MORE_INPUT) {
+      return 5001;
+   }
+   QCBORDecode_VGetNextConsume(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_NEED_MORE_INPUT) {
+      return 5002;
+   }
+   QCBORDecode_ContinueInput(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts), false);
+   QCBORDecode_VGetNextConsume(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_ARRAY ||
+      QCBORDecode_Tell(&DCtx) != sizeof(spExpectedEncodedInts)) {
+      return 5003;
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 5004;
+   }
+
+   /* The end of an entered map that ends with the input is the end
+    * of the map, not a need for more input */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x01\x02"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS ||
+      Item.val.int64 != 2) {
+      return 5100;
+   }
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 5101;
+   }
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 5102;
+   }
+
+   /* Same for an empty array and for byte-string wrapped CBOR */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x80"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 5110;
+   }
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x41\x01"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS ||
+      QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 5120;
+   }
+
+   /* Part way into a map that isn't entered still needs more input */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa2\x01\x02"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtx);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_NEED_MORE_INPUT) {
+      return 5130;
+   }
+
+   return 0;
+}
+
+
+/* 20 arrays each holding the next, then [1, {1: 2}]; 22 levels deep */
+static const uint8_t spNested22[] = {
+   0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+   0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+   0x82, 0x01, 0xa1, 0x01, 0x02
+};
+
+/* Decode spNested22 with GetNext, optionally peeking first at each
+ * item and returning the number of items or an error as negative. */
+static int32_t
+NestingStorageDecode(UsefulBuf Storage, bool bPeek)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   QCBORItem          PeekItem;
+   QCBORPeekCache     Cache;
+   QCBORError         uErr;
+   int32_t            nCount;
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   if(QCBORDecode_SetNestingStorage(&DCtx, Storage)) {
+      return -1000;
+   }
+   if(bPeek) {
+      QCBORDecode_SetPeekCache(&DCtx, &Cache);
+   }
+   for(nCount = 0; ; nCount++) {
+      if(bPeek) {
+         uErr = QCBORDecode_PeekNext(&DCtx, &PeekItem);
+         if(uErr != QCBOR_SUCCESS && uErr != QCBOR_ERR_NO_MORE_ITEMS) {
+            return -(int32_t)uErr;
+         }
+      }
+      uErr = QCBORDecode_GetNext(&DCtx, &Item);
+      if(uErr == QCBOR_ERR_NO_MORE_ITEMS) {
+         break;
+      }
+      if(uErr != QCBOR_SUCCESS) {
+         return -(int32_t)uErr;
+      }
+      if(bPeek && !SameItem(&Item, &PeekItem)) {
+         return -2000;
+      }
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return -3000;
+   }
+   return nCount;
+}
+
+
+int32_t NestingStorageTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   QCBORCursor        Cursor;
+   int64_t            nInt;
+   int                nLevel;
+   int32_t            nResult;
+   uint64_t           puStorage[(QCBOR_DECODE_NESTING_STORAGE_SIZE(30) + 7) / 8];
+   uint64_t           puSmall[(QCBOR_DECODE_NESTING_STORAGE_SIZE(2) + 7) / 8];
+   const UsefulBuf    Storage = {puStorage, sizeof(puStorage)};
+
+   /* Too deep for the built-in storage */
+   nResult = NestingStorageDecode(NULLUsefulBuf, false);
+   if(nResult != -(int32_t)QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP) {
+      return 1;
+   }
+
+   /* 21 arrays, an integer, the map and the integer in it */
+   nResult = NestingStorageDecode(Storage, false);
+   if(nResult != 24) {
+      return 2;
+   }
+   nResult = NestingStorageDecode(Storage, true);
+   if(nResult != 24) {
+      return 3;
+   }
+
+   /* Too deep for two levels */
+   nResult = NestingStorageDecode((UsefulBuf){puSmall, sizeof(puSmall)}, false);
+   if(nResult != -(int32_t)QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP) {
+      return 4;
+   }
+
+   /* Consume the whole thing with and without fast skip */
+   for(nLevel = 0; nLevel < 2; nLevel++) {
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+      QCBORDecode_SetNestingStorage(&DCtx, Storage);
+      if(nLevel) {
+         QCBORDecode_EnableFastSkip(&DCtx);
+      }
+      QCBORDecode_VGetNextConsume(&DCtx, &Item);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS ||
+         Item.uDataType != QCBOR_TYPE_ARRAY) {
+         return 10 + nLevel;
+      }
+   }
+
+   /* Enter all the way in, search the map and exit all the way out */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   QCBORDecode_SetNestingStorage(&DCtx, Storage);
+   for(nLevel = 0; nLevel < 21; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtx, 1, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 2) {
+      return 20;
+   }
+   QCBORDecode_ExitMap(&DCtx);
+   for(nLevel = 0; nLevel < 21; nLevel++) {
+      QCBORDecode_ExitArray(&DCtx);
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 21;
+   }
+
+   /* A cursor can't hold that many levels */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   QCBORDecode_SetNestingStorage(&DCtx, Storage);
+   for(nLevel = 0; nLevel < 10; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   QCBORDecode_SaveCursor(&DCtx, &Cursor);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS) {
+      return 30;
+   }
+   for(; nLevel < 20; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   QCBORDecode_SaveCursor(&DCtx, &Cursor);
+   if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP) {
+      return 31;
+   }
+   QCBORDecode_RestoreCursor(&DCtx, &Cursor);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP) {
+      return 32;
+   }
+
+   /* Can't go back to built-in storage when entered too deep */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   QCBORDecode_SetNestingStorage(&DCtx, Storage);
+   for(nLevel = 0; nLevel < 16; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   if(QCBORDecode_SetNestingStorage(&DCtx, NULLUsefulBuf) != QCBOR_ERR_NESTING_STORAGE) {
+      return 40;
+   }
+   for(nLevel = 0; nLevel < 16; nLevel++) {
+      QCBORDecode_ExitArray(&DCtx);
+   }
+   if(QCBORDecode_SetNestingStorage(&DCtx, NULLUsefulBuf) != QCBOR_SUCCESS) {
+      return 41;
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 42;
+   }
+
+   /* Storage set part way in keeps the levels already entered */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   for(nLevel = 0; nLevel < 5; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   if(QCBORDecode_SetNestingStorage(&DCtx, (UsefulBuf){puSmall, sizeof(puSmall)}) != QCBOR_ERR_NESTING_STORAGE) {
+      return 50;
+   }
+   if(QCBORDecode_SetNestingStorage(&DCtx, Storage) != QCBOR_SUCCESS) {
+      return 51;
+   }
+   for(; nLevel < 21; nLevel++) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+   }
+   QCBORDecode_GetInt64(&DCtx, &nInt);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_ExitMap(&DCtx);
+   for(nLevel = 0; nLevel < 21; nLevel++) {
+      QCBORDecode_ExitArray(&DCtx);
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 52;
+   }
+
+   /* Misaligned */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNested22), 0);
+   if(QCBORDecode_SetNestingStorage(&DCtx, (UsefulBuf){(uint8_t *)puStorage + 1, sizeof(puStorage) - 1}) != QCBOR_ERR_NESTING_STORAGE) {
+      return 60;
+   }
+
+   return 0;
+}
+
+
+/* An array of a million items */
+static const uint8_t spMillionArrayHead[] = {0x9a, 0x00, 0x0f, 0x42, 0x40};
+
+#ifdef QCBOR_WIDE_COUNTS
+#define WIDE_ARRAY_COUNT 1000000
+#define WIDE_MAP_COUNT   70000
+static uint8_t spWideCountBuf[1500000];
+#endif /* QCBOR_WIDE_COUNTS */
+
+int32_t WideCountTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spMillionArrayHead), 0);
+#ifndef QCBOR_WIDE_COUNTS
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_ARRAY_DECODE_TOO_LONG) {
+      return 1;
+   }
+#else /* ! QCBOR_WIDE_COUNTS */
+   QCBOREncodeContext ECtx;
+   UsefulBufC         Encoded;
+   uint32_t           uIndex;
+   int64_t            nInt;
+
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS ||
+      Item.val.uCount != 1000000) {
+      return 1;
+   }
+
+   /* [ [0, 1, ... 23, 0, 1, ...], {0: 0, 1: 1, 2: 2, ...} ] */
+   QCBOREncode_Init(&ECtx, UsefulBuf_FROM_BYTE_ARRAY(spWideCountBuf));
+   QCBOREncode_OpenArray(&ECtx);
+   QCBOREncode_OpenArray(&ECtx);
+   for(uIndex = 0; uIndex < WIDE_ARRAY_COUNT; uIndex++) {
+      QCBOREncode_AddUInt64(&ECtx, uIndex % 24);
+   }
+   QCBOREncode_CloseArray(&ECtx);
+   QCBOREncode_OpenMap(&ECtx);
+   for(uIndex = 0; uIndex < WIDE_MAP_COUNT; uIndex++) {
+      QCBOREncode_AddInt64ToMapN(&ECtx, uIndex, uIndex);
+   }
+   QCBOREncode_CloseMap(&ECtx);
+   QCBOREncode_CloseArray(&ECtx);
+   if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+      return 10;
+   }
+   /* Check the heads have the 32-bit counts */
+   if(UsefulBuf_Compare(UsefulBuf_Head(Encoded, 6),
+                        UsefulBuf_FROM_SZ_LITERAL("\x82\x9a\x00\x0f\x42\x40"))) {
+      return 11;
+   }
+
+   /* Decode every item */
+   QCBORDecode_Init(&DCtx, Encoded, 0);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(Item.uDataType != QCBOR_TYPE_ARRAY || Item.val.uCount != WIDE_ARRAY_COUNT) {
+      return 20;
+   }
+   for(uIndex = 0; uIndex < WIDE_ARRAY_COUNT; uIndex++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS ||
+         Item.val.int64 != uIndex % 24 ||
+         Item.uNextNestLevel != (uIndex == WIDE_ARRAY_COUNT - 1 ? 1 : 2)) {
+         return 21;
+      }
+   }
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(Item.uDataType != QCBOR_TYPE_MAP || Item.val.uCount != WIDE_MAP_COUNT) {
+      return 22;
+   }
+   for(uIndex = 0; uIndex < WIDE_MAP_COUNT; uIndex++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS ||
+         Item.label.int64 != uIndex || Item.val.int64 != uIndex) {
+         return 23;
+      }
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 24;
+   }
+
+   /* Skip the array and search the map with spiffy decode */
+   QCBORDecode_Init(&DCtx, Encoded, 0);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_VGetNextConsume(&DCtx, &Item);
+   QCBORDecode_EnterMap(&DCtx, &Item);
+   QCBORDecode_GetInt64InMapN(&DCtx, WIDE_MAP_COUNT - 1, &nInt);
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_ExitArray(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS ||
+      Item.val.uCount != WIDE_MAP_COUNT ||
+      nInt != WIDE_MAP_COUNT - 1) {
+      return 30;
+   }
+
+   /* The same with the fast skip scanner */
+   QCBORDecode_Init(&DCtx, Encoded, 0);
+   QCBORDecode_EnableFastSkip(&DCtx);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_VGetNextConsume(&DCtx, &Item);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtx, 12345, &nInt);
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_ExitArray(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || nInt != 12345) {
+      return 31;
+   }
+#endif /* ! QCBOR_WIDE_COUNTS */
+
+   return 0;
+}
+
+
+/* One event from QCBORDecode_Walk() */
+struct WalkEvent {
+   char     cKind;
+   uint8_t  uType;
+   uint64_t uValue;
+};
+
+struct WalkRecorder {
+   struct WalkEvent Events[100];
+   size_t           uCount;
+   size_t           uFailAt;
+};
+
+static QCBORError
+WalkRecord(struct WalkRecorder *pMe, char cKind, uint8_t uType, uint64_t uValue)
+{
+   if(pMe->uCount == pMe->uFailAt) {
+      return QCBOR_ERR_CALLBACK_FAIL;
+   }
+   if(pMe->uCount < C_ARRAY_COUNT(pMe->Events, struct WalkEvent)) {
+      pMe->Events[pMe->uCount].cKind  = cKind;
+      pMe->Events[pMe->uCount].uType  = uType;
+      pMe->Events[pMe->uCount].uValue = uValue;
+   }
+   pMe->uCount++;
+   return QCBOR_SUCCESS;
+}
+
+static QCBORError WalkInt(void *pCBCtx, int64_t nValue)
+{
+   return WalkRecord(pCBCtx, 'I', 0, (uint64_t)nValue);
+}
+
+static QCBORError WalkUInt(void *pCBCtx, uint64_t uValue)
+{
+   return WalkRecord(pCBCtx, 'U', 0, uValue);
+}
+
+static QCBORError WalkString(void *pCBCtx, uint8_t uDataType, UsefulBufC String)
+{
+   return WalkRecord(pCBCtx, 'S', uDataType, String.len);
+}
+
+static QCBORError WalkStart(void *pCBCtx, uint8_t uDataType, uint64_t uCount)
+{
+   return WalkRecord(pCBCtx, '[', uDataType, uCount);
+}
+
+static QCBORError WalkEnd(void *pCBCtx, uint8_t uDataType)
+{
+   return WalkRecord(pCBCtx, ']', uDataType, 0);
+}
+
+static QCBORError WalkTag(void *pCBCtx, uint64_t uTagNumber)
+{
+   return WalkRecord(pCBCtx, 'T', 0, uTagNumber);
+}
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+static QCBORError WalkFloat(void *pCBCtx, double dValue)
+{
+   /* Records the value times ten to keep it an integer */
+   return WalkRecord(pCBCtx, 'F', 0, (uint64_t)(dValue * 10));
+}
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+static QCBORError WalkSimple(void *pCBCtx, uint8_t uSimpleValue)
+{
+   return WalkRecord(pCBCtx, 'V', 0, uSimpleValue);
+}
+
+static const QCBORWalkCallbacks spWalkRecordCallbacks = {
+   WalkInt,
+   WalkUInt,
+   WalkString,
+   WalkStart,
+   WalkEnd,
+   WalkTag,
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+   WalkFloat,
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+   WalkSimple
+};
+
+
+#if !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS) && \
+    !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS) && \
+    !defined(QCBOR_DISABLE_TAGS) && \
+    !defined(QCBOR_DISABLE_PREFERRED_FLOAT) && \
+    !defined(USEFULBUF_DISABLE_ALL_FLOAT)
+/* [_ 1, -2, 18446744073709551615, h'0102', (_ "a", "b"), {1: 2}, [],
+ *    1(3), 1.5, true, null, simple(99)] */
+static const uint8_t spWalkInput[] = {
+   0x9f, 0x01, 0x21, 0x1b, 0xff, 0xff, 0xff, 0xff,
+   0xff, 0xff, 0xff, 0xff, 0x42, 0x01, 0x02, 0x7f,
+   0x61, 0x61, 0x61, 0x62, 0xff, 0xa1, 0x01, 0x02,
+   0x80, 0xc1, 0x03, 0xf9, 0x3e, 0x00, 0xf5, 0xf6,
+   0xf8, 0x63, 0xff
+};
+
+static const struct WalkEvent spWalkExpected[] = {
+   {'[', QCBOR_TYPE_ARRAY,       QCBOR_WALK_INDEFINITE_LENGTH},
+   {'I', 0,                      1},
+   {'I', 0,                      (uint64_t)-2},
+   {'U', 0,                      UINT64_MAX},
+   {'S', QCBOR_TYPE_BYTE_STRING, 2},
+   {'[', QCBOR_TYPE_TEXT_STRING, QCBOR_WALK_INDEFINITE_LENGTH},
+   {'S', QCBOR_TYPE_TEXT_STRING, 1},
+   {'S', QCBOR_TYPE_TEXT_STRING, 1},
+   {']', QCBOR_TYPE_TEXT_STRING, 0},
+   {'[', QCBOR_TYPE_MAP,         1},
+   {'I', 0,                      1},
+   {'I', 0,                      2},
+   {']', QCBOR_TYPE_MAP,         0},
+   {'[', QCBOR_TYPE_ARRAY,       0},
+   {']', QCBOR_TYPE_ARRAY,       0},
+   {'T', 0,                      1},
+   {'I', 0,                      3},
+   {'F', 0,                      15},
+   {'V', 0,                      QCBOR_TYPE_TRUE},
+   {'V', 0,                      QCBOR_TYPE_NULL},
+   {'V', 0,                      99},
+   {']', QCBOR_TYPE_ARRAY,       0}
+};
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS && ... */
+
+
+/* Count the items and labels GetNext() gives and the events that
+ * correspond */
+static int32_t
+WalkCompareCount(UsefulBufC Input)
+{
+   QCBORDecodeContext  DCtx;
+   QCBORItem           Item;
+   struct WalkRecorder Recorder;
+   size_t              uItems;
+   size_t              uEvents;
+   size_t              uIndex;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   uItems = 0;
+   while(QCBORDecode_GetNext(&DCtx, &Item) == QCBOR_SUCCESS) {
+      /* Labels are events of their own */
+      uItems += Item.uLabelType == QCBOR_TYPE_NONE ? 1 : 2;
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 1;
+   }
+
+   memset(&Recorder, 0, sizeof(Recorder));
+   Recorder.uFailAt = SIZE_MAX;
+   if(QCBORDecode_Walk(Input, &spWalkRecordCallbacks, &Recorder, NULL) != QCBOR_SUCCESS) {
+      return 2;
+   }
+   uEvents = 0;
+   if(Recorder.uCount > C_ARRAY_COUNT(Recorder.Events, struct WalkEvent)) {
+      return 3;
+   }
+   for(uIndex = 0; uIndex < Recorder.uCount; uIndex++) {
+      if(Recorder.Events[uIndex].cKind != ']' && Recorder.Events[uIndex].cKind != 'T') {
+         uEvents++;
+      }
+   }
+   if(uEvents != uItems) {
+      return 4;
+   }
+   return 0;
+}
+
+
+int32_t WalkTest(void)
+{
+   struct WalkRecorder       Recorder;
+   const QCBORWalkCallbacks  NoCallbacks = {0};
+   QCBORError                uErr;
+   size_t                    uOffset;
+   size_t                    uIndex;
+   int32_t                   nResult;
+
+   /* Everything in the not-well-formed corpus must fail */
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(paNotWellFormedCBOR, struct someBinaryBytes); uIndex++) {
+      const struct someBinaryBytes *pBytes = &paNotWellFormedCBOR[uIndex];
+
+      uErr = QCBORDecode_Walk((UsefulBufC){pBytes->p, pBytes->n}, &NoCallbacks, NULL, &uOffset);
+      if(uErr == QCBOR_SUCCESS) {
+         return (int32_t)(1000 + uIndex);
+      }
+      if(uOffset > pBytes->n) {
+         return (int32_t)(2000 + uIndex);
+      }
+   }
+
+#if !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS) && \
+    !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS) && \
+    !defined(QCBOR_DISABLE_TAGS) && \
+    !defined(QCBOR_DISABLE_PREFERRED_FLOAT) && \
+    !defined(USEFULBUF_DISABLE_ALL_FLOAT)
+   /* Every kind of event */
+   memset(&Recorder, 0, sizeof(Recorder));
+   Recorder.uFailAt = SIZE_MAX;
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spWalkInput),
+                           &spWalkRecordCallbacks,
+                           &Recorder,
+                           &uOffset);
+   if(uErr != QCBOR_SUCCESS || uOffset != sizeof(spWalkInput)) {
+      return 10;
+   }
+   if(Recorder.uCount != C_ARRAY_COUNT(spWalkExpected, struct WalkEvent)) {
+      return 11;
+   }
+   for(uIndex = 0; uIndex < Recorder.uCount; uIndex++) {
+      if(Recorder.Events[uIndex].cKind != spWalkExpected[uIndex].cKind ||
+         Recorder.Events[uIndex].uType != spWalkExpected[uIndex].uType ||
+         Recorder.Events[uIndex].uValue != spWalkExpected[uIndex].uValue) {
+         return (int32_t)(100 + uIndex);
+      }
+   }
+
+   /* A callback error stops the walk at the item it was called for */
+   memset(&Recorder, 0, sizeof(Recorder));
+   Recorder.uFailAt = 3;
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spWalkInput),
+                           &spWalkRecordCallbacks,
+                           &Recorder,
+                           &uOffset);
+   if(uErr != QCBOR_ERR_CALLBACK_FAIL || uOffset != 3 || Recorder.uCount != 3) {
+      return 12;
+   }
+
+   /* Without callbacks it is just a check */
+   if(QCBORDecode_Walk(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spWalkInput), &NoCallbacks, NULL, NULL)) {
+      return 13;
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS && ... */
+
+   /* The same items as GetNext() */
+   nResult = WalkCompareCount(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts));
+   if(nResult) {
+      return 20 + nResult;
+   }
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   nResult = WalkCompareCount(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded));
+   if(nResult) {
+      return 30 + nResult;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   /* A sequence, and an empty one */
+   memset(&Recorder, 0, sizeof(Recorder));
+   Recorder.uFailAt = SIZE_MAX;
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_SZ_LITERAL("\x01\x02\x03"), &spWalkRecordCallbacks, &Recorder, &uOffset);
+   if(uErr != QCBOR_SUCCESS || Recorder.uCount != 3 || uOffset != 3 ||
+      Recorder.Events[2].uValue != 3) {
+      return 40;
+   }
+   uErr = QCBORDecode_Walk(NULLUsefulBufC, &spWalkRecordCallbacks, &Recorder, &uOffset);
+   if(uErr != QCBOR_SUCCESS || Recorder.uCount != 3 || uOffset != 0) {
+      return 41;
+   }
+
+   /* Errors */
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_SZ_LITERAL("\x01\x3b\xff\xff\xff\xff\xff\xff\xff\xff"),
+                           &NoCallbacks, NULL, &uOffset);
+   if(uErr != QCBOR_ERR_INT_OVERFLOW || uOffset != 1) {
+      return 50;
+   }
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_SZ_LITERAL("\x01\xff"), &NoCallbacks, NULL, &uOffset);
+   if(uErr != QCBOR_ERR_BAD_BREAK || uOffset != 1) {
+      return 51;
+   }
+#ifndef QCBOR_DISABLE_TAGS
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_SZ_LITERAL("\x01\xc1"), &NoCallbacks, NULL, &uOffset);
+   if(uErr != QCBOR_ERR_HIT_END || uOffset != 2) {
+      return 52;
+   }
+#endif /* ! QCBOR_DISABLE_TAGS */
+   uErr = QCBORDecode_Walk(UsefulBuf_FROM_SZ_LITERAL("\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x00"),
+                           &NoCallbacks, NULL, &uOffset);
+   if(uErr != QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP || uOffset != 15) {
+      return 53;
+   }
+
+   return 0;
+}
+
+
+/* Items for each case of the fast path in QCBORDecode_GetNext()
+ * mixed with items that aren't for it: tags, indefinite lengths,
+ * labels it doesn't handle, empty maps and arrays and a level ended
+ * by a break right after a fast item. The 0 after the array is so
+ * the bounded traversal doesn't end at the end of the input. */
+static const uint8_t spFastGetNextInput[] = {
+   0x9f,
+      0xa3,
+         0x01, 0x63, 'a', 'b', 'c',
+         0x20, 0xc1, 0x1a, 0x00, 0x00, 0x00, 0x01,
+         0x62, 'h', 'i', 0x42, 0x01, 0x02,
+      0x82, 0xf5, 0xf6,
+      0xfb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0xf9, 0x3c, 0x00,
+      0xfa, 0x3f, 0xc0, 0x00, 0x00,
+      0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xa1, 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+      0xa1, 0x41, 0x00, 0x9f, 0xff,
+      0x80,
+      0xa0,
+      0x81, 0x81, 0x81, 0x38, 0x63,
+      0xe0,
+      0x82, 0x01, 0x9f, 0x02, 0xff,
+   0xff,
+   0x00
+};
+
+
+/* Traverse the input with the fast path and again in streaming mode
+ * which never uses it. All items and errors must be the same. */
+static int32_t
+FastGetNextCompare(UsefulBufC Input, bool bEnter)
+{
+   QCBORDecodeContext DCtx;
+   QCBORDecodeContext DCtxSlow;
+   QCBORItem          Item;
+   QCBORItem          ItemSlow;
+   QCBORError         uErr;
+   QCBORError         uErrSlow;
+   int32_t            nCount;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_Init(&DCtxSlow, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableStreaming(&DCtxSlow);
+   if(bEnter) {
+      QCBORDecode_EnterArray(&DCtx, NULL);
+      QCBORDecode_EnterArray(&DCtxSlow, NULL);
+   }
+
+   for(nCount = 0; nCount < 100; nCount++) {
+      uErr     = QCBORDecode_GetNext(&DCtx, &Item);
+      uErrSlow = QCBORDecode_GetNext(&DCtxSlow, &ItemSlow);
+      if(uErr != uErrSlow) {
+         return 1;
+      }
+      if(!SameItem(&Item, &ItemSlow)) {
+         return 2;
+      }
+#ifndef QCBOR_DISABLE_TAGS
+      if(memcmp(Item.uTags, ItemSlow.uTags, sizeof(Item.uTags))) {
+         return 3;
+      }
+#endif /* ! QCBOR_DISABLE_TAGS */
+      if(QCBORDecode_IsUnrecoverableError(uErr) || uErr == QCBOR_ERR_NO_MORE_ITEMS) {
+         break;
+      }
+   }
+   if(nCount == 100) {
+      return 4;
+   }
+
+   if(bEnter) {
+      QCBORDecode_ExitArray(&DCtx);
+      QCBORDecode_ExitArray(&DCtxSlow);
+      if(QCBORDecode_GetError(&DCtx) != QCBORDecode_GetError(&DCtxSlow) ||
+         QCBORDecode_Tell(&DCtx) != QCBORDecode_Tell(&DCtxSlow)) {
+         return 5;
+      }
+   }
+
+   return 0;
+}
+
+
+int32_t FastGetNextTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   QCBORError         uErr;
+   size_t             uInput;
+   int32_t            nResult;
+   const UsefulBufC   Inputs[] = {
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFastGetNextInput),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spExpectedEncodedInts),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(pValidMapEncoded),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNestedForIndex),
+      UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spSequenceTestInput)
+   };
+
+   for(uInput = 0; uInput < C_ARRAY_COUNT(Inputs, UsefulBufC); uInput++) {
+      nResult = FastGetNextCompare(Inputs[uInput], false);
+      if(nResult) {
+         return (int32_t)(uInput * 10) + nResult;
+      }
+   }
+
+   /* Within a bounded array */
+   nResult = FastGetNextCompare(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spFastGetNextInput), true);
+   if(nResult) {
+      return 100 + nResult;
+   }
+
+   /* Errors are the same as from the full decode */
+   QCBORDecode_Init(&DCtx,
+                    UsefulBuf_FROM_SZ_LITERAL("\x82\x01\x3b\xff\xff\xff\xff\xff\xff\xff\xff"),
+                    QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   uErr = QCBORDecode_GetNext(&DCtx, &Item);
+   if(uErr != QCBOR_ERR_INT_OVERFLOW || Item.uDataType != QCBOR_TYPE_NONE) {
+      return 200;
+   }
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x01\xff"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   uErr = QCBORDecode_GetNext(&DCtx, &Item);
+   if(uErr != QCBOR_ERR_BAD_BREAK) {
+      return 201;
+   }
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x82\x01\x62\x41"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   uErr = QCBORDecode_GetNext(&DCtx, &Item);
+   if(uErr != QCBOR_ERR_HIT_END) {
+      return 202;
+   }
+   QCBORDecode_Init(&DCtx,
+                    UsefulBuf_FROM_SZ_LITERAL("\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x00"),
+                    QCBOR_DECODE_MODE_NORMAL);
+   do {
+      uErr = QCBORDecode_GetNext(&DCtx, &Item);
+   } while(uErr == QCBOR_SUCCESS);
+   if(uErr != QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP) {
+      return 203;
+   }
+
+   /* The end of bstr-wrapped CBOR is by byte count */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x43\x82\x01\x02\x05"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnterBstrWrapped(&DCtx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(Item.uDataType != QCBOR_TYPE_ARRAY || Item.uNestingLevel != 1 || Item.uNextNestLevel != 2) {
+      return 300;
+   }
+   QCBORDecode_GetNext(&DCtx, &Item);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(Item.uDataType != QCBOR_TYPE_INT64 || Item.val.int64 != 2 || Item.uNextNestLevel != 1) {
+      return 301;
+   }
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_NO_MORE_ITEMS) {
+      return 302;
+   }
+   QCBORDecode_ExitBstrWrapped(&DCtx);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_INT64 || Item.val.int64 != 5) {
+      return 303;
+   }
+
+   return 0;
+}
+
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+/* Different labels with the same fingerprint key: -1 and
+ * 18446744073709551615, text "a" and byte string "a" */
+static const uint8_t spNoDuplicates[] = {
+   0xa6,
+      0x01, 0x01,
+      0x20, 0x02,
+      0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x03,
+      0x61, 'a', 0x04,
+      0x41, 'a', 0x05,
+      0x02, 0xa2, 0x01, 0x01, 0x01, 0x02
+};
+
+static const uint8_t spDuplicateText[] = {
+   0xa3, 0x61, 'a', 0x01, 0x61, 'b', 0x02, 0x61, 'a', 0x03
+};
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+
+static QCBORError
+DuplicateLabelEnter(UsefulBufC Input, QCBORLabelFingerprint *pLabels, size_t uCount)
+{
+   QCBORDecodeContext DCtx;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetDuplicateLabelCheck(&DCtx, pLabels, uCount);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   return QCBORDecode_GetError(&DCtx);
+}
+
+
+int32_t DuplicateLabelTest(void)
+{
+   QCBORDecodeContext    DCtx;
+   QCBORLabelFingerprint Labels[400];
+   QCBOREncodeContext    ECtx;
+   UsefulBufC            Encoded;
+   int64_t               nInt;
+   int                   i;
+   static uint8_t        spBig[4000];
+
+   /* Only the labels searched for are checked without it */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa3\x01\x01\x02\x02\x01\x03"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtx, 2, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 2) {
+      return 1;
+   }
+
+   if(DuplicateLabelEnter(UsefulBuf_FROM_SZ_LITERAL("\xa3\x01\x01\x02\x02\x01\x03"), Labels, 400) != QCBOR_ERR_DUPLICATE_LABEL) {
+      return 2;
+   }
+   if(DuplicateLabelEnter(UsefulBuf_FROM_SZ_LITERAL("\xa0"), Labels, 0) != QCBOR_SUCCESS) {
+      return 3;
+   }
+   if(DuplicateLabelEnter(UsefulBuf_FROM_SZ_LITERAL("\xa3\x01\x01\x02\x02\x03\x03"), Labels, 2) != QCBOR_ERR_DUPLICATE_CHECK_TOO_SMALL) {
+      return 4;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   if(DuplicateLabelEnter(UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spDuplicateText), Labels, 400) != QCBOR_ERR_DUPLICATE_LABEL) {
+      return 10;
+   }
+
+   /* A map is checked when it is entered, not before */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spNoDuplicates), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetDuplicateLabelCheck(&DCtx, Labels, 6);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapSZ(&DCtx, "a", &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 4) {
+      return 11;
+   }
+   QCBORDecode_EnterMapFromMapN(&DCtx, 2);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_DUPLICATE_LABEL) {
+      return 12;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   /* A bigger map, with and without one duplicate in each place */
+   for(int nDup = -1; nDup < 300; nDup += 37) {
+      QCBOREncode_Init(&ECtx, UsefulBuf_FROM_BYTE_ARRAY(spBig));
+      QCBOREncode_OpenMap(&ECtx);
+      for(i = 0; i < 300; i++) {
+         QCBOREncode_AddInt64ToMapN(&ECtx, (i * 7919) % 300 - 150, i);
+      }
+      if(nDup >= 0) {
+         QCBOREncode_AddInt64ToMapN(&ECtx, (nDup * 7919) % 300 - 150, 0);
+      }
+      QCBOREncode_CloseMap(&ECtx);
+      if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+         return 20;
+      }
+      if(DuplicateLabelEnter(Encoded, Labels, 400) != (nDup < 0 ? QCBOR_SUCCESS : QCBOR_ERR_DUPLICATE_LABEL)) {
+         return 21 + nDup;
+      }
+   }
+
+   return 0;
+}
+
+
+static const struct ValidateTestInput DeterministicTestInputs[] = {
+   /* 23, 24 and 256 in the shortest heads */
+   {{"\x83\x17\x18\x18\x19\x01\x00", 7}, QCBOR_SUCCESS, 7},
+   /* 23 with a one-byte argument */
+   {{"\x18\x17", 2}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 255 with a two-byte argument */
+   {{"\x19\x00\xff", 3}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 65535 with a four-byte argument */
+   {{"\x1a\x00\x00\xff\xff", 5}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 2^32 - 1 with an eight-byte argument */
+   {{"\x1b\x00\x00\x00\x00\xff\xff\xff\xff", 9}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* -6 in an array with a one-byte argument */
+   {{"\x82\x01\x38\x05", 4}, QCBOR_ERR_NOT_PREFERRED, 2},
+   /* Byte string with a long length */
+   {{"\x58\x01\x00", 3}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* Array with a long count */
+   {{"\x98\x01\x00", 3}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* Tag number 1 with a long head */
+   {{"\xd8\x01\x00", 3}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 1(1) */
+   {{"\xc1\x01", 2}, QCBOR_SUCCESS, 2},
+   /* Simple value 32 */
+   {{"\xf8\x20", 2}, QCBOR_SUCCESS, 2},
+   /* (_ h'00') */
+   {{"\x5f\x41\x00\xff", 4}, QCBOR_ERR_INDEFINITE_NOT_ALLOWED, 0},
+   /* [1, [_ ]] */
+   {{"\x82\x01\x9f\xff", 4}, QCBOR_ERR_INDEFINITE_NOT_ALLOWED, 2},
+   /* {_ } */
+   {{"\xbf\xff", 2}, QCBOR_ERR_INDEFINITE_NOT_ALLOWED, 0},
+   /* {1: 0, 2: 0} */
+   {{"\xa2\x01\x00\x02\x00", 5}, QCBOR_SUCCESS, 5},
+   /* {2: 0, 1: 0} */
+   {{"\xa2\x02\x00\x01\x00", 5}, QCBOR_ERR_UNSORTED, 3},
+   /* {1: 0, 1: 0} */
+   {{"\xa2\x01\x00\x01\x00", 5}, QCBOR_ERR_DUPLICATE_LABEL, 3},
+   /* {24: 0, -1: 0} is bytewise order, not length-first */
+   {{"\xa2\x18\x18\x00\x20\x00", 6}, QCBOR_SUCCESS, 6},
+   /* {"a": 0, 100: 0} */
+   {{"\xa2\x61\x61\x00\x18\x64\x00", 7}, QCBOR_ERR_UNSORTED, 4},
+   /* {1: [2, 3], {1: 0}: 0} with a label that is a map */
+   {{"\xa2\x01\x82\x02\x03\xa1\x01\x00\x00", 9}, QCBOR_SUCCESS, 9},
+   /* {{1: 0}: 0, 1: 0} */
+   {{"\xa2\xa1\x01\x00\x00\x01\x00", 7}, QCBOR_ERR_UNSORTED, 5},
+   /* {1(1): 0, 1: 0} with the tag number as part of the label */
+   {{"\xa2\xc1\x01\x00\x01\x00", 6}, QCBOR_ERR_UNSORTED, 4},
+   /* {1: {}, 2: {2: 0, 1: 0}} unsorted in a nested map */
+   {{"\xa2\x01\xa0\x02\xa2\x02\x00\x01\x00", 9}, QCBOR_ERR_UNSORTED, 7},
+   /* Each map is checked on its own: [{2: 0}, {1: 0}] */
+   {{"\x82\xa1\x02\x00\xa1\x01\x00", 7}, QCBOR_SUCCESS, 7},
+   /* Not-well-formed errors are the same as validation */
+   {{"\x82\x01\xff", 3}, QCBOR_ERR_BAD_BREAK, 2},
+   {{"\x83\x01\x02", 3}, QCBOR_ERR_HIT_END, 3},
+   {{"\x01\x02", 2}, QCBOR_ERR_EXTRA_BYTES, 1},
+   {{"\x81\xf8\x1f", 3}, QCBOR_ERR_BAD_TYPE_7, 1},
+   {{"\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x81\x00", 17},
+     QCBOR_ERR_ARRAY_DECODE_NESTING_TOO_DEEP, 15},
+};
+
+
+#if !defined(QCBOR_DISABLE_PREFERRED_FLOAT) && !defined(USEFULBUF_DISABLE_ALL_FLOAT)
+static const struct ValidateTestInput DeterministicFloatInputs[] = {
+   /* 1.0 as half */
+   {{"\xf9\x3c\x00", 3}, QCBOR_SUCCESS, 3},
+   /* 1.0 as single */
+   {{"\xfa\x3f\x80\x00\x00", 5}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 1.0 as double */
+   {{"\xfb\x3f\xf0\x00\x00\x00\x00\x00\x00", 9}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 1 + 2^-23 as single */
+   {{"\xfa\x3f\x80\x00\x01", 5}, QCBOR_SUCCESS, 5},
+   /* 1 + 2^-23 as double */
+   {{"\xfb\x3f\xf0\x00\x00\x20\x00\x00\x00", 9}, QCBOR_ERR_NOT_PREFERRED, 0},
+   /* 0.1 as double */
+   {{"\xfb\x3f\xb9\x99\x99\x99\x99\x99\x9a", 9}, QCBOR_SUCCESS, 9},
+   /* NaN as double */
+   {{"\x81\xfb\x7f\xf8\x00\x00\x00\x00\x00\x00", 10}, QCBOR_ERR_NOT_PREFERRED, 1},
+};
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT && ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+
+int32_t DeterministicTest(void)
+{
+   QCBORError uErr;
+   size_t     uOffset;
+   size_t     uIndex;
+
+   /* Not-well-formed input is never deterministic */
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(paNotWellFormedCBOR, struct someBinaryBytes); uIndex++) {
+      const struct someBinaryBytes *pBytes = &paNotWellFormedCBOR[uIndex];
+
+      uErr = QCBORDecode_CheckDeterministic((UsefulBufC){pBytes->p, pBytes->n}, &uOffset);
+      if(uErr == QCBOR_SUCCESS) {
+         return (int32_t)(1000 + uIndex);
+      }
+      if(uOffset > pBytes->n) {
+         return (int32_t)(2000 + uIndex);
+      }
+   }
+
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(DeterministicTestInputs, struct ValidateTestInput); uIndex++) {
+      const struct ValidateTestInput *pTest = &DeterministicTestInputs[uIndex];
+
+      uErr = QCBORDecode_CheckDeterministic(pTest->Input, &uOffset);
+      if(uErr != pTest->uExpectedErr) {
+         return (int32_t)(3000 + uIndex * 100 + uErr);
+      }
+      if(uOffset != pTest->uExpectedOffset) {
+         return (int32_t)(4000 + uIndex);
+      }
+   }
+
+#if !defined(QCBOR_DISABLE_PREFERRED_FLOAT) && !defined(USEFULBUF_DISABLE_ALL_FLOAT)
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(DeterministicFloatInputs, struct ValidateTestInput); uIndex++) {
+      const struct ValidateTestInput *pTest = &DeterministicFloatInputs[uIndex];
+
+      uErr = QCBORDecode_CheckDeterministic(pTest->Input, &uOffset);
+      if(uErr != pTest->uExpectedErr) {
+         return (int32_t)(5000 + uIndex * 100 + uErr);
+      }
+      if(uOffset != pTest->uExpectedOffset) {
+         return (int32_t)(6000 + uIndex);
+      }
+   }
+
+   /* The encoder's preferred serialization of floats passes */
+   {
+      QCBOREncodeContext ECtx;
+      UsefulBufC         Encoded;
+      static const double pdValues[] = {0.0, -0.0, 1.5, 65504.0, 3.4028234663852886E+38,
+                                        0.1, 1.0E-300, INFINITY, NAN};
+      UsefulBuf_MAKE_STACK_UB(Buffer, 100);
+
+      QCBOREncode_Init(&ECtx, Buffer);
+      QCBOREncode_OpenArray(&ECtx);
+      for(uIndex = 0; uIndex < C_ARRAY_COUNT(pdValues, double); uIndex++) {
+         QCBOREncode_AddDouble(&ECtx, pdValues[uIndex]);
+      }
+      QCBOREncode_CloseArray(&ECtx);
+      if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+         return 7000;
+      }
+      uErr = QCBORDecode_CheckDeterministic(Encoded, NULL);
+      if(uErr != QCBOR_SUCCESS) {
+         return (int32_t)(7100 + uErr);
+      }
+   }
+#else /* ! QCBOR_DISABLE_PREFERRED_FLOAT && ! USEFULBUF_DISABLE_ALL_FLOAT */
+   uErr = QCBORDecode_CheckDeterministic(UsefulBuf_FROM_SZ_LITERAL("\xf9\x3c\x00"), &uOffset);
+   if(uErr != FLOAT_ERR_CODE_NO_HALF_PREC(QCBOR_SUCCESS)) {
+      return 8000;
+   }
+#endif /* ! QCBOR_DISABLE_PREFERRED_FLOAT && ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+   return 0;
+}
+
+
+/* ["ok", h'FF', "\xc0\xaf", "é"] */
+static const uint8_t spUTF8Input[] = {
+   0x84, 0x62, 0x6f, 0x6b, 0x41, 0xff, 0x62, 0xc0, 0xaf, 0x62, 0xc3, 0xa9
+};
+
+
+#if !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS) || !defined(QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS)
+struct UTF8RecoveryInput {
+   UsefulBufC Input;
+   int        nItems;
+   QCBORError uErr[5];
+   uint8_t    uDataType[5];
+   uint8_t    uNestingLevel[5];
+};
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+static const struct UTF8RecoveryInput UTF8IndefiniteArrayInputs[] = {
+   /* [_ 1, "\xff", 2], 3 */
+   {{"\x9f\x01\x61\xff\x02\xff\x03", 7}, 5,
+    {QCBOR_SUCCESS, QCBOR_SUCCESS, QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS, QCBOR_SUCCESS},
+    {QCBOR_TYPE_ARRAY, QCBOR_TYPE_INT64, 0, QCBOR_TYPE_INT64, QCBOR_TYPE_INT64},
+    {0, 1, 0, 1, 0}},
+   /* [_ "\xff"], 2 */
+   {{"\x9f\x61\xff\xff\x02", 5}, 3,
+    {QCBOR_SUCCESS, QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS},
+    {QCBOR_TYPE_ARRAY, 0, QCBOR_TYPE_INT64},
+    {0, 0, 0}},
+   /* {_ 1: "\xff", 2: 3}, 4 */
+   {{"\xbf\x01\x61\xff\x02\x03\xff\x04", 8}, 4,
+    {QCBOR_SUCCESS, QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS, QCBOR_SUCCESS},
+    {QCBOR_TYPE_MAP, 0, QCBOR_TYPE_INT64, QCBOR_TYPE_INT64},
+    {0, 0, 1, 0}},
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   /* [_ (_ "\xff"), 1] */
+   {{"\x9f\x7f\x61\xff\xff\x01\xff", 7}, 3,
+    {QCBOR_SUCCESS, QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS},
+    {QCBOR_TYPE_ARRAY, 0, QCBOR_TYPE_INT64},
+    {0, 0, 1}},
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+};
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+static const struct UTF8RecoveryInput UTF8IndefiniteStringInputs[] = {
+   /* (_ "\xff", "a"), 1 with the bad chunk first */
+   {{"\x7f\x61\xff\x61\x61\xff\x01", 7}, 2,
+    {QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS},
+    {0, QCBOR_TYPE_INT64},
+    {0, 0}},
+   /* (_ "ab", "\xc3"), 1 with a sequence cut off by a chunk boundary */
+   {{"\x7f\x62\x61\x62\x61\xc3\xff\x01", 8}, 2,
+    {QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS},
+    {0, QCBOR_TYPE_INT64},
+    {0, 0}},
+   /* {1: (_ "\xff", "a"), 2: 3} */
+   {{"\xa2\x01\x7f\x61\xff\x61\x61\xff\x02\x03", 10}, 3,
+    {QCBOR_SUCCESS, QCBOR_ERR_INVALID_UTF8, QCBOR_SUCCESS},
+    {QCBOR_TYPE_MAP, 0, QCBOR_TYPE_INT64},
+    {0, 0, 1}},
+};
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+
+/* Check decoding carries on correctly after a bad string in an
+ * indefinite-length array, map or string. */
+static int32_t
+UTF8RecoveryCheck(const struct UTF8RecoveryInput *pTest)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   int                nIndex;
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   UsefulBuf_MAKE_STACK_UB(Pool, 100);
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+   QCBORDecode_Init(&DCtx, pTest->Input, QCBOR_DECODE_MODE_NORMAL);
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   /* For the chunks of indefinite-length strings */
+   QCBORDecode_SetMemPool(&DCtx, Pool, 0);
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+   QCBORDecode_EnableUTF8Check(&DCtx);
+   for(nIndex = 0; nIndex < pTest->nItems; nIndex++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != pTest->uErr[nIndex]) {
+         return 1 + nIndex;
+      }
+      if(pTest->uErr[nIndex] != QCBOR_SUCCESS) {
+         continue;
+      }
+      if(Item.uDataType != pTest->uDataType[nIndex] ||
+         Item.uNestingLevel != pTest->uNestingLevel[nIndex]) {
+         return 10 + nIndex;
+      }
+   }
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 20;
+   }
+
+   return 0;
+}
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS || ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+
+int32_t UTF8DecodeTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Item;
+   QCBORItemLite      Lite;
+   int                nIndex;
+
+   /* Not checked by default */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spUTF8Input), QCBOR_DECODE_MODE_NORMAL);
+   for(nIndex = 0; nIndex < 5; nIndex++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_SUCCESS) {
+         return 1;
+      }
+   }
+
+   /* Decoding continues after the bad string */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spUTF8Input), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableUTF8Check(&DCtx);
+   for(nIndex = 0; nIndex < 5; nIndex++) {
+      if(QCBORDecode_GetNext(&DCtx, &Item) != (nIndex == 3 ? QCBOR_ERR_INVALID_UTF8 : QCBOR_SUCCESS)) {
+         return 10 + nIndex;
+      }
+   }
+   if(Item.uDataType != QCBOR_TYPE_TEXT_STRING ||
+      UsefulBuf_Compare(Item.val.string, UsefulBuf_FROM_SZ_LITERAL("\xc3\xa9"))) {
+      return 20;
+   }
+
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spUTF8Input), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableUTF8Check(&DCtx);
+   for(nIndex = 0; nIndex < 4; nIndex++) {
+      if(QCBORDecode_GetNextLite(&DCtx, &Lite) != (nIndex == 3 ? QCBOR_ERR_INVALID_UTF8 : QCBOR_SUCCESS)) {
+         return 30 + nIndex;
+      }
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   /* {"\xed\xa0\x80": 2} with a surrogate label */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x63\xed\xa0\x80\x02"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnableUTF8Check(&DCtx);
+   QCBORDecode_GetNext(&DCtx, &Item);
+   if(QCBORDecode_GetNext(&DCtx, &Item) != QCBOR_ERR_INVALID_UTF8) {
+      return 40;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   for(nIndex = 0; nIndex < (int)C_ARRAY_COUNT(UTF8IndefiniteArrayInputs, struct UTF8RecoveryInput); nIndex++) {
+      const int32_t nResult = UTF8RecoveryCheck(&UTF8IndefiniteArrayInputs[nIndex]);
+      if(nResult) {
+         return 1000 + nIndex * 100 + nResult;
+      }
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS
+   for(nIndex = 0; nIndex < (int)C_ARRAY_COUNT(UTF8IndefiniteStringInputs, struct UTF8RecoveryInput); nIndex++) {
+      const int32_t nResult = UTF8RecoveryCheck(&UTF8IndefiniteStringInputs[nIndex]);
+      if(nResult) {
+         return 2000 + nIndex * 100 + nResult;
+      }
+   }
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_STRINGS */
+
+   return 0;
+}
+
+
+typedef struct {
+   int64_t nX;
+   int64_t nY;
+} StructTestPos;
+
+typedef struct {
+   int64_t       nId;
+   uint64_t      uCount;
+   UsefulBufC    Name;
+   UsefulBufC    Blob;
+   bool          bFlag;
+   double        dScore;
+   StructTestPos Pos;
+   QCBORItem     Extra;
+   int64_t       nMissing;
+} StructTest;
+
+static const QCBORStructField StructTestPosFields[] = {
+   {NULL, 1, QCBOR_TYPE_INT64, QCBOR_FIELD_REQUIRED, offsetof(StructTestPos, nX), NULL},
+   {NULL, 2, QCBOR_TYPE_INT64, QCBOR_FIELD_REQUIRED, offsetof(StructTestPos, nY), NULL},
+};
+static const QCBORStructDescriptor StructTestPosDescriptor = {StructTestPosFields, 2};
+
+static const QCBORStructField StructTestFields[] = {
+   {NULL, 1, QCBOR_TYPE_INT64,       QCBOR_FIELD_REQUIRED, offsetof(StructTest, nId),      NULL},
+   {NULL, 2, QCBOR_TYPE_UINT64,      0,                    offsetof(StructTest, uCount),   NULL},
+   {NULL, 3, QCBOR_TYPE_TEXT_STRING, QCBOR_FIELD_REQUIRED, offsetof(StructTest, Name),     NULL},
+   {NULL, 4, QCBOR_TYPE_BYTE_STRING, 0,                    offsetof(StructTest, Blob),     NULL},
+   {NULL, 5, QCBOR_TYPE_TRUE,        0,                    offsetof(StructTest, bFlag),    NULL},
+   {NULL, 6, QCBOR_TYPE_DOUBLE,      0,                    offsetof(StructTest, dScore),   NULL},
+   {NULL, 7, QCBOR_TYPE_MAP,         0,                    offsetof(StructTest, Pos),      &StructTestPosDescriptor},
+   {NULL, 8, QCBOR_TYPE_ANY,         0,                    offsetof(StructTest, Extra),    NULL},
+   {NULL, 9, QCBOR_TYPE_INT64,       0,                    offsetof(StructTest, nMissing), NULL},
+};
+static const QCBORStructDescriptor StructTestDescriptor = {StructTestFields, 9};
+
+
+/* Encode the map for StructTest with one field changed by nVariant */
+static UsefulBufC
+StructTestEncode(UsefulBuf Buffer, int nVariant)
+{
+   QCBOREncodeContext ECtx;
+   UsefulBufC         Encoded;
+
+   QCBOREncode_Init(&ECtx, Buffer);
+   QCBOREncode_OpenArray(&ECtx);
+   QCBOREncode_OpenMap(&ECtx);
+   /* Not in the descriptor and skipped */
+   QCBOREncode_OpenMapInMapN(&ECtx, 100);
+   QCBOREncode_OpenArrayInMapN(&ECtx, 1);
+   QCBOREncode_AddInt64(&ECtx, 1);
+   QCBOREncode_CloseArray(&ECtx);
+   QCBOREncode_CloseMap(&ECtx);
+   /* Out of descriptor order */
+   QCBOREncode_AddSZStringToMapN(&ECtx, 3, "Bob");
+   QCBOREncode_AddInt64ToMapN(&ECtx, 1, nVariant == 1 ? -1 : 42);
+   QCBOREncode_AddInt64ToMapN(&ECtx, 2, nVariant == 2 ? -7 : 7);
+   if(nVariant != 3) {
+      QCBOREncode_AddBytesToMapN(&ECtx, 4, UsefulBuf_FROM_SZ_LITERAL("\x01\x02"));
+   } else {
+      QCBOREncode_AddSZStringToMapN(&ECtx, 4, "x");
+   }
+   QCBOREncode_AddBoolToMapN(&ECtx, 5, true);
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+   QCBOREncode_AddDoubleNoPreferredToMapN(&ECtx, 6, 1.5);
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+   QCBOREncode_OpenMapInMapN(&ECtx, 7);
+   if(nVariant != 4) {
+      QCBOREncode_AddInt64ToMapN(&ECtx, 1, 10);
+   }
+   QCBOREncode_AddInt64ToMapN(&ECtx, 2, -20);
+   QCBOREncode_CloseMap(&ECtx);
+   QCBOREncode_OpenArrayInMapN(&ECtx, 8);
+   QCBOREncode_AddInt64(&ECtx, 1);
+   QCBOREncode_AddInt64(&ECtx, 2);
+   QCBOREncode_CloseArray(&ECtx);
+   if(nVariant == 5) {
+      QCBOREncode_AddSZStringToMapN(&ECtx, 3, "Bob");
+   }
+   if(nVariant == 6) {
+      /* Optional label 9 is found and required label 3 is not */
+      QCBOREncode_AddInt64ToMapN(&ECtx, 9, 99);
+   }
+   QCBOREncode_CloseMap(&ECtx);
+   QCBOREncode_AddInt64(&ECtx, 77);
+   QCBOREncode_CloseArray(&ECtx);
+
+   if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+      return NULLUsefulBufC;
+   }
+   if(nVariant == 6) {
+      /* Change the label of "Bob" from 3 to 10 */
+      ((uint8_t *)Buffer.ptr)[8] = 0x0a;
+   }
+   return Encoded;
+}
+
+
+int32_t GetStructTest(void)
+{
+   QCBORDecodeContext DCtx;
+   StructTest         S;
+   QCBORError         puErrors[9];
+   int64_t            nInt;
+   size_t             uIndex;
+   UsefulBuf_MAKE_STACK_UB(Buffer, 100);
+
+   static const struct {
+      int        nVariant;
+      QCBORError uExpectedErr;
+      size_t     uField;
+      QCBORError uFieldErr;
+   } Variants[] = {
+      {0, QCBOR_SUCCESS,                    8, QCBOR_ERR_LABEL_NOT_FOUND},
+      {1, QCBOR_SUCCESS,                    0, QCBOR_SUCCESS},
+      {2, QCBOR_ERR_NUMBER_SIGN_CONVERSION, 1, QCBOR_ERR_NUMBER_SIGN_CONVERSION},
+      {3, QCBOR_ERR_UNEXPECTED_TYPE,        3, QCBOR_ERR_UNEXPECTED_TYPE},
+      {4, QCBOR_ERR_LABEL_NOT_FOUND,        6, QCBOR_ERR_LABEL_NOT_FOUND},
+      {5, QCBOR_ERR_DUPLICATE_LABEL,        2, QCBOR_ERR_DUPLICATE_LABEL},
+      {6, QCBOR_ERR_LABEL_NOT_FOUND,        2, QCBOR_ERR_LABEL_NOT_FOUND},
+   };
+
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(Variants, Variants[0]); uIndex++) {
+      QCBORDecode_Init(&DCtx, StructTestEncode(Buffer, Variants[uIndex].nVariant), QCBOR_DECODE_MODE_NORMAL);
+      memset(&S, 0, sizeof(S));
+      S.nMissing = 99;
+      QCBORDecode_EnterArray(&DCtx, NULL);
+      QCBORDecode_GetStruct(&DCtx, &StructTestDescriptor, &S, puErrors);
+      if(QCBORDecode_GetAndResetError(&DCtx) != Variants[uIndex].uExpectedErr) {
+         return (int32_t)(10 + uIndex * 10);
+      }
+      if(puErrors[Variants[uIndex].uField] != Variants[uIndex].uFieldErr) {
+         return (int32_t)(11 + uIndex * 10);
+      }
+      /* Fields after an error are still filled in and decoding
+       * continues after the map */
+      if(S.Pos.nY != -20 || S.Extra.uDataType != QCBOR_TYPE_ARRAY || S.nMissing != 99) {
+         return (int32_t)(12 + uIndex * 10);
+      }
+      QCBORDecode_GetInt64(&DCtx, &nInt);
+      QCBORDecode_ExitArray(&DCtx);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || nInt != 77) {
+         return (int32_t)(13 + uIndex * 10);
+      }
+   }
+
+   /* Check the values from the last success */
+   QCBORDecode_Init(&DCtx, StructTestEncode(Buffer, 0), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnterArray(&DCtx, NULL);
+   QCBORDecode_GetStruct(&DCtx, &StructTestDescriptor, &S, NULL);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      S.nId != 42 ||
+      S.uCount != 7 ||
+      UsefulBuf_Compare(S.Name, UsefulBuf_FROM_SZ_LITERAL("Bob")) ||
+      UsefulBuf_Compare(S.Blob, UsefulBuf_FROM_SZ_LITERAL("\x01\x02")) ||
+      !S.bFlag ||
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+      S.dScore != 1.5 ||
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+      S.Pos.nX != 10 ||
+      S.Pos.nY != -20 ||
+      S.Extra.val.uCount != 2) {
+      return 100;
+   }
+
+   /* Not a map */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\x81\x01"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetStruct(&DCtx, &StructTestDescriptor, &S, NULL);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE) {
+      return 101;
+   }
+
+   /* Bad descriptors */
+   {
+      static const QCBORStructField BadType[] = {
+         {NULL, 1, QCBOR_TYPE_ARRAY, 0, 0, NULL},
+      };
+      static const QCBORStructField NoNested[] = {
+         {NULL, 1, QCBOR_TYPE_MAP, 0, 0, NULL},
+      };
+      const QCBORStructDescriptor Bad[] = {{BadType, 1}, {NoNested, 1}, {StructTestFields, QCBOR_MAX_STRUCT_FIELDS + 1}};
+
+      for(uIndex = 0; uIndex < C_ARRAY_COUNT(Bad, QCBORStructDescriptor); uIndex++) {
+         QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x01\x01"), QCBOR_DECODE_MODE_NORMAL);
+         QCBORDecode_GetStruct(&DCtx, &Bad[uIndex], &S, NULL);
+         if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_STRUCT_DESCRIPTOR) {
+            return (int32_t)(110 + uIndex);
+         }
+      }
+   }
+
+   /* Not-well-formed in a nested map stops decoding */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x07\xa1\x01\x1c"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetStruct(&DCtx, &StructTestDescriptor, &S, NULL);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNSUPPORTED) {
+      return 120;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   {
+      static const QCBORStructField TextFields[] = {
+         {"x", 0, QCBOR_TYPE_INT64, QCBOR_FIELD_REQUIRED, offsetof(StructTestPos, nX), NULL},
+         {"y", 0, QCBOR_TYPE_INT64, QCBOR_FIELD_REQUIRED, offsetof(StructTestPos, nY), NULL},
+      };
+      static const QCBORStructDescriptor TextDescriptor = {TextFields, 2};
+      StructTestPos Pos;
+
+      /* {"y": 2, "xx": 0, "x": 1} */
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa3\x61y\x02\x62xx\x00\x61x\x01"), QCBOR_DECODE_MODE_NORMAL);
+      QCBORDecode_GetStruct(&DCtx, &TextDescriptor, &Pos, NULL);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || Pos.nX != 1 || Pos.nY != 2) {
+         return 130;
+      }
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   return 0;
+}
+
+
+/* Encode the map for GetByPathTest, definite- or indefinite-length */
+static UsefulBufC
+PathTestEncode(UsefulBuf Buffer, bool bIndefinite)
+{
+   QCBOREncodeContext ECtx;
+   UsefulBufC         Encoded;
+
+   QCBOREncode_Init(&ECtx, Buffer);
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   if(bIndefinite) {
+      QCBOREncode_OpenMapIndefiniteLength(&ECtx);
+   } else {
+      QCBOREncode_OpenMap(&ECtx);
+   }
+#else /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   (void)bIndefinite;
+   QCBOREncode_OpenMap(&ECtx);
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   /* Skipped over on the way to "claims" */
+   QCBOREncode_OpenArrayInMap(&ECtx, "pad");
+   QCBOREncode_OpenArray(&ECtx);
+   QCBOREncode_AddInt64(&ECtx, 1);
+   QCBOREncode_AddInt64(&ECtx, 2);
+   QCBOREncode_CloseArray(&ECtx);
+   QCBOREncode_OpenMap(&ECtx);
+   QCBOREncode_AddInt64ToMapN(&ECtx, 7, 7);
+   QCBOREncode_CloseMap(&ECtx);
+   QCBOREncode_CloseArray(&ECtx);
+   QCBOREncode_OpenMapInMap(&ECtx, "claims");
+   QCBOREncode_AddSZStringToMapN(&ECtx, -3, "neg");
+   QCBOREncode_AddInt64ToMap(&ECtx, "a/b", 5);
+   QCBOREncode_AddSZStringToMap(&ECtx, "7", "textseven");
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   if(bIndefinite) {
+      QCBOREncode_OpenArrayIndefiniteLengthInMapN(&ECtx, 7);
+   } else {
+      QCBOREncode_OpenArrayInMapN(&ECtx, 7);
+   }
+#else /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   QCBOREncode_OpenArrayInMapN(&ECtx, 7);
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   QCBOREncode_AddInt64(&ECtx, 10);
+   QCBOREncode_AddInt64(&ECtx, 11);
+   QCBOREncode_AddInt64(&ECtx, 12);
+   QCBOREncode_OpenMap(&ECtx);
+   QCBOREncode_AddSZStringToMap(&ECtx, "name", "Alice");
+   QCBOREncode_CloseMap(&ECtx);
+#ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+   if(bIndefinite) {
+      QCBOREncode_CloseArrayIndefiniteLength(&ECtx);
+      QCBOREncode_CloseMap(&ECtx);
+      QCBOREncode_CloseMapIndefiniteLength(&ECtx);
+   } else {
+      QCBOREncode_CloseArray(&ECtx);
+      QCBOREncode_CloseMap(&ECtx);
+      QCBOREncode_CloseMap(&ECtx);
+   }
+#else /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+   QCBOREncode_CloseArray(&ECtx);
+   QCBOREncode_CloseMap(&ECtx);
+   QCBOREncode_CloseMap(&ECtx);
+#endif /* ! QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+
+   if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+      return NULLUsefulBufC;
+   }
+   return Encoded;
+}
+
+
+int32_t GetByPathTest(void)
+{
+   QCBORDecodeContext       DCtx;
+   QCBORItem                Item;
+   QCBORPath                Path;
+   size_t                   uIndex;
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORContainerIndexEntry Index[10];
+   size_t                   uIndexCount;
+   size_t                   uPass;
+   UsefulBufC               Encoded;
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   UsefulBuf_MAKE_STACK_UB(Buffer, 120);
+
+   static const char *aszBadPaths[] = {
+      "", "a//b", "a/", "/a", "[x]", "[1", "[]", "[-1]", "'abc", "'a'b",
+      "0/1/2/3/4/5/6/7/8/9/10/11/12/13/14/15"
+   };
+
+   for(uIndex = 0; uIndex < C_ARRAY_COUNT(aszBadPaths, const char *); uIndex++) {
+      if(QCBORPath_Compile(aszBadPaths[uIndex], &Path) != QCBOR_ERR_PATH_SYNTAX) {
+         return (int32_t)(1 + uIndex);
+      }
+   }
+
+   if(QCBORPath_Compile("claims/-9223372036854775808/[3]/9223372036854775808/'7'/''", &Path) ||
+      Path.uNumSteps != 6 ||
+      Path.Steps[0].uType != QCBOR_TYPE_TEXT_STRING ||
+      Path.Steps[1].uType != QCBOR_TYPE_INT64 ||
+      Path.Steps[1].nValue != INT64_MIN ||
+      Path.Steps[2].uType != QCBOR_TYPE_ARRAY ||
+      Path.Steps[2].nValue != 3 ||
+      Path.Steps[3].uType != QCBOR_TYPE_TEXT_STRING ||
+      Path.Steps[4].uType != QCBOR_TYPE_TEXT_STRING ||
+      UsefulBuf_Compare(Path.Steps[4].Label, UsefulBuf_FROM_SZ_LITERAL("7")) ||
+      Path.Steps[5].Label.len != 0) {
+      return 20;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   static const struct {
+      const char *szPath;
+      QCBORError  uExpectedErr;
+      uint8_t     uDataType;
+      int64_t     nValue;
+   } Lookups[] = {
+      {"claims/7/[3]/name", QCBOR_SUCCESS,             QCBOR_TYPE_TEXT_STRING, 0},
+      {"claims/-3",         QCBOR_SUCCESS,             QCBOR_TYPE_TEXT_STRING, 0},
+      {"claims/'a/b'",      QCBOR_SUCCESS,             QCBOR_TYPE_INT64,       5},
+      {"claims/'7'",        QCBOR_SUCCESS,             QCBOR_TYPE_TEXT_STRING, 0},
+      {"claims/7",          QCBOR_SUCCESS,             QCBOR_TYPE_ARRAY,       0},
+      {"claims/7/[2]",      QCBOR_SUCCESS,             QCBOR_TYPE_INT64,       12},
+      {"pad/[1]/7",         QCBOR_SUCCESS,             QCBOR_TYPE_INT64,       7},
+      {"claims/7/[4]",      QCBOR_ERR_LABEL_NOT_FOUND, QCBOR_TYPE_NONE,        0},
+      {"claims/8",          QCBOR_ERR_LABEL_NOT_FOUND, QCBOR_TYPE_NONE,        0},
+      {"claims/7/name",     QCBOR_ERR_UNEXPECTED_TYPE, QCBOR_TYPE_NONE,        0},
+      {"claims/-3/x",       QCBOR_ERR_UNEXPECTED_TYPE, QCBOR_TYPE_NONE,        0},
+      {"[0]",               QCBOR_ERR_UNEXPECTED_TYPE, QCBOR_TYPE_NONE,        0},
+   };
+
+   /* Definite and indefinite lengths each with and without an index */
+   for(uPass = 0; uPass < 4; uPass++) {
+#ifdef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
+      if(uPass & 1) {
+         continue;
+      }
+#endif /* QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS */
+      Encoded = PathTestEncode(Buffer, (uPass & 1) != 0);
+      QCBORDecode_Init(&DCtx, Encoded, QCBOR_DECODE_MODE_NORMAL);
+      if(uPass & 2) {
+         if(QCBORDecode_BuildContainerIndex(Encoded, Index, C_ARRAY_COUNT(Index, QCBORContainerIndexEntry), &uIndexCount)) {
+            return 30;
+         }
+         QCBORDecode_SetContainerIndex(&DCtx, Index, uIndexCount);
+      }
+
+      for(uIndex = 0; uIndex < C_ARRAY_COUNT(Lookups, Lookups[0]); uIndex++) {
+         if(QCBORPath_Compile(Lookups[uIndex].szPath, &Path)) {
+            return (int32_t)(100 + uPass * 100 + uIndex * 10);
+         }
+         QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+         if(QCBORDecode_GetAndResetError(&DCtx) != Lookups[uIndex].uExpectedErr ||
+            Item.uDataType != Lookups[uIndex].uDataType) {
+            return (int32_t)(101 + uPass * 100 + uIndex * 10);
+         }
+         if(Item.uDataType == QCBOR_TYPE_INT64 && Item.val.int64 != Lookups[uIndex].nValue) {
+            return (int32_t)(102 + uPass * 100 + uIndex * 10);
+         }
+      }
+
+      /* Check the value and label of the deepest one */
+      QCBORPath_Compile("claims/7/[3]/name", &Path);
+      QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+      if(UsefulBuf_Compare(Item.val.string, UsefulBuf_FROM_SZ_LITERAL("Alice")) ||
+         Item.uLabelType != QCBOR_TYPE_TEXT_STRING ||
+         UsefulBuf_Compare(Item.label.string, UsefulBuf_FROM_SZ_LITERAL("name")) ||
+         Item.uNestingLevel != 0) {
+         return (int32_t)(190 + uPass * 100);
+      }
+      QCBORPath_Compile("claims/-3", &Path);
+      QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+      if(Item.uLabelType != QCBOR_TYPE_INT64 || Item.label.int64 != -3) {
+         return (int32_t)(191 + uPass * 100);
+      }
+
+      /* The traversal cursor didn't move */
+      QCBORDecode_VGetNextConsume(&DCtx, &Item);
+      if(Item.uDataType != QCBOR_TYPE_MAP || QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+         return (int32_t)(192 + uPass * 100);
+      }
+   }
+
+   /* Relative to the entered map */
+   QCBORDecode_Init(&DCtx, PathTestEncode(Buffer, false), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_EnterMapFromMapSZ(&DCtx, "claims");
+   QCBORPath_Compile("7/[1]", &Path);
+   QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_INT64 ||
+      Item.val.int64 != 11) {
+      return 600;
+   }
+   QCBORDecode_VGetNext(&DCtx, &Item);
+   if(Item.uLabelType != QCBOR_TYPE_INT64 || Item.label.int64 != -3) {
+      return 601;
+   }
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 602;
+   }
+#else /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   /* Text string labels never match */
+   QCBORDecode_Init(&DCtx, PathTestEncode(Buffer, false), QCBOR_DECODE_MODE_NORMAL);
+   QCBORPath_Compile("claims", &Path);
+   QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_LABEL_NOT_FOUND) {
+      return 600;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   /* {1: [5, 6]} */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa1\x01\x82\x05\x06"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORPath_Compile("1/[1]", &Path);
+   QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Item.uDataType != QCBOR_TYPE_INT64 ||
+      Item.val.int64 != 6 ||
+      Item.uLabelType != QCBOR_TYPE_NONE) {
+      return 605;
+   }
+
+   /* A not-well-formed item skipped over is an error */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa2\x01\x1c\x02\x02"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORPath_Compile("2", &Path);
+   QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNSUPPORTED || Item.uDataType != QCBOR_TYPE_NONE) {
+      return 610;
+   }
+
+   /* Running off the end of a truncated map */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa2\x01\x01"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_GetByPath(&DCtx, &Path, &Item);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_HIT_END) {
+      return 611;
+   }
+
+   return 0;
+}
+
+
+/* Encode the map for LabelIndexTest */
+static UsefulBufC
+LabelIndexEncode(UsefulBuf Buffer)
+{
+   QCBOREncodeContext ECtx;
+   UsefulBufC         Encoded;
+   int64_t            nLabel;
+
+   QCBOREncode_Init(&ECtx, Buffer);
+   QCBOREncode_OpenMap(&ECtx);
+   for(nLabel = 0; nLabel < 40; nLabel++) {
+      QCBOREncode_AddInt64ToMapN(&ECtx, nLabel, nLabel * 10);
+   }
+   QCBOREncode_AddInt64ToMapN(&ECtx, 60, 1);
+   QCBOREncode_OpenMapInMapN(&ECtx, 50);
+   QCBOREncode_AddSZStringToMapN(&ECtx, 1, "inner");
+   QCBOREncode_AddInt64ToMapN(&ECtx, 2, 22);
+   QCBOREncode_CloseMap(&ECtx);
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBOREncode_AddSZStringToMap(&ECtx, "name", "Alice");
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+   QCBOREncode_AddInt64ToMapN(&ECtx, 60, 2);
+   QCBOREncode_AddBoolToMapN(&ECtx, -5, true);
+   QCBOREncode_CloseMap(&ECtx);
+
+   if(QCBOREncode_Finish(&ECtx, &Encoded) != QCBOR_SUCCESS) {
+      return NULLUsefulBufC;
+   }
+   return Encoded;
+}
+
+
+/* Searches that give the same results with and without the index */
+static int32_t
+LabelIndexSearches(UsefulBufC Input, QCBORLabelIndexEntry *pEntries, size_t uCount)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Items[4];
+   int64_t            nLabel;
+   int64_t            nInt;
+   bool               bBool;
+   UsefulBufC         String;
+
+   QCBORDecode_Init(&DCtx, Input, QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetLabelIndex(&DCtx, pEntries, uCount);
+   QCBORDecode_EnterMap(&DCtx, NULL);
+
+   for(nLabel = 39; nLabel >= 0; nLabel--) {
+      QCBORDecode_GetInt64InMapN(&DCtx, nLabel, &nInt);
+      if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != nLabel * 10) {
+         return 1;
+      }
+   }
+
+   QCBORDecode_GetBoolInMapN(&DCtx, -5, &bBool);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || !bBool) {
+      return 2;
+   }
+
+   QCBORDecode_GetInt64InMapN(&DCtx, 1000, &nInt);
+   if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_LABEL_NOT_FOUND) {
+      return 3;
+   }
+   QCBORDecode_GetTextStringInMapN(&DCtx, 3, &String);
+   if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE) {
+      return 4;
+   }
+   QCBORDecode_GetInt64InMapN(&DCtx, 60, &nInt);
+   if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_DUPLICATE_LABEL) {
+      return 5;
+   }
+
+#ifndef QCBOR_DISABLE_NON_INTEGER_LABELS
+   QCBORDecode_GetTextStringInMapSZ(&DCtx, "name", &String);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      UsefulBuf_Compare(String, UsefulBuf_FROM_SZ_LITERAL("Alice"))) {
+      return 6;
+   }
+#endif /* ! QCBOR_DISABLE_NON_INTEGER_LABELS */
+
+   Items[0].uLabelType  = QCBOR_TYPE_INT64;
+   Items[0].label.int64 = 3;
+   Items[0].uDataType   = QCBOR_TYPE_INT64;
+   Items[1].uLabelType  = QCBOR_TYPE_INT64;
+   Items[1].label.int64 = 999;
+   Items[1].uDataType   = QCBOR_TYPE_ANY;
+   Items[2].uLabelType  = QCBOR_TYPE_INT64;
+   Items[2].label.int64 = 50;
+   Items[2].uDataType   = QCBOR_TYPE_MAP;
+   Items[3].uLabelType  = QCBOR_TYPE_NONE;
+   QCBORDecode_GetItemsInMap(&DCtx, Items);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      Items[0].val.int64 != 30 ||
+      Items[1].uDataType != QCBOR_TYPE_NONE ||
+      Items[2].val.uCount != 2) {
+      return 7;
+   }
+
+   /* The nested map gets the index and the outer map loses it */
+   QCBORDecode_EnterMapFromMapN(&DCtx, 50);
+   QCBORDecode_GetInt64InMapN(&DCtx, 2, &nInt);
+   QCBORDecode_GetTextStringInMapN(&DCtx, 1, &String);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+      nInt != 22 ||
+      UsefulBuf_Compare(String, UsefulBuf_FROM_SZ_LITERAL("inner"))) {
+      return 8;
+   }
+   QCBORDecode_ExitMap(&DCtx);
+   QCBORDecode_GetInt64InMapN(&DCtx, 7, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 70) {
+      return 9;
+   }
+
+   QCBORDecode_ExitMap(&DCtx);
+   if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS) {
+      return 10;
+   }
+
+   return 0;
+}
+
+
+int32_t LabelIndexTest(void)
+{
+   QCBORDecodeContext   DCtx;
+   QCBORLabelIndexEntry Entries[100];
+   QCBORItem            Item;
+   int64_t              nInt;
+   int32_t              nResult;
+   int                  nIndexed;
+   UsefulBufC           Input;
+   UsefulBuf_MAKE_STACK_UB(Buffer, 300);
+
+   Input = LabelIndexEncode(Buffer);
+
+   /* No index, big enough and too small */
+   nResult = LabelIndexSearches(Input, NULL, 0);
+   if(nResult) {
+      return nResult;
+   }
+   nResult = LabelIndexSearches(Input, Entries, C_ARRAY_COUNT(Entries, QCBORLabelIndexEntry));
+   if(nResult) {
+      return 100 + nResult;
+   }
+   nResult = LabelIndexSearches(Input, Entries, 10);
+   if(nResult) {
+      return 200 + nResult;
+   }
+
+   /* An error in an item is set when it is searched for, the same
+    * as without the index. {1: 1, 2: <reserved>} */
+   QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa2\x01\x01\x02\x1c"), QCBOR_DECODE_MODE_NORMAL);
+   QCBORDecode_SetLabelIndex(&DCtx, Entries, C_ARRAY_COUNT(Entries, QCBORLabelIndexEntry));
+   QCBORDecode_EnterMap(&DCtx, NULL);
+   QCBORDecode_GetInt64InMapN(&DCtx, 1, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 1) {
+      return 300;
+   }
+   QCBORDecode_GetInt64InMapN(&DCtx, 2, &nInt);
+   if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNSUPPORTED) {
+      return 301;
+   }
+
+   for(nIndexed = 0; nIndexed < 2; nIndexed++) {
+      /* The wrong type is found before the duplicate. {1: "x", 1: 2} */
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa2\x01\x61\x78\x01\x02"), QCBOR_DECODE_MODE_NORMAL);
+      if(nIndexed) {
+         QCBORDecode_SetLabelIndex(&DCtx, Entries, C_ARRAY_COUNT(Entries, QCBORLabelIndexEntry));
+      }
+      QCBORDecode_EnterMap(&DCtx, NULL);
+      QCBORDecode_GetItemInMapN(&DCtx, 1, QCBOR_TYPE_INT64, &Item);
+      if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_UNEXPECTED_TYPE) {
+         return 310 + nIndexed;
+      }
+
+      /* The duplicate is found before the end of a map that is cut
+       * off and can't be indexed. {1: 1, 1: 2, 3: */
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_SZ_LITERAL("\xa3\x01\x01\x01\x02\x03"), QCBOR_DECODE_MODE_NORMAL);
+      if(nIndexed) {
+         QCBORDecode_SetLabelIndex(&DCtx, Entries, C_ARRAY_COUNT(Entries, QCBORLabelIndexEntry));
+      }
+      QCBORDecode_EnterMap(&DCtx, NULL);
+      QCBORDecode_GetInt64InMapN(&DCtx, 1, &nInt);
+      if(QCBORDecode_GetError(&DCtx) != QCBOR_ERR_DUPLICATE_LABEL) {
+         return 320 + nIndexed;
+      }
+   }
+
+   return 0;
+}
+
+
+int32_t TrustedInputTest(void)
+{
+   QCBORDecodeContext DCtx;
+   QCBORItem          Items[3];
+   int64_t            nInt;
+   int                nTrusted;
+
+   /* [{1: 1, 2: {3: 3}, 1: 4, 5: 5}, 77] with a duplicate of label 1 */
+   static const uint8_t spInput[] = {
+      0x82, 0xa4, 0x01, 0x01, 0x02, 0xa1, 0x03, 0x03, 0x01, 0x04, 0x05, 0x05, 0x18, 0x4d
+   };
+
+   for(nTrusted = 0; nTrusted < 2; nTrusted++) {
+      QCBORDecode_Init(&DCtx, UsefulBuf_FROM_BYTE_ARRAY_LITERAL(spInput), QCBOR_DECODE_MODE_NORMAL);
+      if(nTrusted) {
+         QCBORDecode_EnableTrustedInput(&DCtx);
+      }
+      QCBORDecode_EnterArray(&DCtx, NULL);
+      QCBORDecode_EnterMap(&DCtx, NULL);
+
+      /* The duplicate is only found by going through the whole map */
+      QCBORDecode_GetInt64InMapN(&DCtx, 1, &nInt);
+      if(nTrusted) {
+         if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 1) {
+            return 10;
+         }
+      } else {
+         if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_DUPLICATE_LABEL) {
+            return 11;
+         }
+      }
+
+      /* Stops after both are found, before the end of the map */
+      Items[0].uLabelType  = QCBOR_TYPE_INT64;
+      Items[0].label.int64 = 5;
+      Items[0].uDataType   = QCBOR_TYPE_INT64;
+      Items[1].uLabelType  = QCBOR_TYPE_INT64;
+      Items[1].label.int64 = 2;
+      Items[1].uDataType   = QCBOR_TYPE_MAP;
+      Items[2].uLabelType  = QCBOR_TYPE_NONE;
+      QCBORDecode_GetItemsInMap(&DCtx, Items);
+      if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS ||
+         Items[0].val.int64 != 5 ||
+         Items[1].val.uCount != 1) {
+         return 20 + nTrusted;
+      }
+
+      QCBORDecode_EnterMapFromMapN(&DCtx, 2);
+      QCBORDecode_GetInt64InMapN(&DCtx, 3, &nInt);
+      QCBORDecode_ExitMap(&DCtx);
+      if(QCBORDecode_GetError(&DCtx) != QCBOR_SUCCESS || nInt != 3) {
+         return 30 + nTrusted;
+      }
+
+      /* A label not in the map is still a full search */
+      QCBORDecode_GetInt64InMapN(&DCtx, 9, &nInt);
+      if(QCBORDecode_GetAndResetError(&DCtx) != QCBOR_ERR_LABEL_NOT_FOUND) {
+         return 40 + nTrusted;
+      }
+
+      /* The end of the map is found for exiting */
+      QCBORDecode_GetInt64InMapN(&DCtx, 5, &nInt);
+      QCBORDecode_ExitMap(&DCtx);
+      QCBORDecode_GetInt64(&DCtx, &nInt);
+      QCBORDecode_ExitArray(&DCtx);
+      if(QCBORDecode_Finish(&DCtx) != QCBOR_SUCCESS || nInt != 77) {
+         return 50 + nTrusted;
+      }
+   }
+
+   return 0;
+}
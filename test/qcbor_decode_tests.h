@@ -331,4 +331,134 @@ int32_t GetMapAndArrayTest(void);
 int32_t TellTests(void);
 
 
+/*
+ * Test decoding of all 256 initial byte values for errors that
+ * are determined by the initial byte alone.
+ */
+int32_t InitialByteTest(void);
+
+
+/*
+ * Test QCBORDecode_GetInt64Array() and QCBORDecode_GetUInt64Array().
+ */
+int32_t IntArrayTest(void);
+
+
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+/*
+ * Test QCBORDecode_GetDoubleArray() and QCBORDecode_GetFloatArray().
+ */
+int32_t FloatArrayTest(void);
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+
+
+/*
+ * Test QCBORDecode_ValidateWellFormed().
+ */
+int32_t WellFormedValidateTest(void);
+
+
+/*
+ * Test QCBORDecode_BuildContainerIndex() and decoding with an index.
+ */
+int32_t ContainerIndexTest(void);
+
+
+/*
+ * Test decoding input fed a piece at a time in streaming mode.
+ */
+int32_t StreamingDecodeTest(void);
+
+
+/*
+ * Test QCBORDecode_EnableFastSkip().
+ */
+int32_t FastSkipTest(void);
+
+
+/*
+ * Test QCBORDecode_GetNextLite().
+ */
+int32_t LiteDecodeTest(void);
+
+
+/*
+ * Test QCBORDecode_SetPeekCache().
+ */
+int32_t PeekCacheTest(void);
+
+
+/*
+ * Test QCBORDecode_SaveCursor() and QCBORDecode_RestoreCursor().
+ */
+int32_t CursorTest(void);
+
+
+/*
+ * Test QCBORDecode_SetNestingStorage().
+ */
+int32_t NestingStorageTest(void);
+
+
+/*
+ * Test maps and arrays with more than 65,534 items.
+ */
+int32_t WideCountTest(void);
+
+
+/*
+ * Test QCBORDecode_Walk().
+ */
+int32_t WalkTest(void);
+
+
+/*
+ * Test the fast path in QCBORDecode_GetNext() gives the same results
+ * as the full decode.
+ */
+int32_t FastGetNextTest(void);
+
+
+/*
+ * Test QCBORDecode_SetDuplicateLabelCheck().
+ */
+int32_t DuplicateLabelTest(void);
+
+
+/*
+ * Test QCBORDecode_CheckDeterministic().
+ */
+int32_t DeterministicTest(void);
+
+
+/*
+ * Test QCBORDecode_EnableUTF8Check().
+ */
+int32_t UTF8DecodeTest(void);
+
+
+/*
+ * Test QCBORDecode_GetStruct().
+ */
+int32_t GetStructTest(void);
+
+
+/*
+ * Test QCBORPath_Compile() and QCBORDecode_GetByPath().
+ */
+int32_t GetByPathTest(void);
+
+
+/*
+ * Test QCBORDecode_SetLabelIndex().
+ */
+int32_t LabelIndexTest(void);
+
+
+/*
+ * Test QCBORDecode_EnableTrustedInput().
+ */
+int32_t TrustedInputTest(void);
+
+
 #endif /* defined(__QCBOR__qcbort_decode_tests__) */
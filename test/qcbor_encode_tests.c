@@ -2100,7 +2100,7 @@ static int32_t GetInt64(QCBORDecodeContext *pDC, int64_t *pInt)
 /*
  Get an array out of the decoder or fail.
  */
-static int32_t GetArray(QCBORDecodeContext *pDC, uint16_t *pInt)
+static int32_t GetArray(QCBORDecodeContext *pDC, QCBORCount *pInt)
 {
    QCBORItem Item;
    int32_t nReturn;
@@ -2120,7 +2120,7 @@ static int32_t GetArray(QCBORDecodeContext *pDC, uint16_t *pInt)
 /*
  Get a map out of the decoder or fail.
  */
-static int32_t GetMap(QCBORDecodeContext *pDC, uint16_t *pInt)
+static int32_t GetMap(QCBORDecodeContext *pDC, QCBORCount *pInt)
 {
    QCBORItem Item;
    int32_t nReturn;
@@ -2187,7 +2187,7 @@ static int32_t GetTextString(QCBORDecodeContext *pDC, UsefulBufC *pTstr)
 {
    int64_t            nInt;
    UsefulBufC         Bstr;
-   uint16_t           nArrayCount;
+   QCBORCount         nArrayCount;
    QCBORDecodeContext DC;
    int32_t            nResult;
 
@@ -2228,7 +2228,7 @@ static int32_t GetTextString(QCBORDecodeContext *pDC, UsefulBufC *pTstr)
 static int32_t DecodeNextNested2(UsefulBufC Wrapped)
 {
    int32_t            nResult;
-   uint16_t           nMapCount;
+   QCBORCount         nMapCount;
    int64_t            nInt;
    UsefulBufC         Bstr;
    QCBORDecodeContext DC;
@@ -2318,7 +2318,7 @@ int32_t BstrWrapNestTest(void)
    QCBORDecode_Init(&DC, Encoded, QCBOR_DECODE_MODE_NORMAL);
 
    UsefulBufC Bstr;
-   uint16_t nArrayCount;
+   QCBORCount nArrayCount;
 
    // Array surrounding the the whole thing
    if(GetArray(&DC, &nArrayCount) || nArrayCount != 2) {
@@ -2768,7 +2768,7 @@ int32_t EncodeErrorTests(void)
    }
 
 
-#ifndef QCBOR_DISABLE_ENCODE_USAGE_GUARDS
+#if !defined(QCBOR_DISABLE_ENCODE_USAGE_GUARDS) && !defined(QCBOR_WIDE_COUNTS)
    /* ------ QCBOR_ERR_ARRAY_TOO_LONG -------- */
    QCBOREncode_Init(&EC, Large);
    QCBOREncode_OpenArray(&EC);
@@ -2796,7 +2796,7 @@ int32_t EncodeErrorTests(void)
    if(QCBOREncode_GetErrorState(&EC) != QCBOR_ERR_ARRAY_TOO_LONG) {
       return 251;
    }
-#endif /* ! QCBOR_DISABLE_ENCODE_USAGE_GUARDS */
+#endif /* ! QCBOR_DISABLE_ENCODE_USAGE_GUARDS && ! QCBOR_WIDE_COUNTS */
 
    return 0;
 }
@@ -3297,3 +3297,55 @@ int32_t SubStringTest(void)
 
    return 0;
 }
+
+
+int32_t UTF8EncodeTest(void)
+{
+   QCBOREncodeContext EC;
+   UsefulBufC         Encoded;
+   QCBORError         uErr;
+
+   /* Not checked by default */
+   QCBOREncode_Init(&EC, UsefulBuf_FROM_BYTE_ARRAY(spBigBuf));
+   QCBOREncode_AddText(&EC, UsefulBuf_FROM_SZ_LITERAL("\xc0\xaf"));
+   uErr = QCBOREncode_Finish(&EC, &Encoded);
+   if(uErr != QCBOR_SUCCESS) {
+      return 1;
+   }
+
+   QCBOREncode_Init(&EC, UsefulBuf_FROM_BYTE_ARRAY(spBigBuf));
+   QCBOREncode_EnableUTF8Check(&EC);
+   QCBOREncode_OpenMap(&EC);
+   QCBOREncode_AddSZStringToMapSZ(&EC, "\xc3\xa9t\xc3\xa9", "\xe2\x82\xac");
+   QCBOREncode_AddBytesToMapN(&EC, 1, UsefulBuf_FROM_SZ_LITERAL("\xff"));
+   QCBOREncode_CloseMap(&EC);
+   uErr = QCBOREncode_Finish(&EC, &Encoded);
+   if(uErr != QCBOR_SUCCESS) {
+      return 2;
+   }
+   if(UsefulBuf_Compare(Encoded, UsefulBuf_FROM_SZ_LITERAL("\xa2\x65\xc3\xa9t\xc3\xa9\x63\xe2\x82\xac\x01\x41\xff"))) {
+      return 3;
+   }
+
+   /* Bad label */
+   QCBOREncode_Init(&EC, UsefulBuf_FROM_BYTE_ARRAY(spBigBuf));
+   QCBOREncode_EnableUTF8Check(&EC);
+   QCBOREncode_OpenMap(&EC);
+   QCBOREncode_AddInt64ToMapSZ(&EC, "\xed\xa0\x80", 1);
+   QCBOREncode_CloseMap(&EC);
+   uErr = QCBOREncode_Finish(&EC, &Encoded);
+   if(uErr != QCBOR_ERR_INVALID_UTF8) {
+      return 4;
+   }
+
+   /* Bad value */
+   QCBOREncode_Init(&EC, UsefulBuf_FROM_BYTE_ARRAY(spBigBuf));
+   QCBOREncode_EnableUTF8Check(&EC);
+   QCBOREncode_AddText(&EC, UsefulBuf_FROM_SZ_LITERAL("abc\xe2\x82"));
+   uErr = QCBOREncode_Finish(&EC, &Encoded);
+   if(uErr != QCBOR_ERR_INVALID_UTF8) {
+      return 5;
+   }
+
+   return 0;
+}
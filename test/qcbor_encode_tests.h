@@ -194,4 +194,10 @@ int32_t OpenCloseBytesTest(void);
 int32_t SubStringTest(void);
 
 
+/*
+ * Test QCBOREncode_EnableUTF8Check().
+ */
+int32_t UTF8EncodeTest(void);
+
+
 #endif /* defined(__QCBOR__qcbor_encode_tests__) */
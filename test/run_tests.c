@@ -61,7 +61,8 @@ static test_entry2 s_tests2[] = {
     TEST_ENTRY(UBMacroConversionsTest),
     TEST_ENTRY(UBUtilTests),
     TEST_ENTRY(UIBTest_IntegerFormat),
-    TEST_ENTRY(UBAdvanceTest)
+    TEST_ENTRY(UBAdvanceTest),
+    TEST_ENTRY(UBUTF8Test)
 };
 
 
@@ -78,6 +79,29 @@ static test_entry s_tests[] = {
     TEST_ENTRY(IntegerConvertTest),
     TEST_ENTRY(EnterMapTest),
     TEST_ENTRY(QCBORHeadTest),
+    TEST_ENTRY(InitialByteTest),
+    TEST_ENTRY(IntArrayTest),
+#ifndef USEFULBUF_DISABLE_ALL_FLOAT
+    TEST_ENTRY(FloatArrayTest),
+#endif /* ! USEFULBUF_DISABLE_ALL_FLOAT */
+    TEST_ENTRY(WellFormedValidateTest),
+    TEST_ENTRY(ContainerIndexTest),
+    TEST_ENTRY(StreamingDecodeTest),
+    TEST_ENTRY(FastSkipTest),
+    TEST_ENTRY(LiteDecodeTest),
+    TEST_ENTRY(PeekCacheTest),
+    TEST_ENTRY(CursorTest),
+    TEST_ENTRY(NestingStorageTest),
+    TEST_ENTRY(WideCountTest),
+    TEST_ENTRY(WalkTest),
+    TEST_ENTRY(FastGetNextTest),
+    TEST_ENTRY(DuplicateLabelTest),
+    TEST_ENTRY(DeterministicTest),
+    TEST_ENTRY(UTF8DecodeTest),
+    TEST_ENTRY(GetStructTest),
+    TEST_ENTRY(GetByPathTest),
+    TEST_ENTRY(LabelIndexTest),
+    TEST_ENTRY(TrustedInputTest),
     TEST_ENTRY(EmptyMapsAndArraysTest),
     TEST_ENTRY(NotWellFormedTests),
 #ifndef QCBOR_DISABLE_INDEFINITE_LENGTH_ARRAYS
@@ -163,6 +187,7 @@ static test_entry s_tests[] = {
 #endif /* QCBOR_DISABLE_EXP_AND_MANTISSA */
     TEST_ENTRY(ParseEmptyMapInMapTest),
     TEST_ENTRY(SubStringTest),
+    TEST_ENTRY(UTF8EncodeTest),
     TEST_ENTRY(BoolTest)
 };
 
@@ -0,0 +1,158 @@
+/* =========================================================================
+   qcbor_mmap.c -- Read a CBOR sequence from a memory-mapped file
+
+   Copyright (c) 2026, Laurence Lundblade. All rights reserved.
+
+   SPDX-License-Identifier: BSD-3-Clause
+
+   See BSD-3-Clause license in file named "LICENSE"
+
+   Created on 10/16/26
+  ========================================================================== */
+
+#include "qcbor_mmap.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Paging hints are given this many bytes at a time. Rounded up to
+ * the page size. */
+#define QCBOR_MMAP_CHUNK (1024 * 1024)
+
+
+/*
+ * Public function, see qcbor_mmap.h
+ */
+int
+QCBORMappedSequence_Open(QCBORMappedSequence *pMe, const char *szFileName)
+{
+   struct stat Stat;
+   void       *pMapped;
+   long        nPageSize;
+   int         fd;
+   int         nErr;
+
+   pMe->pMapped   = NULL;
+   pMe->uLength   = 0;
+   pMe->uOffset   = 0;
+   pMe->uReleased = 0;
+   pMe->uError    = QCBOR_SUCCESS;
+
+   nPageSize = sysconf(_SC_PAGESIZE);
+   if(nPageSize <= 0) {
+      nPageSize = 4096;
+   }
+   pMe->uChunk = (QCBOR_MMAP_CHUNK + (size_t)nPageSize - 1) / (size_t)nPageSize * (size_t)nPageSize;
+
+   fd = open(szFileName, O_RDONLY);
+   if(fd < 0) {
+      return errno;
+   }
+   if(fstat(fd, &Stat) != 0) {
+      nErr = errno;
+      close(fd);
+      return nErr;
+   }
+   if((uint64_t)Stat.st_size > SIZE_MAX) {
+      close(fd);
+      return EFBIG;
+   }
+
+   if(Stat.st_size > 0) {
+      pMapped = mmap(NULL, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(pMapped == MAP_FAILED) {
+         nErr = errno;
+         close(fd);
+         return nErr;
+      }
+      pMe->pMapped = pMapped;
+      pMe->uLength = (size_t)Stat.st_size;
+
+      /* Hints only, so failure doesn't matter */
+      (void)madvise(pMapped, pMe->uLength, MADV_SEQUENTIAL);
+   }
+
+   /* The mapping stays valid after the file is closed */
+   close(fd);
+
+   return 0;
+}
+
+
+/* Give back the pages that are done with and ask for the next ones. */
+static void
+QCBORMappedSequence_Private_Advise(QCBORMappedSequence *pMe)
+{
+   size_t uAhead;
+
+   if(pMe->uOffset - pMe->uReleased < pMe->uChunk) {
+      return;
+   }
+
+   while(pMe->uOffset - pMe->uReleased >= pMe->uChunk) {
+      /* Cast away const is needed for the POSIX API. The pages are
+       * not written. */
+      (void)madvise((void *)(uintptr_t)(pMe->pMapped + pMe->uReleased), pMe->uChunk, MADV_DONTNEED);
+      pMe->uReleased += pMe->uChunk;
+   }
+
+   /* uReleased is a page multiple and no more than one chunk behind
+    * uOffset */
+   uAhead = pMe->uLength - pMe->uReleased;
+   if(uAhead > 2 * pMe->uChunk) {
+      uAhead = 2 * pMe->uChunk;
+   }
+   (void)madvise((void *)(uintptr_t)(pMe->pMapped + pMe->uReleased), uAhead, MADV_WILLNEED);
+}
+
+
+/*
+ * Public function, see qcbor_mmap.h
+ */
+QCBORError
+QCBORMappedSequence_GetNext(QCBORMappedSequence *pMe, UsefulBufC *pItem)
+{
+   const UsefulBufC Sequence = {pMe->pMapped, pMe->uLength};
+
+   pMe->uError = QCBORDecode_GetNextSequenceItem(Sequence, &(pMe->uOffset), pItem);
+   if(pMe->uError == QCBOR_SUCCESS) {
+      QCBORMappedSequence_Private_Advise(pMe);
+   }
+
+   return pMe->uError;
+}
+
+
+/*
+ * Public function, see qcbor_mmap.h
+ */
+QCBORError
+QCBORMappedSequence_GetNextDecoder(QCBORMappedSequence *pMe, QCBORDecodeContext *pDCtx)
+{
+   UsefulBufC Item;
+
+   if(QCBORMappedSequence_GetNext(pMe, &Item) == QCBOR_SUCCESS) {
+      QCBORDecode_Init(pDCtx, Item, QCBOR_DECODE_MODE_NORMAL);
+   }
+
+   return pMe->uError;
+}
+
+
+/*
+ * Public function, see qcbor_mmap.h
+ */
+void
+QCBORMappedSequence_Close(QCBORMappedSequence *pMe)
+{
+   if(pMe->pMapped != NULL) {
+      munmap((void *)(uintptr_t)pMe->pMapped, pMe->uLength);
+   }
+   pMe->pMapped = NULL;
+   pMe->uLength = 0;
+   pMe->uOffset = 0;
+}
@@ -0,0 +1,170 @@
+/*==============================================================================
+ qcbor_mmap.h -- Read a CBOR sequence from a memory-mapped file
+
+ Copyright (c) 2026, Laurence Lundblade. All rights reserved.
+
+ SPDX-License-Identifier: BSD-3-Clause
+
+ See BSD-3-Clause license in file named "LICENSE"
+
+ Created on 10/16/26
+ =============================================================================*/
+
+#ifndef qcbor_mmap_h
+#define qcbor_mmap_h
+
+#include <stddef.h>
+#include "qcbor/qcbor_decode.h"
+
+
+/**
+ * @file qcbor_mmap.h
+ *
+ * This is an optional add-on for POSIX systems. It is not part of
+ * the QCBOR library, which has no OS dependencies. It maps a file of
+ * a CBOR sequence (RFC 8742) read-only and gives out one encoded data
+ * item at a time with QCBORDecode_GetNextSequenceItem(), so nothing is
+ * copied with read(). As the items are gotten it tells the OS which
+ * pages are done with and which are needed next.
+ *
+ * @code
+ *    QCBORMappedSequence Seq;
+ *    QCBORDecodeContext  DCtx;
+ *
+ *    if(QCBORMappedSequence_Open(&Seq, "log.cbor") != 0) {
+ *       // errno-style error
+ *    }
+ *    while(QCBORMappedSequence_GetNextDecoder(&Seq, &DCtx) == QCBOR_SUCCESS) {
+ *       // Decode the item with DCtx and QCBORDecode_Finish()
+ *    }
+ *    if(QCBORMappedSequence_GetError(&Seq) != QCBOR_ERR_NO_MORE_ITEMS) {
+ *       // The file is not a well-formed sequence
+ *    }
+ *    QCBORMappedSequence_Close(&Seq);
+ * @endcode
+ *
+ * This is not thread safe. Use one @ref QCBORMappedSequence per
+ * thread, or see QCBORDecode_SplitSequence() to split up the work.
+ */
+
+
+/**
+ * A memory-mapped CBOR sequence. The members are private.
+ */
+typedef struct {
+   /* PRIVATE DATA STRUCTURE */
+   const uint8_t *pMapped;   /* NULL for an empty file */
+   size_t         uLength;
+   size_t         uOffset;   /* Of the next item */
+   size_t         uReleased; /* Pages before this are given back */
+   size_t         uChunk;    /* Size of the paging hints, page multiple */
+   QCBORError     uError;    /* Last result of getting an item */
+} QCBORMappedSequence;
+
+
+/**
+ * @brief Map a file of a CBOR sequence.
+ *
+ * @param[out] pMe         The mapped sequence to initialize.
+ * @param[in] szFileName   The file to map.
+ *
+ * @returns 0 or an @c errno value from opening or mapping the file.
+ *
+ * The file is mapped read-only and private. The whole file is
+ * mapped, but only the pages near the item being decoded are kept
+ * in memory if the OS takes the hints. The file must not be
+ * truncated while it is mapped.
+ */
+int
+QCBORMappedSequence_Open(QCBORMappedSequence *pMe, const char *szFileName);
+
+
+/**
+ * @brief Get the next encoded data item in the sequence.
+ *
+ * @param[in] pMe     The mapped sequence.
+ * @param[out] pItem  The encoded data item in the mapping.
+ *
+ * @returns The same as QCBORDecode_GetNextSequenceItem().
+ *
+ * @c *pItem points into the mapping and is valid until
+ * QCBORMappedSequence_Close(). Pages before the current item are
+ * released as getting items goes on. They are read again from the
+ * file if an earlier item is used after that, so it still works but
+ * is slower.
+ */
+QCBORError
+QCBORMappedSequence_GetNext(QCBORMappedSequence *pMe, UsefulBufC *pItem);
+
+
+/**
+ * @brief Get the next data item in the sequence ready to decode.
+ *
+ * @param[in] pMe     The mapped sequence.
+ * @param[out] pDCtx  Decode context to initialize.
+ *
+ * @returns The same as QCBORMappedSequence_GetNext().
+ *
+ * On success @c pDCtx is initialized with QCBORDecode_Init() in @ref
+ * QCBOR_DECODE_MODE_NORMAL on the next item. Set up anything else,
+ * such as a string allocator, before decoding.
+ */
+QCBORError
+QCBORMappedSequence_GetNextDecoder(QCBORMappedSequence *pMe, QCBORDecodeContext *pDCtx);
+
+
+/**
+ * @brief Get the result of the last item gotten.
+ *
+ * @param[in] pMe  The mapped sequence.
+ *
+ * @returns @ref QCBOR_ERR_NO_MORE_ITEMS after the last item.
+ */
+static QCBORError
+QCBORMappedSequence_GetError(const QCBORMappedSequence *pMe);
+
+
+/**
+ * @brief Get the offset of the next item in the file.
+ *
+ * @param[in] pMe  The mapped sequence.
+ *
+ * @returns The offset. When getting an item fails this is where the
+ *          bad item starts.
+ */
+static size_t
+QCBORMappedSequence_Tell(const QCBORMappedSequence *pMe);
+
+
+/**
+ * @brief Unmap the file.
+ *
+ * @param[in] pMe  The mapped sequence.
+ */
+void
+QCBORMappedSequence_Close(QCBORMappedSequence *pMe);
+
+
+
+
+/* ========================================================================= *
+ *    BEGINNING OF PRIVATE INLINE IMPLEMENTATION                             *
+ * ========================================================================= */
+
+static inline QCBORError
+QCBORMappedSequence_GetError(const QCBORMappedSequence *pMe)
+{
+   return pMe->uError;
+}
+
+static inline size_t
+QCBORMappedSequence_Tell(const QCBORMappedSequence *pMe)
+{
+   return pMe->uOffset;
+}
+
+/* ========================================================================= *
+ *    END OF PRIVATE INLINE IMPLEMENTATION                                   *
+ * ========================================================================= */
+
+#endif /* qcbor_mmap_h */
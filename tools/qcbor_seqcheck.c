@@ -0,0 +1,79 @@
+/* =========================================================================
+   qcbor_seqcheck.c -- Check a file of a CBOR sequence
+
+   Copyright (c) 2026, Laurence Lundblade. All rights reserved.
+
+   SPDX-License-Identifier: BSD-3-Clause
+
+   See BSD-3-Clause license in file named "LICENSE"
+
+   Created on 10/16/26
+  ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "qcbor_mmap.h"
+
+
+/*
+ * Usage: qcbor_seqcheck file...
+ *
+ * Maps each file and decodes every item in it with
+ * QCBORDecode_VGetNextConsume(). Prints the number of items or where
+ * the first error is. This is also an example of using
+ * QCBORMappedSequence.
+ */
+int
+main(int argc, char *argv[])
+{
+   QCBORMappedSequence Seq;
+   QCBORDecodeContext  DCtx;
+   QCBORItem           Item;
+   QCBORError          uErr;
+   size_t              uCount;
+   size_t              uItemStart;
+   int                 nErr;
+   int                 nResult;
+
+   if(argc < 2) {
+      fprintf(stderr, "Usage: %s file...\n", argv[0]);
+      return 2;
+   }
+
+   nResult = 0;
+   for(int i = 1; i < argc; i++) {
+      nErr = QCBORMappedSequence_Open(&Seq, argv[i]);
+      if(nErr != 0) {
+         fprintf(stderr, "%s: %s\n", argv[i], strerror(nErr));
+         nResult = 1;
+         continue;
+      }
+
+      uCount     = 0;
+      uItemStart = 0;
+      while(QCBORMappedSequence_GetNextDecoder(&Seq, &DCtx) == QCBOR_SUCCESS) {
+         QCBORDecode_VGetNextConsume(&DCtx, &Item);
+         uErr = QCBORDecode_Finish(&DCtx);
+         if(uErr != QCBOR_SUCCESS) {
+            printf("%s: item %zu at offset %zu: %s\n",
+                   argv[i], uCount, uItemStart, qcbor_err_to_str(uErr));
+            nResult = 1;
+         }
+         uItemStart = QCBORMappedSequence_Tell(&Seq);
+         uCount++;
+      }
+
+      uErr = QCBORMappedSequence_GetError(&Seq);
+      if(uErr != QCBOR_ERR_NO_MORE_ITEMS) {
+         printf("%s: not well-formed at offset %zu: %s\n",
+                argv[i], QCBORMappedSequence_Tell(&Seq), qcbor_err_to_str(uErr));
+         nResult = 1;
+      } else {
+         printf("%s: %zu items\n", argv[i], uCount);
+      }
+
+      QCBORMappedSequence_Close(&Seq);
+   }
+
+   return nResult;
+}